@@ -2,6 +2,8 @@
 #include <random>
 #include <functional>
 #include <bit>
+#include <fstream>
+#include <iterator>
 #include <Windows.h>
 
 #include "app.h"
@@ -10,6 +12,7 @@
 #include "core/zec_math.h"
 #include "utils/exceptions.h"
 #include "camera.h"
+#include "dynamic_resolution.h"
 #include "gltf_loading.h"
 #include "gfx/render_task_system.h"
 #include "gfx/pipeline_compilation_manager.h"
@@ -31,6 +34,7 @@
 #include "compute_tasks/irradiance_map_creator.h"
 
 #include "cpu_tasks.h"
+#include "task_graph.h"
 
 static constexpr u32 DESCRIPTOR_TABLE_SIZE = 4096;
 static constexpr size_t MAX_NUM_OBJECTS = 16384;
@@ -146,11 +150,35 @@ namespace clustered
         return usage_name_map[index];
     }
 
+    // What the render graph compiled to last time. Only used when the passes and resources are still the same.
+    constexpr const char* RENDER_GRAPH_CACHE_PATH = "render_graph_cache.bin";
+
+    bool load_compiled_render_graph(render_graph::RenderTaskList& render_task_list)
+    {
+        std::ifstream file{ RENDER_GRAPH_CACHE_PATH, std::ios::binary };
+        if (!file)
+        {
+            return false;
+        }
+        const std::vector<u8> data(std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{});
+        return render_task_list.load_compiled(data);
+    }
+
+    void save_compiled_render_graph(const render_graph::RenderTaskList& render_task_list)
+    {
+        const std::vector<u8> data = render_task_list.serialize_compiled();
+        std::ofstream file{ RENDER_GRAPH_CACHE_PATH, std::ios::binary | std::ios::trunc };
+        file.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+    }
+
     class ClusteredForward : public zec::App
     {
 
     public:
-        ClusteredForward() : App{ L"Clustered Forward Rendering" } { }
+        ClusteredForward() : App{ L"Clustered Forward Rendering" }
+        {
+            pipelined_frames = true;
+        }
 
         FPSCameraController camera_controller = {};
 
@@ -173,14 +201,97 @@ namespace clustered
         render_graph::RenderTaskList render_task_list = {};
 
         render_graph::PassHandle pass_handles[std::size(render_pass_task_descs)] = {};
-
-        TaskScheduler task_scheduler{};
+        // Depth tests against the depth target while drawing into the full size SDR target, so it needs them to match
+        render_graph::PassHandle cluster_debug_pass_handle = {};
+
+        // Scales the depth and HDR targets to keep the frame time on target, the tone mapping pass upscales them.
+        // Driven by the CPU frame time, since we don't read back GPU timestamps. That's synced to vsync, so it can't drop
+        // below the target and the scale has to creep back up on its own.
+        DynamicResolutionController dynamic_resolution_controller{ DynamicResolutionDesc{ .target_frame_time_ms = 16.6f, .recovery_rate = 0.002f } };
+        bool dynamic_resolution_enabled = false;
+        float render_scale = 1.0f;
+
+        // Per frame work that can overlap, built once in init()
+        TaskGraph update_graph{};
+        TaskGraph copy_graph{};
+        // Inputs to the update graph, captured before it is submitted
+        zec::input::InputState frame_input_state = {};
+        float frame_delta_seconds = 0.0f;
+
+        // Requests from the UI that touch render state, applied at the frame hand-off rather than while a frame may be rendering
+        render_graph::PipelineId pipeline_to_recompile = {};
+        render_graph::PassHandle pass_to_toggle = {};
+        bool pass_toggle_enabled = false;
+
+        enum struct CompilationState : u32
+        {
+            INVALID = 0,
+            SUCCESS,
+            FAILURE
+        };
+        CompilationState compilation_state = CompilationState::INVALID;
+        std::string compilation_errors = {};
+        // Copied from the resource context at the frame hand-off so the UI never reads it mid-compile
+        render_graph::TransientMemoryStats transient_memory_stats = {};
+        // Same for the render task list's rolling averages, indexed like pass_handles
+        render_graph::PassStats pass_stats[std::size(render_pass_task_descs)] = {};
+        render_graph::RenderGraphFrameStats render_graph_frame_stats = {};
+
+        void build_task_graphs()
+        {
+            TaskGraphNodeHandle camera_node = update_graph.add_node({
+                .name = "Camera Update",
+                .function = [](TaskScheduler* task_scheduler, void* arg) {
+                    ClusteredForward* app = static_cast<ClusteredForward*>(arg);
+                    app->camera_controller.update(app->camera, app->frame_input_state, app->frame_delta_seconds);
+                    app->camera_controller.apply(app->camera);
+                },
+                .arg = this,
+                .priority = TaskPriority::HIGH,
+            });
+            TaskGraphNodeHandle world_bounds_node = update_graph.add_node({
+                .name = "World Bounds Update",
+                .function = [](TaskScheduler* task_scheduler, void* arg) {
+                    static_cast<ClusteredForward*>(arg)->renderable_scene.renderables.world_bounds.update();
+                },
+                .arg = this,
+                .priority = TaskPriority::HIGH,
+            });
+            TaskGraphNodeHandle culling_node = update_graph.add_node({
+                .name = "Main Camera Culling",
+                .function = [](TaskScheduler* task_scheduler, void* arg) {
+                    ClusteredForward* app = static_cast<ClusteredForward*>(arg);
+                    app->renderable_camera.cull(app->renderable_scene.renderables);
+                },
+                .arg = this,
+                .priority = TaskPriority::HIGH,
+            });
+            update_graph.add_dependency(camera_node, culling_node);
+            update_graph.add_dependency(world_bounds_node, culling_node);
+            update_graph.compile();
+
+            // The copies write to separate buffers, so they're independent of one another
+            copy_graph.add_node({
+                .name = "Camera Copy",
+                .function = [](TaskScheduler* task_scheduler, void* arg) {
+                    static_cast<ClusteredForward*>(arg)->renderable_camera.copy();
+                },
+                .arg = this,
+            });
+            copy_graph.add_node({
+                .name = "Scene Copy",
+                .function = [](TaskScheduler* task_scheduler, void* arg) {
+                    ClusteredForward* app = static_cast<ClusteredForward*>(arg);
+                    app->renderable_scene.copy(app->spot_lights, app->point_lights);
+                },
+                .arg = this,
+            });
+            copy_graph.compile();
+        }
 
     protected:
         void init() override final
         {
-            task_scheduler.init();
-
             camera = create_camera(float(width) / float(height), VERTICAL_FOV, CAMERA_NEAR, CAMERA_FAR, CAMERA_CREATION_FLAG_REVERSE_Z);
             camera.position = vec3{ -5.5f, 4.4f, -0.2f };
 
@@ -471,6 +582,10 @@ namespace clustered
                     const render_graph::PassDesc* pass_desc = render_pass_task_descs[i];
                     render_graph::PassListBuilder::Result res = pass_list_builder.add_pass(*pass_desc);
                     pass_handles[i] = res.get_pass_handle();
+                    if (pass_desc == &clustered_debug_pass::pass_desc)
+                    {
+                        cluster_debug_pass_handle = pass_handles[i];
+                    }
                 }
             }
 
@@ -480,8 +595,16 @@ namespace clustered
             render_task_list.create_settings(to_rid(ESettingsIds::CLUSTER_GRID_SETUP), CLUSTER_SETUP);
             render_task_list.create_settings(to_rid(ESettingsIds::MAIN_PASS_VIEW_CB), renderable_camera.view_constant_buffer);
             render_task_list.create_settings(to_rid(ESettingsIds::RENDERABLE_SCENE_PTR), &renderable_scene);
+            render_task_list.create_settings(to_rid(ESettingsIds::MAIN_PASS_VISIBLE_LIST_PTR), static_cast<const Array<u32>*>(&renderable_camera.render_visible_list));
 
             render_task_list.setup();
+            if (!load_compiled_render_graph(render_task_list))
+            {
+                render_task_list.compile();
+                save_compiled_render_graph(render_task_list);
+            }
+
+            build_task_graphs();
 
             gfx::cmd::cpu_wait(receipt);
         }
@@ -495,11 +618,24 @@ namespace clustered
         {
             static bool show_pipeline_menu = false;
             static bool show_render_task_list = false;
-            zec::input::InputState input_state = input_manager.get_state();
+            frame_input_state = input_manager.get_state();
+            frame_delta_seconds = time_data.delta_seconds_f;
+
+            TaskCounter update_counter{};
+            update_graph.submit(task_scheduler, update_counter);
 
-            camera_controller.update(camera, input_state, time_data.delta_seconds_f);
-            camera_controller.apply(camera);
+            const bool cluster_debug_enabled = render_task_list.get_pass_enabled(cluster_debug_pass_handle);
+            if (dynamic_resolution_enabled && !cluster_debug_enabled)
+            {
+                render_scale = dynamic_resolution_controller.update(time_data.delta_seconds_f * 1000.0f);
+            }
+            else
+            {
+                dynamic_resolution_controller.reset();
+                render_scale = dynamic_resolution_controller.get_render_scale();
+            }
 
+            // ImGui isn't thread safe, so the UI stays on this thread and overlaps with the update graph
             ui::begin_frame();
             ImGui::ShowDemoWindow();
 
@@ -507,6 +643,33 @@ namespace clustered
             const auto framerate = ImGui::GetIO().Framerate;
             ImGui::Begin("Clustered Forward Rendering");
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / framerate, framerate);
+            ImGui::Text(
+                "Transient memory: %.1f MB (%.1f MB without aliasing)",
+                float(transient_memory_stats.heap_byte_size) / (1024.0f * 1024.0f),
+                float(transient_memory_stats.unaliased_byte_size) / (1024.0f * 1024.0f)
+            );
+            ImGui::Text("UAV barriers elided: %u", render_task_list.get_num_elided_uav_barriers());
+            ImGui::Text(
+                "Render graph recording: %.3f ms, %u command lists in %u submits, %u GPU waits",
+                render_graph_frame_stats.cpu_record_ms,
+                render_graph_frame_stats.num_command_lists,
+                render_graph_frame_stats.num_submits,
+                render_graph_frame_stats.num_gpu_waits
+            );
+            ImGui::Checkbox("Dynamic resolution", &dynamic_resolution_enabled);
+            if (dynamic_resolution_enabled)
+            {
+                float target_frame_time_ms = dynamic_resolution_controller.get_desc().target_frame_time_ms;
+                if (ImGui::SliderFloat("Target frame time (ms)", &target_frame_time_ms, 4.0f, 33.3f))
+                {
+                    dynamic_resolution_controller.set_target_frame_time(target_frame_time_ms);
+                }
+                ImGui::Text("Render scale: %.2f", render_scale);
+                if (cluster_debug_enabled)
+                {
+                    ImGui::Text("Held at full scale while the Cluster Debug Pass is enabled");
+                }
+            }
             if (ImGui::Button("Open pipelines menus"))
             {
                 show_pipeline_menu = true;
@@ -523,15 +686,8 @@ namespace clustered
             {
                 if (ImGui::Begin("Pipelines", &show_pipeline_menu, ImGuiWindowFlags_MenuBar))
                 {
-                    enum struct CompilationState : u32
-                    {
-                        INVALID = 0,
-                        SUCCESS,
-                        FAILURE
-                    };
-
-                    static CompilationState state = CompilationState::INVALID;
-                    static std::string errors = {};
+                    CompilationState& state = compilation_state;
+                    std::string& errors = compilation_errors;
                     static render_graph::PipelineId selected = {};
                     {
                         ImGui::BeginChild("pipeline list", ImVec2(0, 100), true);
@@ -555,8 +711,7 @@ namespace clustered
                     {
                         if (ImGui::Button("Reload Shader"))
                         {
-                            ZecResult res = shader_store.recompile(selected, errors);
-                            state = (res == ZecResult::SUCCESS) ? CompilationState::SUCCESS : CompilationState::FAILURE;
+                            pipeline_to_recompile = selected;
                         }
 
                         if (state == CompilationState::SUCCESS)
@@ -609,12 +764,15 @@ namespace clustered
                         ImGui::Text(pass_desc->name.data());
                         ImGui::Separator();
                         bool enabled = render_task_list.get_pass_enabled(pass_handle);
-                        ImGui::Checkbox("Enabled", &enabled);
-                        render_task_list.set_pass_enabled(pass_handle, enabled);
+                        if (ImGui::Checkbox("Enabled", &enabled))
+                        {
+                            pass_to_toggle = pass_handle;
+                            pass_toggle_enabled = enabled;
+                        }
 
                         ImGui::Text("Queue Type: ");
                         ImGui::SameLine();
-                        if (pass_desc->command_queue_type == CommandQueueType::GRAPHICS)
+                        if (render_task_list.get_pass_queue(pass_handle) == CommandQueueType::GRAPHICS)
                         {
                             ImGui::Text("Graphics");
                         }
@@ -623,6 +781,17 @@ namespace clustered
                             ImGui::Text("Compute");
                         }
 
+                        const PassStats& stats = pass_stats[selected_index];
+                        ImGui::Text("CPU Record Time: %.3f ms", stats.cpu_record_ms);
+                        ImGui::Text("Draws: %u, Dispatches: %u", stats.num_draws, stats.num_dispatches);
+                        ImGui::Text(
+                            "Transitions: %u, UAV Barriers: %u, Aliasing Barriers: %u",
+                            stats.num_transitions,
+                            stats.num_uav_barriers,
+                            stats.num_aliasing_barriers
+                        );
+                        ImGui::Text("Command Lists: %u", stats.num_command_lists);
+
                         const auto render_pass_resource_usage = [](const render_graph::PassResourceUsage& usage)
                         {
                             if (usage.type == PassResourceType::TEXTURE)
@@ -678,27 +847,59 @@ namespace clustered
 
             ImGui::End();
             ui::end_frame();
+
+            task_scheduler.wait_on_counter(update_counter);
         }
 
-        void copy() override final
+        void publish_frame_state() override final
         {
-            renderable_camera.copy();
+            renderable_camera.publish();
 
-            renderable_scene.copy(spot_lights, point_lights);
+            if (pipeline_to_recompile.is_valid())
+            {
+                ZecResult res = shader_store.recompile(pipeline_to_recompile, compilation_errors);
+                compilation_state = (res == ZecResult::SUCCESS) ? CompilationState::SUCCESS : CompilationState::FAILURE;
+                pipeline_to_recompile = {};
+            }
 
-            // Make sure the relevant settings are updated
+            if (is_valid(pass_to_toggle))
+            {
+                render_task_list.set_pass_enabled(pass_to_toggle, pass_toggle_enabled);
+                pass_to_toggle = {};
+            }
+
+            transient_memory_stats = resource_context.get_transient_memory_stats();
+            for (size_t i = 0; i < std::size(pass_handles); i++)
+            {
+                pass_stats[i] = render_task_list.get_average_pass_stats(pass_handles[i]);
+            }
+            render_graph_frame_stats = render_task_list.get_average_frame_stats();
+            resource_context.set_render_scale(render_scale);
+
+            if (pipelined_frames)
+            {
+                ui::capture_frame();
+            }
+        }
+
+        void copy() override final
+        {
+            copy_graph.execute(task_scheduler);
         }
 
         void render() override final
         {
-            render_task_list.execute(/*task_scheduler*/);
+            render_task_list.execute(task_scheduler);
         }
 
         void before_reset() override final
         { }
 
         void after_reset() override final
-        { }
+        {
+            // Recreates the render targets sized relative to the swap chain
+            resource_context.set_render_config_state(gfx::get_config_state());
+        }
     };
 
 }
@@ -25,6 +25,8 @@ namespace clustered
                 .usage = zec::RESOURCE_USAGE_DEPTH_STENCIL,
                 .initial_state = zec::RESOURCE_USAGE_DEPTH_STENCIL,
             },
+            .is_transient = true,
+            .dynamic_resolution = true,
         };
         zec::render_graph::TextureResourceDesc HDR_TARGET = {
             .identifier = to_rid(EResourceIds::HDR_TARGET),
@@ -41,6 +43,8 @@ namespace clustered
                 .usage = zec::RESOURCE_USAGE_RENDER_TARGET | zec::RESOURCE_USAGE_SHADER_READABLE,
                 .initial_state = zec::RESOURCE_USAGE_RENDER_TARGET,
             },
+            .is_transient = true,
+            .dynamic_resolution = true,
         };
         zec::render_graph::TextureResourceDesc SDR_TARGET = {
             .identifier = to_rid(EResourceIds::SDR_TARGET),
@@ -68,7 +72,8 @@ namespace clustered
                 .type = zec::BufferType::RAW,
                 .byte_size = 0,
                 .stride = 4,
-            }
+            },
+            .is_transient = true,
         };
         zec::render_graph::BufferResourceDesc POINT_LIGHT_INDICES = {
             .identifier = to_rid(EResourceIds::POINT_LIGHT_INDICES),
@@ -79,7 +84,8 @@ namespace clustered
                 .type = zec::BufferType::RAW,
                 .byte_size = 0,
                 .stride = 4,
-            }
+            },
+            .is_transient = true,
         };
     }
 
@@ -168,7 +174,7 @@ namespace clustered
         {
             .constants = {{
                 .visibility = zec::ShaderVisibility::PIXEL,
-                .num_constants = 2
+                .num_constants = 6
                 }},
             .num_constants = 1,
             .num_constant_buffers = 0,
@@ -178,7 +184,8 @@ namespace clustered
             .num_resource_tables = 1,
             .static_samplers = {
                 {
-                    .filtering = zec::SamplerFilterType::MIN_POINT_MAG_POINT_MIP_POINT,
+                    // Bilinear, to upscale the HDR target when it's rendered at a lower resolution
+                    .filtering = zec::SamplerFilterType::MIN_LINEAR_MAG_LINEAR_MIP_POINT,
                     .wrap_u = zec::SamplerWrapMode::CLAMP,
                     .wrap_v = zec::SamplerWrapMode::CLAMP,
                     .binding_slot = 0,
@@ -23,6 +23,7 @@ namespace clustered
         BACKGROUND_CUBE_MAP,
         FULLSCREEN_QUAD,
         EXPOSURE,
+        MAIN_PASS_VISIBLE_LIST_PTR,
 
         COUNT
     };
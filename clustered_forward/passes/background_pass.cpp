@@ -17,6 +17,14 @@ namespace clustered
             RESOURCE_TABLE
         };
 
+        struct BackgroundPassData
+        {
+            PassDataRef<TextureHandle> background_cube_map;
+            PassDataRef<BufferHandle> view_cb;
+            PassDataRef<MeshHandle> fullscreen_mesh;
+        };
+        MAKE_IDENTIFIER(BACKGROUND_PASS_DATA);
+
         static constexpr PassResourceUsage inputs[] = {
             {
                 .identifier = to_rid(EResourceIds::DEPTH_TARGET),
@@ -36,31 +44,35 @@ namespace clustered
 
     namespace background_pass
     {
+        static void background_pass_setup(const SettingsStore* settings_context, PerPassDataStore* per_pass_data_store)
+        {
+            per_pass_data_store->emplace(BACKGROUND_PASS_DATA, BackgroundPassData{
+                .background_cube_map = settings_context->get_ref<TextureHandle>(to_rid(ESettingsIds::BACKGROUND_CUBE_MAP)),
+                .view_cb = settings_context->get_ref<BufferHandle>(to_rid(ESettingsIds::MAIN_PASS_VIEW_CB)),
+                .fullscreen_mesh = settings_context->get_ref<MeshHandle>(to_rid(ESettingsIds::FULLSCREEN_QUAD)),
+            });
+        }
+
         static void background_pass_execution(const render_graph::PassExecutionContext* context)
         {
             const CommandContextHandle cmd_ctx = context->cmd_context;
-            const ResourceContext& resource_context = *context->resource_context;
             const PipelineStore& pipeline_context = *context->pipeline_context;
-            const SettingsStore& settings_context = *context->settings_context;
+            const BackgroundPassData& pass_data = context->get_pass_data<BackgroundPassData>();
 
-            TextureHandle depth_target = resource_context.get_texture(to_rid(EResourceIds::DEPTH_TARGET));
-            TextureHandle hdr_buffer = resource_context.get_texture(to_rid(EResourceIds::HDR_TARGET));
-            const TextureInfo& texture_info = gfx::textures::get_texture_info(hdr_buffer);
-            Viewport viewport = { 0.0f, 0.0f, static_cast<float>(texture_info.width), static_cast<float>(texture_info.height) };
-            Scissor scissor{ 0, 0, texture_info.width, texture_info.height };
+            const Viewport viewport = context->get_output_viewport(0);
+            const Scissor scissor = context->get_output_scissor(0);
 
             const ResourceLayoutHandle resource_layout = pipeline_context.get_resource_layout(to_rid(EResourceLayoutIds::BACKGROUND_PASS_RESOURCE_LAYOUT));
             const PipelineStateHandle pso = pipeline_context.get_pipeline(to_rid(EPipelineIds::BACKGROUND_PASS_PIPELINE));
 
             gfx::cmd::set_graphics_resource_layout(cmd_ctx, resource_layout);
             gfx::cmd::set_graphics_pipeline_state(cmd_ctx, pso);
-            gfx::cmd::set_render_targets(cmd_ctx, &hdr_buffer, 1, depth_target);
             gfx::cmd::set_viewports(cmd_ctx, &viewport, 1);
             gfx::cmd::set_scissors(cmd_ctx, &scissor, 1);
 
-            const TextureHandle background_cube_map = settings_context.get<TextureHandle>(to_rid(ESettingsIds::BACKGROUND_CUBE_MAP));
-            const BufferHandle view_cb_handle = settings_context.get<BufferHandle>(to_rid(ESettingsIds::MAIN_PASS_VIEW_CB));
-            const MeshHandle fullscreen_mesh = settings_context.get<MeshHandle>(to_rid(ESettingsIds::FULLSCREEN_QUAD));
+            const TextureHandle background_cube_map = *pass_data.background_cube_map;
+            const BufferHandle view_cb_handle = *pass_data.view_cb;
+            const MeshHandle fullscreen_mesh = *pass_data.fullscreen_mesh;
 
             struct Constants
             {
@@ -81,6 +93,7 @@ namespace clustered
         extern const render_graph::PassDesc pass_desc = {
             .name = "Background Pass",
             .command_queue_type = zec::CommandQueueType::GRAPHICS,
+            .setup_fn = &background_pass_setup,
             .execute_fn = &background_pass_execution,
             .inputs = inputs,
             .outputs = outputs,
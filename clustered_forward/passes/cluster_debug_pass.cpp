@@ -22,6 +22,10 @@ namespace clustered
         struct ClusterDebugPassData
         {
             BufferHandle cluster_grid_cb;
+            PassDataRef<ClusterGridSetup> cluster_grid_setup;
+            PassDataRef<RenderableScene*> scene;
+            PassDataRef<BufferHandle> view_cb;
+            PassDataRef<const Array<u32>*> visible_list;
         };
         MAKE_IDENTIFIER(CLUSTER_DEBUG_PASS_DATA);
 
@@ -55,6 +59,8 @@ namespace clustered
                 .identifier = to_rid(EResourceIds::SDR_TARGET),
                 .type = PassResourceType::TEXTURE,
                 .usage = RESOURCE_USAGE_RENDER_TARGET,
+                .contents = AttachmentContents::CLEARED,
+                .clear_value = { 0.0f, 0.0f, 0.0f, 1.0f },
             },
         };
 
@@ -71,33 +77,31 @@ namespace clustered
                 .stride = 0 });
             gfx::set_debug_name(cluster_grid_cb, L"Cluster Grid Constants");
             per_pass_data_store->emplace(CLUSTER_DEBUG_PASS_DATA, ClusterDebugPassData{
-                .cluster_grid_cb = cluster_grid_cb
+                .cluster_grid_cb = cluster_grid_cb,
+                .cluster_grid_setup = settings_context->get_ref<ClusterGridSetup>(to_rid(ESettingsIds::CLUSTER_GRID_SETUP)),
+                .scene = settings_context->get_ref<RenderableScene*>(to_rid(ESettingsIds::RENDERABLE_SCENE_PTR)),
+                .view_cb = settings_context->get_ref<BufferHandle>(to_rid(ESettingsIds::MAIN_PASS_VIEW_CB)),
+                .visible_list = settings_context->get_ref<const Array<u32>*>(to_rid(ESettingsIds::MAIN_PASS_VISIBLE_LIST_PTR)),
             });
         }
 
         static void cluster_debug_execution(const PassExecutionContext* context)
         {
             const CommandContextHandle cmd_ctx = context->cmd_context;
-            const ResourceContext& resource_context = *context->resource_context;
             const PipelineStore& pipeline_context = *context->pipeline_context;
-            const SettingsStore& settings_context = *context->settings_context;
+            const ClusterDebugPassData& pass_data = context->get_pass_data<ClusterDebugPassData>();
 
-            const BufferHandle spot_light_indices_buffer = resource_context.get_buffer(to_rid(EResourceIds::SPOT_LIGHT_INDICES));
-            const BufferHandle point_light_indices_buffer = resource_context.get_buffer(to_rid(EResourceIds::POINT_LIGHT_INDICES));
+            const BufferHandle spot_light_indices_buffer = context->get_input_buffer(1);
+            const BufferHandle point_light_indices_buffer = context->get_input_buffer(2);
 
-            const ClusterGridSetup cluster_grid_setup = settings_context.get<ClusterGridSetup>(to_rid(ESettingsIds::CLUSTER_GRID_SETUP));
             ClusterGridConstants binning_constants = {
-                .setup = cluster_grid_setup,
+                .setup = *pass_data.cluster_grid_setup,
                 .spot_light_indices_list_idx = gfx::buffers::get_shader_readable_index(spot_light_indices_buffer),
                 .point_light_indices_list_idx = gfx::buffers::get_shader_readable_index(point_light_indices_buffer),
             };
-            const ClusterDebugPassData pass_data = context->per_pass_data_store->get<ClusterDebugPassData>(CLUSTER_DEBUG_PASS_DATA);
             gfx::buffers::update(pass_data.cluster_grid_cb, &binning_constants, sizeof(binning_constants));
 
-            constexpr float clear_color[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
-
-            TextureHandle depth_target = resource_context.get_texture(to_rid(EResourceIds::DEPTH_TARGET));
-            TextureHandle render_target = resource_context.get_texture(outputs[0].identifier);
+            TextureHandle render_target = context->get_output_texture(0);
             const TextureInfo& texture_info = gfx::textures::get_texture_info(render_target);
             Viewport viewport = { 0.0f, 0.0f, static_cast<float>(texture_info.width), static_cast<float>(texture_info.height) };
             Scissor scissor{ 0, 0, texture_info.width, texture_info.height };
@@ -109,11 +113,9 @@ namespace clustered
             gfx::cmd::set_viewports(cmd_ctx, &viewport, 1);
             gfx::cmd::set_scissors(cmd_ctx, &scissor, 1);
 
-            gfx::cmd::clear_render_target(cmd_ctx, render_target, clear_color);
-            gfx::cmd::set_render_targets(cmd_ctx, &render_target, 1, depth_target);
 
-            const RenderableScene* scene_data = settings_context.get<RenderableScene*>(to_rid(ESettingsIds::RENDERABLE_SCENE_PTR));
-            const BufferHandle view_cb_handle = settings_context.get<BufferHandle>(to_rid(ESettingsIds::MAIN_PASS_VIEW_CB));
+            const RenderableScene* scene_data = *pass_data.scene;
+            const BufferHandle view_cb_handle = *pass_data.view_cb;
             gfx::cmd::bind_graphics_constant_buffer(cmd_ctx, view_cb_handle, u32(BindingSlots::VIEW_CONSTANT_BUFFER));
             gfx::cmd::bind_graphics_constant_buffer(cmd_ctx, scene_data->scene_constants, u32(BindingSlots::SCENE_CONSTANT_BUFFER));
             gfx::cmd::bind_graphics_constant_buffer(cmd_ctx, pass_data.cluster_grid_cb, u32(BindingSlots::CLUSTER_GRID_CONSTANTS));
@@ -127,7 +129,8 @@ namespace clustered
             };
             gfx::cmd::bind_graphics_constants(cmd_ctx, &buffer_descriptors, 2, u32(BindingSlots::BUFFERS_DESCRIPTORS));
 
-            for (u32 i = 0; i < renderables.num_entities; i++) {
+            const Array<u32>& visible_list = **pass_data.visible_list;
+            for (const u32 i : visible_list) {
                 u32 per_draw_indices[] = {
                     i,
                     renderables.material_indices[i]
@@ -16,11 +16,22 @@ namespace clustered
             RAW_BUFFERS_TABLE,
         };
 
+        struct DepthPassData
+        {
+            PassDataRef<RenderableScene*> scene;
+            PassDataRef<BufferHandle> view_cb;
+            PassDataRef<const Array<u32>*> visible_list;
+        };
+        MAKE_IDENTIFIER(DEPTH_PASS_DATA);
+
         constexpr PassResourceUsage outputs[] = {
             {
                 .identifier = to_rid(EResourceIds::DEPTH_TARGET),
                 .type = PassResourceType::TEXTURE,
                 .usage = RESOURCE_USAGE_DEPTH_STENCIL,
+                // Reversed Z
+                .contents = AttachmentContents::CLEARED,
+                .clear_value = { 0.0f, 0.0f },
             },
         };
 
@@ -28,17 +39,23 @@ namespace clustered
 
     namespace depth_pass
     {
+        static void depth_pass_setup(const SettingsStore* settings_context, PerPassDataStore* per_pass_data_store)
+        {
+            per_pass_data_store->emplace(DEPTH_PASS_DATA, DepthPassData{
+                .scene = settings_context->get_ref<RenderableScene*>(to_rid(ESettingsIds::RENDERABLE_SCENE_PTR)),
+                .view_cb = settings_context->get_ref<BufferHandle>(to_rid(ESettingsIds::MAIN_PASS_VIEW_CB)),
+                .visible_list = settings_context->get_ref<const Array<u32>*>(to_rid(ESettingsIds::MAIN_PASS_VISIBLE_LIST_PTR)),
+            });
+        }
+
         void depth_pass_execution_fn(const PassExecutionContext* context)
         {
             const CommandContextHandle cmd_ctx = context->cmd_context;
-            const ResourceContext& resource_context = *context->resource_context;
             const PipelineStore& pipeline_context = *context->pipeline_context;
-            const SettingsStore& settings_context = *context->settings_context;
-            TextureHandle depth_target = resource_context.get_texture(to_rid(EResourceIds::DEPTH_TARGET));
+            const DepthPassData& pass_data = context->get_pass_data<DepthPassData>();
 
-            const TextureInfo& texture_info = gfx::textures::get_texture_info(depth_target);
-            Viewport viewport = { 0.0f, 0.0f, static_cast<float>(texture_info.width), static_cast<float>(texture_info.height) };
-            Scissor scissor{ 0, 0, texture_info.width, texture_info.height };
+            const Viewport viewport = context->get_output_viewport(0);
+            const Scissor scissor = context->get_output_scissor(0);
 
             const ResourceLayoutHandle resource_layout = pipeline_context.get_resource_layout(to_rid(EResourceLayoutIds::DEPTH_PASS_RESOURCE_LAYOUT));
             const PipelineStateHandle pso = pipeline_context.get_pipeline(to_rid(EPipelineIds::DEPTH_PASS_PIPELINE));
@@ -48,20 +65,22 @@ namespace clustered
             gfx::cmd::set_viewports(cmd_ctx, &viewport, 1);
             gfx::cmd::set_scissors(cmd_ctx, &scissor, 1);
 
-            gfx::cmd::clear_depth_target(cmd_ctx, depth_target, 0.0f, 0);
-            gfx::cmd::set_render_targets(cmd_ctx, nullptr, 0, depth_target);
 
-            const BufferHandle view_cb_handle = settings_context.get<BufferHandle>(to_rid(ESettingsIds::MAIN_PASS_VIEW_CB));
+            const BufferHandle view_cb_handle = *pass_data.view_cb;
             gfx::cmd::bind_graphics_constant_buffer(cmd_ctx, view_cb_handle, u32(BindingSlots::VIEW_CONSTANT_BUFFER));
 
-            const RenderableScene* scene_data = settings_context.get<RenderableScene*>(to_rid(ESettingsIds::RENDERABLE_SCENE_PTR));
+            const RenderableScene* scene_data = *pass_data.scene;
             const Renderables& renderables = scene_data->renderables;
             gfx::cmd::bind_graphics_resource_table(cmd_ctx, u32(BindingSlots::RAW_BUFFERS_TABLE));
 
             u32 buffer_descriptor = gfx::buffers::get_shader_readable_index(renderables.vs_buffer);
             gfx::cmd::bind_graphics_constants(cmd_ctx, &buffer_descriptor, 1, u32(BindingSlots::BUFFERS_DESCRIPTORS));
 
-            for (u32 i = 0; i < renderables.num_entities; i++) {
+            const Array<u32>& visible_list = **pass_data.visible_list;
+            size_t begin, end;
+            context->get_job_range(visible_list.size, begin, end);
+            for (size_t draw_idx = begin; draw_idx < end; draw_idx++) {
+                const u32 i = visible_list[draw_idx];
                 gfx::cmd::bind_graphics_constants(cmd_ctx, &i, 1, u32(BindingSlots::PER_INSTANCE_CONSTANTS));
                 gfx::cmd::draw_mesh(cmd_ctx, renderables.meshes[i]);
             }
@@ -70,9 +89,11 @@ namespace clustered
         extern const render_graph::PassDesc pass_desc = {
             .name = "Depth Prepass",
             .command_queue_type = zec::CommandQueueType::GRAPHICS,
+            .setup_fn = &depth_pass_setup,
             .execute_fn = &depth_pass_execution_fn,
             .inputs = {},
             .outputs = outputs,
+            .max_recording_jobs = 8,
         };
     }
 
@@ -29,6 +29,10 @@ namespace clustered
         struct ForwardPassData
         {
             BufferHandle cluster_grid_cb;
+            PassDataRef<ClusterGridSetup> cluster_grid_setup;
+            PassDataRef<RenderableScene*> scene;
+            PassDataRef<BufferHandle> view_cb;
+            PassDataRef<const Array<u32>*> visible_list;
         };
         MAKE_IDENTIFIER(FORWARD_PASS_DATA)
 
@@ -69,36 +73,36 @@ namespace clustered
                 .byte_size = sizeof(ClusterGridConstants),
                 .stride = 0 });
             gfx::set_debug_name(cluster_grid_cb, L"Forward Pass Binning Constants");
-            per_pass_data_store->emplace(FORWARD_PASS_DATA, ForwardPassData{ .cluster_grid_cb = cluster_grid_cb });
+            per_pass_data_store->emplace(FORWARD_PASS_DATA, ForwardPassData{
+                .cluster_grid_cb = cluster_grid_cb,
+                .cluster_grid_setup = settings_context->get_ref<ClusterGridSetup>(to_rid(ESettingsIds::CLUSTER_GRID_SETUP)),
+                .scene = settings_context->get_ref<RenderableScene*>(to_rid(ESettingsIds::RENDERABLE_SCENE_PTR)),
+                .view_cb = settings_context->get_ref<BufferHandle>(to_rid(ESettingsIds::MAIN_PASS_VIEW_CB)),
+                .visible_list = settings_context->get_ref<const Array<u32>*>(to_rid(ESettingsIds::MAIN_PASS_VISIBLE_LIST_PTR)),
+            });
         };
 
         static void forward_pass_execution(const PassExecutionContext* context)
         {
             const CommandContextHandle cmd_ctx = context->cmd_context;
-            const ResourceContext& resource_context = *context->resource_context;
             const PipelineStore& pipeline_context = *context->pipeline_context;
-            const SettingsStore& settings_context = *context->settings_context;
-            const PerPassDataStore& per_pass_data_store = *context->per_pass_data_store;
+            const ForwardPassData& pass_data = context->get_pass_data<ForwardPassData>();
 
-            const ForwardPassData pass_data = per_pass_data_store.get<ForwardPassData>(FORWARD_PASS_DATA);
-
-            const BufferHandle spot_light_indices_buffer = resource_context.get_buffer(to_rid(EResourceIds::SPOT_LIGHT_INDICES));
-            const BufferHandle point_light_indices_buffer = resource_context.get_buffer(to_rid(EResourceIds::POINT_LIGHT_INDICES));
-
-            const ClusterGridSetup cluster_grid_setup = settings_context.get<ClusterGridSetup>(to_rid(ESettingsIds::CLUSTER_GRID_SETUP));
+            const BufferHandle spot_light_indices_buffer = context->get_input_buffer(1);
+            const BufferHandle point_light_indices_buffer = context->get_input_buffer(2);
 
             ClusterGridConstants binning_constants = {
-                .setup = cluster_grid_setup,
+                .setup = *pass_data.cluster_grid_setup,
                 .spot_light_indices_list_idx = gfx::buffers::get_shader_readable_index(spot_light_indices_buffer),
                 .point_light_indices_list_idx = gfx::buffers::get_shader_readable_index(point_light_indices_buffer),
             };
-            gfx::buffers::update(pass_data.cluster_grid_cb, &binning_constants, sizeof(binning_constants));
+            // Every job binds the same constants, so only one of them has to write them
+            if (context->job_idx == 0) {
+                gfx::buffers::update(pass_data.cluster_grid_cb, &binning_constants, sizeof(binning_constants));
+            }
 
-            TextureHandle depth_target = resource_context.get_texture(to_rid(EResourceIds::DEPTH_TARGET));
-            TextureHandle render_target = resource_context.get_texture(to_rid(EResourceIds::HDR_TARGET));
-            const TextureInfo& texture_info = gfx::textures::get_texture_info(render_target);
-            Viewport viewport = { 0.0f, 0.0f, static_cast<float>(texture_info.width), static_cast<float>(texture_info.height) };
-            Scissor scissor{ 0, 0, texture_info.width, texture_info.height };
+            const Viewport viewport = context->get_output_viewport(0);
+            const Scissor scissor = context->get_output_scissor(0);
 
             const ResourceLayoutHandle resource_layout = pipeline_context.get_resource_layout(to_rid(EResourceLayoutIds::FORWARD_PASS_RESOURCE_LAYOUT));
             const PipelineStateHandle pso = pipeline_context.get_pipeline(to_rid(EPipelineIds::FORWARD_PASS_PIPELINE));
@@ -108,11 +112,9 @@ namespace clustered
             gfx::cmd::set_viewports(cmd_ctx, &viewport, 1);
             gfx::cmd::set_scissors(cmd_ctx, &scissor, 1);
 
-            gfx::cmd::set_render_targets(cmd_ctx, &render_target, 1, depth_target);
-
 
-            const RenderableScene* scene_data = settings_context.get<RenderableScene*>(to_rid(ESettingsIds::RENDERABLE_SCENE_PTR));
-            const BufferHandle view_cb_handle = settings_context.get<BufferHandle>(to_rid(ESettingsIds::MAIN_PASS_VIEW_CB));
+            const RenderableScene* scene_data = *pass_data.scene;
+            const BufferHandle view_cb_handle = *pass_data.view_cb;
             gfx::cmd::bind_graphics_constant_buffer(cmd_ctx, view_cb_handle, u32(BindingSlots::VIEW_CONSTANT_BUFFER));
             gfx::cmd::bind_graphics_constant_buffer(cmd_ctx, scene_data->scene_constants, u32(BindingSlots::SCENE_CONSTANT_BUFFER));
             gfx::cmd::bind_graphics_constant_buffer(cmd_ctx, pass_data.cluster_grid_cb, u32(BindingSlots::CLUSTER_GRID_CONSTANTS));
@@ -129,7 +131,11 @@ namespace clustered
             };
             gfx::cmd::bind_graphics_constants(cmd_ctx, &buffer_descriptors, 2, u32(BindingSlots::BUFFERS_DESCRIPTORS));
 
-            for (u32 i = 0; i < renderables.num_entities; i++) {
+            const Array<u32>& visible_list = **pass_data.visible_list;
+            size_t begin, end;
+            context->get_job_range(visible_list.size, begin, end);
+            for (size_t draw_idx = begin; draw_idx < end; draw_idx++) {
+                const u32 i = visible_list[draw_idx];
                 u32 per_draw_indices[] = {
                     i,
                     renderables.material_indices[i]
@@ -146,6 +152,7 @@ namespace clustered
             .execute_fn = &forward_pass_execution,
             .inputs = inputs,
             .outputs = outputs,
+            .max_recording_jobs = 8,
         };
     }
 
@@ -30,6 +30,9 @@ namespace clustered::light_binning_pass
         struct LightBinningPassData
         {
             BufferHandle cluster_grid_cb;
+            PassDataRef<ClusterGridSetup> cluster_grid_setup;
+            PassDataRef<RenderableScene*> scene;
+            PassDataRef<BufferHandle> view_cb;
         };
         MAKE_IDENTIFIER(LIGHT_BINNING_PASS_DATA);
 
@@ -58,29 +61,28 @@ namespace clustered::light_binning_pass
             .stride = 0 });
         gfx::set_debug_name(cluster_grid_cb, L"Cluster Grid Constants");
         per_pass_data_store->emplace(LIGHT_BINNING_PASS_DATA, LightBinningPassData{
-            .cluster_grid_cb = cluster_grid_cb
+            .cluster_grid_cb = cluster_grid_cb,
+            .cluster_grid_setup = settings_context->get_ref<ClusterGridSetup>(to_rid(ESettingsIds::CLUSTER_GRID_SETUP)),
+            .scene = settings_context->get_ref<RenderableScene*>(to_rid(ESettingsIds::RENDERABLE_SCENE_PTR)),
+            .view_cb = settings_context->get_ref<BufferHandle>(to_rid(ESettingsIds::MAIN_PASS_VIEW_CB)),
         });
     }
 
     void light_binning_execution(const PassExecutionContext* context)
     {
         const CommandContextHandle cmd_ctx = context->cmd_context;
-        const ResourceContext& resource_context = *context->resource_context;
         const PipelineStore& pipeline_context = *context->pipeline_context;
-        const SettingsStore& settings_context = *context->settings_context;
-        const PerPassDataStore* per_pass_data_store = context->per_pass_data_store;
 
-        const LightBinningPassData& pass_data = per_pass_data_store->get<LightBinningPassData>(LIGHT_BINNING_PASS_DATA);
+        const LightBinningPassData& pass_data = context->get_pass_data<LightBinningPassData>();
         const ResourceLayoutHandle resource_layout = pipeline_context.get_resource_layout(to_rid(EResourceLayoutIds::LIGHT_BINNING_PASS_RESOURCE_LAYOUT));
         const PipelineStateHandle spot_light_pso = pipeline_context.get_pipeline(to_rid(EPipelineIds::LIGHT_BINNING_PASS_SPOT_LIGHT_PIPELINE));
         const PipelineStateHandle point_light_pso = pipeline_context.get_pipeline(to_rid(EPipelineIds::LIGHT_BINNING_PASS_POINT_LIGHT_PIPELINE));
 
-        const BufferHandle spot_light_indices_buffer = resource_context.get_buffer(to_rid(EResourceIds::SPOT_LIGHT_INDICES));
-        const BufferHandle point_light_indices_buffer = resource_context.get_buffer(to_rid(EResourceIds::POINT_LIGHT_INDICES));
+        const BufferHandle spot_light_indices_buffer = context->get_output_buffer(0);
+        const BufferHandle point_light_indices_buffer = context->get_output_buffer(1);
 
-        const ClusterGridSetup cluster_grid_setup = settings_context.get<ClusterGridSetup>(to_rid(ESettingsIds::CLUSTER_GRID_SETUP));
         ClusterGridConstants binning_constants = {
-            .setup = cluster_grid_setup,
+            .setup = *pass_data.cluster_grid_setup,
             .spot_light_indices_list_idx = gfx::buffers::get_shader_writable_index(spot_light_indices_buffer),
             .point_light_indices_list_idx = gfx::buffers::get_shader_writable_index(point_light_indices_buffer),
         };
@@ -89,12 +91,12 @@ namespace clustered::light_binning_pass
         gfx::cmd::set_compute_resource_layout(cmd_ctx, resource_layout);
         gfx::cmd::set_compute_pipeline_state(cmd_ctx, spot_light_pso);
 
-        const BufferHandle view_cb_handle = settings_context.get<BufferHandle>(to_rid(ESettingsIds::MAIN_PASS_VIEW_CB));
+        const BufferHandle view_cb_handle = *pass_data.view_cb;
         gfx::cmd::bind_compute_constant_buffer(cmd_ctx, view_cb_handle, u32(BindingSlots::VIEW_CONSTANTS));
 
         gfx::cmd::bind_compute_constant_buffer(cmd_ctx, pass_data.cluster_grid_cb, u32(BindingSlots::CLUSTER_GRID_CONSTANTS));
 
-        const RenderableScene* renderable_scene = settings_context.get<RenderableScene*>(to_rid(ESettingsIds::RENDERABLE_SCENE_PTR));
+        const RenderableScene* renderable_scene = *pass_data.scene;
         gfx::cmd::bind_compute_constant_buffer(cmd_ctx, renderable_scene->scene_constants, u32(BindingSlots::SCENE_CONSTANTS));
 
         gfx::cmd::bind_compute_resource_table(cmd_ctx, u32(BindingSlots::READ_BUFFERS_TABLE));
@@ -119,5 +121,6 @@ namespace clustered::light_binning_pass
         .execute_fn = &light_binning_execution,
         .inputs = {},
         .outputs = outputs,
+        .allow_async_compute = true,
     };
 }
@@ -11,8 +11,19 @@ namespace clustered
         {
             u32 src_texture;
             float exposure;
+            // The HDR target may only be rendered to in part, see TextureResourceDesc::dynamic_resolution.
+            // uv_max keeps the bilinear taps from reaching past it.
+            float uv_scale[2];
+            float uv_max[2];
         };
 
+        struct ToneMappingPassData
+        {
+            PassDataRef<float> exposure;
+            PassDataRef<MeshHandle> fullscreen_mesh;
+        };
+        MAKE_IDENTIFIER(TONE_MAPPING_PASS_DATA);
+
         static constexpr PassResourceUsage inputs[] = {
             {
                 .identifier = to_rid(EResourceIds::HDR_TARGET),
@@ -32,15 +43,21 @@ namespace clustered
 
     namespace tone_mapping_pass
     {
+        static void tone_mapping_pass_setup(const SettingsStore* settings_context, PerPassDataStore* per_pass_data_store)
+        {
+            per_pass_data_store->emplace(TONE_MAPPING_PASS_DATA, ToneMappingPassData{
+                .exposure = settings_context->get_ref<float>(to_rid(ESettingsIds::EXPOSURE)),
+                .fullscreen_mesh = settings_context->get_ref<MeshHandle>(to_rid(ESettingsIds::FULLSCREEN_QUAD)),
+            });
+        }
+
         static void tone_mapping_pass_exectution(const PassExecutionContext* context)
         {
             const CommandContextHandle cmd_ctx = context->cmd_context;
-            const ResourceContext& resource_context = *context->resource_context;
             const PipelineStore& pipeline_context = *context->pipeline_context;
-            const SettingsStore& settings_context = *context->settings_context;
+            const ToneMappingPassData& pass_data = context->get_pass_data<ToneMappingPassData>();
 
-            TextureHandle sdr_buffer = resource_context.get_texture(to_rid(EResourceIds::SDR_TARGET));
-            gfx::cmd::set_render_targets(cmd_ctx, &sdr_buffer, 1);
+            TextureHandle sdr_buffer = context->get_output_texture(0);
 
             const TextureInfo& texture_info = gfx::textures::get_texture_info(sdr_buffer);
             Viewport viewport = { 0.0f, 0.0f, static_cast<float>(texture_info.width), static_cast<float>(texture_info.height) };
@@ -53,24 +70,29 @@ namespace clustered
             gfx::cmd::set_viewports(cmd_ctx, &viewport, 1);
             gfx::cmd::set_scissors(cmd_ctx, &scissor, 1);
 
-            TextureHandle hdr_buffer = resource_context.get_texture(to_rid(EResourceIds::HDR_TARGET));
-            const float exposure = settings_context.get<float>(to_rid(ESettingsIds::EXPOSURE));
+            TextureHandle hdr_buffer = context->get_input_texture(0);
+            const TextureInfo& hdr_info = gfx::textures::get_texture_info(hdr_buffer);
+            const Viewport hdr_viewport = context->get_input_viewport(0);
+            const float hdr_width = static_cast<float>(hdr_info.width);
+            const float hdr_height = static_cast<float>(hdr_info.height);
             TonemapPassConstants tonemapping_constants = {
                 .src_texture = gfx::textures::get_shader_readable_index(hdr_buffer),
-                .exposure = exposure
+                .exposure = *pass_data.exposure,
+                .uv_scale = { hdr_viewport.width / hdr_width, hdr_viewport.height / hdr_height },
+                .uv_max = { (hdr_viewport.width - 0.5f) / hdr_width, (hdr_viewport.height - 0.5f) / hdr_height },
             };
-            gfx::cmd::bind_graphics_constants(cmd_ctx, &tonemapping_constants, 2, 0);
+            gfx::cmd::bind_graphics_constants(cmd_ctx, &tonemapping_constants, 6, 0);
             gfx::cmd::bind_graphics_resource_table(cmd_ctx, 1);
 
             // TODO: Why isn't this just a resource? We just need three indices in a buffer actually
-            const MeshHandle fullscreen_mesh = settings_context.get<MeshHandle>(to_rid(ESettingsIds::FULLSCREEN_QUAD));
+            const MeshHandle fullscreen_mesh = *pass_data.fullscreen_mesh;
             gfx::cmd::draw_mesh(cmd_ctx, fullscreen_mesh);
         }
 
         extern const render_graph::PassDesc pass_desc = {
             .name = "Tone Mapping Pass",
             .command_queue_type = zec::CommandQueueType::GRAPHICS,
-            .setup_fn = nullptr,
+            .setup_fn = &tone_mapping_pass_setup,
             .execute_fn = &tone_mapping_pass_exectution,
             .inputs = inputs,
             .outputs = outputs,
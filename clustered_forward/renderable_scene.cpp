@@ -50,9 +50,16 @@ namespace clustered
         meshes.push_back(mesh_handle);
         vertex_shader_data.push_back(vs_data);
         aabb_soa.push_back(aabb);
+        world_bounds.push_back(aabb, vs_data.model_transform);
         ASSERT(meshes.size == vertex_shader_data.size && meshes.size == num_entities);
     }
 
+    void Renderables::set_vertex_shader_data(const u32 renderable_idx, const VertexShaderData& vs_data)
+    {
+        vertex_shader_data[renderable_idx] = vs_data;
+        world_bounds.set_transform(renderable_idx, vs_data.model_transform);
+    }
+
     void RenderableScene::initialize(const RenderableSceneSettings& settings)
     {
         this->settings = settings;
@@ -119,13 +126,30 @@ namespace clustered
         gfx::set_debug_name(view_constant_buffer, name);
     }
 
+    void RenderableCamera::cull(const Renderables& renderables)
+    {
+        visible_list.empty();
+        const Frustum frustum = extract_frustum_planes(camera->projection * camera->view);
+        cull_world_bounds(frustum, renderables.world_bounds, visible_list);
+    }
+
+    void RenderableCamera::publish()
+    {
+        render_camera = *camera;
+
+        render_visible_list.empty();
+        render_visible_list.reserve(visible_list.size);
+        memory::copy(render_visible_list.data, visible_list.data, visible_list.size * sizeof(u32));
+        render_visible_list.size = visible_list.size;
+    }
+
     void RenderableCamera::copy()
     {
         ViewConstantData view_constant_data{
-            .VP = camera->projection * camera->view,
-            .invVP = invert(camera->projection * mat4(to_mat3(camera->view), {})),
-            .view = camera->view,
-            .camera_position = camera->position,
+            .VP = render_camera.projection * render_camera.view,
+            .invVP = invert(render_camera.projection * mat4(to_mat3(render_camera.view), {})),
+            .view = render_camera.view,
+            .camera_position = render_camera.position,
         };
         gfx::buffers::update(view_constant_buffer, &view_constant_data, sizeof(view_constant_data));
     }
@@ -2,6 +2,7 @@
 #include "core/array.h"
 #include "core/zec_math.h"
 #include "camera.h"
+#include "culling.h"
 #include "gfx/gfx.h"
 
 namespace clustered
@@ -104,6 +105,8 @@ namespace clustered
         zec::Array<VertexShaderData> vertex_shader_data;
 
         AABB_SoA aabb_soa;
+        // World space bounds, only recomputed for renderables whose transform has changed
+        zec::WorldBoundsCache world_bounds;
 
         size_t max_num_materials;
         zec::Array<u32> material_indices;
@@ -124,6 +127,9 @@ namespace clustered
 
         void push_renderable(const u32 material_idx, const zec::MeshHandle mesh_handle, const VertexShaderData& vs_data, const zec::AABB& aabb);
 
+        // Use this rather than writing to vertex_shader_data directly, so that the world bounds get updated
+        void set_vertex_shader_data(const u32 renderable_idx, const VertexShaderData& vs_data);
+
     };
 
     struct RenderableSceneSettings
@@ -155,9 +161,21 @@ namespace clustered
         zec::PerspectiveCamera* camera = nullptr;
         ViewConstantData view_constant_data = {};
         zec::BufferHandle view_constant_buffer = {};
+        // Indices of the renderables that passed frustum culling this frame
+        zec::Array<u32> visible_list = {};
+
+        // Snapshot of the camera and visible list taken by publish(), which is what copy() and the passes read.
+        // This lets the next frame's update and culling run while this one is rendered.
+        zec::PerspectiveCamera render_camera = {};
+        zec::Array<u32> render_visible_list = {};
 
         void initialize(const wchar* name, zec::PerspectiveCamera* in_camera);
 
+        // Expects renderables.world_bounds to be up to date
+        void cull(const Renderables& renderables);
+
+        void publish();
+
         void copy();
     };
 
@@ -353,6 +353,14 @@ public:
 
     Scene scene = {};
     Array<u32> visibility_list = {};
+    Array<u32> lod_list = {};
+    Array<u8> lod_state = {};
+    LodSettings lod_settings = {
+        .min_pixel_size = 2.0f,
+        .lod_pixel_sizes = { 0.0f, 128.0f, 32.0f, 8.0f },
+        .num_lods = 4,
+        .hysteresis = 0.1f,
+    };
 
     AABB_SoA aabb_soa;
 
@@ -361,7 +369,7 @@ public:
 
     render_pass_system::RenderPassList render_list;
 
-    //ftl::TaskScheduler task_scheduler;
+    //TaskScheduler task_scheduler;
 
 protected:
     void init() override final
@@ -397,7 +405,7 @@ protected:
 
         constexpr u16 fullscreen_indices[] = { 0, 1, 2 };
 
-        //task_scheduler.Init();
+        //task_scheduler.init();
 
         // Create the cube mesh
         {
@@ -716,11 +724,12 @@ protected:
             // TODO: Allow toggling of this + debug pass using imgui
             // Generate visibility list
             visibility_list.empty();
+            lod_list.empty();
             //cull_obbs(camera, scene.global_transforms, scene.aabbs, visibility_list);
             //cull_obbs_sse(camera, scene.global_transforms, scene.aabbs, visibility_list);
             //cull_obbs_mt(task_scheduler, camera, scene.global_transforms, scene.aabbs, visibility_list);
-            cull_obbs_sac(camera, scene.global_transforms, scene.aabbs, visibility_list);
-            //cull_obbs_sac_ispc(camera, scene.global_transforms, aabb_soa, visibility_list);
+            cull_obbs_sac(camera, float(height), lod_settings, scene.global_transforms, scene.aabbs, lod_state, visibility_list, lod_list);
+            //cull_obbs_sac_ispc(camera, float(height), lod_settings, scene.global_transforms, aabb_soa, lod_state, visibility_list, lod_list);
         }
     }
 
@@ -3,9 +3,9 @@
 #include "core/array.h"
 #include "core/zec_math.h"
 #include "camera.h"
+#include "cpu_tasks.h"
+#include "parallel_algorithms.h"
 #include <xmmintrin.h>
-#include <ftl/task_scheduler.h>
-#include <ftl/task_counter.h>
 
 #define SPLAT(v, c) _mm_permute_ps(v, _MM_SHUFFLE(c, c, c, c))
 
@@ -14,20 +14,8 @@ namespace zec
 
     constexpr size_t NUM_ITEMS_PER_LIST = 1024;
 
-    struct ViewFrustumCullTaskData
-    {
-        mat4 const* VP = nullptr;
-        AABB const* aabbs = nullptr;
-        mat4 const* model_transforms = nullptr;
-        u32* visibility_list;
-        u32 offset = 0;
-        u32 num_to_process = 0;
-        u32 size = 0;
-    };
-
-    static Array<ftl::Task> tasks = {};
-    static Array<ViewFrustumCullTaskData> task_data = {};
-    static Array<u32> temp_visibility_list = {};
+    static Array<u32> temp_visibility_flags = {};
+    static Array<u32> temp_visibility_offsets = {};
 
     // ---------- SSE Methods ----------
 
@@ -271,72 +259,46 @@ namespace zec
 
     // ---------- Multi-threaded Methods ----------
 
-    void cull_obbs_task(ftl::TaskScheduler* task_scheduler, void* arg)
-    {
-        (void)task_scheduler;
-        ViewFrustumCullTaskData* task_data = static_cast<ViewFrustumCullTaskData*>(arg);
-
-        for (size_t i = 0; i < task_data->num_to_process; i++) {
-            mat4 transform;
-            matrix_mul_sse(*task_data->VP, task_data->model_transforms[i], transform);
-
-            const AABB& aabb = task_data->aabbs[i];
-            if (test_aabb_visiblity_against_frustum_256(transform, aabb)) {
-                task_data->visibility_list[task_data->size++] = task_data->offset + i;
-            }
-        }
-    };
-
-    void cull_obbs_mt(ftl::TaskScheduler& task_scheduler, const PerspectiveCamera& camera, const Array<mat4>& transforms, const Array<AABB>& aabb_list, Array<u32>& out_visible_list)
+    void cull_obbs_mt(TaskScheduler& task_scheduler, const PerspectiveCamera& camera, const Array<mat4>& transforms, const Array<AABB>& aabb_list, Array<u32>& out_visible_list)
     {
         ASSERT(out_visible_list.size == 0);
 
         mat4 VP;
         matrix_mul_sse(camera.projection, camera.view, VP);
 
-        size_t num_tasks = (aabb_list.size + NUM_ITEMS_PER_LIST - 1) / NUM_ITEMS_PER_LIST;
-
-        if (temp_visibility_list.size < aabb_list.size) {
-            temp_visibility_list.grow(aabb_list.size - temp_visibility_list.size);
+        const size_t num_items = aabb_list.size;
+        if (temp_visibility_flags.size < num_items) {
+            temp_visibility_flags.grow(num_items - temp_visibility_flags.size);
+            temp_visibility_offsets.grow(num_items - temp_visibility_offsets.size);
         }
 
-        if (tasks.size < num_tasks) {
-            tasks.grow(num_tasks - tasks.size);
-            task_data.grow(num_tasks - task_data.size);
-        }
-
-        // Fork
-        for (size_t task_idx = 0; task_idx < num_tasks; task_idx++) {
-            size_t offset = task_idx * num_tasks;
-            task_data[task_idx].VP = &VP;
-            task_data[task_idx].aabbs = &aabb_list[offset];
-            task_data[task_idx].model_transforms = &transforms[offset];
-            task_data[task_idx].visibility_list = &temp_visibility_list[offset];
-            task_data[task_idx].offset = u32(offset);
-            task_data[task_idx].num_to_process = u32(min(NUM_ITEMS_PER_LIST, aabb_list.size - offset));
-            task_data[task_idx].size = 0;
-            tasks[task_idx].Function = &cull_obbs_task;
-            tasks[task_idx].ArgData = &task_data[task_idx];
-        }
+        parallel_for(task_scheduler, num_items, [&](const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                mat4 transform;
+                matrix_mul_sse(VP, transforms[i], transform);
+                temp_visibility_flags[i] = test_aabb_visiblity_against_frustum_256(transform, aabb_list[i]) ? 1 : 0;
+            }
+        }, NUM_ITEMS_PER_LIST);
 
-        ftl::TaskCounter counter(&task_scheduler);
-        task_scheduler.AddTasks(num_tasks, tasks.data, ftl::TaskPriority::High, &counter);
+        // Compact the visible indices, the scan gives each visible item its slot in the output list
+        parallel_scan(task_scheduler, temp_visibility_flags.data, temp_visibility_offsets.data, num_items, 0u, [](const u32 a, const u32 b) {
+            return a + b;
+        }, ScanType::EXCLUSIVE, NUM_ITEMS_PER_LIST);
 
-        if (out_visible_list.capacity < aabb_list.size) {
-            out_visible_list.reserve(aabb_list.size);
+        const u32 num_visible = num_items > 0 ? temp_visibility_offsets[num_items - 1] + temp_visibility_flags[num_items - 1] : 0;
+        if (out_visible_list.capacity < num_visible) {
+            out_visible_list.reserve(num_visible);
         }
 
-        task_scheduler.WaitForCounter(&counter, 0);
-
-        // Reduce
-        for (size_t task_idx = 0; task_idx < num_tasks; task_idx++) {
-            auto& task_datum = task_data[task_idx];
-
-            u32* dest = out_visible_list.data + out_visible_list.size;
-            memory::copy(dest, task_datum.visibility_list, task_datum.size * sizeof(u32));
-            out_visible_list.size += task_datum.size;
-        }
+        parallel_for(task_scheduler, num_items, [&](const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                if (temp_visibility_flags[i]) {
+                    out_visible_list.data[temp_visibility_offsets[i]] = u32(i);
+                }
+            }
+        }, NUM_ITEMS_PER_LIST);
+        out_visible_list.size = num_visible;
     };
 };
 
-#undef SPLAT
\ No newline at end of file
+#undef SPLAT
@@ -50,6 +50,17 @@ struct CullingFrustum {
 };
 #endif
 
+#ifndef __ISPC_STRUCT_ScreenSpaceParams__
+#define __ISPC_STRUCT_ScreenSpaceParams__
+struct ScreenSpaceParams {
+    float projection_scale;
+    float min_pixel_size;
+    float hysteresis;
+    uint32_t num_lods;
+    float lod_pixel_sizes[4];
+};
+#endif
+
 #ifndef __ISPC_STRUCT_mat4__
 #define __ISPC_STRUCT_mat4__
 struct mat4 {
@@ -64,7 +75,7 @@ struct mat4 {
 #if defined(__cplusplus) && (! defined(__ISPC_NO_EXTERN_C) || !__ISPC_NO_EXTERN_C )
 extern "C" {
 #endif // __cplusplus
-    extern void cull_obbs_ispc(const struct CullingFrustum &frustum, const struct mat4 * model_transforms, const float * min_x, const float * min_y, const float * min_z, const float * max_x, const float * max_y, const float * max_z, const uint32_t num_items, uint32_t * out_visibility_list, uint32_t * out_num_items);
+    extern void cull_obbs_ispc(const struct CullingFrustum &frustum, const struct ScreenSpaceParams &screen_space_params, const struct mat4 * model_transforms, const float * min_x, const float * min_y, const float * min_z, const float * max_x, const float * max_y, const float * max_z, const uint32_t num_items, uint8_t * lod_state, uint32_t * out_visibility_list, uint32_t * out_lod_list, uint32_t * out_num_items);
 #if defined(__cplusplus) && (! defined(__ISPC_NO_EXTERN_C) || !__ISPC_NO_EXTERN_C )
 } /* end extern C */
 #endif // __cplusplus
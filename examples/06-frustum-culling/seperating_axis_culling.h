@@ -13,6 +13,7 @@ namespace zec
         R_CROSS_A,
         U_CROSS_A,
         FRUSTUM_EDGE_CROSS_A,
+        SCREEN_SIZE,
         NUM_CULLING_COUNTERS
     };
 
@@ -22,6 +23,7 @@ namespace zec
         L"R_CROSS_A",
         L"U_CROSS_A",
         L"FRUSTUM_EDGE_CROSS_A",
+        L"SCREEN_SIZE",
     };
     static u32 culling_counters[NUM_CULLING_COUNTERS] = { 0 };
 
@@ -53,15 +55,47 @@ namespace zec
 
     Array<mat4> model_to_view_transforms;
 
-    bool test_using_separating_axis_theorem(const CullingFrustum& frustum, const mat4& vs_transform, const AABB& aabb)
+    constexpr u32 MAX_NUM_LODS = 4;
+
+    struct LodSettings
     {
-        // Near, far
-        float z_near = frustum.near_plane;
-        float z_far = frustum.far_plane;
-        // half width, half height
-        float x_near = frustum.near_right;
-        float y_near = frustum.near_top;
+        // Objects whose projected diameter (in pixels) falls below this are rejected outright
+        float min_pixel_size = 1.0f;
+        // Minimum projected diameter (in pixels) required to select each LOD, from most to least detailed.
+        // LOD 0's entry is ignored since it's selected for anything larger than lod_pixel_sizes[1].
+        float lod_pixel_sizes[MAX_NUM_LODS] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        u32 num_lods = 1;
+        // Fraction of a threshold that must be crossed before switching away from the previous LOD
+        float hysteresis = 0.1f;
+    };
+
+    struct ScreenSpaceParams
+    {
+        // Converts (diameter / view space depth) into pixels
+        float projection_scale;
+        float min_pixel_size;
+        float hysteresis;
+        u32 num_lods;
+        float lod_pixel_sizes[MAX_NUM_LODS];
+    };
 
+    ScreenSpaceParams get_screen_space_params(const PerspectiveCamera& camera, const float viewport_height, const LodSettings& lod_settings)
+    {
+        ASSERT(lod_settings.num_lods > 0 && lod_settings.num_lods <= MAX_NUM_LODS);
+        ScreenSpaceParams params = {
+            .projection_scale = 0.5f * viewport_height / tanf(0.5f * camera.vertical_fov),
+            .min_pixel_size = lod_settings.min_pixel_size,
+            .hysteresis = lod_settings.hysteresis,
+            .num_lods = lod_settings.num_lods,
+        };
+        for (size_t i = 0; i < MAX_NUM_LODS; i++) {
+            params.lod_pixel_sizes[i] = lod_settings.lod_pixel_sizes[i];
+        }
+        return params;
+    }
+
+    OBBv2 get_view_space_obb(const mat4& vs_transform, const AABB& aabb)
+    {
         // So first thing we need to do is obtain the normal directions of our OBB by transforming 4 of our AABB vertices
         vec3 corners[] = {
                     {aabb.min.x, aabb.min.y, aabb.min.z},
@@ -89,6 +123,40 @@ namespace zec
         obb.axes[1] = obb.axes[1] / obb.extents.y;
         obb.axes[2] = obb.axes[2] / obb.extents.z;
         obb.extents *= 0.5f;
+        return obb;
+    }
+
+    // Projected diameter, in pixels, of the OBB's bounding sphere
+    float get_projected_pixel_size(const ScreenSpaceParams& params, const CullingFrustum& frustum, const OBBv2& obb)
+    {
+        const float radius = length(obb.extents);
+        // Clamp to the near plane so that objects straddling the camera are treated as (very) large
+        const float depth = max(-obb.center.z, -frustum.near_plane);
+        return 2.0f * radius * params.projection_scale / depth;
+    }
+
+    // lod_pixel_sizes[i] is the boundary between LOD i - 1 and LOD i. Boundaries we're already past (i <= previous_lod)
+    // are scaled up and the others scaled down, so an object has to move past a boundary by the hysteresis factor
+    // before we switch away from previous_lod. Since the thresholds are monotonically decreasing, the selected LOD
+    // is just the number of boundaries we fall below.
+    u8 select_lod(const ScreenSpaceParams& params, const float pixel_size, const u8 previous_lod)
+    {
+        u8 lod = 0;
+        for (u32 i = 1; i < params.num_lods; i++) {
+            const float scale = i <= previous_lod ? (1.0f + params.hysteresis) : (1.0f - params.hysteresis);
+            lod += pixel_size < params.lod_pixel_sizes[i] * scale ? 1 : 0;
+        }
+        return lod;
+    }
+
+    bool test_using_separating_axis_theorem(const CullingFrustum& frustum, const OBBv2& obb)
+    {
+        // Near, far
+        float z_near = frustum.near_plane;
+        float z_far = frustum.far_plane;
+        // half width, half height
+        float x_near = frustum.near_right;
+        float y_near = frustum.near_top;
 
         {
             vec3 M = { 0, 0, 1 };
@@ -309,9 +377,23 @@ namespace zec
         return true;
     };
 
-    void cull_obbs_sac(const PerspectiveCamera& camera, const Array<mat4>& transforms, const Array<AABB>& aabb_list, Array<u32>& out_visible_list)
+    // out_lod_list[i] holds the LOD selected for out_visible_list[i], while lod_state holds the last LOD selected for
+    // each object (indexed by object) and is used to apply hysteresis between frames.
+    void cull_obbs_sac(
+        const PerspectiveCamera& camera,
+        const float viewport_height,
+        const LodSettings& lod_settings,
+        const Array<mat4>& transforms,
+        const Array<AABB>& aabb_list,
+        Array<u8>& lod_state,
+        Array<u32>& out_visible_list,
+        Array<u32>& out_lod_list)
     {
         ASSERT(out_visible_list.size == 0);
+        ASSERT(out_lod_list.size == 0);
+        if (lod_state.size < aabb_list.size) {
+            lod_state.grow(aabb_list.size - lod_state.size);
+        }
 
         for (size_t i = 0; i < CullingCounter::NUM_CULLING_COUNTERS; i++) {
             culling_counters[i] = 0;
@@ -324,13 +406,25 @@ namespace zec
             .near_plane = -camera.near_plane,
             .far_plane = -camera.far_plane,
         };
+        const ScreenSpaceParams screen_space_params = get_screen_space_params(camera, viewport_height, lod_settings);
+
         for (size_t i = 0; i < aabb_list.size; i++) {
             mat4 transform;
             matrix_mul_sse(camera.view, transforms[i], transform);
 
-            const AABB& aabb = aabb_list[i];
-            if (test_using_separating_axis_theorem(frustum, transform, aabb)) {
-                out_visible_list.push_back(i);
+            const OBBv2 obb = get_view_space_obb(transform, aabb_list[i]);
+            // Cheapest test first, so tiny objects skip the SAT tests entirely
+            const float pixel_size = get_projected_pixel_size(screen_space_params, frustum, obb);
+            if (pixel_size < screen_space_params.min_pixel_size) {
+                culling_counters[CullingCounter::SCREEN_SIZE]++;
+                continue;
+            }
+
+            if (test_using_separating_axis_theorem(frustum, obb)) {
+                const u8 lod = select_lod(screen_space_params, pixel_size, lod_state[i]);
+                lod_state[i] = lod;
+                out_visible_list.push_back(u32(i));
+                out_lod_list.push_back(lod);
             }
         }
 
@@ -339,12 +433,27 @@ namespace zec
         }
     };
 
-    void cull_obbs_sac_ispc(const PerspectiveCamera& camera, const Array<mat4>& transforms, const AABB_SoA& aabb_soa, Array<u32>& out_visible_list)
+    void cull_obbs_sac_ispc(
+        const PerspectiveCamera& camera,
+        const float viewport_height,
+        const LodSettings& lod_settings,
+        const Array<mat4>& transforms,
+        const AABB_SoA& aabb_soa,
+        Array<u8>& lod_state,
+        Array<u32>& out_visible_list,
+        Array<u32>& out_lod_list)
     {
         ASSERT(out_visible_list.size == 0);
+        ASSERT(out_lod_list.size == 0);
         if (out_visible_list.capacity < transforms.size) {
             out_visible_list.reserve(transforms.size);
         }
+        if (out_lod_list.capacity < transforms.size) {
+            out_lod_list.reserve(transforms.size);
+        }
+        if (lod_state.size < transforms.size) {
+            lod_state.grow(transforms.size - lod_state.size);
+        }
         if (model_to_view_transforms.size < transforms.size) {
             model_to_view_transforms.grow(transforms.size - model_to_view_transforms.size);
         }
@@ -357,6 +466,17 @@ namespace zec
             .far_plane = -camera.far_plane,
         };
 
+        const ScreenSpaceParams params = get_screen_space_params(camera, viewport_height, lod_settings);
+        ispc::ScreenSpaceParams ispc_params = {
+            .projection_scale = params.projection_scale,
+            .min_pixel_size = params.min_pixel_size,
+            .hysteresis = params.hysteresis,
+            .num_lods = params.num_lods,
+        };
+        for (size_t i = 0; i < MAX_NUM_LODS; i++) {
+            ispc_params.lod_pixel_sizes[i] = params.lod_pixel_sizes[i];
+        }
+
         for (size_t i = 0; i < transforms.size; i++) {
             matrix_mul_sse(camera.view, transforms[i], model_to_view_transforms[i]);
         }
@@ -364,6 +484,7 @@ namespace zec
         u32 num_visible = 0;
         ispc::cull_obbs_ispc(
             frustum,
+            ispc_params,
             reinterpret_cast<const ispc::mat4*>(model_to_view_transforms.data),
             aabb_soa.min_x.data,
             aabb_soa.min_y.data,
@@ -372,8 +493,11 @@ namespace zec
             aabb_soa.max_y.data,
             aabb_soa.max_z.data,
             transforms.size,
+            lod_state.data,
             out_visible_list.data,
+            out_lod_list.data,
             &num_visible);
         out_visible_list.size = num_visible;
+        out_lod_list.size = num_visible;
     }
 }
@@ -14,6 +14,9 @@ cbuffer pass_constants : register(b0)
 {
     uint src_texture_idx;
     float exposure;
+    // Part of the source texture that was rendered to
+    float2 uv_scale;
+    float2 uv_max;
 };
 
 SamplerState default_sampler : register(s0);
@@ -101,7 +104,8 @@ PSInput VSMain(float3 position : POSITION, float2 uv : TEXCOORD)
 float4 PSMain(PSInput input) : SV_TARGET
 {
     Texture2D src_texture = tex2D_table[src_texture_idx];
-    float4 color = src_texture.Sample(default_sampler, input.uv);
+    float2 uv = min(input.uv * uv_scale, uv_max);
+    float4 color = src_texture.Sample(default_sampler, uv);
     float3 rgb = color.rgb;
     
     float3 Yxy = convertRGB2Yxy(rgb);
@@ -8,6 +8,17 @@ EXTERNAL_LIB_DIR  = (ZEC_DIR .. "external/lib/")
 local BUILD_DIR = (ZEC_DIR .. ".build/")
 
 include("./examples.lua")
+
+newoption {
+  trigger = "gfx-backend",
+  value = "BACKEND",
+  description = "Which implementation of the gfx API to build zec_lib with",
+  default = "d3d12",
+  allowed = {
+    { "d3d12", "Direct3D 12" },
+    { "null", "No GPU, for headless tests and benchmarks" },
+  }
+}
 --
 -- Solution
 --
@@ -62,8 +73,13 @@ workspace "zec"
     "NOHELP",
     "WIN32_LEAN_AND_MEAN", -- // Exclude rarely-used stuff from Windows headers
     "STRICT",              --// Use strict declarations for Windows types"
-    "USE_D3D_RENDERER",
   }
+
+  filter { "options:gfx-backend=d3d12" }
+    defines { "USE_D3D_RENDERER" }
+  filter { "options:gfx-backend=null" }
+    defines { "USE_NULL_RENDERER" }
+  filter { }
   linkoptions {
     "/ignore:4221", -- LNK4221: This object file does not define any previously undefined public symbols, so it will not be used by any link operation that consumes this library
     "/ignore:4006", -- LNK4006
@@ -121,6 +137,12 @@ project("zec_lib")
     flags {"ExcludeFromBuild"}
   filter {}
 
+  filter { "options:gfx-backend=d3d12" }
+    removefiles { path.join(ZEC_SRC_DIR, "gfx/null/**") }
+  filter { "options:gfx-backend=null" }
+    removefiles { path.join(ZEC_SRC_DIR, "gfx/d3d12/**") }
+  filter {}
+
   flags {
     "FatalWarnings"
   }
@@ -154,8 +176,6 @@ project("zec_lib")
   configuration {}
 
   links {
-    "boost_context",
-    "ftl",
     "dxcompiler",
   }
 
@@ -33,8 +33,14 @@ namespace zec
         while (window.is_alive()) {
             PROFILE_FRAME("Main Thread");
             if (!window.is_minimized()) {
-                update_internal();
-                render_internal();
+                if (pipelined_frames) {
+                    pipelined_frame_internal();
+                }
+                else {
+                    update_internal();
+                    publish_frame_state();
+                    render_internal();
+                }
             }
 
             window.message_loop();
@@ -64,9 +70,11 @@ namespace zec
                 app->window.get_client_area(width, height);
                 app->input_manager.set_dimensions(width, height);
 
+                app->before_reset_internal();
                 gfx::on_window_resize(width, height);
                 app->width = width;
                 app->height = height;
+                app->after_reset_internal();
             }
         }
     }
@@ -78,6 +86,8 @@ namespace zec
         init_time_data(time_data);
         window.show(true);
 
+        task_scheduler.init();
+
         RendererDesc renderer_desc{ };
         renderer_desc.width = width;
         renderer_desc.height = height;
@@ -95,10 +105,16 @@ namespace zec
 
     void App::shutdown_internal()
     {
+        if (render_thread.joinable()) {
+            render_thread_exiting = true;
+            render_requested.release();
+            render_thread.join();
+        }
         gfx::flush_gpu();
         ui::destroy();
         shutdown();
         gfx::destroy_renderer();
+        task_scheduler.shutdown();
     }
 
     void App::update_internal()
@@ -127,9 +143,48 @@ namespace zec
         gfx::present_frame();
     }
 
+    void App::pipelined_frame_internal()
+    {
+        if (!has_published_frame) {
+            update_internal();
+            publish_frame_state();
+            has_published_frame = true;
+        }
+
+        if (!render_thread.joinable()) {
+            render_thread = std::thread{ &App::render_thread_loop, this };
+        }
+
+        // Render the published frame while the next one is updated
+        render_requested.release();
+
+        update_internal();
+
+        // Hand-off point: both frames are done, so it's safe to publish the new state. Window messages
+        // (including resizes) are only processed after this, while no rendering is in flight.
+        render_finished.acquire();
+        publish_frame_state();
+    }
+
+    void App::render_thread_loop()
+    {
+        while (true) {
+            render_requested.acquire();
+            if (render_thread_exiting) {
+                return;
+            }
+            render_internal();
+            render_finished.release();
+        }
+    }
+
     void App::before_reset_internal()
-    { }
+    {
+        before_reset();
+    }
 
     void App::after_reset_internal()
-    { }
+    {
+        after_reset();
+    }
 }
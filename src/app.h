@@ -1,7 +1,10 @@
 #pragma once
+#include <semaphore>
+#include <thread>
 #include "window.h"
 #include "timer.h"
 #include "input_manager.h"
+#include "cpu_tasks.h"
 #include "gfx/gfx.h"
 #include "gfx/ui.h"
 
@@ -27,9 +30,15 @@ namespace zec
         virtual void copy() = 0;
         virtual void render() = 0;
 
+        // Called around swap chain resizes, while no rendering is in flight. after_reset() is also called once after init().
         virtual void before_reset() = 0;
         virtual void after_reset() = 0;
 
+        // Called on the main thread after update(), while nothing else is touching the app's state.
+        // Anything that copy() and render() read from the update state should be snapshotted here,
+        // since update() may already be building the next frame by the time they run.
+        virtual void publish_frame_state() { };
+
         void exit();
         static void window_message_callback(void* context, HWND hWnd, UINT msg, WPARAM w_param, LPARAM l_param);
 
@@ -37,6 +46,11 @@ namespace zec
         std::wstring app_name;
 
         input::InputManager input_manager = {};
+        TaskScheduler task_scheduler{};
+
+        // Opt-in, set before run(). copy() and render() for frame N then execute on a render thread while update()
+        // builds frame N + 1 on the main thread, so the CPU frame time tends towards max(update, render).
+        bool pipelined_frames = false;
     private:
 
         //void parse_command_line(const wchar* cmdLine);
@@ -46,6 +60,19 @@ namespace zec
 
         void update_internal();
         void render_internal();
+        void pipelined_frame_internal();
+
+        void render_thread_loop();
+
+        // Whether publish_frame_state() has produced a frame that hasn't been rendered yet
+        bool has_published_frame = false;
+        // Renders pipelined frames. It's a thread of its own rather than a task, since tasks can get picked up by the
+        // main thread while update() waits on the scheduler, which would run the whole frame's rendering inside update().
+        std::thread render_thread = {};
+        std::binary_semaphore render_requested{ 0 };
+        std::binary_semaphore render_finished{ 0 };
+        // Read by the render thread once render_requested is released
+        bool render_thread_exiting = false;
 
         void before_reset_internal();
         void after_reset_internal();
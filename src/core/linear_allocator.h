@@ -1,4 +1,5 @@
 #pragma once
+#include <vector>
 #include "../utils/memory.h"
 
 namespace zec
@@ -57,4 +58,61 @@ namespace zec
         size_t offset = 0;
         u8* ptr = nullptr;
     };
-}
\ No newline at end of file
+
+    // Hands out aligned allocations from blocks of at least block_size bytes, adding a block whenever the last one is full.
+    // Allocations never move, so pointers to them stay valid for as long as the allocator lives.
+    class GrowableLinearAllocator
+    {
+    public:
+        GrowableLinearAllocator(size_t block_size = 1024) : block_size(block_size) {};
+
+        ~GrowableLinearAllocator()
+        {
+            for (Block& block : blocks) {
+                zec::memory::free_mem(block.ptr);
+            }
+        };
+
+        GrowableLinearAllocator(GrowableLinearAllocator& other) = delete;
+        GrowableLinearAllocator& operator=(GrowableLinearAllocator& other) = delete;
+
+        void* allocate(size_t num_bytes, size_t alignment)
+        {
+            ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+            if (!blocks.empty()) {
+                Block& block = blocks.back();
+                const size_t offset = align_offset(block, alignment);
+                if (offset + num_bytes <= block.capacity) {
+                    block.offset = offset + num_bytes;
+                    return block.ptr + offset;
+                }
+            }
+
+            // Big enough for the allocation whatever alignment malloc gives us
+            Block& block = blocks.emplace_back();
+            block.capacity = num_bytes + alignment - 1 > block_size ? num_bytes + alignment - 1 : block_size;
+            block.ptr = reinterpret_cast<u8*>(zec::memory::alloc(block.capacity));
+            const size_t offset = align_offset(block, alignment);
+            block.offset = offset + num_bytes;
+            return block.ptr + offset;
+        }
+
+    private:
+        struct Block
+        {
+            u8* ptr = nullptr;
+            // In bytes
+            size_t capacity = 0;
+            size_t offset = 0;
+        };
+
+        static size_t align_offset(const Block& block, size_t alignment)
+        {
+            const uintptr_t address = reinterpret_cast<uintptr_t>(block.ptr) + block.offset;
+            return block.offset + ((alignment - address % alignment) % alignment);
+        }
+
+        const size_t block_size = 0;
+        std::vector<Block> blocks = {};
+    };
+}
@@ -1,35 +1,605 @@
 #include "cpu_tasks.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "utils/assert.h"
 
 namespace zec
 {
-    TaskCounter::TaskCounter(TaskScheduler& task_scheduler) : internal_counter{ std::make_unique<ftl::TaskCounter>(task_scheduler.task_scheduler.get()) }
-    { };
+    namespace
+    {
+        struct QueuedTask
+        {
+            Task task = {};
+            TaskCounter* counter = nullptr;
+        };
+
+        // Chase-Lev work stealing deque with a fixed capacity (see "Correct and Efficient Work-Stealing for Weak
+        // Memory Models", Le et al. 2013). Only the owning thread may push and pop, any thread may steal.
+        // Slots are made of atomics so that a thief reading a slot that's concurrently being written is well defined,
+        // the thief's CAS on top then tells it whether the value it read is actually valid.
+        class WorkStealingQueue
+        {
+        public:
+            WorkStealingQueue(const u32 capacity) : slots{ std::make_unique<Slot[]>(capacity) }, mask{ i64(capacity) - 1 }
+            {
+                ASSERT_MSG((capacity & (capacity - 1)) == 0, "Work stealing queue capacity must be a power of two");
+            }
+
+            bool push(const QueuedTask& queued_task)
+            {
+                const i64 b = bottom.load(std::memory_order_relaxed);
+                const i64 t = top.load(std::memory_order_acquire);
+                if (b - t > mask) {
+                    return false;
+                }
+                Slot& slot = slots[b & mask];
+                slot.function.store(queued_task.task.function, std::memory_order_relaxed);
+                slot.arg.store(queued_task.task.arg, std::memory_order_relaxed);
+                slot.name.store(queued_task.task.name, std::memory_order_relaxed);
+                slot.counter.store(queued_task.counter, std::memory_order_relaxed);
+                bottom.store(b + 1, std::memory_order_release);
+                return true;
+            }
+
+            bool pop(QueuedTask& out_task)
+            {
+                const i64 b = bottom.load(std::memory_order_relaxed) - 1;
+                bottom.store(b, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                i64 t = top.load(std::memory_order_relaxed);
+
+                if (t > b) {
+                    // Empty
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                read_slot(b, out_task);
+                if (t == b) {
+                    // Last item, race any thieves for it
+                    const bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                    return won;
+                }
+                return true;
+            }
+
+            bool steal(QueuedTask& out_task)
+            {
+                i64 t = top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                const i64 b = bottom.load(std::memory_order_acquire);
+                if (t >= b) {
+                    return false;
+                }
+
+                read_slot(t, out_task);
+                return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            }
+
+            // Only an estimate when called from threads other than the owner
+            i64 size() const
+            {
+                const i64 b = bottom.load(std::memory_order_relaxed);
+                const i64 t = top.load(std::memory_order_relaxed);
+                return b > t ? b - t : 0;
+            }
+
+        private:
+            struct Slot
+            {
+                std::atomic<TaskFunction> function = nullptr;
+                std::atomic<void*> arg = nullptr;
+                std::atomic<const char*> name = nullptr;
+                std::atomic<TaskCounter*> counter = nullptr;
+            };
+
+            void read_slot(const i64 idx, QueuedTask& out_task) const
+            {
+                const Slot& slot = slots[idx & mask];
+                out_task.task.function = slot.function.load(std::memory_order_relaxed);
+                out_task.task.arg = slot.arg.load(std::memory_order_relaxed);
+                out_task.task.name = slot.name.load(std::memory_order_relaxed);
+                out_task.counter = slot.counter.load(std::memory_order_relaxed);
+            }
+
+            std::unique_ptr<Slot[]> slots;
+            const i64 mask;
+            alignas(64) std::atomic<i64> top = 0;
+            alignas(64) std::atomic<i64> bottom = 0;
+        };
+
+        // Only ever written by the thread that owns it, so the atomics are just there to make reads from other
+        // threads well defined and don't need to be read-modify-writes.
+        struct ThreadInstrumentation
+        {
+            std::unique_ptr<TaskEvent[]> events;
+            u64 max_events = 0;
+            // Includes events that were dropped because the buffer was full
+            std::atomic<u64> num_events = 0;
+
+            std::atomic<u64> num_tasks_executed = 0;
+            std::atomic<u64> num_tasks_stolen = 0;
+            std::atomic<u64> num_steal_attempts = 0;
+            std::atomic<u64> busy_time_ns = 0;
+            std::atomic<u64> idle_time_ns = 0;
+            std::atomic<u64> max_queue_depth = 0;
+
+            // Owner thread only
+            bool is_idle = false;
+            u64 idle_begin_ns = 0;
+        };
+
+        inline void increment(std::atomic<u64>& value, const u64 amount = 1)
+        {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        struct Worker
+        {
+            Worker(const u32 queue_capacity)
+            {
+                for (size_t i = 0; i < size_t(TaskPriority::COUNT); i++) {
+                    queues[i] = std::make_unique<WorkStealingQueue>(queue_capacity);
+                }
+            }
+
+            std::unique_ptr<WorkStealingQueue> queues[size_t(TaskPriority::COUNT)];
+            std::thread thread;
+            // Used to pick steal victims
+            u32 rng_state = 0;
+
+            ThreadInstrumentation instrumentation;
+        };
+
+        constexpr u32 NUM_SPINS_BEFORE_SLEEPING = 64;
+
+        thread_local const TaskScheduler* tl_scheduler = nullptr;
+        thread_local u32 tl_thread_idx = UINT32_MAX;
+
+        u32 xorshift(u32& state)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+    }
+
+    struct TaskSchedulerInternals
+    {
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        // Tasks added from threads that aren't part of the scheduler, or that didn't fit in a worker's queue
+        std::mutex shared_queue_mutex;
+        std::deque<QueuedTask> shared_queues[size_t(TaskPriority::COUNT)];
+        std::atomic<i64> shared_queue_size = 0;
+
+        // Number of tasks sitting in any queue, used to put idle workers to sleep
+        std::atomic<i64> num_queued_tasks = 0;
+        std::atomic<u32> num_sleeping_workers = 0;
+        std::mutex sleep_mutex;
+        std::condition_variable sleep_cv;
+
+        std::atomic<bool> is_shutting_down = false;
+
+        bool instrumentation_enabled = false;
+        std::chrono::steady_clock::time_point start_time;
+
+        static void mark_task_finished(TaskCounter* counter)
+        {
+            counter->value.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        u64 get_time_ns() const
+        {
+            return u64(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
+        }
+
+        // Returns null for threads that don't belong to the scheduler, or when instrumentation is disabled
+        ThreadInstrumentation* get_instrumentation(const u32 thread_idx)
+        {
+            if (!instrumentation_enabled || thread_idx >= workers.size()) {
+                return nullptr;
+            }
+            return &workers[thread_idx]->instrumentation;
+        }
+
+        void begin_idle(const u32 thread_idx)
+        {
+            ThreadInstrumentation* instrumentation = get_instrumentation(thread_idx);
+            if (instrumentation != nullptr && !instrumentation->is_idle) {
+                instrumentation->is_idle = true;
+                instrumentation->idle_begin_ns = get_time_ns();
+            }
+        }
+
+        void end_idle(const u32 thread_idx)
+        {
+            ThreadInstrumentation* instrumentation = get_instrumentation(thread_idx);
+            if (instrumentation != nullptr && instrumentation->is_idle) {
+                instrumentation->is_idle = false;
+                increment(instrumentation->idle_time_ns, get_time_ns() - instrumentation->idle_begin_ns);
+            }
+        }
+    };
 
-    void TaskScheduler::init()
+    static bool take_task(TaskSchedulerInternals& internals, const u32 thread_idx, QueuedTask& out_task)
     {
-        if (task_scheduler == nullptr) {
-            task_scheduler = std::make_unique<ftl::TaskScheduler>();
-            ftl::TaskSchedulerInitOptions options;
-            options.ThreadPoolSize = ftl::GetNumHardwareThreads() - 2;
-            options.Behavior = ftl::EmptyQueueBehavior::Yield;
-            task_scheduler->Init(options);
+        const u32 num_workers = u32(internals.workers.size());
+        for (size_t priority = 0; priority < size_t(TaskPriority::COUNT); priority++) {
+            if (thread_idx < num_workers && internals.workers[thread_idx]->queues[priority]->pop(out_task)) {
+                return true;
+            }
 
-            window_thread_id = ftl::GetCurrentThread().Id;
+            if (internals.shared_queue_size.load(std::memory_order_relaxed) > 0) {
+                std::lock_guard<std::mutex> lock{ internals.shared_queue_mutex };
+                if (!internals.shared_queues[priority].empty()) {
+                    out_task = internals.shared_queues[priority].front();
+                    internals.shared_queues[priority].pop_front();
+                    internals.shared_queue_size.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+
+            // Steal, starting from a random victim so that thieves don't all pile onto the same worker
+            static thread_local u32 steal_rng = 0x9E3779B9u ^ u32(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+            const u32 offset = xorshift(thread_idx < num_workers ? internals.workers[thread_idx]->rng_state : steal_rng);
+            ThreadInstrumentation* instrumentation = internals.get_instrumentation(thread_idx);
+            for (u32 i = 0; i < num_workers; i++) {
+                const u32 victim_idx = (offset + i) % num_workers;
+                if (victim_idx == thread_idx) {
+                    continue;
+                }
+                const bool stolen = internals.workers[victim_idx]->queues[priority]->steal(out_task);
+                if (instrumentation != nullptr) {
+                    increment(instrumentation->num_steal_attempts);
+                    increment(instrumentation->num_tasks_stolen, stolen ? 1 : 0);
+                }
+                if (stolen) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    static bool try_execute_one(TaskScheduler* task_scheduler, TaskSchedulerInternals& internals, const u32 thread_idx)
+    {
+        QueuedTask queued_task;
+        if (!take_task(internals, thread_idx, queued_task)) {
+            return false;
+        }
+        internals.num_queued_tasks.fetch_sub(1, std::memory_order_relaxed);
+
+        ThreadInstrumentation* instrumentation = internals.get_instrumentation(thread_idx);
+        if (instrumentation == nullptr) {
+            queued_task.task.function(task_scheduler, queued_task.task.arg);
+            TaskSchedulerInternals::mark_task_finished(queued_task.counter);
+            return true;
         }
-        else {
+
+        internals.end_idle(thread_idx);
+        const u64 begin_ns = internals.get_time_ns();
+        queued_task.task.function(task_scheduler, queued_task.task.arg);
+        const u64 end_ns = internals.get_time_ns();
+
+        // Publish the event before finishing the task, so that anyone waiting on the counter sees it
+        const u64 event_idx = instrumentation->num_events.load(std::memory_order_relaxed);
+        if (event_idx < instrumentation->max_events) {
+            instrumentation->events[event_idx] = {
+                .name = queued_task.task.name != nullptr ? queued_task.task.name : "Task",
+                .begin_ns = begin_ns,
+                .end_ns = end_ns,
+            };
+        }
+        instrumentation->num_events.store(event_idx + 1, std::memory_order_release);
+        increment(instrumentation->num_tasks_executed);
+        increment(instrumentation->busy_time_ns, end_ns - begin_ns);
+
+        TaskSchedulerInternals::mark_task_finished(queued_task.counter);
+        return true;
+    }
+
+    static void worker_thread_loop(TaskScheduler* task_scheduler, TaskSchedulerInternals* internals, const u32 thread_idx)
+    {
+        tl_scheduler = task_scheduler;
+        tl_thread_idx = thread_idx;
+
+        u32 num_failed_attempts = 0;
+        while (!internals->is_shutting_down.load(std::memory_order_relaxed)) {
+            if (try_execute_one(task_scheduler, *internals, thread_idx)) {
+                num_failed_attempts = 0;
+                continue;
+            }
+
+            internals->begin_idle(thread_idx);
+            if (++num_failed_attempts < NUM_SPINS_BEFORE_SLEEPING) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Both the sleeping worker count and the queued task count are seq_cst, so either we see the new tasks
+            // here or add_tasks sees us sleeping and wakes us up.
+            std::unique_lock<std::mutex> lock{ internals->sleep_mutex };
+            internals->num_sleeping_workers.fetch_add(1);
+            internals->sleep_cv.wait(lock, [internals]() {
+                return internals->num_queued_tasks.load() > 0 || internals->is_shutting_down.load();
+            });
+            internals->num_sleeping_workers.fetch_sub(1);
+            num_failed_attempts = 0;
+        }
+        internals->end_idle(thread_idx);
+
+        tl_scheduler = nullptr;
+        tl_thread_idx = UINT32_MAX;
+    }
+
+    TaskScheduler::TaskScheduler() = default;
+
+    TaskScheduler::~TaskScheduler()
+    {
+        shutdown();
+    }
+
+    void TaskScheduler::init(const TaskSchedulerDesc& desc)
+    {
+        if (internals != nullptr) {
             throw std::runtime_error("Cannot initialize task scheduler twice!");
         }
+
+        u32 num_worker_threads = desc.num_worker_threads;
+        if (num_worker_threads == 0) {
+            const u32 num_hardware_threads = std::thread::hardware_concurrency();
+            num_worker_threads = num_hardware_threads > 1 ? num_hardware_threads - 1 : 1;
+        }
+
+        internals = std::make_unique<TaskSchedulerInternals>();
+        internals->instrumentation_enabled = desc.enable_instrumentation;
+        internals->start_time = std::chrono::steady_clock::now();
+
+        // Worker zero is the calling thread
+        const u32 num_threads = num_worker_threads + 1;
+        internals->workers.reserve(num_threads);
+        for (u32 i = 0; i < num_threads; i++) {
+            internals->workers.push_back(std::make_unique<Worker>(desc.queue_capacity));
+            internals->workers[i]->rng_state = 0x9E3779B9u * (i + 1);
+            if (desc.enable_instrumentation) {
+                internals->workers[i]->instrumentation.events = std::make_unique<TaskEvent[]>(desc.max_events_per_thread);
+                internals->workers[i]->instrumentation.max_events = desc.max_events_per_thread;
+            }
+        }
+
+        tl_scheduler = this;
+        tl_thread_idx = 0;
+
+        for (u32 i = 1; i < num_threads; i++) {
+            internals->workers[i]->thread = std::thread{ worker_thread_loop, this, internals.get(), i };
+        }
     }
 
-    void TaskScheduler::add_tasks(const size_t num_tasks, Task* tasks, TaskCounter& counter)
+    void TaskScheduler::shutdown()
     {
-        task_scheduler->AddTasks(num_tasks, reinterpret_cast<ftl::Task*>(tasks), ftl::TaskPriority::High, counter.internal_counter.get());
+        if (internals == nullptr) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{ internals->sleep_mutex };
+            internals->is_shutting_down.store(true);
+        }
+        internals->sleep_cv.notify_all();
+
+        for (auto& worker : internals->workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+
+        if (tl_scheduler == this) {
+            tl_scheduler = nullptr;
+            tl_thread_idx = UINT32_MAX;
+        }
+        internals = nullptr;
+    }
+
+    void TaskScheduler::add_tasks(const size_t num_tasks, const Task* tasks, TaskCounter& counter, const TaskPriority priority)
+    {
+        ASSERT(internals != nullptr);
+        ASSERT(priority < TaskPriority::COUNT);
+        if (num_tasks == 0) {
+            return;
+        }
+
+        // Increment before any of the tasks can run, so the counter can't hit zero early
+        counter.value.fetch_add(u32(num_tasks), std::memory_order_relaxed);
+
+        const u32 thread_idx = get_current_thread_idx();
+        size_t num_pushed = 0;
+        if (thread_idx != UINT32_MAX) {
+            WorkStealingQueue& queue = *internals->workers[thread_idx]->queues[size_t(priority)];
+            for (; num_pushed < num_tasks; num_pushed++) {
+                if (!queue.push({ .task = tasks[num_pushed], .counter = &counter })) {
+                    break;
+                }
+            }
+
+            ThreadInstrumentation* instrumentation = internals->get_instrumentation(thread_idx);
+            if (instrumentation != nullptr) {
+                const u64 queue_depth = u64(queue.size());
+                if (queue_depth > instrumentation->max_queue_depth.load(std::memory_order_relaxed)) {
+                    instrumentation->max_queue_depth.store(queue_depth, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        if (num_pushed < num_tasks) {
+            std::lock_guard<std::mutex> lock{ internals->shared_queue_mutex };
+            for (size_t i = num_pushed; i < num_tasks; i++) {
+                internals->shared_queues[size_t(priority)].push_back({ .task = tasks[i], .counter = &counter });
+            }
+            internals->shared_queue_size.fetch_add(i64(num_tasks - num_pushed), std::memory_order_relaxed);
+        }
+
+        internals->num_queued_tasks.fetch_add(i64(num_tasks));
+        if (internals->num_sleeping_workers.load() > 0) {
+            // Taking the lock ensures a worker can't miss the notification between checking its predicate and waiting
+            std::lock_guard<std::mutex> lock{ internals->sleep_mutex };
+            internals->sleep_cv.notify_all();
+        }
     }
 
     void TaskScheduler::wait_on_counter(TaskCounter& task_counter)
     {
-        // This ensures our window doesn't wander between threads
-        bool pin_to_current_thread = (ftl::GetCurrentThread().Id == window_thread_id);
-        task_scheduler->WaitForCounter(task_counter.internal_counter.get(), pin_to_current_thread);
+        ASSERT(internals != nullptr);
+        const u32 thread_idx = get_current_thread_idx();
+        while (!task_counter.is_done()) {
+            if (!try_execute_one(this, *internals, thread_idx)) {
+                internals->begin_idle(thread_idx);
+                std::this_thread::yield();
+            }
+        }
+        internals->end_idle(thread_idx);
+    }
+
+    u32 TaskScheduler::get_num_threads() const
+    {
+        return internals != nullptr ? u32(internals->workers.size()) : 0;
+    }
+
+    u32 TaskScheduler::get_current_thread_idx() const
+    {
+        return tl_scheduler == this ? tl_thread_idx : UINT32_MAX;
+    }
+
+    bool TaskScheduler::is_instrumentation_enabled() const
+    {
+        return internals != nullptr && internals->instrumentation_enabled;
+    }
+
+    TaskSchedulerThreadStats TaskScheduler::get_thread_stats(const u32 thread_idx) const
+    {
+        if (!is_instrumentation_enabled()) {
+            return {};
+        }
+        ASSERT(thread_idx < internals->workers.size());
+        const ThreadInstrumentation& instrumentation = internals->workers[thread_idx]->instrumentation;
+        const u64 num_events = instrumentation.num_events.load(std::memory_order_acquire);
+        return {
+            .num_tasks_executed = instrumentation.num_tasks_executed.load(std::memory_order_relaxed),
+            .num_tasks_stolen = instrumentation.num_tasks_stolen.load(std::memory_order_relaxed),
+            .num_steal_attempts = instrumentation.num_steal_attempts.load(std::memory_order_relaxed),
+            .busy_time_ns = instrumentation.busy_time_ns.load(std::memory_order_relaxed),
+            .idle_time_ns = instrumentation.idle_time_ns.load(std::memory_order_relaxed),
+            .max_queue_depth = instrumentation.max_queue_depth.load(std::memory_order_relaxed),
+            .num_events = num_events < instrumentation.max_events ? num_events : instrumentation.max_events,
+            .num_dropped_events = num_events > instrumentation.max_events ? num_events - instrumentation.max_events : 0,
+        };
+    }
+
+    const TaskEvent* TaskScheduler::get_thread_events(const u32 thread_idx, size_t& num_events) const
+    {
+        num_events = 0;
+        if (!is_instrumentation_enabled()) {
+            return nullptr;
+        }
+        ASSERT(thread_idx < internals->workers.size());
+        const ThreadInstrumentation& instrumentation = internals->workers[thread_idx]->instrumentation;
+        const u64 num_recorded = instrumentation.num_events.load(std::memory_order_acquire);
+        num_events = size_t(num_recorded < instrumentation.max_events ? num_recorded : instrumentation.max_events);
+        return instrumentation.events.get();
+    }
+
+    void TaskScheduler::reset_instrumentation()
+    {
+        if (!is_instrumentation_enabled()) {
+            return;
+        }
+        for (auto& worker : internals->workers) {
+            ThreadInstrumentation& instrumentation = worker->instrumentation;
+            instrumentation.num_events.store(0, std::memory_order_relaxed);
+            instrumentation.num_tasks_executed.store(0, std::memory_order_relaxed);
+            instrumentation.num_tasks_stolen.store(0, std::memory_order_relaxed);
+            instrumentation.num_steal_attempts.store(0, std::memory_order_relaxed);
+            instrumentation.busy_time_ns.store(0, std::memory_order_relaxed);
+            instrumentation.idle_time_ns.store(0, std::memory_order_relaxed);
+            instrumentation.max_queue_depth.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    static void write_json_string(std::ostream& stream, const char* str)
+    {
+        stream << '"';
+        for (const char* c = str; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\') {
+                stream << '\\' << *c;
+            }
+            else if (u8(*c) >= 0x20) {
+                stream << *c;
+            }
+        }
+        stream << '"';
+    }
+
+    void TaskScheduler::write_chrome_trace(std::ostream& stream) const
+    {
+        stream << "{\"traceEvents\":[";
+        bool is_first_event = true;
+        const auto begin_event = [&]() {
+            stream << (is_first_event ? "\n" : ",\n");
+            is_first_event = false;
+        };
+
+        const std::streamsize old_precision = stream.precision(3);
+        const std::ios_base::fmtflags old_flags = stream.setf(std::ios_base::fixed, std::ios_base::floatfield);
+
+        const u32 num_threads = is_instrumentation_enabled() ? get_num_threads() : 0;
+        for (u32 thread_idx = 0; thread_idx < num_threads; thread_idx++) {
+            const TaskSchedulerThreadStats stats = get_thread_stats(thread_idx);
+            begin_event();
+            stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread_idx << ",\"args\":{\"name\":\"";
+            if (thread_idx == 0) {
+                stream << "Main Thread";
+            }
+            else {
+                stream << "Worker " << thread_idx;
+            }
+            stream << "\"}}";
+
+            // Counters as a single sample, so they show up alongside the thread in the viewer
+            begin_event();
+            stream << "{\"name\":\"Worker " << thread_idx << " stats\",\"ph\":\"C\",\"pid\":0,\"tid\":" << thread_idx << ",\"ts\":0"
+                << ",\"args\":{\"tasks_executed\":" << stats.num_tasks_executed
+                << ",\"tasks_stolen\":" << stats.num_tasks_stolen
+                << ",\"steal_attempts\":" << stats.num_steal_attempts
+                << ",\"busy_ms\":" << double(stats.busy_time_ns) * 1e-6
+                << ",\"idle_ms\":" << double(stats.idle_time_ns) * 1e-6
+                << ",\"max_queue_depth\":" << stats.max_queue_depth
+                << ",\"dropped_events\":" << stats.num_dropped_events << "}}";
+
+            size_t num_events = 0;
+            const TaskEvent* events = get_thread_events(thread_idx, num_events);
+            for (size_t i = 0; i < num_events; i++) {
+                const TaskEvent& event = events[i];
+                begin_event();
+                stream << "{\"name\":";
+                write_json_string(stream, event.name);
+                stream << ",\"cat\":\"task\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread_idx
+                    << ",\"ts\":" << double(event.begin_ns) * 1e-3
+                    << ",\"dur\":" << double(event.end_ns - event.begin_ns) * 1e-3 << "}";
+            }
+        }
+        stream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+        stream.precision(old_precision);
+        stream.flags(old_flags);
     }
-}
\ No newline at end of file
+}
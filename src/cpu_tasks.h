@@ -1,12 +1,14 @@
 #pragma once
+#include <atomic>
+#include <iosfwd>
 #include <memory>
 
-#include <ftl/task_scheduler.h>
-#include <ftl/task_counter.h>
+#include "core/zec_types.h"
 
 namespace zec
 {
     class TaskScheduler;
+    struct TaskSchedulerInternals;
 
     typedef void (*TaskFunction)(TaskScheduler* taskScheduler, void* arg);
 
@@ -14,36 +16,123 @@ namespace zec
     {
         TaskFunction function;
         void* arg;
+        // Only used for instrumentation, must outlive the scheduler
+        const char* name = nullptr;
+    };
+
+    enum struct TaskPriority : u8
+    {
+        HIGH = 0,
+        NORMAL,
+        LOW,
+
+        COUNT
     };
 
     class TaskCounter
     {
     public:
         friend class TaskScheduler;
+        friend struct TaskSchedulerInternals;
 
         TaskCounter() = default;
-        TaskCounter(TaskScheduler& task_scheduler);
+
+        UNCOPIABLE(TaskCounter);
+        UNMOVABLE(TaskCounter);
+
+        inline bool is_done() const
+        {
+            return value.load(std::memory_order_acquire) == 0;
+        }
+
     private:
-        std::unique_ptr<ftl::TaskCounter> internal_counter = nullptr;
+        // Number of tasks associated with this counter that have not yet finished
+        std::atomic<u32> value = 0;
+    };
+
+    struct TaskSchedulerDesc
+    {
+        // Number of threads spawned by the scheduler. Zero means one per hardware thread, minus one for the thread calling init()
+        u32 num_worker_threads = 0;
+        // Capacity of each worker's per-priority deque, must be a power of two.
+        // Tasks that don't fit will spill into a (slower) shared queue.
+        u32 queue_capacity = 4096;
+        // Records a begin/end timestamp for every task plus per-thread counters, see TaskScheduler::get_thread_stats
+        bool enable_instrumentation = false;
+        // Size of each thread's event buffer, events past this are dropped (but still counted)
+        u32 max_events_per_thread = 1 << 16;
+    };
+
+    struct TaskEvent
+    {
+        const char* name;
+        // Nanoseconds since the scheduler was initialized
+        u64 begin_ns;
+        u64 end_ns;
+    };
+
+    struct TaskSchedulerThreadStats
+    {
+        u64 num_tasks_executed = 0;
+        // Tasks taken from another worker's queue
+        u64 num_tasks_stolen = 0;
+        // Number of victim queues checked, whether or not the steal succeeded
+        u64 num_steal_attempts = 0;
+        u64 busy_time_ns = 0;
+        // Time spent spinning, sleeping or waiting on a counter without anything to execute
+        u64 idle_time_ns = 0;
+        // Largest number of tasks seen in this thread's queues when pushing to them
+        u64 max_queue_depth = 0;
+        u64 num_events = 0;
+        u64 num_dropped_events = 0;
     };
 
     class TaskScheduler
     {
     public:
-        friend class TaskCounter;
+        TaskScheduler();
+        ~TaskScheduler();
+
+        UNCOPIABLE(TaskScheduler);
+        UNMOVABLE(TaskScheduler);
+
+        // The thread calling init() becomes worker zero. It owns its own queues but only executes tasks while it waits on a counter.
+        void init(const TaskSchedulerDesc& desc = {});
 
-        // call this only from the Window thread!
-        void init();
+        // Stops and joins the worker threads. Any tasks that haven't been started are dropped.
+        void shutdown();
 
-        void add_tasks(const size_t num_tasks, Task* tasks, TaskCounter& counter);
+        // Tasks are copied, so the array doesn't have to outlive this call (but the args do!)
+        void add_tasks(const size_t num_tasks, const Task* tasks, TaskCounter& counter, const TaskPriority priority = TaskPriority::NORMAL);
 
+        // Rather than blocking, the calling thread will execute other tasks until the counter reaches zero.
         void wait_on_counter(TaskCounter& task_counter);
 
-    private:
+        // Worker threads plus the thread that called init()
+        u32 get_num_threads() const;
+
+        // Index in [0, get_num_threads()) of the calling thread, or UINT32_MAX if the thread doesn't belong to this scheduler.
+        u32 get_current_thread_idx() const;
+
+        // ---------- Instrumentation ----------
+        // All of these are no-ops (or return zeroes) unless the scheduler was initialized with enable_instrumentation.
 
-        DWORD window_thread_id = UINT32_MAX;
-        std::unique_ptr<ftl::TaskScheduler> task_scheduler = nullptr;
+        bool is_instrumentation_enabled() const;
+
+        TaskSchedulerThreadStats get_thread_stats(const u32 thread_idx) const;
+
+        // Events are appended to by their thread while we read them, so only the first num_events are valid.
+        const TaskEvent* get_thread_events(const u32 thread_idx, size_t& num_events) const;
+
+        // Clears the events and counters. Must not be called while tasks are executing.
+        void reset_instrumentation();
+
+        // Writes the recorded events, with a track per thread, in the Chrome trace event JSON format
+        // (which chrome://tracing and the Perfetto UI can both open).
+        void write_chrome_trace(std::ostream& stream) const;
+
+    private:
+        std::unique_ptr<TaskSchedulerInternals> internals;
     };
 
 }
-
@@ -0,0 +1,130 @@
+#include "culling.h"
+#include <bit>
+
+namespace zec
+{
+    Frustum extract_frustum_planes(const mat4& view_projection)
+    {
+        const vec4& r0 = view_projection.rows[0];
+        const vec4& r1 = view_projection.rows[1];
+        const vec4& r2 = view_projection.rows[2];
+        const vec4& r3 = view_projection.rows[3];
+
+        Frustum frustum = {};
+        frustum.planes[Frustum::LEFT_PLANE].normal_d = r3 + r0;
+        frustum.planes[Frustum::RIGHT_PLANE].normal_d = r3 - r0;
+        frustum.planes[Frustum::BOTTOM_PLANE].normal_d = r3 + r1;
+        frustum.planes[Frustum::TOP_PLANE].normal_d = r3 - r1;
+        // 0 <= z <= w
+        frustum.planes[Frustum::NEAR_PLANE].normal_d = r2;
+        frustum.planes[Frustum::FAR_PLANE].normal_d = r3 - r2;
+
+        for (Plane& plane : frustum.planes) {
+            const float normal_length = length(plane.normal);
+            if (normal_length > 0.0f) {
+                plane.normal_d = plane.normal_d / normal_length;
+            }
+        }
+        return frustum;
+    }
+
+    size_t WorldBoundsCache::push_back(const AABB& local_aabb, const mat4& transform)
+    {
+        const size_t idx = local_aabbs.push_back(local_aabb);
+        transforms.push_back(transform);
+
+        min_x.push_back(0.0f);
+        min_y.push_back(0.0f);
+        min_z.push_back(0.0f);
+        max_x.push_back(0.0f);
+        max_y.push_back(0.0f);
+        max_z.push_back(0.0f);
+        center_x.push_back(0.0f);
+        center_y.push_back(0.0f);
+        center_z.push_back(0.0f);
+        radius.push_back(0.0f);
+
+        if (idx / 64 >= dirty_bits.size) {
+            dirty_bits.push_back(0);
+        }
+        mark_dirty(idx);
+        return idx;
+    }
+
+    void WorldBoundsCache::set_transform(const size_t idx, const mat4& transform)
+    {
+        transforms[idx] = transform;
+        mark_dirty(idx);
+    }
+
+    size_t WorldBoundsCache::update()
+    {
+        size_t num_updated = 0;
+        for (size_t word_idx = 0; word_idx < dirty_bits.size; word_idx++) {
+            u64 word = dirty_bits[word_idx];
+            // Most words will be zero in a static scene, so this loop is usually just a scan of the bitset
+            while (word != 0) {
+                const size_t idx = word_idx * 64 + std::countr_zero(word);
+                word &= word - 1;
+
+                // Transform the center and extents rather than all eight corners (Arvo's method)
+                const AABB& aabb = local_aabbs[idx];
+                const mat4& transform = transforms[idx];
+                const vec3 local_center = 0.5f * (aabb.max + aabb.min);
+                const vec3 local_extents = 0.5f * (aabb.max - aabb.min);
+
+                const vec3 center = (transform * vec4{ local_center, 1.0f }).xyz;
+                vec3 extents;
+                for (size_t row = 0; row < 3; row++) {
+                    const vec4& r = transform.rows[row];
+                    extents[row] = fabsf(r.x) * local_extents.x + fabsf(r.y) * local_extents.y + fabsf(r.z) * local_extents.z;
+                }
+
+                min_x[idx] = center.x - extents.x;
+                min_y[idx] = center.y - extents.y;
+                min_z[idx] = center.z - extents.z;
+                max_x[idx] = center.x + extents.x;
+                max_y[idx] = center.y + extents.y;
+                max_z[idx] = center.z + extents.z;
+
+                center_x[idx] = center.x;
+                center_y[idx] = center.y;
+                center_z[idx] = center.z;
+                radius[idx] = length(extents);
+                num_updated++;
+            }
+            dirty_bits[word_idx] = 0;
+        }
+        return num_updated;
+    }
+
+    void cull_world_bounds(const Frustum& frustum, const WorldBoundsCache& bounds, Array<u32>& out_visible_list)
+    {
+        if (out_visible_list.capacity < out_visible_list.size + bounds.size()) {
+            out_visible_list.reserve(out_visible_list.size + bounds.size());
+        }
+
+        for (size_t i = 0; i < bounds.size(); i++) {
+            bool visible = true;
+            for (const Plane& plane : frustum.planes) {
+                const float distance = plane.normal.x * bounds.center_x[i] + plane.normal.y * bounds.center_y[i] + plane.normal.z * bounds.center_z[i] + plane.d;
+                visible &= distance >= -bounds.radius[i];
+            }
+            if (!visible) {
+                continue;
+            }
+
+            // Sphere is (at least partially) inside, test the AABB's most positive vertex against each plane
+            for (const Plane& plane : frustum.planes) {
+                const float p_x = plane.normal.x >= 0.0f ? bounds.max_x[i] : bounds.min_x[i];
+                const float p_y = plane.normal.y >= 0.0f ? bounds.max_y[i] : bounds.min_y[i];
+                const float p_z = plane.normal.z >= 0.0f ? bounds.max_z[i] : bounds.min_z[i];
+                visible &= plane.normal.x * p_x + plane.normal.y * p_y + plane.normal.z * p_z + plane.d >= 0.0f;
+            }
+
+            if (visible) {
+                out_visible_list.push_back(u32(i));
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "core/array.h"
+#include "core/zec_math.h"
+
+namespace zec
+{
+    // Normalized world space planes with their normals pointing into the frustum
+    struct Frustum
+    {
+        enum PlaneIndex : u32
+        {
+            LEFT_PLANE = 0,
+            RIGHT_PLANE,
+            BOTTOM_PLANE,
+            TOP_PLANE,
+            NEAR_PLANE,
+            FAR_PLANE,
+            NUM_PLANES
+        };
+
+        Plane planes[NUM_PLANES] = {};
+    };
+
+    // Works for both regular and reversed depth, since the near and far planes simply swap places
+    Frustum extract_frustum_planes(const mat4& view_projection);
+
+    // Caches world space AABBs and bounding spheres (in SoA form) for a list of objects. Bounds are only recomputed for
+    // objects whose transform was changed since the last call to update(), so static objects cost nothing after the
+    // first frame.
+    class WorldBoundsCache
+    {
+    public:
+        // World space AABBs
+        Array<float> min_x;
+        Array<float> min_y;
+        Array<float> min_z;
+        Array<float> max_x;
+        Array<float> max_y;
+        Array<float> max_z;
+
+        // World space bounding spheres
+        Array<float> center_x;
+        Array<float> center_y;
+        Array<float> center_z;
+        Array<float> radius;
+
+        size_t push_back(const AABB& local_aabb, const mat4& transform);
+
+        void set_transform(const size_t idx, const mat4& transform);
+
+        void mark_dirty(const size_t idx)
+        {
+            ASSERT(idx < local_aabbs.size);
+            dirty_bits[idx / 64] |= u64(1) << (idx % 64);
+        };
+
+        bool is_dirty(const size_t idx) const
+        {
+            ASSERT(idx < local_aabbs.size);
+            return (dirty_bits[idx / 64] & (u64(1) << (idx % 64))) != 0;
+        };
+
+        inline size_t size() const
+        {
+            return local_aabbs.size;
+        };
+
+        // Recomputes the world space bounds of every dirty object, returns the number of objects that were updated.
+        size_t update();
+
+    private:
+        Array<AABB> local_aabbs;
+        Array<mat4> transforms;
+        Array<u64> dirty_bits;
+    };
+
+    // Tests the cached world space bounds against the frustum, pushing the indices of visible objects into out_visible_list.
+    // Cheap sphere tests are used to reject most objects before testing the AABB.
+    void cull_world_bounds(const Frustum& frustum, const WorldBoundsCache& bounds, Array<u32>& out_visible_list);
+}
@@ -0,0 +1,46 @@
+#include "dynamic_resolution.h"
+#include <algorithm>
+#include <cmath>
+#include "utils/assert.h"
+
+namespace zec
+{
+    DynamicResolutionController::DynamicResolutionController(const DynamicResolutionDesc& desc)
+        : desc{ desc }
+    {
+        ASSERT(desc.target_frame_time_ms > 0.0f);
+        ASSERT(desc.min_scale > 0.0f && desc.min_scale <= desc.max_scale && desc.max_scale <= 1.0f);
+        ASSERT(desc.recovery_rate >= 0.0f);
+        reset();
+    }
+
+    float DynamicResolutionController::update(const float frame_time_ms)
+    {
+        float error = (desc.target_frame_time_ms - frame_time_ms) / desc.target_frame_time_ms;
+        if (std::abs(error) < desc.error_deadband) {
+            error = 0.0f;
+        }
+        // Until we have a history, the error is treated as having been the same all along
+        const float e1 = num_updates > 0 ? previous_errors[0] : error;
+        const float e2 = num_updates > 1 ? previous_errors[1] : e1;
+
+        const float delta = desc.proportional_gain * (error - e1)
+            + desc.integral_gain * error
+            + desc.derivative_gain * (error - 2.0f * e1 + e2)
+            + (error == 0.0f ? desc.recovery_rate : 0.0f);
+        render_scale = std::clamp(render_scale + delta, desc.min_scale, desc.max_scale);
+
+        previous_errors[1] = e1;
+        previous_errors[0] = error;
+        num_updates++;
+        return render_scale;
+    }
+
+    void DynamicResolutionController::reset()
+    {
+        render_scale = desc.max_scale;
+        previous_errors[0] = 0.0f;
+        previous_errors[1] = 0.0f;
+        num_updates = 0;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "core/zec_types.h"
+
+namespace zec
+{
+    struct DynamicResolutionDesc
+    {
+        float target_frame_time_ms = 16.0f;
+        float min_scale = 0.5f;
+        float max_scale = 1.0f;
+        // Gains of the PID controller, applied to the frame time error as a fraction of the target. Positive errors
+        // mean there's time to spare, so the scale goes up.
+        float proportional_gain = 0.1f;
+        float integral_gain = 0.05f;
+        float derivative_gain = 0.0f;
+        // Frame times within this fraction of the target count as being on target, so that noisy frame times don't
+        // keep nudging the resolution around
+        float error_deadband = 0.02f;
+        // How much the scale goes up each update that's on target. Frame times synced to vsync never drop below the
+        // refresh interval, so there's never a positive error to raise the scale with once it's come down. Creeping up
+        // lets the controller find out whether there's headroom again. Leave at zero when frame times aren't synced.
+        float recovery_rate = 0.0f;
+    };
+
+    // Picks a render scale that keeps the measured frame time around a target. Works in velocity form, i.e. each update
+    // nudges the scale rather than computing it from scratch, so the scale staying clamped at either end doesn't make the
+    // integral term wind up.
+    class DynamicResolutionController
+    {
+    public:
+        DynamicResolutionController() = default;
+        explicit DynamicResolutionController(const DynamicResolutionDesc& desc);
+
+        // Feeds in how long the last frame took, and returns the render scale to use for the next one
+        float update(const float frame_time_ms);
+        float get_render_scale() const { return render_scale; }
+        // Back to max_scale, forgetting the frame times seen so far
+        void reset();
+
+        const DynamicResolutionDesc& get_desc() const { return desc; }
+        void set_target_frame_time(const float target_frame_time_ms) { desc.target_frame_time_ms = target_frame_time_ms; }
+
+    private:
+        DynamicResolutionDesc desc = {};
+        float render_scale = 1.0f;
+        // Errors of the last two updates
+        float previous_errors[2] = {};
+        u32 num_updates = 0;
+    };
+}
@@ -8,4 +8,7 @@ namespace zec
     constexpr u64 NUM_CMD_ALLOCATORS = RENDER_LATENCY;
 
     constexpr u64 MAX_NUM_MESH_VERTEX_BUFFERS = 8;
+    constexpr u32 MAX_NUM_RENDER_TARGETS = 8;
+    // Threads that can provision and record command contexts at the same time, see gfx::cmd::provision
+    constexpr u32 MAX_NUM_RECORDING_THREADS = 32;
 }
\ No newline at end of file
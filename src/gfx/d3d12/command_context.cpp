@@ -7,11 +7,18 @@ namespace zec::gfx::dx12
 {
     constexpr u64 CMD_LIST_IDX_BIT_WIDTH = 8;
     constexpr u64 CMD_ALLOCATOR_IDX_BIT_WIDTH = 16;
+    constexpr u64 QUEUE_TYPE_BIT_WIDTH = 2;
+    // The remaining 6 bits hold the index of the pool
+    static_assert(MAX_NUM_COMMAND_CONTEXT_POOL_SETS <= 64);
+    static_assert(size_t(CommandQueueType::NUM_COMMAND_CONTEXT_POOLS) <= (1 << QUEUE_TYPE_BIT_WIDTH));
 
-    CommandContextHandle encode_command_context_handle(const CommandQueueType type, const u16 cmd_allocator_idx, const u8 cmd_list_idx)
+    CommandContextHandle encode_command_context_handle(const CommandQueueType type, const u8 pool_idx, const u16 cmd_allocator_idx, const u8 cmd_list_idx)
     {
         return {
-            (u32(type) << (CMD_LIST_IDX_BIT_WIDTH + CMD_ALLOCATOR_IDX_BIT_WIDTH)) | (u32(cmd_allocator_idx) << CMD_LIST_IDX_BIT_WIDTH) | u32(cmd_list_idx)
+            (u32(pool_idx) << (QUEUE_TYPE_BIT_WIDTH + CMD_LIST_IDX_BIT_WIDTH + CMD_ALLOCATOR_IDX_BIT_WIDTH))
+            | (u32(type) << (CMD_LIST_IDX_BIT_WIDTH + CMD_ALLOCATOR_IDX_BIT_WIDTH))
+            | (u32(cmd_allocator_idx) << CMD_LIST_IDX_BIT_WIDTH)
+            | u32(cmd_list_idx)
         };
     }
 
@@ -47,9 +54,10 @@ namespace zec::gfx::dx12
         return size_t(cmd_utils::get_command_queue_type(handle));
     }
 
-    void CommandContextPool::initialize(CommandQueueType type, ID3D12Device* device)
+    void CommandContextPool::initialize(CommandQueueType type, const u8 pool_idx, ID3D12Device* device)
     {
         this->queue_type = type;
+        this->pool_idx = pool_idx;
         this->device = device;
     }
 
@@ -102,8 +110,9 @@ namespace zec::gfx::dx12
             cmd_list = cmd_lists[cmd_list_idx];
             cmd_list->Reset(cmd_allocator, nullptr);
         }
+        cmd_list_stats[cmd_list_idx] = {};
 
-        return encode_command_context_handle(queue_type, allocator_idx, cmd_list_idx);
+        return encode_command_context_handle(queue_type, pool_idx, allocator_idx, cmd_list_idx);
     }
 
     void CommandContextPool::return_to_pool(const u64 fence_value, CommandContextHandle& handle)
@@ -171,6 +180,12 @@ namespace zec::gfx::dx12
         return cmd_lists[get_command_list_idx(context_handle)];
     }
 
+    CommandContextStats& CommandContextPool::get_stats(const CommandContextHandle context_handle)
+    {
+        ASSERT(is_valid(context_handle));
+        return cmd_list_stats[get_command_list_idx(context_handle)];
+    }
+
     void CommandContextPool::reset(const u64 fence_value)
     {
         allocators_free_list.process_in_flight(fence_value);
@@ -181,6 +196,12 @@ namespace zec::gfx::dx12::cmd_utils
 {
     CommandQueueType get_command_queue_type(const CommandContextHandle context_handle)
     {
-        return CommandQueueType(context_handle.idx >> (CMD_LIST_IDX_BIT_WIDTH + CMD_ALLOCATOR_IDX_BIT_WIDTH));
+        constexpr u32 mask = (1 << QUEUE_TYPE_BIT_WIDTH) - 1;
+        return CommandQueueType((context_handle.idx >> (CMD_LIST_IDX_BIT_WIDTH + CMD_ALLOCATOR_IDX_BIT_WIDTH)) & mask);
+    }
+
+    u8 get_command_pool_idx(const CommandContextHandle context_handle)
+    {
+        return u8(context_handle.idx >> (QUEUE_TYPE_BIT_WIDTH + CMD_LIST_IDX_BIT_WIDTH + CMD_ALLOCATOR_IDX_BIT_WIDTH));
     }
 }
\ No newline at end of file
@@ -3,12 +3,16 @@
 
 #include "core/array.h"
 #include "core/ring_buffer.h"
+#include "gfx/constants.h"
 #include "gfx/public_resources.h"
 #include "gfx/gfx.h"
 #include "wrappers.h"
 
 namespace zec::gfx::dx12
 {
+    // The first set of pools is used by cmd::provision(type), then there's one set per recording thread
+    constexpr size_t MAX_NUM_COMMAND_CONTEXT_POOL_SETS = 1 + MAX_NUM_RECORDING_THREADS;
+
     template<typename IndexType, size_t capacity>
     struct AsyncFreeList
     {
@@ -45,6 +49,7 @@ namespace zec::gfx::dx12
         FixedRingBuffer<Node, capacity> in_flight = {};
     };
 
+    // Not thread safe, each thread that records commands at the same time as others needs a pool of its own
     class CommandContextPool
     {
     public:
@@ -52,12 +57,16 @@ namespace zec::gfx::dx12
         ID3D12Device* device;
         // Owning
         CommandQueueType queue_type;
+        // Encoded into the handles provisioned from this pool
+        u8 pool_idx = 0;
         FixedArray<ID3D12GraphicsCommandList*, 128> cmd_lists = {};
+        // Indexed like cmd_lists, reset whenever the list is provisioned
+        CommandContextStats cmd_list_stats[128] = {};
         FixedRingBuffer<u8, 128> free_cmd_list_indices = {};
         FixedArray<ID3D12CommandAllocator*, 128> allocators = {};
         AsyncFreeList<u16, 128> allocators_free_list = {};
 
-        void initialize(CommandQueueType queue_type, ID3D12Device* device);
+        void initialize(CommandQueueType queue_type, const u8 pool_idx, ID3D12Device* device);
         void destroy();
 
         CommandContextHandle provision();
@@ -67,6 +76,7 @@ namespace zec::gfx::dx12
         void reset(const u64 fence_value);
 
         ID3D12GraphicsCommandList* get_graphics_command_list(const CommandContextHandle context_handle);
+        CommandContextStats& get_stats(const CommandContextHandle context_handle);
     };
 
     struct CommandQueue
@@ -118,5 +128,6 @@ namespace zec::gfx::dx12
     namespace cmd_utils
     {
         CommandQueueType get_command_queue_type(const CommandContextHandle context_handle);
+        u8 get_command_pool_idx(const CommandContextHandle context_handle);
     }
 }
\ No newline at end of file
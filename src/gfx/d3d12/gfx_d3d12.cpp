@@ -37,8 +37,7 @@ namespace zec::gfx
         // Used in the profiler, don't use it elsewhere I guess
         ID3D12GraphicsCommandList* get_command_list(const CommandContextHandle cmd_ctx)
         {
-            auto& pool = g_context.command_pools[cmd_utils::get_command_queue_type(cmd_ctx)];
-            return pool.get_graphics_command_list(cmd_ctx);
+            return get_command_pool(g_context, cmd_ctx).get_graphics_command_list(cmd_ctx);
         };
 
         RenderContext& get_render_context()
@@ -129,16 +128,14 @@ namespace zec::gfx
 
             DXCall(swap_chain.swap_chain->SetFullscreenState(swap_chain.fullscreen, nullptr));*/
 
-            for (u64 i = 0; i < NUM_BACK_BUFFERS; i++) {
-                DXCall(swap_chain.swap_chain->ResizeBuffers(
-                    NUM_BACK_BUFFERS,
-                    swap_chain.width,
-                    swap_chain.height,
-                    swap_chain.non_sRGB_format,
-                    DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH |
-                    DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING |
-                    DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT));
-            }
+            DXCall(swap_chain.swap_chain->ResizeBuffers(
+                NUM_BACK_BUFFERS,
+                swap_chain.width,
+                swap_chain.height,
+                swap_chain.non_sRGB_format,
+                DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH |
+                DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING |
+                DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT));
 
             /*if (swap_chain.fullscreen) {
                 DXGI_MODE_DESC mode;
@@ -291,9 +288,10 @@ namespace zec::gfx
                 // Initialize Queue
                 g_context.command_queues[queue_type].initialize(queue_type, g_context.device);
 
-                // Initialize Pool
-
-                g_context.command_pools[queue_type].initialize(queue_type, g_context.device);
+                // Initialize Pools
+                for (size_t pool_idx = 0; pool_idx < MAX_NUM_COMMAND_CONTEXT_POOL_SETS; pool_idx++) {
+                    g_context.command_pools[pool_idx][queue_type].initialize(queue_type, u8(pool_idx), g_context.device);
+                }
 
             }
 
@@ -379,7 +377,8 @@ namespace zec::gfx
         {
             g_context.textures.destroy(
                 [](ID3D12Resource* resource, D3D12MA::Allocation* allocation) {
-                    resource->Release();
+                    // Destroyed textures leave an empty slot behind
+                    if (resource) resource->Release();
                     if (allocation) allocation->Release();
                 },
                 [](DescriptorRangeHandle handle) {
@@ -409,12 +408,21 @@ namespace zec::gfx
             g_context.buffers.destroy();
         }
 
+        for (D3D12MA::Allocation* heap_allocation : g_context.resource_heaps) {
+            if (heap_allocation != nullptr) {
+                heap_allocation->Release();
+            }
+        }
+        g_context.resource_heaps.empty();
+
         destroy(g_context.destruction_queue, g_context.current_frame_idx, g_context.frame_fence);
 
         g_context.descriptor_heap_manager.destroy();
 
-        for (auto& pool : g_context.command_pools) {
-            pool.destroy();
+        for (auto& pools : g_context.command_pools) {
+            for (auto& pool : pools) {
+                pool.destroy();
+            }
         }
 
         for (auto& queue : g_context.command_queues) {
@@ -454,7 +462,9 @@ namespace zec::gfx
         for (size_t i = 0; i < size_t(CommandQueueType::NUM_COMMAND_CONTEXT_POOLS); i++) {
             auto& queue = g_context.command_queues[i];
             queue.flush();
-            g_context.command_pools[i].reset(queue.last_used_fence_value);
+            for (auto& pools : g_context.command_pools) {
+                pools[i].reset(queue.last_used_fence_value);
+            }
         }
 
         u64 last_submitted_frame = g_context.current_cpu_frame - 1;
@@ -515,11 +525,12 @@ namespace zec::gfx
                 ++g_context.current_gpu_frame;
             }
 
-            for (size_t i = 0; i < g_context.command_pools.size; i++) {
+            for (size_t i = 0; i < g_context.command_queues.size; i++) {
                 auto& queue = g_context.command_queues[i];
-                auto& command_pool = g_context.command_pools[i];
                 queue_completed_fence_values[i] = get_completed_value(queue.fence);
-                command_pool.reset(queue_completed_fence_values[i]);
+                for (auto& pools : g_context.command_pools) {
+                    pools[i].reset(queue_completed_fence_values[i]);
+                }
             }
 
         }
@@ -556,7 +567,22 @@ namespace zec::gfx
         return g_context.swap_chain.back_buffers[g_context.current_frame_idx];
     };
 
-    void on_window_resize(u32 width, u32 height) { };
+    void on_window_resize(u32 width, u32 height)
+    {
+        SwapChain& swap_chain = g_context.swap_chain;
+        if (swap_chain.swap_chain == nullptr || width == 0 || height == 0 || (width == swap_chain.width && height == swap_chain.height)) {
+            return;
+        }
+
+        // Nothing in flight can still be referencing the back buffers once they're resized
+        flush_gpu();
+
+        swap_chain.width = width;
+        swap_chain.height = height;
+        g_context.config_state.width = width;
+        g_context.config_state.height = height;
+        reset_swap_chain(swap_chain);
+    };
 
     namespace shader_compilation
     {
@@ -902,9 +928,46 @@ namespace zec::gfx
         }
     }
 
+    namespace heaps
+    {
+        ResourceHeapHandle create(const ResourceHeapDesc& desc)
+        {
+            ASSERT(desc.byte_size > 0);
+            constexpr D3D12_HEAP_FLAGS heap_flags[] = {
+                D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,             // BUFFERS
+                D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES,  // TEXTURES
+                D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES,      // RENDER_TARGETS
+            };
+            static_assert(std::size(heap_flags) == size_t(ResourceHeapType::COUNT));
+
+            D3D12MA::ALLOCATION_DESC alloc_desc = {};
+            alloc_desc.HeapType = D3D12_HEAP_TYPE_DEFAULT;
+            alloc_desc.ExtraHeapFlags = heap_flags[size_t(desc.type)];
+            // Heap sizes have to be a multiple of 64KB
+            constexpr u64 alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+            const D3D12_RESOURCE_ALLOCATION_INFO allocation_info = {
+                .SizeInBytes = ((desc.byte_size + alignment - 1) / alignment) * alignment,
+                .Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
+            };
+
+            D3D12MA::Allocation* allocation = nullptr;
+            DXCall(g_context.allocator->AllocateMemory(&alloc_desc, &allocation_info, &allocation));
+            return { u32(g_context.resource_heaps.push_back(allocation)) };
+        }
+
+        void destroy(const ResourceHeapHandle handle)
+        {
+            ASSERT(is_valid(handle));
+            D3D12MA::Allocation*& allocation = g_context.resource_heaps[handle];
+            ASSERT_MSG(allocation != nullptr, "Heap has already been destroyed");
+            g_context.destruction_queue.enqueue(g_context.current_frame_idx, nullptr, allocation);
+            allocation = nullptr;
+        }
+    }
+
     namespace buffers
     {
-        BufferHandle create(BufferDesc desc)
+        static Buffer to_buffer(const BufferDesc& desc)
         {
             ASSERT(desc.byte_size != 0);
             ASSERT(desc.usage != u16(RESOURCE_USAGE_UNUSED));
@@ -942,7 +1005,7 @@ namespace zec::gfx
                 total_size = RENDER_LATENCY * per_frame_size;
             }
 
-            Buffer buffer{
+            return Buffer{
                 .info = {
                     .total_size = total_size,
                     .per_frame_size = per_frame_size,
@@ -950,36 +1013,20 @@ namespace zec::gfx
                     .cpu_accessible = is_cpu_accessible,
                 }
             };
+        }
 
-            D3D12_HEAP_TYPE heap_type = D3D12_HEAP_TYPE_DEFAULT;
-            D3D12_RESOURCE_STATES initial_resource_state = D3D12_RESOURCE_STATE_COMMON;
-            if (is_cpu_accessible) {
-                heap_type = D3D12_HEAP_TYPE_UPLOAD;
-                initial_resource_state = D3D12_RESOURCE_STATE_GENERIC_READ;
-            }
-
+        static D3D12_RESOURCE_DESC to_resource_desc(const BufferDesc& desc, const Buffer& buffer)
+        {
             D3D12_RESOURCE_FLAGS resource_flags = D3D12_RESOURCE_FLAG_NONE;
             if (desc.usage & RESOURCE_USAGE_COMPUTE_WRITABLE) {
                 resource_flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
             }
+            return CD3DX12_RESOURCE_DESC::Buffer(buffer.info.total_size, resource_flags);
+        }
 
-            D3D12_RESOURCE_DESC resource_desc = CD3DX12_RESOURCE_DESC::Buffer(buffer.info.total_size, resource_flags);
-            D3D12MA::ALLOCATION_DESC alloc_desc = {};
-            alloc_desc.HeapType = heap_type;
-
-            HRESULT res = (g_context.allocator->CreateResource(
-                &alloc_desc,
-                &resource_desc,
-                initial_resource_state,
-                NULL,
-                &buffer.allocation,
-                IID_PPV_ARGS(&buffer.resource)
-            ));
-            if (res == DXGI_ERROR_DEVICE_REMOVED) {
-                debug_print(GetDXErrorString(g_context.device->GetDeviceRemovedReason()));
-            }
-            DXCall(res);
-
+        // Creates the views for a buffer whose resource has already been created, and adds it to our list
+        static BufferHandle create_views_and_push_back(Buffer& buffer, const BufferDesc& desc)
+        {
             buffer.info.gpu_address = buffer.resource->GetGPUVirtualAddress();
 
             bool is_raw = desc.type == BufferType::RAW;
@@ -1021,8 +1068,81 @@ namespace zec::gfx
             }
 
             return g_context.buffers.push_back(buffer);
+        }
+
+        BufferHandle create(BufferDesc desc)
+        {
+            Buffer buffer = to_buffer(desc);
+
+            D3D12_HEAP_TYPE heap_type = D3D12_HEAP_TYPE_DEFAULT;
+            D3D12_RESOURCE_STATES initial_resource_state = D3D12_RESOURCE_STATE_COMMON;
+            if (buffer.info.cpu_accessible) {
+                heap_type = D3D12_HEAP_TYPE_UPLOAD;
+                initial_resource_state = D3D12_RESOURCE_STATE_GENERIC_READ;
+            }
+
+            D3D12_RESOURCE_DESC resource_desc = to_resource_desc(desc, buffer);
+            D3D12MA::ALLOCATION_DESC alloc_desc = {};
+            alloc_desc.HeapType = heap_type;
+
+            HRESULT res = (g_context.allocator->CreateResource(
+                &alloc_desc,
+                &resource_desc,
+                initial_resource_state,
+                NULL,
+                &buffer.allocation,
+                IID_PPV_ARGS(&buffer.resource)
+            ));
+            if (res == DXGI_ERROR_DEVICE_REMOVED) {
+                debug_print(GetDXErrorString(g_context.device->GetDeviceRemovedReason()));
+            }
+            DXCall(res);
+
+            return create_views_and_push_back(buffer, desc);
         };
 
+        BufferHandle create_placed(const ResourceHeapHandle heap, const u64 heap_offset, BufferDesc desc)
+        {
+            ASSERT(is_valid(heap));
+            ASSERT_MSG((desc.usage & RESOURCE_USAGE_DYNAMIC) == 0, "Heaps live in GPU memory, so CPU writable buffers can't be placed in them");
+            Buffer buffer = to_buffer(desc);
+
+            // The heap's allocation keeps the memory alive, so the buffer doesn't get one of its own
+            D3D12_RESOURCE_DESC resource_desc = to_resource_desc(desc, buffer);
+            DXCall(g_context.allocator->CreateAliasingResource(
+                g_context.resource_heaps[heap],
+                heap_offset,
+                &resource_desc,
+                D3D12_RESOURCE_STATE_COMMON,
+                nullptr,
+                IID_PPV_ARGS(&buffer.resource)
+            ));
+
+            return create_views_and_push_back(buffer, desc);
+        }
+
+        ResourceAllocationInfo get_allocation_info(const BufferDesc& desc)
+        {
+            const D3D12_RESOURCE_DESC resource_desc = to_resource_desc(desc, to_buffer(desc));
+            const D3D12_RESOURCE_ALLOCATION_INFO allocation_info = g_context.device->GetResourceAllocationInfo(0, 1, &resource_desc);
+            return { .byte_size = allocation_info.SizeInBytes, .alignment = allocation_info.Alignment };
+        }
+
+        void destroy(const BufferHandle handle)
+        {
+            ASSERT(is_valid(handle));
+            ID3D12Resource*& resource = g_context.buffers.resources[handle];
+            ASSERT_MSG(resource != nullptr, "Buffer has already been destroyed");
+            g_context.destruction_queue.enqueue(g_context.current_frame_idx, resource, g_context.buffers.allocations[handle]);
+            resource = nullptr;
+            g_context.buffers.allocations[handle] = nullptr;
+
+            g_context.descriptor_heap_manager.free_descriptors(g_context.current_frame_idx, g_context.buffers.srvs[handle]);
+            g_context.descriptor_heap_manager.free_descriptors(g_context.current_frame_idx, g_context.buffers.uavs[handle]);
+            g_context.buffers.srvs[handle] = INVALID_HANDLE;
+            g_context.buffers.uavs[handle] = INVALID_HANDLE;
+        }
+
         u32 get_shader_readable_index(const BufferHandle handle)
         {
             DescriptorRangeHandle descriptor = g_context.buffers.srvs[handle];
@@ -1107,21 +1227,18 @@ namespace zec::gfx
 
     namespace textures
     {
-        TextureHandle create(TextureDesc desc)
+        // Everything needed to create a texture's D3D resource, whether it gets memory of its own or is placed in a heap
+        struct D3DTextureDesc
         {
-            Texture texture = {
-              .info = {
-                  .width = desc.width,
-                  .height = desc.height,
-                  .depth = desc.depth,
-                  .num_mips = desc.num_mips,
-                  .array_size = desc.array_size,
-                  .format = desc.format,
-                  .is_cubemap = desc.is_cubemap
-              }
-            };
+            D3D12_RESOURCE_DESC d3d_desc = {};
+            D3D12_CLEAR_VALUE optimized_clear_value = {};
+            D3D12_RESOURCE_STATES initial_state = D3D12_RESOURCE_STATE_COMMON;
+            bool depth_or_rt = false;
+        };
 
-            DXGI_FORMAT d3d_format = to_d3d_format(texture.info.format);
+        static D3DTextureDesc to_resource_desc(const TextureDesc& desc)
+        {
+            DXGI_FORMAT d3d_format = to_d3d_format(desc.format);
             D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE;
             /*if (desc.initial_state != RESOURCE_USAGE_UNUSED);
             ASSERT(desc.initial_state & desc.usage);*/
@@ -1157,11 +1274,12 @@ namespace zec::gfx
                 depth_or_array_size = u16(desc.depth);
             }
 
-            D3D12_RESOURCE_DESC d3d_desc = {
+            D3DTextureDesc resource_desc = {};
+            resource_desc.d3d_desc = {
                 .Dimension = desc.is_3d ? D3D12_RESOURCE_DIMENSION_TEXTURE3D : D3D12_RESOURCE_DIMENSION_TEXTURE2D,
                 .Alignment = 0,
-                .Width = texture.info.width,
-                .Height = texture.info.height,
+                .Width = desc.width,
+                .Height = desc.height,
                 .DepthOrArraySize = depth_or_array_size,
                 .MipLevels = u16(desc.num_mips),
                 .Format = d3d_format,
@@ -1173,29 +1291,24 @@ namespace zec::gfx
                  .Flags = flags
             };
 
-            D3D12MA::ALLOCATION_DESC alloc_desc = {
-                .HeapType = D3D12_HEAP_TYPE_DEFAULT
-            };
-
-            D3D12_RESOURCE_STATES initial_state = desc.initial_state == RESOURCE_USAGE_UNUSED
+            resource_desc.optimized_clear_value = optimized_clear_value;
+            resource_desc.initial_state = desc.initial_state == RESOURCE_USAGE_UNUSED
                 ? D3D12_RESOURCE_STATE_COMMON
                 : to_d3d_resource_state(desc.initial_state);
+            resource_desc.depth_or_rt = bool(desc.usage & (RESOURCE_USAGE_DEPTH_STENCIL | RESOURCE_USAGE_RENDER_TARGET));
+            return resource_desc;
+        }
 
-            const bool depth_or_rt = bool(desc.usage & (RESOURCE_USAGE_DEPTH_STENCIL | RESOURCE_USAGE_RENDER_TARGET));
-            DXCall(g_context.allocator->CreateResource(
-                &alloc_desc,
-                &d3d_desc,
-                initial_state,
-                depth_or_rt ? &optimized_clear_value : nullptr,
-                &texture.allocation,
-                IID_PPV_ARGS(&texture.resource)
-            ));
+        // Creates the views for a texture whose resource has already been created, and adds it to our list
+        static TextureHandle create_views_and_push_back(Texture& texture, const TextureDesc& desc)
+        {
+            const DXGI_FORMAT d3d_format = to_d3d_format(desc.format);
 
             // Allocate SRV
             if (desc.usage & RESOURCE_USAGE_SHADER_READABLE) {
 
                 D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc = {
-                    .Format = d3d_desc.Format,
+                    .Format = d3d_format,
                     .ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D,
                     .Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
                     .Texture2D = {
@@ -1293,8 +1406,94 @@ namespace zec::gfx
             }
 
             return g_context.textures.push_back(texture);
+        }
+
+        static Texture to_texture(const TextureDesc& desc)
+        {
+            return {
+              .info = {
+                  .width = desc.width,
+                  .height = desc.height,
+                  .depth = desc.depth,
+                  .num_mips = desc.num_mips,
+                  .array_size = desc.array_size,
+                  .format = desc.format,
+                  .is_cubemap = desc.is_cubemap
+              }
+            };
+        }
+
+        TextureHandle create(TextureDesc desc)
+        {
+            Texture texture = to_texture(desc);
+            const D3DTextureDesc resource_desc = to_resource_desc(desc);
+
+            D3D12MA::ALLOCATION_DESC alloc_desc = {
+                .HeapType = D3D12_HEAP_TYPE_DEFAULT
+            };
+
+            DXCall(g_context.allocator->CreateResource(
+                &alloc_desc,
+                &resource_desc.d3d_desc,
+                resource_desc.initial_state,
+                resource_desc.depth_or_rt ? &resource_desc.optimized_clear_value : nullptr,
+                &texture.allocation,
+                IID_PPV_ARGS(&texture.resource)
+            ));
+
+            return create_views_and_push_back(texture, desc);
         };
 
+        TextureHandle create_placed(const ResourceHeapHandle heap, const u64 heap_offset, TextureDesc desc)
+        {
+            ASSERT(is_valid(heap));
+            Texture texture = to_texture(desc);
+            const D3DTextureDesc resource_desc = to_resource_desc(desc);
+
+            // The heap's allocation keeps the memory alive, so the texture doesn't get one of its own
+            DXCall(g_context.allocator->CreateAliasingResource(
+                g_context.resource_heaps[heap],
+                heap_offset,
+                &resource_desc.d3d_desc,
+                resource_desc.initial_state,
+                resource_desc.depth_or_rt ? &resource_desc.optimized_clear_value : nullptr,
+                IID_PPV_ARGS(&texture.resource)
+            ));
+
+            return create_views_and_push_back(texture, desc);
+        }
+
+        ResourceAllocationInfo get_allocation_info(const TextureDesc& desc)
+        {
+            const D3DTextureDesc resource_desc = to_resource_desc(desc);
+            const D3D12_RESOURCE_ALLOCATION_INFO allocation_info = g_context.device->GetResourceAllocationInfo(0, 1, &resource_desc.d3d_desc);
+            return { .byte_size = allocation_info.SizeInBytes, .alignment = allocation_info.Alignment };
+        }
+
+        void destroy(const TextureHandle handle)
+        {
+            ASSERT(is_valid(handle));
+            ID3D12Resource*& resource = g_context.textures.resources[handle];
+            ASSERT_MSG(resource != nullptr, "Texture has already been destroyed");
+            g_context.destruction_queue.enqueue(g_context.current_frame_idx, resource, g_context.textures.allocations[handle]);
+            resource = nullptr;
+            g_context.textures.allocations[handle] = nullptr;
+
+            DescriptorRangeHandle* descriptors[] = {
+                &g_context.textures.srvs[handle],
+                &g_context.textures.uavs[handle],
+                &g_context.textures.rtvs[handle],
+            };
+            for (DescriptorRangeHandle* descriptor : descriptors) {
+                g_context.descriptor_heap_manager.free_descriptors(g_context.current_frame_idx, *descriptor);
+                *descriptor = INVALID_HANDLE;
+            }
+            if (g_context.textures.dsvs.contains(handle)) {
+                g_context.descriptor_heap_manager.free_descriptors(g_context.current_frame_idx, g_context.textures.dsvs[handle]);
+                g_context.textures.dsvs.erase(handle);
+            }
+        }
+
         u32 get_shader_readable_index(const TextureHandle handle)
         {
             DescriptorRangeHandle descriptor = g_context.textures.srvs[handle];
@@ -1466,10 +1665,10 @@ namespace zec::gfx
     namespace cmd
     {
         // ---------- Command Contexts ----------
-        CommandContextHandle provision(CommandQueueType type)
+        static CommandContextHandle provision_from_pool(CommandContextPool& pool)
         {
-            CommandContextHandle cmd_ctx = g_context.command_pools[type].provision();
-            if (type != CommandQueueType::COPY) {
+            CommandContextHandle cmd_ctx = pool.provision();
+            if (pool.queue_type != CommandQueueType::COPY) {
                 ID3D12GraphicsCommandList* cmd_list = get_command_list(cmd_ctx);
                 auto* heap = g_context.descriptor_heap_manager.get_d3d_heaps(HeapType::CBV_SRV_UAV);
                 cmd_list->SetDescriptorHeaps(1, &heap);
@@ -1477,6 +1676,22 @@ namespace zec::gfx
             return cmd_ctx;
         };
 
+        CommandContextHandle provision(CommandQueueType type)
+        {
+            return provision_from_pool(g_context.command_pools[0][type]);
+        };
+
+        CommandContextHandle provision(CommandQueueType type, const u32 thread_idx)
+        {
+            ASSERT(thread_idx < MAX_NUM_RECORDING_THREADS);
+            return provision_from_pool(g_context.command_pools[1 + thread_idx][type]);
+        };
+
+        CommandContextStats get_stats(const CommandContextHandle ctx)
+        {
+            return get_command_pool(g_context, ctx).get_stats(ctx);
+        }
+
         CmdReceipt return_and_execute(CommandContextHandle* context_handles, const size_t num_contexts)
         {
             constexpr size_t MAX_NUM_SIMULTANEOUS_COMMAND_LIST_EXECUTION = 128; // Arbitrary limit
@@ -1485,7 +1700,6 @@ namespace zec::gfx
             ID3D12GraphicsCommandList** cmd_lists = static_cast<ID3D12GraphicsCommandList**>(_alloca(num_contexts * sizeof(ID3D12GraphicsCommandList*)));
 
             CommandQueueType queue_type = cmd_utils::get_command_queue_type(context_handles[0]);
-            CommandContextPool& pool = g_context.command_pools[queue_type];
             CommandQueue& queue = g_context.command_queues[queue_type];
 
             // Collect command lists
@@ -1493,7 +1707,7 @@ namespace zec::gfx
                 // Make sure all contexts are using the same pool/queue
                 ASSERT(cmd_utils::get_command_queue_type(context_handles[i]) == queue_type);
 
-                cmd_lists[i] = pool.get_graphics_command_list(context_handles[i]);
+                cmd_lists[i] = get_command_list(context_handles[i]);
                 DXCall(cmd_lists[i]->Close());
             }
 
@@ -1513,9 +1727,9 @@ namespace zec::gfx
                     g_context.upload_store.clear_staged_uploads(context_handles[i]);
                 }
             }
-            // Return to pools
+            // Return to pools, which may differ if the contexts were recorded on different threads
             for (size_t i = 0; i < num_contexts; i++) {
-                pool.return_to_pool(receipt.fence_value, context_handles[i]);
+                get_command_pool(g_context, context_handles[i]).return_to_pool(receipt.fence_value, context_handles[i]);
             }
 
             return receipt;
@@ -1593,6 +1807,7 @@ namespace zec::gfx
             cmd_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_LINESTRIP);
             cmd_list->IASetVertexBuffers(0, 1, &vb_view);
             cmd_list->DrawInstanced(u32(buffer_info.per_frame_size) / stride, 1, 0, 0);
+            get_command_pool(g_context, ctx).get_stats(ctx).num_draws++;
         };
 
         void draw_mesh(const CommandContextHandle ctx, const BufferHandle index_buffer_id, const size_t num_instances)
@@ -1608,6 +1823,7 @@ namespace zec::gfx
             cmd_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
             cmd_list->IASetIndexBuffer(&view);
             cmd_list->DrawIndexedInstanced(u32(buffer_info.per_frame_size / buffer_info.stride), num_instances, 0, 0, 0);
+            get_command_pool(g_context, ctx).get_stats(ctx).num_draws++;
         }
 
         //--------- Resource Binding ----------
@@ -1658,6 +1874,7 @@ namespace zec::gfx
         {
             ID3D12GraphicsCommandList* cmd_list = get_command_list(ctx);
             cmd_list->Dispatch(thread_group_count_x, thread_group_count_y, thread_group_count_z);
+            get_command_pool(g_context, ctx).get_stats(ctx).num_dispatches++;
         }
 
         // Misc
@@ -1723,6 +1940,54 @@ namespace zec::gfx
             cmd_list->OMSetRenderTargets(num_render_targets, rtvs, FALSE, dsv_ptr);
         };
 
+        // Command lists here don't use native render passes, so load and store ops are emulated with clears and discards
+        void begin_render_pass(const CommandContextHandle ctx, const RenderPassDesc& render_pass_desc)
+        {
+            ID3D12GraphicsCommandList* cmd_list = get_command_list(ctx);
+            TextureHandle render_targets[MAX_NUM_RENDER_TARGETS] = {};
+            ASSERT(render_pass_desc.num_render_targets <= MAX_NUM_RENDER_TARGETS);
+            for (u32 i = 0; i < render_pass_desc.num_render_targets; i++) {
+                const RenderPassAttachment& attachment = render_pass_desc.render_targets[i];
+                render_targets[i] = attachment.texture;
+                if (attachment.load_op == LoadOp::CLEAR) {
+                    clear_render_target(ctx, attachment.texture, attachment.clear_value);
+                }
+                else if (attachment.load_op == LoadOp::DISCARD) {
+                    cmd_list->DiscardResource(g_context.textures.resources[attachment.texture], nullptr);
+                }
+            }
+
+            const RenderPassAttachment& depth_target = render_pass_desc.depth_target;
+            if (is_valid(depth_target.texture)) {
+                if (depth_target.load_op == LoadOp::CLEAR) {
+                    const DescriptorRangeHandle dsv = g_context.textures.dsvs[depth_target.texture];
+                    auto cpu_handle = g_context.descriptor_heap_manager.get_cpu_descriptor_handle(dsv);
+                    const D3D12_CLEAR_FLAGS clear_flags = D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL;
+                    cmd_list->ClearDepthStencilView(cpu_handle, clear_flags, depth_target.clear_value[0], u8(depth_target.clear_value[1]), 0, nullptr);
+                }
+                else if (depth_target.load_op == LoadOp::DISCARD) {
+                    cmd_list->DiscardResource(g_context.textures.resources[depth_target.texture], nullptr);
+                }
+            }
+
+            set_render_targets(ctx, render_targets, render_pass_desc.num_render_targets, depth_target.texture);
+        }
+
+        void end_render_pass(const CommandContextHandle ctx, const RenderPassDesc& render_pass_desc)
+        {
+            ID3D12GraphicsCommandList* cmd_list = get_command_list(ctx);
+            for (u32 i = 0; i < render_pass_desc.num_render_targets; i++) {
+                const RenderPassAttachment& attachment = render_pass_desc.render_targets[i];
+                if (attachment.store_op == StoreOp::DISCARD) {
+                    cmd_list->DiscardResource(g_context.textures.resources[attachment.texture], nullptr);
+                }
+            }
+            const RenderPassAttachment& depth_target = render_pass_desc.depth_target;
+            if (is_valid(depth_target.texture) && depth_target.store_op == StoreOp::DISCARD) {
+                cmd_list->DiscardResource(g_context.textures.resources[depth_target.texture], nullptr);
+            }
+        }
+
         void transition_textures(
             const CommandContextHandle ctx,
             TextureTransitionDesc* transition_descs,
@@ -1751,27 +2016,63 @@ namespace zec::gfx
             u64 num_transitions
         )
         {
-            constexpr u64 MAX_NUM_BARRIERS = 16;
-            ASSERT(num_transitions <= MAX_NUM_BARRIERS);
-            D3D12_RESOURCE_BARRIER barriers[MAX_NUM_BARRIERS];
-            for (size_t i = 0; i < num_transitions; i++) {
-                D3D12_RESOURCE_BARRIER& barrier = barriers[i];
+            // Descs covering a mip level across every array slice (or the other way around) expand to a barrier per
+            // subresource, so barriers are issued in batches of however many fit
+            constexpr u64 MAX_NUM_BARRIERS_PER_BATCH = 16;
+            D3D12_RESOURCE_BARRIER barriers[MAX_NUM_BARRIERS_PER_BATCH];
+            u32 num_barriers = 0;
+            ID3D12GraphicsCommandList* cmd_list = get_command_list(ctx);
+
+            const auto add_barrier = [&](const ResourceTransitionDesc& transition_desc, ID3D12Resource* resource, const u32 subresource)
+            {
+                if (num_barriers == MAX_NUM_BARRIERS_PER_BATCH) {
+                    cmd_list->ResourceBarrier(num_barriers, barriers);
+                    num_barriers = 0;
+                }
+                D3D12_RESOURCE_BARRIER& barrier = barriers[num_barriers++];
                 barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
                 barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-                ID3D12Resource* resource = nullptr;
-                if (transition_descs[i].type == ResourceTransitionType::TEXTURE) {
-                    resource = g_context.textures.resources[transition_descs[i].texture];
+                if (transition_desc.split == SplitBarrier::BEGIN) {
+                    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
                 }
-                else {
-                    resource = g_context.buffers.resources[transition_descs[i].buffer];
+                else if (transition_desc.split == SplitBarrier::END) {
+                    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
                 }
                 barrier.Transition.pResource = resource;
-                barrier.Transition.StateBefore = to_d3d_resource_state(transition_descs[i].before);
-                barrier.Transition.StateAfter = to_d3d_resource_state(transition_descs[i].after);
-                barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                barrier.Transition.StateBefore = to_d3d_resource_state(transition_desc.before);
+                barrier.Transition.StateAfter = to_d3d_resource_state(transition_desc.after);
+                barrier.Transition.Subresource = subresource;
+            };
+
+            for (size_t i = 0; i < num_transitions; i++) {
+                const ResourceTransitionDesc& transition_desc = transition_descs[i];
+                const bool is_whole_resource = transition_desc.mip_level == k_all_subresources && transition_desc.array_slice == k_all_subresources;
+                if (transition_desc.type == ResourceTransitionType::BUFFER) {
+                    add_barrier(transition_desc, g_context.buffers.resources[transition_desc.buffer], D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+                }
+                else if (is_whole_resource) {
+                    add_barrier(transition_desc, g_context.textures.resources[transition_desc.texture], D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+                }
+                else {
+                    const TextureInfo& texture_info = g_context.textures.infos[transition_desc.texture];
+                    ID3D12Resource* resource = g_context.textures.resources[transition_desc.texture];
+                    const u32 num_mips = texture_info.num_mips;
+                    const u32 array_size = texture_info.array_size;
+                    const u32 first_mip = transition_desc.mip_level == k_all_subresources ? 0 : transition_desc.mip_level;
+                    const u32 last_mip = transition_desc.mip_level == k_all_subresources ? num_mips : first_mip + 1;
+                    const u32 first_slice = transition_desc.array_slice == k_all_subresources ? 0 : transition_desc.array_slice;
+                    const u32 last_slice = transition_desc.array_slice == k_all_subresources ? array_size : first_slice + 1;
+                    ASSERT(last_mip <= num_mips && last_slice <= array_size);
+                    for (u32 slice = first_slice; slice < last_slice; slice++) {
+                        for (u32 mip = first_mip; mip < last_mip; mip++) {
+                            add_barrier(transition_desc, resource, D3D12CalcSubresource(mip, slice, 0, num_mips, array_size));
+                        }
+                    }
+                }
+            }
+            if (num_barriers > 0) {
+                cmd_list->ResourceBarrier(num_barriers, barriers);
             }
-            ID3D12GraphicsCommandList* cmd_list = get_command_list(ctx);
-            cmd_list->ResourceBarrier(u32(num_transitions), barriers);
         }
 
         void compute_write_barrier(const CommandContextHandle ctx, BufferHandle buffer_handle)
@@ -1807,6 +2108,34 @@ namespace zec::gfx
             };
             cmd_list->ResourceBarrier(1, &barrier);
         }
+
+        void aliasing_barrier(const CommandContextHandle ctx, BufferHandle buffer_handle)
+        {
+            ASSERT(is_valid(buffer_handle));
+            ID3D12GraphicsCommandList* cmd_list = get_command_list(ctx);
+
+            // Any resource overlapping this one could have been the last one used, so we don't specify a resource before
+            D3D12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, g_context.buffers.resources[buffer_handle]);
+            cmd_list->ResourceBarrier(1, &barrier);
+        }
+
+        void aliasing_barrier(const CommandContextHandle ctx, TextureHandle texture_handle)
+        {
+            ASSERT(is_valid(texture_handle));
+            ID3D12GraphicsCommandList* cmd_list = get_command_list(ctx);
+
+            D3D12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, g_context.textures.resources[texture_handle]);
+            cmd_list->ResourceBarrier(1, &barrier);
+        }
+
+        void discard_texture(const CommandContextHandle ctx, TextureHandle texture_handle)
+        {
+            ASSERT(is_valid(texture_handle));
+            // Render and depth targets need their metadata initialized after being aliased, which discarding takes care of
+            ASSERT_MSG(is_valid(g_context.textures.rtvs[texture_handle]) || g_context.textures.dsvs.contains(texture_handle), "Only render and depth targets can be discarded");
+            ID3D12GraphicsCommandList* cmd_list = get_command_list(ctx);
+            cmd_list->DiscardResource(g_context.textures.resources[texture_handle], nullptr);
+        }
     }
 
     void set_debug_name(const ResourceLayoutHandle handle, const wchar* name)
@@ -112,5 +112,6 @@ namespace zec::gfx::cmd
         cmd_list->IASetIndexBuffer(&mesh.index_buffer_view);
         cmd_list->IASetVertexBuffers(0, mesh.num_vertex_buffers, mesh.buffer_views);
         cmd_list->DrawIndexedInstanced(mesh.index_count, 1, 0, 0, 0);
+        get_command_pool(render_context, ctx).get_stats(ctx).num_draws++;
     }
 }
\ No newline at end of file
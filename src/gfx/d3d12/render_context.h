@@ -56,7 +56,8 @@ namespace zec::gfx::dx12
         SwapChain swap_chain = {};
 
         PerQueueArray<CommandQueue> command_queues;
-        PerQueueArray<CommandContextPool> command_pools = {};
+        // Indexed by the pool index encoded in the command context handles, see MAX_NUM_COMMAND_CONTEXT_POOL_SETS
+        PerQueueArray<CommandContextPool> command_pools[MAX_NUM_COMMAND_CONTEXT_POOL_SETS] = {};
 
         UploadContextStore upload_store;
         ResourceDestructionQueue destruction_queue = {};
@@ -72,13 +73,20 @@ namespace zec::gfx::dx12
 
         BufferList buffers = {};
         TextureList textures = {};
+        // Memory that placed resources are created in
+        ResourceArray<D3D12MA::Allocation*, ResourceHeapHandle> resource_heaps = {};
     };
 
-    inline ID3D12GraphicsCommandList* get_command_list(RenderContext& render_context, const CommandContextHandle& handle)
+    inline CommandContextPool& get_command_pool(RenderContext& render_context, const CommandContextHandle& handle)
     {
+        ASSERT(is_valid(handle));
         CommandQueueType type = cmd_utils::get_command_queue_type(handle);
-        CommandContextPool& command_pool = render_context.command_pools[type];
-        return command_pool.get_graphics_command_list(handle);
+        return render_context.command_pools[cmd_utils::get_command_pool_idx(handle)][type];
+    };
+
+    inline ID3D12GraphicsCommandList* get_command_list(RenderContext& render_context, const CommandContextHandle& handle)
+    {
+        return get_command_pool(render_context, handle).get_graphics_command_list(handle);
     };
 
     RenderContext& get_render_context();
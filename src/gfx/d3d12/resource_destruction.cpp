@@ -18,8 +18,9 @@ namespace zec::gfx::dx12
         auto& internal_queue = internal_queues[current_frame_idx];
         for (size_t i = 0; i < internal_queue.size; i++) {
             auto [resource, allocation] = internal_queue[i];
-            ASSERT(resource != nullptr);
-            resource->Release();
+            // Heaps are queued up without a resource
+            ASSERT(resource != nullptr || allocation != nullptr);
+            if (resource != nullptr) resource->Release();
             if (allocation != nullptr) allocation->Release();
         }
         internal_queue.empty();
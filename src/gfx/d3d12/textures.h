@@ -61,6 +61,16 @@ namespace zec::gfx::dx12
             internal_map[handle] = dsv;
         }
 
+        bool contains(const TextureHandle handle) const
+        {
+            return internal_map.contains(handle);
+        }
+
+        void erase(const TextureHandle handle)
+        {
+            internal_map.erase(handle);
+        }
+
         DescriptorRangeHandle& operator[](const TextureHandle handle) { 
             return internal_map.at(handle);
         };
@@ -106,6 +116,7 @@ namespace zec::gfx::dx12
 
         TextureHandle push_back(const Texture& texture);
 
+        // Note: destroyed textures leave null resources behind, the callback has to handle those
         void destroy(void (*resource_destruction_callback)(ID3D12Resource*, D3D12MA::Allocation*), void(*descriptor_destruction_callback)(DescriptorRangeHandle));
 
         // Getters
@@ -19,8 +19,20 @@ namespace zec::ui
     struct UIState
     {
         DescriptorRangeHandle srv_handle = {};
+        // Filled in by capture_frame(), the lists are clones owned by us rather than ImGui
+        bool has_captured_draw_data = false;
+        ImDrawData captured_draw_data = {};
+        ImVector<ImDrawList*> captured_draw_lists = {};
     };
 
+    static void free_captured_draw_lists(UIState& ui_state)
+    {
+        for (ImDrawList* draw_list : ui_state.captured_draw_lists) {
+            IM_DELETE(draw_list);
+        }
+        ui_state.captured_draw_lists.clear();
+    }
+
     static UIState g_ui_state;
 
     void window_callback(void* context, HWND hwnd, UINT msg, WPARAM w_param, LPARAM l_param)
@@ -59,6 +71,8 @@ namespace zec::ui
     void destroy()
     {
         ASSERT(g_is_ui_initialized);
+        free_captured_draw_lists(g_ui_state);
+        g_ui_state.has_captured_draw_data = false;
         RenderContext& render_context = gfx::dx12::get_render_context();
         render_context.descriptor_heap_manager.free_descriptors(render_context.current_frame_idx, g_ui_state.srv_handle);
         ImGui_ImplDX12_Shutdown();
@@ -82,11 +96,29 @@ namespace zec::ui
         ImGui::Render();
     }
 
+    void capture_frame()
+    {
+        ASSERT(g_is_ui_initialized);
+        const ImDrawData* draw_data = ImGui::GetDrawData();
+        ASSERT(draw_data != nullptr && draw_data->Valid);
+
+        free_captured_draw_lists(g_ui_state);
+        for (int i = 0; i < draw_data->CmdListsCount; i++) {
+            g_ui_state.captured_draw_lists.push_back(draw_data->CmdLists[i]->CloneOutput());
+        }
+
+        ImDrawData& captured = g_ui_state.captured_draw_data;
+        captured = *draw_data;
+        captured.CmdLists = g_ui_state.captured_draw_lists.Data;
+        g_ui_state.has_captured_draw_data = true;
+    }
+
     void draw_frame(CommandContextHandle handle)
     {
         ASSERT(g_is_ui_initialized);
         RenderContext& render_context = gfx::dx12::get_render_context();
         ID3D12GraphicsCommandList* cmd_list = get_command_list(render_context, handle);
-        ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), cmd_list);
+        ImDrawData* draw_data = g_ui_state.has_captured_draw_data ? &g_ui_state.captured_draw_data : ImGui::GetDrawData();
+        ImGui_ImplDX12_RenderDrawData(draw_data, cmd_list);
     }
 }
\ No newline at end of file
@@ -23,6 +23,7 @@ namespace zec::gfx
 
     TextureHandle get_current_back_buffer_handle();
 
+    // Waits for the GPU to finish everything in flight, then resizes the swap chain's back buffers
     void on_window_resize(u32 width, u32 height);
 
     namespace shader_compilation
@@ -41,9 +42,22 @@ namespace zec::gfx
         ZecResult               recreate_pipeline_state_object(const ShaderBlobsHandle& shader_blobs_handle, const ResourceLayoutHandle& resource_layout_handle, const PipelineStateObjectDesc& desc, const PipelineStateHandle pipeline_state_handle);
     }
 
+    // Heaps let several placed resources share memory, as long as they are never used at the same time
+    namespace heaps
+    {
+        ResourceHeapHandle create(const ResourceHeapDesc& desc);
+        // The heap is only released once the GPU is done with the current frame, destroy the resources placed in it first
+        void destroy(const ResourceHeapHandle handle);
+    }
+
     namespace buffers
     {
         BufferHandle create(BufferDesc buffer_desc);
+        // Creates the buffer at heap_offset bytes into a BUFFERS heap, rather than in memory of its own
+        BufferHandle create_placed(const ResourceHeapHandle heap, const u64 heap_offset, BufferDesc buffer_desc);
+        ResourceAllocationInfo get_allocation_info(const BufferDesc& buffer_desc);
+        // The buffer is only released once the GPU is done with the current frame
+        void destroy(const BufferHandle handle);
 
         u32 get_shader_readable_index(const BufferHandle handle);
         u32 get_shader_writable_index(const BufferHandle handle);
@@ -63,6 +77,11 @@ namespace zec::gfx
     namespace textures
     {
         TextureHandle create(TextureDesc texture_desc);
+        // Creates the texture at heap_offset bytes into a TEXTURES or RENDER_TARGETS heap, rather than in memory of its own
+        TextureHandle create_placed(const ResourceHeapHandle heap, const u64 heap_offset, TextureDesc texture_desc);
+        ResourceAllocationInfo get_allocation_info(const TextureDesc& texture_desc);
+        // The texture is only released once the GPU is done with the current frame
+        void destroy(const TextureHandle handle);
 
         u32 get_shader_readable_index(const TextureHandle handle);
         u32 get_shader_writable_index(const TextureHandle handle);
@@ -77,9 +96,16 @@ namespace zec::gfx
     {
         // ---------- Command Contexts ----------
         CommandContextHandle provision(CommandQueueType type);
+        // Provisions from the calling thread's own pool, so that several threads can provision and record at once.
+        // thread_idx must be unique to the calling thread and below MAX_NUM_RECORDING_THREADS, e.g. TaskScheduler::get_current_thread_idx().
+        // Contexts can be submitted from any thread, as long as their recording threads aren't provisioning in the meantime.
+        CommandContextHandle provision(CommandQueueType type, const u32 thread_idx);
 
         CmdReceipt return_and_execute(CommandContextHandle* context_handles, const size_t num_contexts);
 
+        // Only valid until the context is returned. Like recording, not thread safe for a given context.
+        CommandContextStats get_stats(const CommandContextHandle ctx);
+
         bool check_status(const CmdReceipt receipt);
 
         void flush_queue(const CommandQueueType type);
@@ -145,6 +171,11 @@ namespace zec::gfx
             const TextureHandle depth_target = INVALID_HANDLE
         );
 
+        // Binds the pass' attachments, applying their load ops. end_render_pass applies the store ops, so it has to be
+        // given the same desc.
+        void begin_render_pass(const CommandContextHandle ctx, const RenderPassDesc& render_pass_desc);
+        void end_render_pass(const CommandContextHandle ctx, const RenderPassDesc& render_pass_desc);
+
         void transition_textures(
             const CommandContextHandle ctx,
             TextureTransitionDesc* transition_descs,
@@ -159,6 +190,14 @@ namespace zec::gfx
 
         void compute_write_barrier(const CommandContextHandle ctx, BufferHandle buffer_handle);
         void compute_write_barrier(const CommandContextHandle ctx, TextureHandle texture_handle);
+
+        // Needed before using a placed resource whose memory was last used by another resource, ahead of any transition of it.
+        void aliasing_barrier(const CommandContextHandle ctx, BufferHandle buffer_handle);
+        void aliasing_barrier(const CommandContextHandle ctx, TextureHandle texture_handle);
+
+        // Aliased render targets and depth targets have to be initialized before anything else uses them, after their
+        // aliasing barrier. They must already be in the RENDER_TARGET or DEPTH_STENCIL state.
+        void discard_texture(const CommandContextHandle ctx, TextureHandle texture_handle);
     }
 
     void set_debug_name(const ResourceLayoutHandle handle, const wchar* name);
@@ -0,0 +1,995 @@
+#include "gfx_null.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gfx/resource_array.h"
+#include "utils/assert.h"
+
+namespace zec::gfx::null
+{
+    // Matches D3D12's default placement alignment
+    constexpr u64 PLACEMENT_ALIGNMENT = 64 * 1024;
+
+    struct HeapInfo
+    {
+        ResourceHeapDesc desc = {};
+        bool is_destroyed = false;
+    };
+
+    // Where a placed resource lives, so we can validate that it fits in its heap
+    struct Placement
+    {
+        ResourceHeapHandle heap = {};
+        u64 offset = 0;
+    };
+
+    struct BufferInfo
+    {
+        BufferDesc desc = {};
+        u32 shader_readable_index = UINT32_MAX;
+        u32 shader_writable_index = UINT32_MAX;
+        Placement placement = {};
+        bool is_destroyed = false;
+    };
+
+    struct TextureEntry
+    {
+        TextureInfo info = {};
+        u16 usage = 0;
+        u32 shader_readable_index = UINT32_MAX;
+        u32 shader_writable_index = UINT32_MAX;
+        Placement placement = {};
+        bool is_destroyed = false;
+    };
+
+    struct MeshInfo
+    {
+        BufferHandle index_buffer = {};
+        BufferHandle vertex_buffers[MAX_NUM_MESH_VERTEX_BUFFERS] = {};
+        u32 num_vertex_buffers = 0;
+    };
+
+    struct PipelineInfo
+    {
+        ResourceLayoutHandle resource_layout = {};
+        PipelineStateObjectDesc desc = {};
+    };
+
+    struct CommandContextInfo
+    {
+        CommandQueueType queue_type = CommandQueueType::GRAPHICS;
+        bool in_use = false;
+        CommandContextStats recorded = {};
+    };
+
+    struct AtomicStats
+    {
+        std::atomic<u64> num_barriers = 0;
+        std::atomic<u64> num_draws = 0;
+        std::atomic<u64> num_dispatches = 0;
+        std::atomic<u64> num_submits = 0;
+        std::atomic<u64> num_command_contexts_submitted = 0;
+        std::atomic<u64> num_bytes_uploaded = 0;
+        std::atomic<u64> num_clears = 0;
+        std::atomic<u64> num_pipeline_state_changes = 0;
+        std::atomic<u64> num_render_target_changes = 0;
+        std::atomic<u64> num_frames_presented = 0;
+        std::atomic<u64> num_buffers_created = 0;
+        std::atomic<u64> num_textures_created = 0;
+        std::atomic<u64> num_meshes_created = 0;
+        std::atomic<u64> num_pipelines_created = 0;
+        std::atomic<u64> num_heaps_created = 0;
+        std::atomic<u64> num_buffers_destroyed = 0;
+        std::atomic<u64> num_textures_destroyed = 0;
+        std::atomic<u64> num_aliasing_barriers = 0;
+        std::atomic<u64> num_gpu_waits = 0;
+        std::atomic<u64> num_split_barriers_begun = 0;
+        std::atomic<u64> num_uav_barriers = 0;
+        std::atomic<u64> num_render_passes = 0;
+        std::atomic<u64> num_attachment_loads = 0;
+        std::atomic<u64> num_attachment_stores = 0;
+        std::atomic<u64> num_discards = 0;
+    };
+
+    struct NullContext
+    {
+        bool is_initialized = false;
+        RenderConfigState config_state = {};
+        u64 current_frame_idx = 0;
+        u64 current_cpu_frame = 0;
+
+        // Guards the tables below, since resources can be created from any thread
+        std::mutex mutex;
+        ResourceArray<BufferInfo, BufferHandle> buffers = {};
+        std::vector<std::vector<u8>> buffer_data = {};
+        ResourceArray<TextureEntry, TextureHandle> textures = {};
+        ResourceArray<MeshInfo, MeshHandle> meshes = {};
+        ResourceArray<ResourceLayoutDesc, ResourceLayoutHandle> resource_layouts = {};
+        ResourceArray<PipelineInfo, PipelineStateHandle> pipelines = {};
+        ResourceArray<CommandContextInfo, CommandContextHandle> command_contexts = {};
+        ResourceArray<HeapInfo, ResourceHeapHandle> heaps = {};
+        u32 num_shader_blobs = 0;
+        // Bindless descriptor indices are just handed out in order
+        u32 next_descriptor_idx = 0;
+
+        TextureHandle back_buffers[NUM_BACK_BUFFERS] = {};
+
+        // Work completes as soon as it is submitted, so a receipt is signalled once its fence value has been handed out
+        std::atomic<u64> next_fence_values[size_t(CommandQueueType::NUM_COMMAND_CONTEXT_POOLS)] = {};
+
+        AtomicStats stats = {};
+    };
+
+    static NullContext g_context = {};
+
+    static void count(std::atomic<u64>& counter, const u64 amount = 1)
+    {
+        counter.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    static u32 allocate_descriptor()
+    {
+        return g_context.next_descriptor_idx++;
+    }
+
+    static u64 align_to_placement(const u64 byte_size)
+    {
+        return ((byte_size + PLACEMENT_ALIGNMENT - 1) / PLACEMENT_ALIGNMENT) * PLACEMENT_ALIGNMENT;
+    }
+
+    static u64 get_texture_byte_size(const TextureDesc& desc)
+    {
+        u64 bytes_per_pixel = 4;
+        switch (desc.format) {
+        case BufferFormat::UINT16:
+        case BufferFormat::UNORM8_2:
+            bytes_per_pixel = 2;
+            break;
+        case BufferFormat::UINT32_2:
+        case BufferFormat::FLOAT_2:
+        case BufferFormat::UINT16_4:
+        case BufferFormat::UNORM16_4:
+        case BufferFormat::HALF_4:
+            bytes_per_pixel = 8;
+            break;
+        case BufferFormat::FLOAT_3:
+            bytes_per_pixel = 12;
+            break;
+        case BufferFormat::FLOAT_4:
+            bytes_per_pixel = 16;
+            break;
+        default:
+            break;
+        }
+        const bool is_block_compressed = desc.format == BufferFormat::UNORM8_BC7 || desc.format == BufferFormat::UNORM8_BC7_SRGB;
+        const u64 depth_or_array_size = desc.is_3d ? desc.depth : desc.array_size;
+
+        u64 byte_size = 0;
+        for (u32 mip = 0; mip < desc.num_mips; mip++) {
+            const u64 width = std::max(desc.width >> mip, 1u);
+            const u64 height = std::max(desc.height >> mip, 1u);
+            if (is_block_compressed) {
+                // 16 bytes per 4x4 block
+                byte_size += ((width + 3) / 4) * ((height + 3) / 4) * 16 * depth_or_array_size;
+            }
+            else {
+                byte_size += width * height * bytes_per_pixel * depth_or_array_size;
+            }
+        }
+        return byte_size;
+    }
+
+    // Expects the caller to hold g_context.mutex
+    static void validate_placement(const Placement& placement, const ResourceHeapType heap_type, const u64 byte_size)
+    {
+        ASSERT(is_valid(placement.heap) && placement.heap.idx < g_context.heaps.size);
+        const HeapInfo& heap = g_context.heaps[placement.heap];
+        ASSERT_MSG(!heap.is_destroyed, "Resource was placed in a heap that has been destroyed");
+        ASSERT_MSG(heap.desc.type == heap_type, "Resource was placed in a heap that can't hold it");
+        ASSERT_MSG(placement.offset % PLACEMENT_ALIGNMENT == 0, "Placed resources must be aligned to their allocation info's alignment");
+        ASSERT_MSG(placement.offset + byte_size <= heap.desc.byte_size, "Placed resource doesn't fit in its heap");
+    }
+
+    static TextureHandle create_texture(const TextureDesc& desc, const Placement placement = {})
+    {
+        std::lock_guard<std::mutex> lock{ g_context.mutex };
+        if (is_valid(placement.heap)) {
+            const bool is_render_target = desc.usage & (RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_DEPTH_STENCIL);
+            validate_placement(placement, is_render_target ? ResourceHeapType::RENDER_TARGETS : ResourceHeapType::TEXTURES, get_texture_byte_size(desc));
+        }
+        TextureEntry entry = {
+            .info = {
+                .width = desc.width,
+                .height = desc.height,
+                .depth = desc.depth,
+                .num_mips = desc.num_mips,
+                .array_size = desc.array_size,
+                .format = desc.format,
+                .is_cubemap = desc.is_cubemap,
+            },
+            .usage = desc.usage,
+            .placement = placement,
+        };
+        if (desc.usage & RESOURCE_USAGE_SHADER_READABLE) {
+            entry.shader_readable_index = allocate_descriptor();
+        }
+        if (desc.usage & RESOURCE_USAGE_COMPUTE_WRITABLE) {
+            entry.shader_writable_index = allocate_descriptor();
+        }
+        count(g_context.stats.num_textures_created);
+        return { u32(g_context.textures.push_back(entry)) };
+    }
+
+    static void write_buffer(const BufferHandle buffer_handle, const void* data, const u64 byte_size)
+    {
+        // Creating a buffer on another thread can reallocate buffer_data, so the copy happens under the lock too
+        std::lock_guard<std::mutex> lock{ g_context.mutex };
+        ASSERT(is_valid(buffer_handle) && buffer_handle.idx < g_context.buffers.size);
+        ASSERT(byte_size <= g_context.buffers[buffer_handle].desc.byte_size);
+        std::vector<u8>& buffer_data = g_context.buffer_data[buffer_handle.idx];
+        if (buffer_data.size() < byte_size) {
+            buffer_data.resize(g_context.buffers[buffer_handle].desc.byte_size);
+        }
+        if (byte_size > 0) {
+            memcpy(buffer_data.data(), data, byte_size);
+        }
+        count(g_context.stats.num_bytes_uploaded, byte_size);
+    }
+
+    Stats get_stats()
+    {
+        const AtomicStats& stats = g_context.stats;
+        return {
+            .num_barriers = stats.num_barriers.load(),
+            .num_draws = stats.num_draws.load(),
+            .num_dispatches = stats.num_dispatches.load(),
+            .num_submits = stats.num_submits.load(),
+            .num_command_contexts_submitted = stats.num_command_contexts_submitted.load(),
+            .num_bytes_uploaded = stats.num_bytes_uploaded.load(),
+            .num_clears = stats.num_clears.load(),
+            .num_pipeline_state_changes = stats.num_pipeline_state_changes.load(),
+            .num_render_target_changes = stats.num_render_target_changes.load(),
+            .num_frames_presented = stats.num_frames_presented.load(),
+            .num_buffers_created = stats.num_buffers_created.load(),
+            .num_textures_created = stats.num_textures_created.load(),
+            .num_meshes_created = stats.num_meshes_created.load(),
+            .num_pipelines_created = stats.num_pipelines_created.load(),
+            .num_heaps_created = stats.num_heaps_created.load(),
+            .num_buffers_destroyed = stats.num_buffers_destroyed.load(),
+            .num_textures_destroyed = stats.num_textures_destroyed.load(),
+            .num_aliasing_barriers = stats.num_aliasing_barriers.load(),
+            .num_gpu_waits = stats.num_gpu_waits.load(),
+            .num_split_barriers_begun = stats.num_split_barriers_begun.load(),
+            .num_uav_barriers = stats.num_uav_barriers.load(),
+            .num_render_passes = stats.num_render_passes.load(),
+            .num_attachment_loads = stats.num_attachment_loads.load(),
+            .num_attachment_stores = stats.num_attachment_stores.load(),
+            .num_discards = stats.num_discards.load(),
+        };
+    }
+
+    void reset_stats()
+    {
+        AtomicStats& stats = g_context.stats;
+        stats.num_barriers = 0;
+        stats.num_draws = 0;
+        stats.num_dispatches = 0;
+        stats.num_submits = 0;
+        stats.num_command_contexts_submitted = 0;
+        stats.num_bytes_uploaded = 0;
+        stats.num_clears = 0;
+        stats.num_pipeline_state_changes = 0;
+        stats.num_render_target_changes = 0;
+        stats.num_frames_presented = 0;
+        stats.num_buffers_created = 0;
+        stats.num_textures_created = 0;
+        stats.num_meshes_created = 0;
+        stats.num_pipelines_created = 0;
+        stats.num_heaps_created = 0;
+        stats.num_buffers_destroyed = 0;
+        stats.num_textures_destroyed = 0;
+        stats.num_aliasing_barriers = 0;
+        stats.num_gpu_waits = 0;
+        stats.num_split_barriers_begun = 0;
+        stats.num_uav_barriers = 0;
+        stats.num_render_passes = 0;
+        stats.num_attachment_loads = 0;
+        stats.num_attachment_stores = 0;
+        stats.num_discards = 0;
+    }
+
+    const void* get_buffer_data(const BufferHandle buffer_handle)
+    {
+        std::lock_guard<std::mutex> lock{ g_context.mutex };
+        ASSERT(is_valid(buffer_handle) && buffer_handle.idx < g_context.buffers.size);
+        const std::vector<u8>& buffer_data = g_context.buffer_data[buffer_handle.idx];
+        return buffer_data.empty() ? nullptr : buffer_data.data();
+    }
+}
+
+namespace zec::gfx
+{
+    using namespace null;
+
+    void init_renderer(const RendererDesc& renderer_desc)
+    {
+        ASSERT_MSG(!g_context.is_initialized, "Renderer has already been initialized");
+        g_context.config_state = {
+            .width = renderer_desc.width,
+            .height = renderer_desc.height,
+            .fullscreen = renderer_desc.fullscreen,
+            .vsync = renderer_desc.vsync,
+            .msaa = renderer_desc.msaa,
+        };
+        g_context.current_frame_idx = 0;
+        g_context.current_cpu_frame = 0;
+        for (auto& fence_value : g_context.next_fence_values) {
+            fence_value = 0;
+        }
+
+        for (TextureHandle& back_buffer : g_context.back_buffers) {
+            back_buffer = create_texture({
+                .width = renderer_desc.width,
+                .height = renderer_desc.height,
+                .depth = 1,
+                .num_mips = 1,
+                .array_size = 1,
+                .format = g_context.config_state.backbuffer_format,
+                .usage = RESOURCE_USAGE_RENDER_TARGET,
+                .initial_state = RESOURCE_USAGE_PRESENT,
+            });
+        }
+        g_context.is_initialized = true;
+    }
+
+    void destroy_renderer()
+    {
+        ASSERT(g_context.is_initialized);
+        std::lock_guard<std::mutex> lock{ g_context.mutex };
+        g_context.buffers.empty();
+        g_context.buffer_data.clear();
+        g_context.textures.empty();
+        g_context.meshes.empty();
+        g_context.resource_layouts.empty();
+        g_context.pipelines.empty();
+        g_context.command_contexts.empty();
+        g_context.heaps.empty();
+        g_context.num_shader_blobs = 0;
+        g_context.next_descriptor_idx = 0;
+        g_context.is_initialized = false;
+    }
+
+    RenderConfigState get_config_state()
+    {
+        return g_context.config_state;
+    };
+
+    u64 get_current_frame_idx()
+    {
+        return g_context.current_frame_idx;
+    };
+
+    void flush_gpu()
+    { }
+
+    CommandContextHandle begin_frame()
+    {
+        CommandContextHandle cmd_ctx = cmd::provision(CommandQueueType::GRAPHICS);
+        // Present -> render target
+        count(g_context.stats.num_barriers);
+        return cmd_ctx;
+    };
+
+    void end_frame(CommandContextHandle cmd_ctx)
+    {
+        // Render target -> present
+        count(g_context.stats.num_barriers);
+        cmd::return_and_execute(&cmd_ctx, 1);
+    };
+
+    void reset_for_frame()
+    {
+        g_context.current_frame_idx = g_context.current_cpu_frame % NUM_BACK_BUFFERS;
+    }
+
+    CmdReceipt present_frame()
+    {
+        count(g_context.stats.num_frames_presented);
+        return CmdReceipt{
+            .queue_type = CommandQueueType::GRAPHICS,
+            .fence_value = g_context.current_cpu_frame++ };
+    }
+
+    TextureHandle get_current_back_buffer_handle()
+    {
+        return g_context.back_buffers[g_context.current_frame_idx];
+    };
+
+    void on_window_resize(u32 width, u32 height)
+    {
+        g_context.config_state.width = width;
+        g_context.config_state.height = height;
+        std::lock_guard<std::mutex> lock{ g_context.mutex };
+        for (const TextureHandle back_buffer : g_context.back_buffers) {
+            g_context.textures[back_buffer].info.width = width;
+            g_context.textures[back_buffer].info.height = height;
+        }
+    };
+
+    namespace shader_compilation
+    {
+        // Nothing is compiled, we only check that the desc makes sense
+        ZecResult compile_shaders(const ShaderCompilationDesc& shader_compilation_desc, ShaderBlobsHandle& inout_blob_handle, std::string& errors)
+        {
+            if (shader_compilation_desc.used_stages == PIPELINE_STAGE_INVALID) {
+                errors = "No pipeline stages were specified";
+                return ZecResult::FAILURE;
+            }
+            if ((shader_compilation_desc.used_stages & PIPELINE_STAGE_COMPUTE) && shader_compilation_desc.used_stages != PIPELINE_STAGE_COMPUTE) {
+                errors = "Compute shaders cannot be combined with other stages";
+                return ZecResult::FAILURE;
+            }
+
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            inout_blob_handle = { g_context.num_shader_blobs++ };
+            return ZecResult::SUCCESS;
+        }
+
+        void release_blobs(ShaderBlobsHandle& blobs)
+        {
+            blobs = INVALID_HANDLE;
+        }
+    }
+
+    namespace pipelines
+    {
+        ResourceLayoutHandle create_resource_layout(const ResourceLayoutDesc& desc)
+        {
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            return { u32(g_context.resource_layouts.push_back(desc)) };
+        }
+
+        PipelineStateHandle create_pipeline_state_object(const ShaderBlobsHandle& shader_blobs_handle, const ResourceLayoutHandle& resource_layout_handle, const PipelineStateObjectDesc& desc)
+        {
+            ASSERT(is_valid(shader_blobs_handle));
+            ASSERT(is_valid(resource_layout_handle));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            count(g_context.stats.num_pipelines_created);
+            return { u32(g_context.pipelines.push_back({ .resource_layout = resource_layout_handle, .desc = desc })) };
+        }
+
+        ZecResult recreate_pipeline_state_object(const ShaderBlobsHandle& shader_blobs_handle, const ResourceLayoutHandle& resource_layout_handle, const PipelineStateObjectDesc& desc, const PipelineStateHandle pipeline_state_handle)
+        {
+            ASSERT(is_valid(shader_blobs_handle));
+            ASSERT(is_valid(pipeline_state_handle));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            g_context.pipelines[pipeline_state_handle] = { .resource_layout = resource_layout_handle, .desc = desc };
+            count(g_context.stats.num_pipelines_created);
+            return ZecResult::SUCCESS;
+        }
+    }
+
+    namespace heaps
+    {
+        ResourceHeapHandle create(const ResourceHeapDesc& desc)
+        {
+            ASSERT(desc.byte_size > 0);
+            ASSERT(desc.type < ResourceHeapType::COUNT);
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            count(g_context.stats.num_heaps_created);
+            return { u32(g_context.heaps.push_back({ .desc = { .type = desc.type, .byte_size = align_to_placement(desc.byte_size) } })) };
+        }
+
+        void destroy(const ResourceHeapHandle handle)
+        {
+            ASSERT(is_valid(handle));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            ASSERT_MSG(!g_context.heaps[handle].is_destroyed, "Heap has already been destroyed");
+            g_context.heaps[handle].is_destroyed = true;
+        }
+    }
+
+    namespace buffers
+    {
+        static BufferHandle create_buffer(const BufferDesc& buffer_desc, const Placement placement)
+        {
+            ASSERT(buffer_desc.byte_size != 0);
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            if (is_valid(placement.heap)) {
+                ASSERT((buffer_desc.usage & RESOURCE_USAGE_DYNAMIC) == 0);
+                validate_placement(placement, ResourceHeapType::BUFFERS, buffer_desc.byte_size);
+            }
+            BufferInfo info = { .desc = buffer_desc, .placement = placement };
+            if (buffer_desc.usage & (RESOURCE_USAGE_SHADER_READABLE | RESOURCE_USAGE_CONSTANT)) {
+                info.shader_readable_index = allocate_descriptor();
+            }
+            if (buffer_desc.usage & RESOURCE_USAGE_COMPUTE_WRITABLE) {
+                info.shader_writable_index = allocate_descriptor();
+            }
+            g_context.buffer_data.emplace_back();
+            count(g_context.stats.num_buffers_created);
+            return { u32(g_context.buffers.push_back(info)) };
+        }
+
+        BufferHandle create(BufferDesc buffer_desc)
+        {
+            return create_buffer(buffer_desc, {});
+        }
+
+        BufferHandle create_placed(const ResourceHeapHandle heap, const u64 heap_offset, BufferDesc buffer_desc)
+        {
+            ASSERT(is_valid(heap));
+            return create_buffer(buffer_desc, { .heap = heap, .offset = heap_offset });
+        }
+
+        ResourceAllocationInfo get_allocation_info(const BufferDesc& buffer_desc)
+        {
+            return { .byte_size = align_to_placement(buffer_desc.byte_size), .alignment = PLACEMENT_ALIGNMENT };
+        }
+
+        void destroy(const BufferHandle handle)
+        {
+            ASSERT(is_valid(handle));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            ASSERT_MSG(!g_context.buffers[handle].is_destroyed, "Buffer has already been destroyed");
+            g_context.buffers[handle].is_destroyed = true;
+            count(g_context.stats.num_buffers_destroyed);
+        }
+
+        u32 get_shader_readable_index(const BufferHandle handle)
+        {
+            ASSERT(is_valid(handle));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            return g_context.buffers[handle].shader_readable_index;
+        }
+
+        u32 get_shader_writable_index(const BufferHandle handle)
+        {
+            ASSERT(is_valid(handle));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            return g_context.buffers[handle].shader_writable_index;
+        }
+
+        void set_data(const BufferHandle handle, const void* data, const u64 data_byte_size)
+        {
+            write_buffer(handle, data, data_byte_size);
+        }
+
+        void set_data(CommandContextHandle cmd_ctx, const BufferHandle handle, const void* data, const u64 data_byte_size)
+        {
+            ASSERT(is_valid(cmd_ctx));
+            write_buffer(handle, data, data_byte_size);
+        }
+
+        void update(const BufferHandle buffer_handle, const void* data, u64 byte_size)
+        {
+            {
+                std::lock_guard<std::mutex> lock{ g_context.mutex };
+                ASSERT(g_context.buffers[buffer_handle].desc.usage & RESOURCE_USAGE_DYNAMIC);
+            }
+            write_buffer(buffer_handle, data, byte_size);
+        }
+    }
+
+    namespace meshes
+    {
+        MeshHandle create(const BufferHandle index_buffer, const BufferHandle* vertex_buffers, u32 num_vertex_buffers)
+        {
+            ASSERT(num_vertex_buffers <= MAX_NUM_MESH_VERTEX_BUFFERS);
+            MeshInfo mesh = { .index_buffer = index_buffer, .num_vertex_buffers = num_vertex_buffers };
+            for (u32 i = 0; i < num_vertex_buffers; i++) {
+                mesh.vertex_buffers[i] = vertex_buffers[i];
+            }
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            count(g_context.stats.num_meshes_created);
+            return { u32(g_context.meshes.push_back(mesh)) };
+        }
+
+        MeshHandle create(CommandContextHandle cmd_ctx, MeshDesc mesh_desc)
+        {
+            BufferHandle index_buffer = buffers::create(mesh_desc.index_buffer_desc);
+            if (mesh_desc.index_buffer_data != nullptr) {
+                buffers::set_data(cmd_ctx, index_buffer, mesh_desc.index_buffer_data, mesh_desc.index_buffer_desc.byte_size);
+            }
+
+            BufferHandle vertex_buffers[MAX_NUM_MESH_VERTEX_BUFFERS] = {};
+            u32 num_vertex_buffers = 0;
+            for (; num_vertex_buffers < MAX_NUM_MESH_VERTEX_BUFFERS; num_vertex_buffers++) {
+                const BufferDesc& vertex_buffer_desc = mesh_desc.vertex_buffer_descs[num_vertex_buffers];
+                if (vertex_buffer_desc.usage == RESOURCE_USAGE_UNUSED) {
+                    break;
+                }
+                vertex_buffers[num_vertex_buffers] = buffers::create(vertex_buffer_desc);
+                if (mesh_desc.vertex_buffer_data[num_vertex_buffers] != nullptr) {
+                    buffers::set_data(cmd_ctx, vertex_buffers[num_vertex_buffers], mesh_desc.vertex_buffer_data[num_vertex_buffers], vertex_buffer_desc.byte_size);
+                }
+            }
+            return create(index_buffer, vertex_buffers, num_vertex_buffers);
+        }
+    }
+
+    namespace textures
+    {
+        TextureHandle create(TextureDesc texture_desc)
+        {
+            return create_texture(texture_desc);
+        }
+
+        TextureHandle create_placed(const ResourceHeapHandle heap, const u64 heap_offset, TextureDesc texture_desc)
+        {
+            ASSERT(is_valid(heap));
+            return create_texture(texture_desc, { .heap = heap, .offset = heap_offset });
+        }
+
+        ResourceAllocationInfo get_allocation_info(const TextureDesc& texture_desc)
+        {
+            return { .byte_size = align_to_placement(get_texture_byte_size(texture_desc)), .alignment = PLACEMENT_ALIGNMENT };
+        }
+
+        void destroy(const TextureHandle handle)
+        {
+            ASSERT(is_valid(handle));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            ASSERT_MSG(!g_context.textures[handle].is_destroyed, "Texture has already been destroyed");
+            g_context.textures[handle].is_destroyed = true;
+            count(g_context.stats.num_textures_destroyed);
+        }
+
+        u32 get_shader_readable_index(const TextureHandle handle)
+        {
+            ASSERT(is_valid(handle));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            return g_context.textures[handle].shader_readable_index;
+        }
+
+        u32 get_shader_writable_index(const TextureHandle handle)
+        {
+            ASSERT(is_valid(handle));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            return g_context.textures[handle].shader_writable_index;
+        }
+
+        const TextureInfo& get_texture_info(const TextureHandle texture_handle)
+        {
+            ASSERT(is_valid(texture_handle));
+            // Entries never move, so the reference stays valid after the lock is released
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            return g_context.textures[texture_handle].info;
+        }
+
+        // We don't decode anything, the file is stood in for by a 1x1 texture
+        TextureHandle create_from_file(CommandContextHandle cmd_ctx, const char* file_path)
+        {
+            ASSERT(is_valid(cmd_ctx));
+            return create_texture({
+                .width = 1,
+                .height = 1,
+                .depth = 1,
+                .num_mips = 1,
+                .array_size = 1,
+                .format = BufferFormat::R8G8B8A8_UNORM,
+                .usage = RESOURCE_USAGE_SHADER_READABLE,
+            });
+        }
+
+        void save_to_file(const TextureHandle texture_handle, const wchar_t* file_path, const ResourceUsage current_usage)
+        {
+            ASSERT(is_valid(texture_handle));
+        }
+    }
+
+    namespace cmd
+    {
+        CommandContextHandle provision(CommandQueueType type)
+        {
+            ASSERT(type < CommandQueueType::NUM_COMMAND_CONTEXT_POOLS);
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            for (size_t i = 0; i < g_context.command_contexts.size; i++) {
+                CommandContextInfo& context = g_context.command_contexts[i];
+                if (!context.in_use && context.queue_type == type) {
+                    context.in_use = true;
+                    context.recorded = {};
+                    return { u32(i) };
+                }
+            }
+            return { u32(g_context.command_contexts.push_back({ .queue_type = type, .in_use = true })) };
+        }
+
+        // Each context is only recorded to by one thread, but the table can grow while it records
+        static void count_recorded(const CommandContextHandle ctx, u32 CommandContextStats::* counter)
+        {
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            g_context.command_contexts[ctx].recorded.*counter += 1;
+        }
+
+        CommandContextStats get_stats(const CommandContextHandle ctx)
+        {
+            ASSERT(is_valid(ctx));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            ASSERT(g_context.command_contexts[ctx].in_use);
+            return g_context.command_contexts[ctx].recorded;
+        }
+
+        CommandContextHandle provision(CommandQueueType type, const u32 thread_idx)
+        {
+            ASSERT(thread_idx < MAX_NUM_RECORDING_THREADS);
+            // Contexts are handed out under the lock anyway, so there's no need for separate pools
+            return provision(type);
+        }
+
+        CmdReceipt return_and_execute(CommandContextHandle* context_handles, const size_t num_contexts)
+        {
+            ASSERT(num_contexts > 0);
+            CommandQueueType queue_type;
+            {
+                std::lock_guard<std::mutex> lock{ g_context.mutex };
+                queue_type = g_context.command_contexts[context_handles[0]].queue_type;
+                for (size_t i = 0; i < num_contexts; i++) {
+                    CommandContextInfo& context = g_context.command_contexts[context_handles[i]];
+                    ASSERT_MSG(context.in_use, "Command context was submitted twice");
+                    ASSERT_MSG(context.queue_type == queue_type, "All command contexts submitted together must belong to the same queue");
+                    context.in_use = false;
+                    context_handles[i] = INVALID_HANDLE;
+                }
+            }
+
+            count(g_context.stats.num_submits);
+            count(g_context.stats.num_command_contexts_submitted, num_contexts);
+            return CmdReceipt{
+                .queue_type = queue_type,
+                .fence_value = g_context.next_fence_values[size_t(queue_type)].fetch_add(1),
+            };
+        }
+
+        bool check_status(const CmdReceipt receipt)
+        {
+            ASSERT(is_valid(receipt));
+            return receipt.fence_value < g_context.next_fence_values[size_t(receipt.queue_type)].load();
+        }
+
+        void flush_queue(const CommandQueueType type)
+        { }
+
+        void cpu_wait(const CmdReceipt receipt)
+        {
+            ASSERT_MSG(check_status(receipt), "Waiting on work that was never submitted");
+        }
+
+        void gpu_wait(const CommandQueueType queue_to_insert_wait, const CmdReceipt receipt_to_wait_on)
+        {
+            ASSERT(is_valid(receipt_to_wait_on));
+            count(g_context.stats.num_gpu_waits);
+        }
+
+        void set_graphics_resource_layout(const CommandContextHandle ctx, const ResourceLayoutHandle resource_layout_id)
+        {
+            ASSERT(is_valid(ctx) && is_valid(resource_layout_id));
+        }
+
+        void set_graphics_pipeline_state(const CommandContextHandle ctx, const PipelineStateHandle pso_handle)
+        {
+            ASSERT(is_valid(ctx) && is_valid(pso_handle));
+            count(g_context.stats.num_pipeline_state_changes);
+        }
+
+        void bind_graphics_resource_table(const CommandContextHandle ctx, const u32 resource_layout_entry_idx)
+        {
+            ASSERT(is_valid(ctx));
+        }
+
+        void bind_graphics_constants(const CommandContextHandle ctx, const void* data, const u32 num_constants, const u32 binding_slot)
+        {
+            ASSERT(is_valid(ctx));
+        }
+
+        void bind_graphics_constant_buffer(const CommandContextHandle ctx, const BufferHandle& buffer_handle, u32 binding_slot)
+        {
+            ASSERT(is_valid(ctx) && is_valid(buffer_handle));
+        }
+
+        void draw_lines(const CommandContextHandle ctx, const BufferHandle vertices)
+        {
+            ASSERT(is_valid(ctx) && is_valid(vertices));
+            count(g_context.stats.num_draws);
+            count_recorded(ctx, &CommandContextStats::num_draws);
+        }
+
+        void draw_mesh(const CommandContextHandle ctx, const BufferHandle index_buffer_id, const size_t num_instances)
+        {
+            ASSERT(is_valid(ctx) && is_valid(index_buffer_id));
+            count(g_context.stats.num_draws);
+            count_recorded(ctx, &CommandContextStats::num_draws);
+        }
+
+        void draw_mesh(const CommandContextHandle ctx, const MeshHandle mesh_id)
+        {
+            ASSERT(is_valid(ctx) && is_valid(mesh_id));
+            count(g_context.stats.num_draws);
+            count_recorded(ctx, &CommandContextStats::num_draws);
+        }
+
+        void set_compute_resource_layout(const CommandContextHandle ctx, const ResourceLayoutHandle resource_layout_id)
+        {
+            ASSERT(is_valid(ctx) && is_valid(resource_layout_id));
+        }
+
+        void set_compute_pipeline_state(const CommandContextHandle ctx, const PipelineStateHandle pso_handle)
+        {
+            ASSERT(is_valid(ctx) && is_valid(pso_handle));
+            count(g_context.stats.num_pipeline_state_changes);
+        }
+
+        void bind_compute_resource_table(const CommandContextHandle ctx, const u32 resource_layout_entry_idx)
+        {
+            ASSERT(is_valid(ctx));
+        }
+
+        void bind_compute_constants(const CommandContextHandle ctx, const void* data, const u32 num_constants, const u32 binding_slot)
+        {
+            ASSERT(is_valid(ctx));
+        }
+
+        void bind_compute_constant_buffer(const CommandContextHandle ctx, const BufferHandle& buffer_handle, const u32 binding_slot)
+        {
+            ASSERT(is_valid(ctx) && is_valid(buffer_handle));
+        }
+
+        void dispatch(const CommandContextHandle ctx, const u32 thread_group_count_x, const u32 thread_group_count_y, const u32 thread_group_count_z)
+        {
+            ASSERT(is_valid(ctx));
+            count(g_context.stats.num_dispatches);
+            count_recorded(ctx, &CommandContextStats::num_dispatches);
+        }
+
+        void clear_render_target(const CommandContextHandle ctx, const TextureHandle render_texture, const float* clear_color)
+        {
+            ASSERT(is_valid(ctx) && is_valid(render_texture));
+            count(g_context.stats.num_clears);
+        }
+
+        void clear_depth_target(const CommandContextHandle ctx, const TextureHandle depth_stencil_buffer, const float depth_value, const u8 stencil_value)
+        {
+            ASSERT(is_valid(ctx) && is_valid(depth_stencil_buffer));
+            count(g_context.stats.num_clears);
+        }
+
+        void set_viewports(const CommandContextHandle ctx, const Viewport* viewports, const u32 num_viewports)
+        {
+            ASSERT(is_valid(ctx));
+        }
+
+        void set_scissors(const CommandContextHandle ctx, const Scissor* scissors, const u32 num_scissors)
+        {
+            ASSERT(is_valid(ctx));
+        }
+
+        void set_render_targets(CommandContextHandle ctx, TextureHandle* render_textures, const u32 num_render_targets, const TextureHandle depth_target)
+        {
+            ASSERT(is_valid(ctx));
+            count(g_context.stats.num_render_target_changes);
+        }
+
+        void begin_render_pass(const CommandContextHandle ctx, const RenderPassDesc& render_pass_desc)
+        {
+            ASSERT(is_valid(ctx));
+            ASSERT(render_pass_desc.num_render_targets <= MAX_NUM_RENDER_TARGETS);
+            const auto apply_load_op = [](const RenderPassAttachment& attachment)
+            {
+                ASSERT(is_valid(attachment.texture));
+                if (attachment.load_op == LoadOp::CLEAR) {
+                    count(g_context.stats.num_clears);
+                }
+                else if (attachment.load_op == LoadOp::LOAD) {
+                    count(g_context.stats.num_attachment_loads);
+                }
+            };
+            for (u32 i = 0; i < render_pass_desc.num_render_targets; i++) {
+                apply_load_op(render_pass_desc.render_targets[i]);
+            }
+            if (is_valid(render_pass_desc.depth_target.texture)) {
+                apply_load_op(render_pass_desc.depth_target);
+            }
+            count(g_context.stats.num_render_passes);
+            count(g_context.stats.num_render_target_changes);
+        }
+
+        void end_render_pass(const CommandContextHandle ctx, const RenderPassDesc& render_pass_desc)
+        {
+            ASSERT(is_valid(ctx));
+            for (u32 i = 0; i < render_pass_desc.num_render_targets; i++) {
+                if (render_pass_desc.render_targets[i].store_op == StoreOp::STORE) {
+                    count(g_context.stats.num_attachment_stores);
+                }
+            }
+            if (is_valid(render_pass_desc.depth_target.texture) && render_pass_desc.depth_target.store_op == StoreOp::STORE) {
+                count(g_context.stats.num_attachment_stores);
+            }
+        }
+
+        void transition_textures(const CommandContextHandle ctx, TextureTransitionDesc* transition_descs, u64 num_transitions)
+        {
+            ASSERT(is_valid(ctx));
+            count(g_context.stats.num_barriers, num_transitions);
+        }
+
+        void transition_resources(const CommandContextHandle ctx, ResourceTransitionDesc* transition_descs, u64 num_transitions)
+        {
+            ASSERT(is_valid(ctx));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            for (u64 i = 0; i < num_transitions; i++) {
+                const ResourceTransitionDesc& transition_desc = transition_descs[i];
+                if (transition_desc.type == ResourceTransitionType::TEXTURE && is_valid(transition_desc.texture)) {
+                    const TextureInfo& info = g_context.textures[transition_desc.texture].info;
+                    ASSERT(transition_desc.mip_level == k_all_subresources || transition_desc.mip_level < info.num_mips);
+                    ASSERT(transition_desc.array_slice == k_all_subresources || transition_desc.array_slice < info.array_size);
+                }
+                else {
+                    ASSERT(transition_desc.mip_level == k_all_subresources && transition_desc.array_slice == k_all_subresources);
+                }
+                if (transition_desc.split == SplitBarrier::BEGIN) {
+                    count(g_context.stats.num_split_barriers_begun);
+                }
+            }
+            count(g_context.stats.num_barriers, num_transitions);
+        }
+
+        void compute_write_barrier(const CommandContextHandle ctx, BufferHandle buffer_handle)
+        {
+            ASSERT(is_valid(ctx) && is_valid(buffer_handle));
+            count(g_context.stats.num_barriers);
+            count(g_context.stats.num_uav_barriers);
+        }
+
+        void compute_write_barrier(const CommandContextHandle ctx, TextureHandle texture_handle)
+        {
+            ASSERT(is_valid(ctx) && is_valid(texture_handle));
+            count(g_context.stats.num_barriers);
+            count(g_context.stats.num_uav_barriers);
+        }
+
+        void aliasing_barrier(const CommandContextHandle ctx, BufferHandle buffer_handle)
+        {
+            ASSERT(is_valid(ctx) && is_valid(buffer_handle));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            const BufferInfo& info = g_context.buffers[buffer_handle];
+            ASSERT_MSG(!info.is_destroyed && is_valid(info.placement.heap), "Only live, placed buffers can be aliased");
+            count(g_context.stats.num_barriers);
+            count(g_context.stats.num_aliasing_barriers);
+        }
+
+        void aliasing_barrier(const CommandContextHandle ctx, TextureHandle texture_handle)
+        {
+            ASSERT(is_valid(ctx) && is_valid(texture_handle));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            const TextureEntry& entry = g_context.textures[texture_handle];
+            ASSERT_MSG(!entry.is_destroyed && is_valid(entry.placement.heap), "Only live, placed textures can be aliased");
+            count(g_context.stats.num_barriers);
+            count(g_context.stats.num_aliasing_barriers);
+        }
+
+        void discard_texture(const CommandContextHandle ctx, TextureHandle texture_handle)
+        {
+            ASSERT(is_valid(ctx) && is_valid(texture_handle));
+            std::lock_guard<std::mutex> lock{ g_context.mutex };
+            const TextureEntry& entry = g_context.textures[texture_handle];
+            ASSERT_MSG(!entry.is_destroyed && (entry.usage & (RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_DEPTH_STENCIL)), "Only live render and depth targets can be discarded");
+            count(g_context.stats.num_discards);
+        }
+    }
+
+    void set_debug_name(const ResourceLayoutHandle handle, const wchar* name)
+    { }
+
+    void set_debug_name(const PipelineStateHandle handle, const wchar* name)
+    { }
+
+    void set_debug_name(const BufferHandle handle, const wchar* name)
+    { }
+
+    void set_debug_name(const TextureHandle handle, const wchar* name)
+    { }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "gfx/gfx.h"
+
+// The null backend implements the whole gfx:: API without a GPU: resources live in CPU side handle tables and
+// command lists only count what's recorded into them. Submissions complete immediately, so receipts are always
+// signalled. Useful for running the render graph, passes and upload paths in tests, benchmarks or on CI machines.
+namespace zec::gfx::null
+{
+    struct Stats
+    {
+        u64 num_barriers = 0;
+        u64 num_draws = 0;
+        u64 num_dispatches = 0;
+        // Calls to cmd::return_and_execute
+        u64 num_submits = 0;
+        u64 num_command_contexts_submitted = 0;
+        // Through set_data, update and mesh creation
+        u64 num_bytes_uploaded = 0;
+        u64 num_clears = 0;
+        u64 num_pipeline_state_changes = 0;
+        u64 num_render_target_changes = 0;
+        u64 num_frames_presented = 0;
+
+        u64 num_buffers_created = 0;
+        u64 num_textures_created = 0;
+        u64 num_meshes_created = 0;
+        u64 num_pipelines_created = 0;
+        u64 num_heaps_created = 0;
+        u64 num_buffers_destroyed = 0;
+        u64 num_textures_destroyed = 0;
+        // Also counted in num_barriers
+        u64 num_aliasing_barriers = 0;
+        // Calls to cmd::gpu_wait
+        u64 num_gpu_waits = 0;
+        // Halves of split barriers that began a transition, also counted in num_barriers
+        u64 num_split_barriers_begun = 0;
+        // Through cmd::compute_write_barrier, also counted in num_barriers
+        u64 num_uav_barriers = 0;
+        // Through cmd::begin_render_pass. Clear load ops are counted in num_clears, and loads and stores are the
+        // attachments whose contents had to be read in or written back.
+        u64 num_render_passes = 0;
+        u64 num_attachment_loads = 0;
+        u64 num_attachment_stores = 0;
+        // Through cmd::discard_texture
+        u64 num_discards = 0;
+    };
+
+    // Counters since init_renderer() or the last reset_stats()
+    Stats get_stats();
+    void reset_stats();
+
+    // Contents last written to a buffer through set_data or update, useful for validating uploads in tests.
+    // Returns nullptr for buffers that have never been written to.
+    const void* get_buffer_data(const BufferHandle buffer_handle);
+}
@@ -0,0 +1,60 @@
+#include "gfx/ui.h"
+#include "gfx/gfx.h"
+#include "utils/assert.h"
+
+namespace zec::ui
+{
+    static bool g_is_ui_initialized = false;
+
+    // ImGui still runs so that application UI code is exercised, there's just nothing to draw its output with
+    void initialize(Window& window)
+    {
+        IMGUI_CHECKVERSION();
+        ASSERT_MSG(!g_is_ui_initialized, "UI can only be initialized once!");
+
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        ImGui::StyleColorsDark();
+
+        // Normally the renderer backend builds the font atlas, NewFrame() asserts if nobody has
+        unsigned char* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        g_is_ui_initialized = true;
+    }
+
+    void destroy()
+    {
+        ASSERT(g_is_ui_initialized);
+        ImGui::DestroyContext();
+        g_is_ui_initialized = false;
+    }
+
+    void begin_frame()
+    {
+        ASSERT(g_is_ui_initialized);
+        const RenderConfigState config_state = gfx::get_config_state();
+        ImGuiIO& io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(float(config_state.width), float(config_state.height));
+        io.DeltaTime = 1.0f / 60.0f;
+        ImGui::NewFrame();
+    }
+
+    void end_frame()
+    {
+        ASSERT(g_is_ui_initialized);
+        ImGui::Render();
+    }
+
+    void capture_frame()
+    {
+        ASSERT(g_is_ui_initialized);
+    }
+
+    void draw_frame(CommandContextHandle context_handle)
+    {
+        ASSERT(g_is_ui_initialized);
+        ASSERT(is_valid(context_handle));
+    }
+}
@@ -1,18 +1,17 @@
 #pragma once
-#include <d3d12.h>
-
 #include "gfx/gfx.h"
 
-// Pix for Windows
-#define USE_PIX
-#include "pix3.h"
-
 #include "optick/optick.h"
 
 #define ZEC_CONCAT_IMPL(x, y) x##y
 #define ZEC_CONCAT(x, y) ZEC_CONCAT_IMPL(x, y)
 
 #ifdef USE_D3D_RENDERER
+#include <d3d12.h>
+
+// Pix for Windows
+#define USE_PIX
+#include "pix3.h"
 
 namespace zec
 {
@@ -74,4 +73,19 @@ namespace zec
 
 }
 
-#endif // USE_D3D_RENDERER
\ No newline at end of file
+#else
+
+// No GPU timings without a GPU, but CPU side events still go to Optick
+#ifndef PROFILE_FRAME
+#define PROFILE_FRAME(NAME) OPTICK_FRAME(NAME);
+#endif // PROFILE_FRAME
+
+#ifndef PROFILE_EVENT
+#define PROFILE_EVENT(NAME) OPTICK_EVENT(NAME);
+#endif // PROFILE_EVENT
+
+#ifndef PROFILE_GPU_EVENT
+#define PROFILE_GPU_EVENT(NAME, CMD_CTX)
+#endif // PROFILE_GPU_EVENT
+
+#endif // USE_D3D_RENDERER
@@ -8,6 +8,8 @@ namespace zec
     // ---------- Constants ----------
 
     constexpr u32 k_invalid_handle = UINT32_MAX;
+    // Mip level or array slice covering every subresource of a texture
+    constexpr u32 k_all_subresources = UINT32_MAX;
 
     // Copied from BGFX and others
 #define RESOURCE_HANDLE(_name)      \
@@ -29,6 +31,7 @@ namespace zec
     RESOURCE_HANDLE(CommandContextHandle);
     RESOURCE_HANDLE(UploadContextHandle);
     RESOURCE_HANDLE(ShaderBlobsHandle);
+    RESOURCE_HANDLE(ResourceHeapHandle);
 
     // TODO: ADD ManagedShaderBlobsHandle
     /*class ManagedShaderBlobsHandle
@@ -274,6 +277,17 @@ namespace zec
         NUM_COMMAND_CONTEXT_POOLS
     };
 
+    // Not all hardware can mix buffers, textures and render targets in a single heap, so heaps only hold one kind
+    enum struct ResourceHeapType : u8
+    {
+        BUFFERS = 0,
+        TEXTURES,
+        // Textures that are used as render targets or depth stencil targets
+        RENDER_TARGETS,
+
+        COUNT
+    };
+
     enum struct MSAASetting : u8
     {
         OFF = 0,
@@ -352,6 +366,19 @@ namespace zec
         u8 clear_stencil;
     };
 
+    struct ResourceHeapDesc
+    {
+        ResourceHeapType type = ResourceHeapType::BUFFERS;
+        u64 byte_size = 0;
+    };
+
+    // What a resource needs when it is placed in a heap
+    struct ResourceAllocationInfo
+    {
+        u64 byte_size = 0;
+        u64 alignment = 0;
+    };
+
     struct SamplerDesc
     {
         SamplerFilterType filtering = SamplerFilterType::MIN_LINEAR_MAG_LINEAR_MIP_LINEAR;
@@ -502,6 +529,38 @@ namespace zec
         u64 bottom = 0;
     };
 
+    // What happens to an attachment's previous contents when a render pass starts
+    enum struct LoadOp : u8
+    {
+        LOAD = 0,
+        CLEAR,
+        // Contents are undefined until the pass writes them
+        DISCARD,
+    };
+
+    // Whether an attachment's contents are needed once a render pass ends
+    enum struct StoreOp : u8
+    {
+        STORE = 0,
+        DISCARD,
+    };
+
+    struct RenderPassAttachment
+    {
+        TextureHandle texture = {};
+        LoadOp load_op = LoadOp::LOAD;
+        StoreOp store_op = StoreOp::STORE;
+        // Render targets use all four, depth targets use the first for depth and the second for stencil
+        float clear_value[4] = {};
+    };
+
+    struct RenderPassDesc
+    {
+        RenderPassAttachment render_targets[MAX_NUM_RENDER_TARGETS] = {};
+        u32 num_render_targets = 0;
+        RenderPassAttachment depth_target = {};
+    };
+
     enum struct ResourceTransitionType : u8
     {
         INVALID = 0,
@@ -526,6 +585,15 @@ namespace zec
         ResourceUsage after;
     };
 
+    // Split barriers let a transition start right after the resource's last use and only finish once it's needed,
+    // giving the GPU the passes in between to do it in. Both halves must be recorded on the same queue.
+    enum struct SplitBarrier : u8
+    {
+        NONE = 0,
+        BEGIN,
+        END,
+    };
+
     struct ResourceTransitionDesc
     {
         ResourceTransitionType type;
@@ -536,6 +604,10 @@ namespace zec
         };
         ResourceUsage before;
         ResourceUsage after;
+        // Textures only. Transitions a single mip level and/or array slice instead of the whole texture.
+        u32 mip_level = k_all_subresources;
+        u32 array_slice = k_all_subresources;
+        SplitBarrier split = SplitBarrier::NONE;
     };
 
     struct TextureInfo
@@ -562,6 +634,13 @@ namespace zec
         return receipt.fence_value != CmdReceipt::INVALID_FENCE_VALUE;
     }
 
+    // Work recorded into a command context since it was provisioned
+    struct CommandContextStats
+    {
+        u32 num_draws = 0;
+        u32 num_dispatches = 0;
+    };
+
     struct RenderConfigState
     {
         u32 width;
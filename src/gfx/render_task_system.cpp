@@ -1,5 +1,13 @@
 #include "render_task_system.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <queue>
 #include "gfx.h"
+#include "../cpu_tasks.h"
 #include "profiling_utils.h"
 
 namespace zec::render_graph
@@ -8,7 +16,11 @@ namespace zec::render_graph
     {
         PassListBuilder::Result validate_usage(const ResourceContext* resource_context, const PassResourceUsage& resource_usage)
         {
-            if (resource_usage.usage == RESOURCE_USAGE_UNUSED) {
+            const bool uses_subresource = resource_usage.mip_level != k_all_subresources || resource_usage.array_slice != k_all_subresources;
+            const bool uses_byte_range = resource_usage.byte_offset != 0 || resource_usage.byte_size != 0;
+            if (resource_usage.usage == RESOURCE_USAGE_UNUSED
+                || (uses_subresource && resource_usage.type != PassResourceType::TEXTURE)
+                || (uses_byte_range && resource_usage.type != PassResourceType::BUFFER)) {
                 return PassListBuilder::Result{ PassListBuilder::StatusCodes::RESOURCE_USAGE_INVALID, resource_usage.identifier };
             }
 
@@ -27,478 +39,2690 @@ namespace zec::render_graph
             // TODO: Check usage? Not currently supported
             return PassListBuilder::Result{ PassListBuilder::StatusCodes::SUCCESS };
         }
+
+        u64 align_up(const u64 value, const u64 alignment)
+        {
+            return ((value + alignment - 1) / alignment) * alignment;
+        }
+
+        u32 get_num_copies(const ResourceLifetime lifetime)
+        {
+            ASSERT(lifetime != ResourceLifetime::INFERRED);
+            return lifetime == ResourceLifetime::SINGLE ? 1 : RENDER_LATENCY;
+        }
+
+        // Pooled allocations that a couple of resizes in a row haven't reused are unlikely to be needed again
+        constexpr u32 k_max_pooled_resizes = 2;
+
+        std::wstring get_view_name(const std::wstring_view name, const u32 view_idx)
+        {
+            return view_idx == 0 ? std::wstring{ name } : std::wstring{ name } + L" (View " + std::to_wstring(view_idx) + L")";
+        }
+
+        float get_elapsed_ms(const std::chrono::steady_clock::time_point start)
+        {
+            return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        u32 get_rounded_average(const u64 sum, const u64 count)
+        {
+            return u32((sum + count / 2) / count);
+        }
+
+        // Start of everything RenderTaskList::serialize_compiled() writes. The version has to be bumped whenever what gets
+        // written, or what goes into the compile hashes, changes.
+        constexpr u32 k_compiled_graph_magic = 0x43475A52;
+        constexpr u32 k_compiled_graph_version = 1;
+
+        // 64 bit FNV-1a
+        constexpr u64 k_hash_seed = 0xCBF29CE484222325;
+
+        void hash_bytes(u64& hash, const void* data, const size_t byte_size)
+        {
+            const u8* bytes = static_cast<const u8*>(data);
+            for (size_t i = 0; i < byte_size; i++)
+            {
+                hash = (hash ^ bytes[i]) * 0x100000001B3;
+            }
+        }
+
+        template<typename T>
+        void hash_value(u64& hash, const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            hash_bytes(hash, &value, sizeof(T));
+        }
+
+        class BlobWriter
+        {
+        public:
+            explicit BlobWriter(std::vector<u8>& data) : data{ data } {};
+
+            template<typename T>
+            void write(const T& value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                const u8* bytes = reinterpret_cast<const u8*>(&value);
+                data.insert(data.end(), bytes, bytes + sizeof(T));
+            }
+
+            // Prefixed by the number of values
+            template<typename T>
+            void write_array(const std::span<const T> values)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                write(u32(values.size()));
+                const u8* bytes = reinterpret_cast<const u8*>(values.data());
+                data.insert(data.end(), bytes, bytes + values.size_bytes());
+            }
+
+        private:
+            std::vector<u8>& data;
+        };
+
+        // Reads back what BlobWriter wrote. Reads past the end fail, as do all the ones after them.
+        class BlobReader
+        {
+        public:
+            explicit BlobReader(const std::span<const u8> data) : data{ data } {};
+
+            template<typename T>
+            bool read(T& value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                if (failed || data.size() - offset < sizeof(T))
+                {
+                    failed = true;
+                    return false;
+                }
+                std::memcpy(&value, data.data() + offset, sizeof(T));
+                offset += sizeof(T);
+                return true;
+            }
+
+            template<typename T>
+            bool read_array(std::vector<T>& values)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                u32 num_values = 0;
+                if (!read(num_values) || (data.size() - offset) / sizeof(T) < num_values)
+                {
+                    failed = true;
+                    return false;
+                }
+                values.resize(num_values);
+                std::memcpy(values.data(), data.data() + offset, num_values * sizeof(T));
+                offset += num_values * sizeof(T);
+                return true;
+            }
+
+            // Whether everything was read, and nothing more
+            bool is_complete() const
+            {
+                return !failed && offset == data.size();
+            }
+
+        private:
+            std::span<const u8> data;
+            size_t offset = 0;
+            bool failed = false;
+        };
     }
 
-    void ResourceContext::register_buffer(const BufferResourceDesc& buffer_desc)
+    u64 pack_transient_allocations(const std::span<const TransientAllocationRequest> requests, const std::span<u64> out_offsets)
     {
-        ASSERT(resource_states.count(buffer_desc.identifier) == 0);
-        ResourceState (&resource_state)[RENDER_LATENCY] = resource_states[buffer_desc.identifier];
+        ASSERT(out_offsets.size() == requests.size());
 
-        for (u32 i = 0; i < RENDER_LATENCY; ++i)
+        // Big allocations are the hardest to fit, so they go first. Ties go to whichever is used first, to keep placement stable.
+        std::vector<u32> placement_order(requests.size());
+        for (u32 i = 0; i < placement_order.size(); i++)
+        {
+            placement_order[i] = i;
+        }
+        std::stable_sort(placement_order.begin(), placement_order.end(), [&](const u32 lhs, const u32 rhs) {
+            if (requests[lhs].byte_size != requests[rhs].byte_size)
+            {
+                return requests[lhs].byte_size > requests[rhs].byte_size;
+            }
+            return requests[lhs].first_use < requests[rhs].first_use;
+        });
+
+        struct MemoryRange
         {
-            resource_state[i].buffer = gfx::buffers::create(buffer_desc.desc);
-            resource_state[i].queue_type = CommandQueueType::GRAPHICS; // TODO: Is this always true???
-            resource_state[i].resource_usage = buffer_desc.initial_usage;
-            gfx::set_debug_name(resource_state[i].buffer, buffer_desc.name.data());
+            u64 begin;
+            u64 end;
+        };
+        std::vector<MemoryRange> conflicting_ranges = {};
+        u64 heap_size = 0;
+        for (size_t i = 0; i < placement_order.size(); i++)
+        {
+            const TransientAllocationRequest& request = requests[placement_order[i]];
+            ASSERT(request.first_use <= request.last_use);
+            ASSERT(request.alignment > 0);
+
+            // Memory taken by already placed allocations that are alive at the same time as this one
+            conflicting_ranges.clear();
+            for (size_t j = 0; j < i; j++)
+            {
+                const TransientAllocationRequest& other = requests[placement_order[j]];
+                if (other.first_use <= request.last_use && request.first_use <= other.last_use)
+                {
+                    const u64 other_offset = out_offsets[placement_order[j]];
+                    conflicting_ranges.push_back({ other_offset, other_offset + other.byte_size });
+                }
+            }
+            std::sort(conflicting_ranges.begin(), conflicting_ranges.end(), [](const MemoryRange& lhs, const MemoryRange& rhs) {
+                return lhs.begin < rhs.begin;
+            });
+
+            // First gap that's big enough
+            u64 offset = 0;
+            for (const MemoryRange& range : conflicting_ranges)
+            {
+                if (offset + request.byte_size <= range.begin)
+                {
+                    break;
+                }
+                offset = std::max(offset, align_up(range.end, request.alignment));
+            }
+
+            out_offsets[placement_order[i]] = offset;
+            heap_size = std::max(heap_size, offset + request.byte_size);
         }
+        return heap_size;
+    }
 
+    void ResourceContext::register_buffer(const BufferResourceDesc& buffer_desc)
+    {
+        ASSERT_MSG(!buffer_desc.is_transient || (buffer_desc.desc.usage & RESOURCE_USAGE_DYNAMIC) == 0, "Transient buffers live in GPU memory and can't be written to by the CPU");
+        ASSERT(buffer_desc.num_views > 0);
+        for (u32 view_idx = 0; view_idx < buffer_desc.num_views; view_idx++)
+        {
+            register_resource({
+                .identifier = get_view_identifier(buffer_desc.identifier, view_idx),
+                .type = ResourceTransitionType::BUFFER,
+                .name = get_view_name(buffer_desc.name, view_idx),
+                .initial_usage = buffer_desc.initial_usage,
+                .buffer_desc = buffer_desc.desc,
+                .requested_lifetime = buffer_desc.lifetime,
+                .is_transient = buffer_desc.is_transient,
+                .num_views = buffer_desc.num_views,
+                .heap_type = ResourceHeapType::BUFFERS,
+                .allocation_info = buffer_desc.is_transient ? gfx::buffers::get_allocation_info(buffer_desc.desc) : ResourceAllocationInfo{},
+            });
+        }
     }
 
     void ResourceContext::register_texture(const TextureResourceDesc& texture_desc)
     {
-        ASSERT(resource_states.count(texture_desc.identifier) == 0);
+        const bool is_render_target = texture_desc.desc.usage & (RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_DEPTH_STENCIL);
+        ASSERT(texture_desc.num_views > 0);
+        for (u32 view_idx = 0; view_idx < texture_desc.num_views; view_idx++)
+        {
+            RegisteredResource registered_resource = {
+                .identifier = get_view_identifier(texture_desc.identifier, view_idx),
+                .type = ResourceTransitionType::TEXTURE,
+                .name = get_view_name(texture_desc.name, view_idx),
+                .initial_usage = texture_desc.desc.initial_state,
+                .texture_desc = texture_desc.desc,
+                .requested_lifetime = texture_desc.lifetime,
+                .is_transient = texture_desc.is_transient,
+                .num_views = texture_desc.num_views,
+                .heap_type = is_render_target ? ResourceHeapType::RENDER_TARGETS : ResourceHeapType::TEXTURES,
+                .sizing = texture_desc.sizing,
+                .relative_width_factor = texture_desc.relative_width_factor,
+                .relative_height_factor = texture_desc.relative_height_factor,
+                .dynamic_resolution = texture_desc.dynamic_resolution,
+            };
+            registered_resource.texture_desc = get_sized_texture_desc(registered_resource);
+            if (texture_desc.is_transient)
+            {
+                registered_resource.allocation_info = gfx::textures::get_allocation_info(registered_resource.texture_desc);
+            }
+            register_resource(std::move(registered_resource));
+        }
+    }
+
+    TextureDesc ResourceContext::get_sized_texture_desc(const RegisteredResource& registered_resource) const
+    {
+        TextureDesc desc = registered_resource.texture_desc;
+        if (registered_resource.sizing == Sizing::RELATIVE_TO_SWAP_CHAIN)
+        {
+            desc.width = std::max(1u, u32(float(render_config_state.width) * registered_resource.relative_width_factor));
+            desc.height = std::max(1u, u32(float(render_config_state.height) * registered_resource.relative_height_factor));
+            desc.depth = 1;
+        }
+        return desc;
+    }
 
-        TextureDesc temp_desc = texture_desc.desc;
-        if (texture_desc.sizing == Sizing::RELATIVE_TO_SWAP_CHAIN) {
-            temp_desc.width = render_config_state.width;
-            temp_desc.height = render_config_state.height;
-            temp_desc.depth = 1;
+    void ResourceContext::set_render_config_state(const RenderConfigState& config_state)
+    {
+        const bool size_changed = config_state.width != render_config_state.width || config_state.height != render_config_state.height;
+        render_config_state = config_state;
+        if (!size_changed)
+        {
+            return;
         }
-        ResourceState (&resource_state)[RENDER_LATENCY] = resource_states[texture_desc.identifier];
-        for (u32 i = 0; i < RENDER_LATENCY; ++i)
+
+        num_resizes++;
+        is_resizing = true;
+        bool transients_resized = false;
+        for (size_t slot = 0; slot < registered_resources.size(); slot++)
         {
-            resource_state[i].texture = gfx::textures::create(temp_desc);
-            resource_state[i].queue_type = CommandQueueType::GRAPHICS; // TODO: Is this always true???
-            resource_state[i].resource_usage = texture_desc.desc.initial_state;
-            gfx::set_debug_name(resource_state[i].texture, texture_desc.name.data());
+            RegisteredResource& registered_resource = registered_resources[slot];
+            if (registered_resource.type != ResourceTransitionType::TEXTURE || registered_resource.sizing != Sizing::RELATIVE_TO_SWAP_CHAIN)
+            {
+                continue;
+            }
+            const TextureDesc sized_desc = get_sized_texture_desc(registered_resource);
+            if (sized_desc.width == registered_resource.texture_desc.width && sized_desc.height == registered_resource.texture_desc.height)
+            {
+                continue;
+            }
+
+            if (registered_resource.is_transient)
+            {
+                // Placed again further down, along with the rest of the transient resources
+                if (registered_resource.heap_offset != UINT64_MAX)
+                {
+                    release_transient_resource(ResourceSlot(slot));
+                }
+                registered_resource.texture_desc = sized_desc;
+                registered_resource.allocation_info = gfx::textures::get_allocation_info(sized_desc);
+                transients_resized = true;
+                continue;
+            }
+
+            ResourceState* resource_state = &resource_states[get_state_idx(ResourceSlot(slot), 0)];
+            for (u32 i = 0; i < get_num_copies(registered_resource.lifetime); ++i)
+            {
+                texture_pool.push_back({
+                    .slot = ResourceSlot(slot),
+                    .width = registered_resource.texture_desc.width,
+                    .height = registered_resource.texture_desc.height,
+                    .texture = resource_state[i].resolved.texture,
+                    .resource_usage = resource_state[i].resource_usage,
+                    .queue_type = resource_state[i].queue_type,
+                    .released_at_resize = num_resizes,
+                });
+            }
+            registered_resource.texture_desc = sized_desc;
+            create_copies(ResourceSlot(slot));
+        }
+
+        if (transients_resized)
+        {
+            // The old offsets were for the old sizes
+            std::vector<TransientResourceLifetime> lifetimes = transient_lifetimes;
+            for (TransientResourceLifetime& lifetime : lifetimes)
+            {
+                lifetime.heap_offset = UINT64_MAX;
+            }
+            place_transient_resources(lifetimes);
         }
+        is_resizing = false;
+
+        std::erase_if(texture_pool, [&](const PooledTexture& pooled)
+        {
+            const bool is_stale = num_resizes - pooled.released_at_resize >= k_max_pooled_resizes;
+            if (is_stale)
+            {
+                gfx::textures::destroy(pooled.texture);
+            }
+            return is_stale;
+        });
+        std::erase_if(heap_pool, [&](const PooledHeap& pooled)
+        {
+            const bool is_stale = num_resizes - pooled.released_at_resize >= k_max_pooled_resizes;
+            if (is_stale)
+            {
+                gfx::heaps::destroy(pooled.heap);
+            }
+            return is_stale;
+        });
     }
 
-    void ResourceContext::set_backbuffer_id(const ResourceIdentifier id)
+    void ResourceContext::clear_resource_pool()
     {
-        ASSERT_MSG(!backbuffer_id.is_valid(), "Backbuffer resource has already been set for this context.");
-        backbuffer_id = id;
-        ResourceState(&resource_state)[RENDER_LATENCY] = resource_states[backbuffer_id];
+        for (const PooledTexture& pooled : texture_pool)
+        {
+            gfx::textures::destroy(pooled.texture);
+        }
+        texture_pool.clear();
+        for (const PooledHeap& pooled : heap_pool)
+        {
+            gfx::heaps::destroy(pooled.heap);
+        }
+        heap_pool.clear();
+    }
+
+    ResourcePoolStats ResourceContext::get_resource_pool_stats() const
+    {
+        ResourcePoolStats stats = {};
+        for (const PooledTexture& pooled : texture_pool)
+        {
+            TextureDesc desc = registered_resources[pooled.slot].texture_desc;
+            desc.width = pooled.width;
+            desc.height = pooled.height;
+            stats.num_textures++;
+            stats.byte_size += gfx::textures::get_allocation_info(desc).byte_size;
+        }
+        for (const PooledHeap& pooled : heap_pool)
+        {
+            stats.num_heaps++;
+            stats.byte_size += pooled.byte_size;
+        }
+        return stats;
+    }
+
+    void ResourceContext::set_render_scale(const float scale)
+    {
+        ASSERT(scale > 0.0f && scale <= 1.0f);
+        render_scale = scale;
+    }
+
+    void ResourceContext::get_render_size(const ResourceSlot slot, u32& width, u32& height) const
+    {
+        ASSERT(slot < registered_resources.size());
+        const RegisteredResource& registered_resource = registered_resources[slot];
+        if (registered_resource.identifier == backbuffer_id)
+        {
+            width = render_config_state.width;
+            height = render_config_state.height;
+            return;
+        }
+
+        ASSERT(registered_resource.type == ResourceTransitionType::TEXTURE);
+        width = registered_resource.texture_desc.width;
+        height = registered_resource.texture_desc.height;
+        if (registered_resource.dynamic_resolution)
+        {
+            width = std::max(1u, u32(std::lround(float(width) * render_scale)));
+            height = std::max(1u, u32(std::lround(float(height) * render_scale)));
+        }
+    }
+
+    Viewport ResourceContext::get_viewport(const ResourceIdentifier id) const
+    {
+        return get_viewport(slots.at(id));
+    }
+
+    Viewport ResourceContext::get_viewport(const ResourceSlot slot) const
+    {
+        u32 width, height;
+        get_render_size(slot, width, height);
+        return { 0.0f, 0.0f, float(width), float(height) };
+    }
+
+    Scissor ResourceContext::get_scissor(const ResourceIdentifier id) const
+    {
+        return get_scissor(slots.at(id));
+    }
+
+    Scissor ResourceContext::get_scissor(const ResourceSlot slot) const
+    {
+        u32 width, height;
+        get_render_size(slot, width, height);
+        return { 0, 0, width, height };
+    }
+
+    TextureHandle ResourceContext::create_texture(const ResourceSlot slot, const u32 copy_idx)
+    {
+        const RegisteredResource& registered_resource = registered_resources[slot];
+        for (auto it = texture_pool.begin(); it != texture_pool.end(); ++it)
+        {
+            if (it->slot == slot && it->width == registered_resource.texture_desc.width && it->height == registered_resource.texture_desc.height)
+            {
+                // Picks up from whatever state it was left in
+                ResourceState& resource_state = resource_states[get_state_idx(slot, copy_idx)];
+                resource_state.resource_usage = it->resource_usage;
+                resource_state.queue_type = it->queue_type;
+                const TextureHandle texture = it->texture;
+                texture_pool.erase(it);
+                return texture;
+            }
+        }
+        return gfx::textures::create(registered_resource.texture_desc);
+    }
+
+    ResourceHeapHandle ResourceContext::create_heap(const ResourceHeapType type, const u64 byte_size)
+    {
+        for (auto it = heap_pool.begin(); it != heap_pool.end(); ++it)
+        {
+            if (it->type == type && it->byte_size == byte_size)
+            {
+                const ResourceHeapHandle heap = it->heap;
+                heap_pool.erase(it);
+                return heap;
+            }
+        }
+        return gfx::heaps::create({ .type = type, .byte_size = byte_size });
+    }
+
+    void ResourceContext::release_heap(const ResourceHeapHandle heap, const ResourceHeapType type, const u64 byte_size)
+    {
+        if (is_resizing)
+        {
+            heap_pool.push_back({ .type = type, .byte_size = byte_size, .heap = heap, .released_at_resize = num_resizes });
+        }
+        else
+        {
+            gfx::heaps::destroy(heap);
+        }
+    }
 
+    ResourceSlot ResourceContext::add_slot(RegisteredResource&& registered_resource)
+    {
+        // Also catches a view's copy of a resource landing on the identifier of another one, see get_view_identifier
+        ASSERT_MSG(!slots.contains(registered_resource.identifier), "A resource with this identifier is already registered");
+        ASSERT_MSG(registered_resources.size() < k_invalid_resource_slot, "Too many resources registered");
+        const ResourceSlot slot = ResourceSlot(registered_resources.size());
+        slots[registered_resource.identifier] = slot;
         for (u32 i = 0; i < RENDER_LATENCY; ++i)
         {
-            // The texture handle gets filled in by refresh_backbuffer
+            resource_states.push_back({
+                .resource_usage = registered_resource.initial_usage,
+                .queue_type = CommandQueueType::GRAPHICS, // TODO: Is this always true???
+            });
+        }
+        registered_resources.push_back(std::move(registered_resource));
+        return slot;
+    }
+
+    void ResourceContext::register_resource(RegisteredResource&& registered_resource)
+    {
+        if (registered_resource.requested_lifetime != ResourceLifetime::INFERRED)
+        {
+            registered_resource.lifetime = registered_resource.requested_lifetime;
+        }
+        const ResourceSlot slot = add_slot(std::move(registered_resource));
+        // Transient resources are created once the render graph knows when they're used, see place_transient_resources
+        if (!registered_resources[slot].is_transient)
+        {
+            create_copies(slot);
+        }
+    }
+
+    void ResourceContext::create_copies(const ResourceSlot slot, const u32 first_copy)
+    {
+        const RegisteredResource& registered_resource = registered_resources[slot];
+        ResourceState* resource_state = &resource_states[get_state_idx(slot, 0)];
+        const u32 num_copies = get_num_copies(registered_resource.lifetime);
+        handles_version++;
+        for (u32 i = first_copy; i < RENDER_LATENCY; ++i)
+        {
+            if (i >= num_copies)
+            {
+                resource_state[i] = resource_state[0];
+                continue;
+            }
+
             resource_state[i].queue_type = CommandQueueType::GRAPHICS;
-            resource_state[i].resource_usage = RESOURCE_USAGE_PRESENT;
+            resource_state[i].resource_usage = registered_resource.initial_usage;
+            if (registered_resource.is_transient)
+            {
+                const ResourceHeapHandle heap = get_transient_heap(registered_resource).heaps[i];
+                if (registered_resource.type == ResourceTransitionType::BUFFER)
+                {
+                    resource_state[i].resolved.buffer = gfx::buffers::create_placed(heap, registered_resource.heap_offset, registered_resource.buffer_desc);
+                }
+                else
+                {
+                    resource_state[i].resolved.texture = gfx::textures::create_placed(heap, registered_resource.heap_offset, registered_resource.texture_desc);
+                }
+            }
+            else
+            {
+                if (registered_resource.type == ResourceTransitionType::BUFFER)
+                {
+                    resource_state[i].resolved.buffer = gfx::buffers::create(registered_resource.buffer_desc);
+                }
+                else
+                {
+                    resource_state[i].resolved.texture = create_texture(slot, i);
+                }
+            }
+
+            if (registered_resource.type == ResourceTransitionType::BUFFER)
+            {
+                gfx::set_debug_name(resource_state[i].resolved.buffer, registered_resource.name.c_str());
+            }
+            else
+            {
+                gfx::set_debug_name(resource_state[i].resolved.texture, registered_resource.name.c_str());
+            }
         }
     }
 
-    void ResourceContext::refresh_backbuffer()
+    void ResourceContext::release_copies(const ResourceSlot slot)
     {
-        ASSERT_MSG(backbuffer_id.is_valid(), "We need valid backbuffer ID, to store the current backbuffer handle with");
-        TextureHandle backbuffer_handle = gfx::get_current_back_buffer_handle();
-        ResourceState(&resource_state)[RENDER_LATENCY] = resource_states[backbuffer_id];
+        const RegisteredResource& registered_resource = registered_resources[slot];
+        ResourceState* resource_state = &resource_states[get_state_idx(slot, 0)];
+        const u32 num_copies = get_num_copies(registered_resource.lifetime);
+        handles_version++;
         for (u32 i = 0; i < RENDER_LATENCY; ++i)
         {
-            resource_state[i].texture = backbuffer_handle;
+            if (i < num_copies)
+            {
+                if (registered_resource.type == ResourceTransitionType::BUFFER)
+                {
+                    gfx::buffers::destroy(resource_state[i].resolved.buffer);
+                }
+                else
+                {
+                    gfx::textures::destroy(resource_state[i].resolved.texture);
+                }
+            }
+            resource_state[i].resolved = {};
         }
     }
 
-    void ResourceContext::set_barrier_state(const ResourceIdentifier id, const BarrierState barrier_state)
+    bool ResourceContext::set_inferred_lifetime(const ResourceIdentifier id, const ResourceLifetime inferred_lifetime)
     {
-        const u64 idx = gfx::get_current_frame_idx() % RENDER_LATENCY;
-        ResourceState(&resource_state)[RENDER_LATENCY] = resource_states.at(id);
-        resource_state[idx].resource_usage = barrier_state.resource_usage;
-        resource_state[idx].queue_type = barrier_state.queue_type;
+        const ResourceSlot slot = slots.at(id);
+        RegisteredResource& registered_resource = registered_resources[slot];
+        const ResourceLifetime lifetime = registered_resource.requested_lifetime == ResourceLifetime::INFERRED ? inferred_lifetime : registered_resource.requested_lifetime;
+        if (lifetime == registered_resource.lifetime)
+        {
+            return false;
+        }
+
+        const u32 num_copies = get_num_copies(lifetime);
+        const u32 prev_num_copies = get_num_copies(registered_resource.lifetime);
+        if (registered_resource.is_transient)
+        {
+            // Resources with a different number of copies live in different heaps, so this has to be placed again
+            const bool was_placed = registered_resource.heap_offset != UINT64_MAX;
+            if (was_placed && num_copies != prev_num_copies)
+            {
+                release_transient_resource(slot);
+            }
+            registered_resource.lifetime = lifetime;
+            return was_placed && num_copies != prev_num_copies;
+        }
+
+        ResourceState* resource_state = &resource_states[get_state_idx(slot, 0)];
+        if (num_copies < prev_num_copies)
+        {
+            // Whichever copy we keep, its state is the one shared by all frames from now on
+            handles_version++;
+            for (u32 i = num_copies; i < prev_num_copies; ++i)
+            {
+                if (registered_resource.type == ResourceTransitionType::BUFFER)
+                {
+                    gfx::buffers::destroy(resource_state[i].resolved.buffer);
+                }
+                else
+                {
+                    gfx::textures::destroy(resource_state[i].resolved.texture);
+                }
+                resource_state[i] = resource_state[0];
+            }
+        }
+        else if (num_copies > prev_num_copies)
+        {
+            // Keep the existing copy, and only create the new ones
+            registered_resource.lifetime = lifetime;
+            create_copies(slot, prev_num_copies);
+        }
+        registered_resource.lifetime = lifetime;
+        return num_copies != prev_num_copies;
     }
 
-    BufferHandle ResourceContext::get_buffer(const ResourceIdentifier buffer_identifier) const
+    void ResourceContext::set_backbuffer_id(const ResourceIdentifier id)
     {
-        const u64 idx = gfx::get_current_frame_idx() % RENDER_LATENCY;
-        return resource_states.at(buffer_identifier)[idx].buffer;
+        ASSERT_MSG(!backbuffer_id.is_valid(), "Backbuffer resource has already been set for this context.");
+        backbuffer_id = id;
+        // The texture handle gets filled in by refresh_backbuffer. Each in-flight frame renders to its own back buffer.
+        add_slot({
+            .identifier = id,
+            .type = ResourceTransitionType::TEXTURE,
+            .initial_usage = RESOURCE_USAGE_PRESENT,
+            .lifetime = ResourceLifetime::PER_FRAME,
+        });
     }
 
-    TextureHandle ResourceContext::get_texture(const ResourceIdentifier texture_identifier) const
-    {
-        const u64 idx = gfx::get_current_frame_idx() % RENDER_LATENCY;
-        return resource_states.at(texture_identifier)[idx].texture;
+    void ResourceContext::refresh_backbuffer()
+    {
+        ASSERT_MSG(backbuffer_id.is_valid(), "We need valid backbuffer ID, to store the current backbuffer handle with");
+        TextureHandle backbuffer_handle = gfx::get_current_back_buffer_handle();
+        const ResourceSlot slot = slots.at(backbuffer_id);
+        for (u32 i = 0; i < RENDER_LATENCY; ++i)
+        {
+            resource_states[get_state_idx(slot, i)].resolved.texture = backbuffer_handle;
+        }
+    }
+
+    void ResourceContext::set_barrier_state(const ResourceIdentifier id, const BarrierState barrier_state)
+    {
+        set_barrier_state(id, gfx::get_current_frame_idx(), barrier_state);
+    }
+
+    void ResourceContext::set_barrier_state(const ResourceIdentifier id, const u64 frame_idx, const BarrierState barrier_state)
+    {
+        set_barrier_state(slots.at(id), frame_idx, barrier_state);
+    }
+
+    void ResourceContext::set_barrier_state(const ResourceSlot slot, const u64 frame_idx, const BarrierState barrier_state)
+    {
+        ResourceState* resource_state = &resource_states[get_state_idx(slot, 0)];
+        // Frames sharing a single copy also share its state
+        const bool is_shared = get_num_copies(registered_resources[slot].lifetime) == 1;
+        for (u32 i = 0; i < RENDER_LATENCY; ++i)
+        {
+            if (is_shared || i == frame_idx % RENDER_LATENCY)
+            {
+                resource_state[i].resource_usage = barrier_state.resource_usage;
+                resource_state[i].queue_type = barrier_state.queue_type;
+            }
+        }
+    }
+
+    BufferHandle ResourceContext::get_buffer(const ResourceIdentifier buffer_identifier) const
+    {
+        return get_buffer(buffer_identifier, gfx::get_current_frame_idx());
+    }
+
+    TextureHandle ResourceContext::get_texture(const ResourceIdentifier texture_identifier) const
+    {
+        return get_texture(texture_identifier, gfx::get_current_frame_idx());
+    }
+
+    BarrierState ResourceContext::get_barrier_state(const ResourceIdentifier resource_identifier) const
+    {
+        return get_barrier_state(resource_identifier, gfx::get_current_frame_idx());
+    }
+
+    BufferHandle ResourceContext::get_buffer(const ResourceIdentifier buffer_identifier, const u64 frame_idx) const
+    {
+        return resource_states[get_state_idx(slots.at(buffer_identifier), frame_idx)].resolved.buffer;
+    }
+
+    TextureHandle ResourceContext::get_texture(const ResourceIdentifier texture_identifier, const u64 frame_idx) const
+    {
+        return resource_states[get_state_idx(slots.at(texture_identifier), frame_idx)].resolved.texture;
+    }
+
+    BarrierState ResourceContext::get_barrier_state(const ResourceIdentifier resource_identifier, const u64 frame_idx) const
+    {
+        return get_barrier_state(slots.at(resource_identifier), frame_idx);
+    }
+
+    BarrierState ResourceContext::get_barrier_state(const ResourceSlot slot, const u64 frame_idx) const
+    {
+        const ResourceState& resource_state = resource_states[get_state_idx(slot, frame_idx)];
+        return {
+            .resource_usage = resource_state.resource_usage,
+            .queue_type = resource_state.queue_type,
+        };
+    }
+
+    u32 ResourceContext::get_num_views(const ResourceIdentifier id) const
+    {
+        const ResourceSlot slot = get_slot(id);
+        return slot != k_invalid_resource_slot ? registered_resources[slot].num_views : 0;
+    }
+
+    ResourceSlot ResourceContext::get_slot(const ResourceIdentifier id) const
+    {
+        const auto it = slots.find(id);
+        return it != slots.end() ? it->second : k_invalid_resource_slot;
+    }
+
+    ResourceIdentifier ResourceContext::get_backbuffer_id()
+    {
+        return backbuffer_id;
+    }
+
+    bool ResourceContext::is_transient(const ResourceIdentifier id) const
+    {
+        const ResourceSlot slot = get_slot(id);
+        return slot != k_invalid_resource_slot && registered_resources[slot].is_transient;
+    }
+
+    bool ResourceContext::is_aliased(const ResourceIdentifier id) const
+    {
+        const ResourceSlot slot = get_slot(id);
+        return slot != k_invalid_resource_slot && registered_resources[slot].is_aliased;
+    }
+
+    bool ResourceContext::place_transient_resources(const std::span<const TransientResourceLifetime> lifetimes)
+    {
+        bool handles_changed = false;
+        transient_memory_stats = {};
+        transient_lifetimes.assign(lifetimes.begin(), lifetimes.end());
+
+        for (size_t heap_type_idx = 0; heap_type_idx < size_t(ResourceHeapType::COUNT); heap_type_idx++)
+        {
+            for (const bool is_single : { false, true })
+            {
+                const auto is_in_heap = [&](const RegisteredResource& transient_resource) -> bool
+                {
+                    return transient_resource.is_transient
+                        && size_t(transient_resource.heap_type) == heap_type_idx
+                        && (transient_resource.lifetime == ResourceLifetime::SINGLE) == is_single;
+                };
+                TransientHeap& transient_heap = transient_heaps[is_single][heap_type_idx];
+                const u32 num_copies = is_single ? 1 : RENDER_LATENCY;
+
+                std::vector<ResourceSlot> ids = {};
+                std::vector<u32> lifetime_indices = {};
+                std::vector<TransientAllocationRequest> requests = {};
+                std::vector<u64> offsets = {};
+                bool has_offsets = true;
+                for (u32 lifetime_idx = 0; lifetime_idx < lifetimes.size(); lifetime_idx++)
+                {
+                    const TransientResourceLifetime& lifetime = lifetimes[lifetime_idx];
+                    const ResourceSlot slot = slots.at(lifetime.identifier);
+                    const RegisteredResource& transient_resource = registered_resources[slot];
+                    if (is_in_heap(transient_resource))
+                    {
+                        ids.push_back(slot);
+                        lifetime_indices.push_back(lifetime_idx);
+                        requests.push_back({
+                            .byte_size = transient_resource.allocation_info.byte_size,
+                            .alignment = transient_resource.allocation_info.alignment,
+                            .first_use = lifetime.first_use,
+                            .last_use = lifetime.last_use,
+                        });
+                        offsets.push_back(lifetime.heap_offset);
+                        has_offsets = has_offsets && lifetime.heap_offset != UINT64_MAX;
+                    }
+                }
+                u64 heap_size = 0;
+                if (has_offsets)
+                {
+                    // Placed up front, e.g. by a render graph loading what it compiled earlier
+                    for (size_t i = 0; i < requests.size(); i++)
+                    {
+                        ASSERT(offsets[i] % requests[i].alignment == 0);
+                        heap_size = std::max(heap_size, offsets[i] + requests[i].byte_size);
+                    }
+                }
+                else
+                {
+                    heap_size = pack_transient_allocations(requests, offsets);
+                }
+                for (size_t i = 0; i < lifetime_indices.size(); i++)
+                {
+                    transient_lifetimes[lifetime_indices[i]].heap_offset = offsets[i];
+                }
+                const bool heap_size_changed = heap_size != transient_heap.byte_size;
+
+                std::vector<u64> new_offsets(registered_resources.size(), UINT64_MAX);
+                for (size_t i = 0; i < ids.size(); i++)
+                {
+                    new_offsets[ids[i]] = offsets[i];
+                }
+
+                // Resources that are no longer used or have moved. Nothing has to move if the placement hasn't changed.
+                for (size_t slot = 0; slot < registered_resources.size(); slot++)
+                {
+                    const RegisteredResource& transient_resource = registered_resources[slot];
+                    if (!is_in_heap(transient_resource) || transient_resource.heap_offset == UINT64_MAX)
+                    {
+                        continue;
+                    }
+                    if (heap_size_changed || new_offsets[slot] != transient_resource.heap_offset)
+                    {
+                        release_transient_resource(ResourceSlot(slot));
+                        handles_changed = true;
+                    }
+                }
+
+                if (heap_size_changed)
+                {
+                    for (u32 i = 0; i < num_copies; i++)
+                    {
+                        ResourceHeapHandle& heap = transient_heap.heaps[i];
+                        if (is_valid(heap))
+                        {
+                            release_heap(heap, ResourceHeapType(heap_type_idx), transient_heap.byte_size);
+                            heap = INVALID_HANDLE;
+                        }
+                        if (heap_size > 0)
+                        {
+                            heap = create_heap(ResourceHeapType(heap_type_idx), heap_size);
+                        }
+                    }
+                    transient_heap.byte_size = heap_size;
+                }
+
+                for (size_t i = 0; i < ids.size(); i++)
+                {
+                    RegisteredResource& transient_resource = registered_resources[ids[i]];
+                    if (transient_resource.heap_offset == UINT64_MAX)
+                    {
+                        create_transient_resource(ids[i], offsets[i]);
+                        handles_changed = true;
+                    }
+
+                    transient_resource.is_aliased = false;
+                    for (size_t j = 0; j < ids.size(); j++)
+                    {
+                        const bool overlaps = offsets[i] < offsets[j] + requests[j].byte_size && offsets[j] < offsets[i] + requests[i].byte_size;
+                        if (i != j && overlaps)
+                        {
+                            transient_resource.is_aliased = true;
+                            break;
+                        }
+                    }
+
+                    transient_memory_stats.num_resources++;
+                    transient_memory_stats.unaliased_byte_size += num_copies * requests[i].byte_size;
+                }
+                transient_memory_stats.heap_byte_size += num_copies * heap_size;
+            }
+        }
+
+        return handles_changed;
+    }
+
+    u64 ResourceContext::get_compile_hash() const
+    {
+        u64 hash = k_hash_seed;
+        hash_value(hash, backbuffer_id);
+        for (const RegisteredResource& registered_resource : registered_resources)
+        {
+            hash_value(hash, registered_resource.identifier);
+            hash_value(hash, registered_resource.type);
+            hash_value(hash, registered_resource.requested_lifetime);
+            hash_value(hash, registered_resource.is_transient);
+            hash_value(hash, registered_resource.heap_type);
+            hash_value(hash, registered_resource.allocation_info.byte_size);
+            hash_value(hash, registered_resource.allocation_info.alignment);
+            hash_value(hash, registered_resource.texture_desc.num_mips);
+            hash_value(hash, registered_resource.texture_desc.array_size);
+        }
+        return hash;
+    }
+
+    ResourceContext::TransientHeap& ResourceContext::get_transient_heap(const RegisteredResource& transient_resource)
+    {
+        return transient_heaps[transient_resource.lifetime == ResourceLifetime::SINGLE][size_t(transient_resource.heap_type)];
+    }
+
+    void ResourceContext::create_transient_resource(const ResourceSlot slot, const u64 heap_offset)
+    {
+        registered_resources[slot].heap_offset = heap_offset;
+        create_copies(slot);
+    }
+
+    void ResourceContext::release_transient_resource(const ResourceSlot slot)
+    {
+        release_copies(slot);
+        RegisteredResource& transient_resource = registered_resources[slot];
+        transient_resource.heap_offset = UINT64_MAX;
+        transient_resource.is_aliased = false;
+    }
+
+    ZecResult PipelineStore::compile(const PipelineId id, const PipelineCompilationDesc& desc, std::string& inout_errors)
+    {
+        ASSERT(!pso_handles.contains(id));
+        ASSERT(!recompilation_infos.contains(id));
+
+        ShaderBlobsHandle blobs_handle{};
+        ZecResult res = gfx::shader_compilation::compile_shaders(desc.shader_compilation_desc, blobs_handle, inout_errors);
+
+        if (res == ZecResult::SUCCESS)
+        {
+            ResourceLayoutHandle resource_layout = desc.resource_layout;
+            PipelineStateHandle pso_handle = gfx::pipelines::create_pipeline_state_object(blobs_handle, resource_layout, desc.pso_desc);
+
+            // Success!
+            // Clean up after ourselves
+            gfx::shader_compilation::release_blobs(blobs_handle);
+
+            pso_handles.set(id, pso_handle);
+            recompilation_infos.set(id, desc);;
+        }
+        return res;
+    }
+
+    ZecResult PipelineStore::recompile(const PipelineId pipeline_id, std::string& inout_errors)
+    {
+        ASSERT(pso_handles.contains(pipeline_id));
+        ASSERT(recompilation_infos.contains(pipeline_id));
+
+        const PipelineCompilationDesc& recompilation_desc = recompilation_infos.get(pipeline_id);
+        ShaderBlobsHandle blobs_handle{};
+        ZecResult res = gfx::shader_compilation::compile_shaders(recompilation_desc.shader_compilation_desc, blobs_handle, inout_errors);
+
+        if (res == ZecResult::SUCCESS)
+        {
+            // Recompile pipeline id
+            const ResourceLayoutHandle resource_layout_handle = recompilation_desc.resource_layout;
+            const PipelineStateHandle old_pipeline_id = pso_handles.get(pipeline_id);
+
+            // TODO: do we need to make this whole process async? How would that work?
+            res = gfx::pipelines::recreate_pipeline_state_object(blobs_handle, resource_layout_handle, recompilation_desc.pso_desc, old_pipeline_id);
+
+            gfx::shader_compilation::release_blobs(blobs_handle);
+        }
+
+        return res;
+    }
+
+    PassListBuilder::PassListBuilder(RenderTaskList* list_to_build) : out_list(list_to_build)
+    {}
+
+    PassListBuilder::Result PassListBuilder::add_pass(const PassDesc& pass_desc, const u32 view_idx)
+    {
+        Result out_result{ StatusCodes::SUCCESS };
+
+        // Other views use their own copies of the resources registered per view
+        std::vector<PassResourceUsage> view_inputs = {};
+        std::vector<PassResourceUsage> view_outputs = {};
+        if (view_idx != 0 && out_list->resource_context != nullptr)
+        {
+            const auto to_view_usage = [&](PassResourceUsage resource_usage) -> PassResourceUsage
+            {
+                // Only resources registered per view have copies to swap in. Looking the view's identifier up for the
+                // others could find an unrelated resource that happens to have it.
+                if (view_idx < out_list->resource_context->get_num_views(resource_usage.identifier))
+                {
+                    resource_usage.identifier = get_view_identifier(resource_usage.identifier, view_idx);
+                }
+                return resource_usage;
+            };
+            std::transform(pass_desc.inputs.begin(), pass_desc.inputs.end(), std::back_inserter(view_inputs), to_view_usage);
+            std::transform(pass_desc.outputs.begin(), pass_desc.outputs.end(), std::back_inserter(view_outputs), to_view_usage);
+        }
+        const PassDesc render_pass_desc = {
+            .name = pass_desc.name,
+            .command_queue_type = pass_desc.command_queue_type,
+            .setup_fn = pass_desc.setup_fn,
+            .execute_fn = pass_desc.execute_fn,
+            .teardown_fn = pass_desc.teardown_fn,
+            .inputs = view_idx != 0 ? std::span<PassResourceUsage const>{ view_inputs } : pass_desc.inputs,
+            .outputs = view_idx != 0 ? std::span<PassResourceUsage const>{ view_outputs } : pass_desc.outputs,
+            .max_recording_jobs = pass_desc.max_recording_jobs,
+            .allow_async_compute = pass_desc.allow_async_compute,
+        };
+
+        if (out_list->resource_context == nullptr)
+        {
+            out_result = Result{ StatusCodes::MISSING_RESOURCE_CONTEXT };
+        }
+        else if (!out_list->resource_context->get_backbuffer_id().is_valid())
+        {
+            out_result = Result{ StatusCodes::UNSPECIFIED_BACKBUFFER_RESOURCE };
+        }
+        else {
+
+            ASSERT(render_pass_desc.command_queue_type != CommandQueueType::COPY && render_pass_desc.command_queue_type != CommandQueueType::NUM_COMMAND_CONTEXT_POOLS);
+            if (render_pass_desc.allow_async_compute)
+            {
+                constexpr u16 graphics_only_usages = RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_DEPTH_STENCIL | RESOURCE_USAGE_PRESENT;
+                for (const auto& resource_usage : render_pass_desc.inputs)
+                {
+                    ASSERT_MSG((resource_usage.usage & graphics_only_usages) == 0, "Passes using render targets can't run on the async compute queue");
+                }
+                for (const auto& resource_usage : render_pass_desc.outputs)
+                {
+                    ASSERT_MSG((resource_usage.usage & graphics_only_usages) == 0, "Passes using render targets can't run on the async compute queue");
+                }
+            }
+
+            // TODO: Want to validate that the inputs/outputs have been registered
+            for (u32 i = 0; out_result.is_success() && i < render_pass_desc.inputs.size(); ++i)
+            {
+                const auto& input = render_pass_desc.inputs[i];
+                if (input.identifier == out_list->resource_context->get_backbuffer_id())
+                {
+                    out_result = Result{ StatusCodes::BACKBUFFER_READ, input.identifier };
+                }
+                else if (!resource_write_ledger.contains(input.identifier))
+                {
+                    out_result = Result{ StatusCodes::MISSING_OUTPUT, input.identifier };
+                }
+                else
+                {
+                    out_result = validate_usage(out_list->resource_context, input);
+                }
+            }
+
+            // TODO: Want to validate that the inputs/outputs have been registered
+            for (u32 i = 0; out_result.is_success() && i < render_pass_desc.outputs.size(); ++i)
+            {
+                const auto& output = render_pass_desc.outputs[i];
+                const bool is_backbuffer_output = output.identifier == out_list->resource_context->get_backbuffer_id();
+                const bool valid_backbuffer_use = output.type == PassResourceType::TEXTURE && output.usage == RESOURCE_USAGE_RENDER_TARGET;
+                if (is_backbuffer_output && !valid_backbuffer_use)
+                {
+                    out_result = Result{ StatusCodes::BACKBUFFER_USED_AS_NON_RT, output.identifier };
+                }
+                else if (!is_backbuffer_output) {
+                    out_result = validate_usage(out_list->resource_context, output);
+                }
+            }
+        }
+
+        if (out_result.is_success())
+        {
+            // If we've gotten this far, validation has succeeded
+            const u32 pass_index = out_list->passes.size();
+            out_result.pass_handle = { pass_index };
+            std::vector<ResourceSlot> resource_slots = {};
+            for (const auto& input : render_pass_desc.inputs)
+            {
+                resource_slots.push_back(out_list->resource_context->get_slot(input.identifier));
+            }
+            for (const auto& output : render_pass_desc.outputs)
+            {
+                resource_slots.push_back(out_list->resource_context->get_slot(output.identifier));
+            }
+            out_list->passes.push_back(RenderTaskList::Pass{
+                .desc = render_pass_desc,
+                .queue_type = render_pass_desc.command_queue_type,
+                .resource_slots = std::move(resource_slots),
+                .view_idx = view_idx,
+                .view_inputs = std::move(view_inputs),
+                .view_outputs = std::move(view_outputs),
+            });
+            out_list->dirty_stages = RenderTaskList::COMPILE_STAGE_ALL;
+
+            for (const auto& output : render_pass_desc.outputs)
+            {
+                // Record last that we're the last writer to this resource
+                resource_write_ledger[output.identifier] = pass_index;
+            }
+        }
+
+        return out_result;
+    }
+
+    void PassListBuilder::export_resource(const ResourceIdentifier id)
+    {
+        ASSERT(out_list->resource_context != nullptr);
+        ASSERT(out_list->resource_context->has_texture(id) || out_list->resource_context->has_buffer(id));
+        out_list->exported_resources.push_back(id);
+        out_list->dirty_stages = RenderTaskList::COMPILE_STAGE_ALL;
+    }
+
+    void PassListBuilder::set_pass_list(RenderTaskList* pass_list)
+    {
+        ASSERT(out_list == nullptr);
+        ASSERT(pass_list->passes.size() == 0);
+        out_list = pass_list;
+    }
+
+
+    void PassListBuilder::set_resource_context(ResourceContext* resource_context)
+    {
+        out_list->resource_context = resource_context;
+    }
+
+    void PassListBuilder::set_shader_store(PipelineStore* shader_store)
+    {
+        out_list->shader_store = shader_store;
+    }
+
+    RenderTaskList::RenderTaskList(ResourceContext* resource_context, PipelineStore* shader_store)
+        : resource_context{ resource_context }
+        , shader_store{ shader_store }
+        , settings_context{}
+        , per_pass_data_store{}
+    {}
+
+    void RenderTaskList::compile()
+    {
+        PROFILE_EVENT("Render Graph Compilation");
+        ASSERT(resource_context != nullptr);
+
+        if (resolved_handles_version != resource_context->get_handles_version())
+        {
+            dirty_stages |= COMPILE_STAGE_HANDLES;
+        }
+        if ((dirty_stages & COMPILE_STAGE_PASSES) && compile_passes())
+        {
+            dirty_stages |= COMPILE_STAGE_BARRIERS;
+        }
+        if (dirty_stages & COMPILE_STAGE_BARRIERS)
+        {
+            compile_barriers();
+            dirty_stages |= COMPILE_STAGE_HANDLES;
+        }
+        if (dirty_stages & COMPILE_STAGE_HANDLES)
+        {
+            resolve_handles();
+        }
+        dirty_stages = 0;
+    }
+
+    u64 RenderTaskList::get_compile_hash() const
+    {
+        ASSERT(resource_context != nullptr);
+        u64 hash = k_hash_seed;
+        hash_value(hash, k_compiled_graph_version);
+        hash_value(hash, resource_context->get_compile_hash());
+        hash_value(hash, async_compute_enabled);
+        for (const ResourceIdentifier id : exported_resources)
+        {
+            hash_value(hash, id);
+        }
+        const auto hash_resource_usage = [&](const PassResourceUsage& resource_usage)
+        {
+            hash_value(hash, resource_usage.identifier);
+            hash_value(hash, resource_usage.type);
+            hash_value(hash, resource_usage.usage);
+            hash_value(hash, resource_usage.mip_level);
+            hash_value(hash, resource_usage.array_slice);
+            hash_value(hash, resource_usage.byte_offset);
+            hash_value(hash, resource_usage.byte_size);
+            hash_value(hash, resource_usage.independent_writes);
+            hash_value(hash, resource_usage.contents);
+            hash_value(hash, resource_usage.clear_value);
+        };
+        for (const Pass& pass : passes)
+        {
+            hash_value(hash, pass.enabled);
+            hash_value(hash, pass.view_idx);
+            hash_bytes(hash, pass.desc.name.data(), pass.desc.name.size());
+            hash_value(hash, pass.desc.command_queue_type);
+            hash_value(hash, pass.desc.allow_async_compute);
+            hash_value(hash, u32(pass.desc.inputs.size()));
+            hash_value(hash, u32(pass.desc.outputs.size()));
+            for (const PassResourceUsage& input : pass.desc.inputs)
+            {
+                hash_resource_usage(input);
+            }
+            for (const PassResourceUsage& output : pass.desc.outputs)
+            {
+                hash_resource_usage(output);
+            }
+        }
+        return hash;
+    }
+
+    std::vector<u8> RenderTaskList::serialize_compiled() const
+    {
+        ASSERT_MSG((dirty_stages & (COMPILE_STAGE_PASSES | COMPILE_STAGE_BARRIERS)) == 0, "The list has to be compiled before it can be serialized");
+        static_assert(std::is_trivially_copyable_v<CompiledPass> && std::is_trivially_copyable_v<CompiledBarrier>);
+        static_assert(std::is_trivially_copyable_v<CompiledResource> && std::is_trivially_copyable_v<CompiledAttachment>);
+
+        std::vector<u8> data = {};
+        BlobWriter writer{ data };
+        writer.write(k_compiled_graph_magic);
+        writer.write(k_compiled_graph_version);
+        writer.write(get_compile_hash());
+
+        std::vector<CommandQueueType> queue_types = {};
+        for (const Pass& pass : passes)
+        {
+            queue_types.push_back(pass.queue_type);
+        }
+        std::vector<ResourceLifetime> lifetimes = {};
+        for (const CompiledResource& compiled_resource : compiled_resources)
+        {
+            lifetimes.push_back(resource_context->get_lifetime(compiled_resource.identifier));
+        }
+
+        writer.write_array<CommandQueueType>(queue_types);
+        writer.write_array<CompiledPass>(compiled_passes);
+        writer.write_array<CompiledResource>(compiled_resources);
+        writer.write_array<ResourceLifetime>(lifetimes);
+        writer.write_array<CompiledBarrier>(frame_transitions);
+        writer.write_array<CompiledBarrier>(frame_uav_barriers);
+        writer.write_array<CompiledBarrier>(frame_aliasing_barriers);
+        writer.write_array<ResourceSlot>(pass_resource_slots);
+        writer.write_array<CompiledAttachment>(compiled_attachments);
+        writer.write_array<TransientResourceLifetime>(resource_context->get_transient_lifetimes());
+        writer.write(num_elided_uav_barriers);
+        return data;
+    }
+
+    bool RenderTaskList::load_compiled(const std::span<const u8> data)
+    {
+        ASSERT(resource_context != nullptr);
+        BlobReader reader{ data };
+        u32 magic = 0;
+        u32 version = 0;
+        u64 hash = 0;
+        if (!reader.read(magic) || magic != k_compiled_graph_magic
+            || !reader.read(version) || version != k_compiled_graph_version
+            || !reader.read(hash) || hash != get_compile_hash())
+        {
+            return false;
+        }
+
+        std::vector<CommandQueueType> queue_types = {};
+        std::vector<CompiledPass> loaded_passes = {};
+        std::vector<CompiledResource> loaded_resources = {};
+        std::vector<ResourceLifetime> lifetimes = {};
+        std::vector<CompiledBarrier> loaded_transitions = {};
+        std::vector<CompiledBarrier> loaded_uav_barriers = {};
+        std::vector<CompiledBarrier> loaded_aliasing_barriers = {};
+        std::vector<ResourceSlot> loaded_resource_slots = {};
+        std::vector<CompiledAttachment> loaded_attachments = {};
+        std::vector<TransientResourceLifetime> loaded_transient_lifetimes = {};
+        u32 loaded_num_elided_uav_barriers = 0;
+        reader.read_array(queue_types);
+        reader.read_array(loaded_passes);
+        reader.read_array(loaded_resources);
+        reader.read_array(lifetimes);
+        reader.read_array(loaded_transitions);
+        reader.read_array(loaded_uav_barriers);
+        reader.read_array(loaded_aliasing_barriers);
+        reader.read_array(loaded_resource_slots);
+        reader.read_array(loaded_attachments);
+        reader.read_array(loaded_transient_lifetimes);
+        reader.read(loaded_num_elided_uav_barriers);
+        if (!reader.is_complete() || queue_types.size() != passes.size() || lifetimes.size() != loaded_resources.size())
+        {
+            return false;
+        }
+
+        // The hash matching means the data was written for this list, but it's still checked for anything that would
+        // index out of bounds, in case it got corrupted
+        const auto is_valid_range = [](const u32 offset, const u32 count, const size_t size) { return u64(offset) + count <= size; };
+        for (const CompiledPass& compiled_pass : loaded_passes)
+        {
+            const bool is_valid = compiled_pass.pass_idx < passes.size()
+                && (compiled_pass.wait_on_pass == UINT32_MAX || compiled_pass.wait_on_pass < loaded_passes.size())
+                && is_valid_range(compiled_pass.transitions_offset, compiled_pass.num_transitions, loaded_transitions.size())
+                && is_valid_range(compiled_pass.after_transitions_offset, compiled_pass.num_after_transitions, loaded_transitions.size())
+                && is_valid_range(compiled_pass.uav_barriers_offset, compiled_pass.num_uav_barriers, loaded_uav_barriers.size())
+                && is_valid_range(compiled_pass.aliasing_barriers_offset, compiled_pass.num_aliasing_barriers, loaded_aliasing_barriers.size())
+                && is_valid_range(compiled_pass.attachments_offset, compiled_pass.num_attachments, loaded_attachments.size())
+                && is_valid_range(compiled_pass.resources_offset, u32(passes[compiled_pass.pass_idx].resource_slots.size()), loaded_resource_slots.size());
+            if (!is_valid)
+            {
+                return false;
+            }
+        }
+        for (const std::vector<CompiledBarrier>* barriers : { &loaded_transitions, &loaded_uav_barriers, &loaded_aliasing_barriers })
+        {
+            for (const CompiledBarrier& barrier : *barriers)
+            {
+                if (barrier.resource_idx >= loaded_resources.size())
+                {
+                    return false;
+                }
+            }
+        }
+        for (const CompiledResource& compiled_resource : loaded_resources)
+        {
+            if (resource_context->get_slot(compiled_resource.identifier) != compiled_resource.slot)
+            {
+                return false;
+            }
+        }
+        for (const CompiledAttachment& attachment : loaded_attachments)
+        {
+            if (attachment.resolved_idx >= loaded_resource_slots.size())
+            {
+                return false;
+            }
+        }
+        for (const TransientResourceLifetime& lifetime : loaded_transient_lifetimes)
+        {
+            if (!resource_context->is_transient(lifetime.identifier))
+            {
+                return false;
+            }
+        }
+
+        for (size_t pass_idx = 0; pass_idx < passes.size(); pass_idx++)
+        {
+            passes[pass_idx].queue_type = queue_types[pass_idx];
+        }
+        compiled_passes = std::move(loaded_passes);
+        compiled_resources = std::move(loaded_resources);
+        compiled_resource_indices.clear();
+        for (u32 resource_idx = 0; resource_idx < compiled_resources.size(); resource_idx++)
+        {
+            compiled_resource_indices.insert({ compiled_resources[resource_idx].identifier, resource_idx });
+        }
+        frame_transitions = std::move(loaded_transitions);
+        frame_uav_barriers = std::move(loaded_uav_barriers);
+        frame_aliasing_barriers = std::move(loaded_aliasing_barriers);
+        pass_resource_slots = std::move(loaded_resource_slots);
+        compiled_attachments = std::move(loaded_attachments);
+        num_elided_uav_barriers = loaded_num_elided_uav_barriers;
+
+        // Lifetimes before placement, since they decide which heaps the transient resources go in
+        const ResourceIdentifier backbuffer_id = resource_context->get_backbuffer_id();
+        for (size_t resource_idx = 0; resource_idx < compiled_resources.size(); resource_idx++)
+        {
+            if (compiled_resources[resource_idx].identifier != backbuffer_id)
+            {
+                resource_context->set_inferred_lifetime(compiled_resources[resource_idx].identifier, lifetimes[resource_idx]);
+            }
+        }
+        resource_context->place_transient_resources(loaded_transient_lifetimes);
+
+        dirty_stages = COMPILE_STAGE_HANDLES;
+        return true;
+    }
+
+    bool RenderTaskList::compile_passes()
+    {
+        compile_stats.num_pass_compiles++;
+        const ResourceIdentifier backbuffer_id = resource_context->get_backbuffer_id();
+        const u32 num_passes = u32(passes.size());
+
+        // What we had before, so that everything further down can be skipped if nothing changes
+        const std::vector<CompiledPass> previous_compiled_passes = std::move(compiled_passes);
+        std::vector<CommandQueueType> previous_queues = {};
+        for (const CompiledPass& compiled_pass : previous_compiled_passes)
+        {
+            previous_queues.push_back(passes[compiled_pass.pass_idx].queue_type);
+        }
+
+        // Dependencies between enabled passes. Passes were validated in the order they were added, which is also the
+        // order that accesses to the same resource have to happen in.
+        struct ResourceAccesses
+        {
+            u32 last_writer = UINT32_MAX;
+            std::vector<u32> readers_since_last_write = {};
+        };
+        std::unordered_map<ResourceIdentifier, ResourceAccesses> resource_accesses = {};
+        // Every pass that has to finish before this one starts
+        std::vector<std::vector<u32>> predecessors(num_passes);
+        // Only the passes that produce contents this one relies on. Outputs are treated as read-modify-write
+        // since, for instance, the forward pass draws on top of the background pass' output.
+        std::vector<std::vector<u32>> producers(num_passes);
+
+        for (u32 pass_idx = 0; pass_idx < num_passes; ++pass_idx)
+        {
+            const Pass& pass = passes[pass_idx];
+            if (!pass.enabled)
+            {
+                continue;
+            }
+
+            for (const auto& input : pass.desc.inputs)
+            {
+                ResourceAccesses& accesses = resource_accesses[input.identifier];
+                if (accesses.last_writer != UINT32_MAX)
+                {
+                    predecessors[pass_idx].push_back(accesses.last_writer);
+                    producers[pass_idx].push_back(accesses.last_writer);
+                }
+                accesses.readers_since_last_write.push_back(pass_idx);
+            }
+
+            for (const auto& output : pass.desc.outputs)
+            {
+                ResourceAccesses& accesses = resource_accesses[output.identifier];
+                if (accesses.last_writer != UINT32_MAX)
+                {
+                    predecessors[pass_idx].push_back(accesses.last_writer);
+                    producers[pass_idx].push_back(accesses.last_writer);
+                }
+                for (const u32 reader : accesses.readers_since_last_write)
+                {
+                    if (reader != pass_idx)
+                    {
+                        predecessors[pass_idx].push_back(reader);
+                    }
+                }
+                accesses.last_writer = pass_idx;
+                accesses.readers_since_last_write.clear();
+            }
+        }
+
+        // Cull passes whose outputs never make it to the backbuffer or an exported resource
+        std::vector<bool> is_live(num_passes, false);
+        std::vector<u32> live_stack = {};
+        for (u32 pass_idx = 0; pass_idx < num_passes; ++pass_idx)
+        {
+            if (!passes[pass_idx].enabled)
+            {
+                continue;
+            }
+            for (const auto& output : passes[pass_idx].desc.outputs)
+            {
+                const bool is_exported = std::find(exported_resources.begin(), exported_resources.end(), output.identifier) != exported_resources.end();
+                if (output.identifier == backbuffer_id || is_exported)
+                {
+                    is_live[pass_idx] = true;
+                    live_stack.push_back(pass_idx);
+                    break;
+                }
+            }
+        }
+        while (!live_stack.empty())
+        {
+            const u32 pass_idx = live_stack.back();
+            live_stack.pop_back();
+            for (const u32 producer : producers[pass_idx])
+            {
+                if (!is_live[producer])
+                {
+                    is_live[producer] = true;
+                    live_stack.push_back(producer);
+                }
+            }
+        }
+
+        // Topological sort of the live passes. Ties go to whichever pass was added first, so the order only differs from
+        // the order passes were added in where dependencies require it.
+        std::vector<u32> num_pending_predecessors(num_passes, 0);
+        std::vector<std::vector<u32>> successors(num_passes);
+        for (u32 pass_idx = 0; pass_idx < num_passes; ++pass_idx)
+        {
+            std::vector<u32>& pass_predecessors = predecessors[pass_idx];
+            std::sort(pass_predecessors.begin(), pass_predecessors.end());
+            pass_predecessors.erase(std::unique(pass_predecessors.begin(), pass_predecessors.end()), pass_predecessors.end());
+            if (!is_live[pass_idx])
+            {
+                continue;
+            }
+            for (const u32 predecessor : pass_predecessors)
+            {
+                if (is_live[predecessor])
+                {
+                    successors[predecessor].push_back(pass_idx);
+                    num_pending_predecessors[pass_idx]++;
+                }
+            }
+        }
+
+        std::priority_queue<u32, std::vector<u32>, std::greater<u32>> ready_passes = {};
+        for (u32 pass_idx = 0; pass_idx < num_passes; ++pass_idx)
+        {
+            if (is_live[pass_idx] && num_pending_predecessors[pass_idx] == 0)
+            {
+                ready_passes.push(pass_idx);
+            }
+        }
+
+        compiled_passes.clear();
+        std::vector<u32> compiled_indices(num_passes, UINT32_MAX);
+        while (!ready_passes.empty())
+        {
+            const u32 pass_idx = ready_passes.top();
+            ready_passes.pop();
+            compiled_indices[pass_idx] = u32(compiled_passes.size());
+            compiled_passes.push_back({ .pass_idx = pass_idx });
+            for (const u32 successor : successors[pass_idx])
+            {
+                if (--num_pending_predecessors[successor] == 0)
+                {
+                    ready_passes.push(successor);
+                }
+            }
+        }
+
+        // Queue assignment. Passes that allow it go on the async compute queue when there's graphics work they can overlap
+        // with, that is a graphics pass that neither depends on them nor is depended on by them. Otherwise moving them
+        // would only add synchronization.
+        const size_t num_compiled_passes = compiled_passes.size();
+        std::vector<std::vector<bool>> is_ancestor(num_compiled_passes, std::vector<bool>(num_compiled_passes, false));
+        for (u32 compiled_idx = 0; compiled_idx < num_compiled_passes; ++compiled_idx)
+        {
+            std::vector<bool>& ancestors = is_ancestor[compiled_idx];
+            for (const u32 predecessor : predecessors[compiled_passes[compiled_idx].pass_idx])
+            {
+                const u32 compiled_predecessor = compiled_indices[predecessor];
+                if (compiled_predecessor == UINT32_MAX)
+                {
+                    continue;
+                }
+                ancestors[compiled_predecessor] = true;
+                for (u32 i = 0; i < compiled_predecessor; ++i)
+                {
+                    if (is_ancestor[compiled_predecessor][i])
+                    {
+                        ancestors[i] = true;
+                    }
+                }
+            }
+        }
+
+        for (u32 compiled_idx = 0; compiled_idx < num_compiled_passes; ++compiled_idx)
+        {
+            Pass& pass = passes[compiled_passes[compiled_idx].pass_idx];
+            pass.queue_type = pass.desc.command_queue_type;
+            if (!async_compute_enabled || !pass.desc.allow_async_compute || pass.queue_type != CommandQueueType::GRAPHICS)
+            {
+                continue;
+            }
+            for (u32 other_idx = 0; other_idx < num_compiled_passes; ++other_idx)
+            {
+                const PassDesc& other_desc = passes[compiled_passes[other_idx].pass_idx].desc;
+                const bool is_graphics_work = other_desc.command_queue_type == CommandQueueType::GRAPHICS && !other_desc.allow_async_compute;
+                const bool is_independent = !is_ancestor[compiled_idx][other_idx] && !is_ancestor[other_idx][compiled_idx];
+                if (other_idx != compiled_idx && is_graphics_work && is_independent)
+                {
+                    pass.queue_type = CommandQueueType::ASYNC_COMPUTE;
+                    break;
+                }
+            }
+        }
+
+        // Cross queue waits. Queues execute in order, so a pass already runs after everything the previous pass on its
+        // queue ran after, plus everything the pass it waits on ran after. Tracking that per queue lets us skip the
+        // predecessors on other queues that earlier waits already order it after.
+        constexpr size_t NUM_QUEUES = size_t(CommandQueueType::NUM_COMMAND_CONTEXT_POOLS);
+        // Per compiled pass and queue: one past the latest pass on that queue it's known to run after
+        std::vector<std::array<u32, NUM_QUEUES>> synced_until(num_compiled_passes);
+        u32 last_on_queue[NUM_QUEUES] = {};
+        std::fill(std::begin(last_on_queue), std::end(last_on_queue), UINT32_MAX);
+        for (u32 compiled_idx = 0; compiled_idx < num_compiled_passes; ++compiled_idx)
+        {
+            CompiledPass& compiled_pass = compiled_passes[compiled_idx];
+            const size_t queue = size_t(passes[compiled_pass.pass_idx].queue_type);
+            std::array<u32, NUM_QUEUES>& synced = synced_until[compiled_idx];
+            synced.fill(0);
+            if (last_on_queue[queue] != UINT32_MAX)
+            {
+                synced = synced_until[last_on_queue[queue]];
+            }
+            synced[queue] = compiled_idx;
+
+            for (const u32 predecessor : predecessors[compiled_pass.pass_idx])
+            {
+                const u32 compiled_predecessor = compiled_indices[predecessor];
+                if (compiled_predecessor == UINT32_MAX)
+                {
+                    continue;
+                }
+                const size_t predecessor_queue = size_t(passes[predecessor].queue_type);
+                if (predecessor_queue != queue && compiled_predecessor >= synced[predecessor_queue])
+                {
+                    if (compiled_pass.wait_on_pass == UINT32_MAX || compiled_pass.wait_on_pass < compiled_predecessor)
+                    {
+                        compiled_pass.wait_on_pass = compiled_predecessor;
+                    }
+                }
+            }
+
+            if (compiled_pass.wait_on_pass != UINT32_MAX)
+            {
+                const std::array<u32, NUM_QUEUES>& waited_on_synced = synced_until[compiled_pass.wait_on_pass];
+                for (size_t i = 0; i < NUM_QUEUES; i++)
+                {
+                    synced[i] = std::max(synced[i], waited_on_synced[i]);
+                }
+                const size_t wait_queue = size_t(passes[compiled_passes[compiled_pass.wait_on_pass].pass_idx].queue_type);
+                synced[wait_queue] = std::max(synced[wait_queue], compiled_pass.wait_on_pass + 1);
+            }
+            last_on_queue[queue] = compiled_idx;
+        }
+
+        bool changed = compiled_passes.size() != previous_compiled_passes.size();
+        for (size_t i = 0; !changed && i < compiled_passes.size(); i++)
+        {
+            changed = compiled_passes[i].pass_idx != previous_compiled_passes[i].pass_idx
+                || compiled_passes[i].wait_on_pass != previous_compiled_passes[i].wait_on_pass
+                || passes[compiled_passes[i].pass_idx].queue_type != previous_queues[i];
+        }
+        if (!changed)
+        {
+            // Keeps the ranges into everything the later stages produced
+            compiled_passes = previous_compiled_passes;
+        }
+        return changed;
+    }
+
+    void RenderTaskList::compile_barriers()
+    {
+        compile_stats.num_barrier_compiles++;
+        const ResourceIdentifier backbuffer_id = resource_context->get_backbuffer_id();
+
+        // Resources used by the compiled passes. Apart from the backbuffer, which is presented, resources are left in the
+        // state of their last use so that the next frame's transitions can pick up from there.
+        compiled_resources.clear();
+        compiled_resource_indices.clear();
+        const auto get_compiled_resource_idx = [&](const ResourceIdentifier id) -> u32
+        {
+            const auto [it, inserted] = compiled_resource_indices.insert({ id, u32(compiled_resources.size()) });
+            if (inserted)
+            {
+                compiled_resources.push_back({ .identifier = id, .slot = resource_context->get_slot(id) });
+            }
+            return it->second;
+        };
+
+        const u32 backbuffer_idx = get_compiled_resource_idx(backbuffer_id);
+        for (const CompiledPass& compiled_pass : compiled_passes)
+        {
+            const PassDesc& desc = passes[compiled_pass.pass_idx].desc;
+            const CommandQueueType queue_type = passes[compiled_pass.pass_idx].queue_type;
+            for (const auto& input : desc.inputs)
+            {
+                compiled_resources[get_compiled_resource_idx(input.identifier)].frame_state = { input.usage, queue_type };
+            }
+            for (const auto& output : desc.outputs)
+            {
+                compiled_resources[get_compiled_resource_idx(output.identifier)].frame_state = { output.usage, queue_type };
+            }
+        }
+        compiled_resources[backbuffer_idx].frame_state = { RESOURCE_USAGE_PRESENT, CommandQueueType::GRAPHICS };
+
+        // Only keep a copy per in-flight frame where one frame's use of a resource could overlap the next one's: when
+        // it's used on more than one queue, or when it's used outside of the list after the frame is done
+        std::vector<u32> queues_used(compiled_resources.size(), 0);
+        for (const CompiledPass& compiled_pass : compiled_passes)
+        {
+            const PassDesc& desc = passes[compiled_pass.pass_idx].desc;
+            const CommandQueueType queue_type = passes[compiled_pass.pass_idx].queue_type;
+            for (const auto& input : desc.inputs)
+            {
+                queues_used[compiled_resource_indices.at(input.identifier)] |= 1 << u32(queue_type);
+            }
+            for (const auto& output : desc.outputs)
+            {
+                queues_used[compiled_resource_indices.at(output.identifier)] |= 1 << u32(queue_type);
+            }
+        }
+        for (u32 resource_idx = 0; resource_idx < compiled_resources.size(); ++resource_idx)
+        {
+            const ResourceIdentifier id = compiled_resources[resource_idx].identifier;
+            if (resource_idx == backbuffer_idx)
+            {
+                continue;
+            }
+            ResourceLifetime lifetime = ResourceLifetime::SINGLE;
+            if (std::find(exported_resources.begin(), exported_resources.end(), id) != exported_resources.end())
+            {
+                lifetime = ResourceLifetime::HISTORY;
+            }
+            else if ((queues_used[resource_idx] & (queues_used[resource_idx] - 1)) != 0)
+            {
+                lifetime = ResourceLifetime::PER_FRAME;
+            }
+            resource_context->set_inferred_lifetime(id, lifetime);
+        }
+
+        // Transient resources only need memory from their first to their last use. Queues run alongside one another
+        // though, so anything used outside of the graphics queue is treated as being alive for the whole frame.
+        std::vector<TransientResourceLifetime> transient_lifetimes = {};
+        std::vector<u32> transient_lifetime_indices(compiled_resources.size(), UINT32_MAX);
+        std::vector<PassResourceType> transient_types(compiled_resources.size(), PassResourceType::INVALID);
+        std::vector<bool> used_outside_graphics_queue = {};
+        for (u32 compiled_idx = 0; compiled_idx < compiled_passes.size(); ++compiled_idx)
+        {
+            const PassDesc& desc = passes[compiled_passes[compiled_idx].pass_idx].desc;
+            const CommandQueueType queue_type = passes[compiled_passes[compiled_idx].pass_idx].queue_type;
+            const auto extend_lifetime = [&](const PassResourceUsage& resource_usage)
+            {
+                if (!resource_context->is_transient(resource_usage.identifier))
+                {
+                    return;
+                }
+                const u32 resource_idx = compiled_resource_indices.at(resource_usage.identifier);
+                u32& lifetime_idx = transient_lifetime_indices[resource_idx];
+                if (lifetime_idx == UINT32_MAX)
+                {
+                    lifetime_idx = u32(transient_lifetimes.size());
+                    transient_lifetimes.push_back({ .identifier = resource_usage.identifier, .first_use = compiled_idx });
+                    transient_types[resource_idx] = resource_usage.type;
+                    used_outside_graphics_queue.push_back(false);
+                }
+                transient_lifetimes[lifetime_idx].last_use = compiled_idx;
+                if (queue_type != CommandQueueType::GRAPHICS)
+                {
+                    used_outside_graphics_queue[lifetime_idx] = true;
+                }
+            };
+            for (const auto& input : desc.inputs)
+            {
+                extend_lifetime(input);
+            }
+            for (const auto& output : desc.outputs)
+            {
+                extend_lifetime(output);
+            }
+        }
+        for (size_t i = 0; i < transient_lifetimes.size(); i++)
+        {
+            if (used_outside_graphics_queue[i])
+            {
+                transient_lifetimes[i].first_use = 0;
+                transient_lifetimes[i].last_use = u32(compiled_passes.size() - 1);
+            }
+            else if (resource_context->get_lifetime(transient_lifetimes[i].identifier) == ResourceLifetime::HISTORY)
+            {
+                // Its contents are still needed once the frame is done
+                transient_lifetimes[i].last_use = u32(compiled_passes.size() - 1);
+            }
+        }
+        resource_context->place_transient_resources(transient_lifetimes);
+
+        // Resources sharing memory need an aliasing barrier before they're first used each frame
+        std::vector<std::vector<u32>> activated_resources(compiled_passes.size());
+        for (u32 resource_idx = 0; resource_idx < compiled_resources.size(); ++resource_idx)
+        {
+            const u32 lifetime_idx = transient_lifetime_indices[resource_idx];
+            if (lifetime_idx != UINT32_MAX && resource_context->is_aliased(compiled_resources[resource_idx].identifier))
+            {
+                activated_resources[transient_lifetimes[lifetime_idx].first_use].push_back(resource_idx);
+            }
+        }
+
+        // Walk the passes in order, recording the transitions and UAV barriers each one needs. Textures that some pass
+        // only uses a mip level or array slice of are tracked per subresource, everything else as a whole.
+        struct SubresourceState
+        {
+            BarrierState barrier_state = {};
+            // Compiled index of the last pass that used the subresource this frame
+            u32 last_use = UINT32_MAX;
+        };
+        struct ByteRange
+        {
+            u64 begin;
+            u64 end;
+        };
+        struct TrackedResource
+        {
+            u32 num_mips = 1;
+            // Either a single state for the whole resource or one per subresource, indexed by mip + slice * num_mips
+            std::vector<SubresourceState> states = {};
+            // Compute writes since the resource's last barrier, which a later compute writable use has to wait on if it overlaps them
+            std::vector<ByteRange> unsynchronized_writes = {};
+        };
+        constexpr ByteRange whole_resource = { 0, UINT64_MAX };
+        std::vector<TrackedResource> tracked_resources(compiled_resources.size());
+        for (size_t i = 0; i < compiled_resources.size(); i++)
+        {
+            tracked_resources[i].states.push_back({ .barrier_state = compiled_resources[i].frame_state });
+            if (compiled_resources[i].frame_state.resource_usage == RESOURCE_USAGE_COMPUTE_WRITABLE)
+            {
+                // Written to by the previous frame, for all we know
+                tracked_resources[i].unsynchronized_writes.push_back(whole_resource);
+            }
+        }
+        num_elided_uav_barriers = 0;
+        for (const CompiledPass& compiled_pass : compiled_passes)
+        {
+            const PassDesc& desc = passes[compiled_pass.pass_idx].desc;
+            const auto track_subresources = [&](const PassResourceUsage& resource_usage)
+            {
+                if (resource_usage.mip_level == k_all_subresources && resource_usage.array_slice == k_all_subresources)
+                {
+                    return;
+                }
+                TrackedResource& tracked = tracked_resources[compiled_resource_indices.at(resource_usage.identifier)];
+                if (tracked.states.size() == 1)
+                {
+                    ASSERT(resource_usage.type == PassResourceType::TEXTURE);
+                    const TextureInfo& texture_info = gfx::textures::get_texture_info(resource_context->get_texture(resource_usage.identifier, 0));
+                    tracked.num_mips = texture_info.num_mips;
+                    tracked.states.resize(size_t(texture_info.num_mips) * texture_info.array_size, tracked.states[0]);
+                }
+            };
+            for (const auto& input : desc.inputs)
+            {
+                track_subresources(input);
+            }
+            for (const auto& output : desc.outputs)
+            {
+                track_subresources(output);
+            }
+        }
+
+        // Previous pass on the same queue, so that we know whether a transition has idle passes it can be split across
+        std::vector<u32> previous_on_queue(compiled_passes.size(), UINT32_MAX);
+        {
+            u32 last_on_queue[size_t(CommandQueueType::NUM_COMMAND_CONTEXT_POOLS)] = {};
+            std::fill(std::begin(last_on_queue), std::end(last_on_queue), UINT32_MAX);
+            for (u32 compiled_idx = 0; compiled_idx < compiled_passes.size(); ++compiled_idx)
+            {
+                const size_t queue = size_t(passes[compiled_passes[compiled_idx].pass_idx].queue_type);
+                previous_on_queue[compiled_idx] = last_on_queue[queue];
+                last_on_queue[queue] = compiled_idx;
+            }
+        }
+
+        // Transitions recorded before each pass' work, and after it: the first halves of split barriers, putting
+        // subresources back into the same state at the end of the frame, and the backbuffer's transition to PRESENT.
+        std::vector<std::vector<CompiledBarrier>> transitions_before(compiled_passes.size());
+        std::vector<std::vector<CompiledBarrier>> transitions_after(compiled_passes.size());
+        std::vector<CompiledBarrier>& uav_barriers = frame_uav_barriers;
+        std::vector<CompiledBarrier>& aliasing_barriers = frame_aliasing_barriers;
+        uav_barriers.clear();
+        aliasing_barriers.clear();
+
+        for (u32 compiled_idx = 0; compiled_idx < compiled_passes.size(); ++compiled_idx)
+        {
+            CompiledPass& compiled_pass = compiled_passes[compiled_idx];
+            const PassDesc& desc = passes[compiled_pass.pass_idx].desc;
+            const CommandQueueType queue_type = passes[compiled_pass.pass_idx].queue_type;
+            compiled_pass.uav_barriers_offset = u32(uav_barriers.size());
+            compiled_pass.aliasing_barriers_offset = u32(aliasing_barriers.size());
+
+            const auto add_barriers = [&](const PassResourceUsage& resource_usage)
+            {
+                const u32 resource_idx = compiled_resource_indices.at(resource_usage.identifier);
+                TrackedResource& tracked = tracked_resources[resource_idx];
+                bool needs_uav_barrier = false;
+
+                // Moves a group of subresources sharing the same state into the one this pass needs
+                const auto use = [&](SubresourceState& state, const u32 mip_level, const u32 array_slice)
+                {
+                    BarrierState& barrier_state = state.barrier_state;
+                    // Transitions act as UAV barriers too, but only for the subresources they cover
+                    const bool synchronizes_writes = mip_level == k_all_subresources && array_slice == k_all_subresources;
+                    if (barrier_state.queue_type != queue_type)
+                    {
+                        // Don't need to insert resource barriers if we're using the resource between queues, the GPU wait takes care of it
+                        barrier_state = { resource_usage.usage, queue_type };
+                        if (synchronizes_writes)
+                        {
+                            tracked.unsynchronized_writes.clear();
+                        }
+                    }
+                    else if (barrier_state.resource_usage != resource_usage.usage)
+                    {
+                        if (synchronizes_writes)
+                        {
+                            tracked.unsynchronized_writes.clear();
+                        }
+                        CompiledBarrier transition = { resource_idx, resource_usage.type, barrier_state.resource_usage, resource_usage.usage, mip_level, array_slice };
+                        // Passes on this queue in between the last use and this one have nothing to do with the resource,
+                        // so the transition can happen while they run
+                        const u32 previous = previous_on_queue[compiled_idx];
+                        if (state.last_use != UINT32_MAX && previous != UINT32_MAX && previous > state.last_use)
+                        {
+                            transition.split = SplitBarrier::BEGIN;
+                            transitions_after[state.last_use].push_back(transition);
+                            transition.split = SplitBarrier::END;
+                        }
+                        transitions_before[compiled_idx].push_back(transition);
+                        barrier_state.resource_usage = resource_usage.usage;
+                    }
+                    else if (resource_usage.usage == RESOURCE_USAGE_COMPUTE_WRITABLE)
+                    {
+                        needs_uav_barrier = true;
+                    }
+                    state.last_use = compiled_idx;
+                };
+
+                const bool is_whole_resource = resource_usage.mip_level == k_all_subresources && resource_usage.array_slice == k_all_subresources;
+                bool is_uniform = true;
+                for (const SubresourceState& state : tracked.states)
+                {
+                    is_uniform = is_uniform && state.barrier_state == tracked.states[0].barrier_state;
+                }
+                if (is_whole_resource && is_uniform)
+                {
+                    // A single barrier covers every subresource, which has to wait for whichever was used last
+                    SubresourceState state = tracked.states[0];
+                    for (const SubresourceState& subresource_state : tracked.states)
+                    {
+                        if (state.last_use == UINT32_MAX || (subresource_state.last_use != UINT32_MAX && subresource_state.last_use > state.last_use))
+                        {
+                            state.last_use = subresource_state.last_use;
+                        }
+                    }
+                    use(state, k_all_subresources, k_all_subresources);
+                    std::fill(tracked.states.begin(), tracked.states.end(), state);
+                }
+                else
+                {
+                    const u32 num_mips = tracked.num_mips;
+                    const u32 array_size = u32(tracked.states.size()) / num_mips;
+                    const u32 first_mip = resource_usage.mip_level == k_all_subresources ? 0 : resource_usage.mip_level;
+                    const u32 last_mip = resource_usage.mip_level == k_all_subresources ? num_mips : first_mip + 1;
+                    const u32 first_slice = resource_usage.array_slice == k_all_subresources ? 0 : resource_usage.array_slice;
+                    const u32 last_slice = resource_usage.array_slice == k_all_subresources ? array_size : first_slice + 1;
+                    ASSERT(last_mip <= num_mips && last_slice <= array_size);
+                    for (u32 slice = first_slice; slice < last_slice; slice++)
+                    {
+                        for (u32 mip = first_mip; mip < last_mip; mip++)
+                        {
+                            use(tracked.states[mip + slice * num_mips], mip, slice);
+                        }
+                    }
+                }
+
+                const ByteRange range = resource_usage.byte_size == 0
+                    ? whole_resource
+                    : ByteRange{ resource_usage.byte_offset, resource_usage.byte_offset + resource_usage.byte_size };
+                if (needs_uav_barrier)
+                {
+                    bool overlaps_earlier_writes = false;
+                    for (const ByteRange& write : tracked.unsynchronized_writes)
+                    {
+                        overlaps_earlier_writes = overlaps_earlier_writes || (write.begin < range.end && range.begin < write.end);
+                    }
+                    if (resource_usage.independent_writes || !overlaps_earlier_writes)
+                    {
+                        num_elided_uav_barriers++;
+                    }
+                    else
+                    {
+                        uav_barriers.push_back({ resource_idx, resource_usage.type, resource_usage.usage, resource_usage.usage });
+                        tracked.unsynchronized_writes.clear();
+                    }
+                }
+                if (resource_usage.usage == RESOURCE_USAGE_COMPUTE_WRITABLE)
+                {
+                    tracked.unsynchronized_writes.push_back(range);
+                }
+            };
+            for (const auto& input : desc.inputs)
+            {
+                add_barriers(input);
+            }
+            for (const auto& output : desc.outputs)
+            {
+                add_barriers(output);
+            }
+
+            for (const u32 resource_idx : activated_resources[compiled_idx])
+            {
+                const ResourceUsage usage = tracked_resources[resource_idx].states[0].barrier_state.resource_usage;
+                aliasing_barriers.push_back({ resource_idx, transient_types[resource_idx], usage, usage });
+            }
+
+            compiled_pass.num_uav_barriers = u32(uav_barriers.size()) - compiled_pass.uav_barriers_offset;
+            compiled_pass.num_aliasing_barriers = u32(aliasing_barriers.size()) - compiled_pass.aliasing_barriers_offset;
+        }
+
+        // Resources are tracked as a whole between frames, so subresources left in another state than the resource's
+        // frame state are moved back into it after the resource's last use
+        for (u32 resource_idx = 0; resource_idx < tracked_resources.size(); ++resource_idx)
+        {
+            TrackedResource& tracked = tracked_resources[resource_idx];
+            if (tracked.states.size() == 1)
+            {
+                continue;
+            }
+            const BarrierState& frame_state = compiled_resources[resource_idx].frame_state;
+            u32 last_use = 0;
+            for (const SubresourceState& state : tracked.states)
+            {
+                last_use = state.last_use != UINT32_MAX ? std::max(last_use, state.last_use) : last_use;
+            }
+            for (u32 subresource = 0; subresource < tracked.states.size(); subresource++)
+            {
+                const BarrierState& barrier_state = tracked.states[subresource].barrier_state;
+                if (barrier_state.resource_usage != frame_state.resource_usage)
+                {
+                    ASSERT_MSG(barrier_state.queue_type == frame_state.queue_type, "Resources used a subresource at a time have to stay on a single queue");
+                    transitions_after[last_use].push_back({
+                        resource_idx,
+                        PassResourceType::TEXTURE,
+                        barrier_state.resource_usage,
+                        frame_state.resource_usage,
+                        subresource % tracked.num_mips,
+                        subresource / tracked.num_mips,
+                    });
+                }
+            }
+        }
+
+        // Recorded after the last pass to use the graphics queue, which is the one that wrote to the backbuffer
+        const BarrierState& backbuffer_state = tracked_resources[backbuffer_idx].states[0].barrier_state;
+        if (backbuffer_state.resource_usage != RESOURCE_USAGE_PRESENT)
+        {
+            ASSERT(backbuffer_state.resource_usage == RESOURCE_USAGE_RENDER_TARGET);
+            ASSERT(backbuffer_state.queue_type == CommandQueueType::GRAPHICS);
+            for (size_t i = compiled_passes.size(); i > 0; i--)
+            {
+                if (passes[compiled_passes[i - 1].pass_idx].queue_type == CommandQueueType::GRAPHICS)
+                {
+                    transitions_after[i - 1].push_back({ backbuffer_idx, PassResourceType::TEXTURE, RESOURCE_USAGE_RENDER_TARGET, RESOURCE_USAGE_PRESENT });
+                    break;
+                }
+            }
+        }
+
+        // Each pass' transitions end up as two contiguous batches, one on either side of its work
+        std::vector<CompiledBarrier>& transitions = frame_transitions;
+        transitions.clear();
+        for (u32 compiled_idx = 0; compiled_idx < compiled_passes.size(); ++compiled_idx)
+        {
+            CompiledPass& compiled_pass = compiled_passes[compiled_idx];
+            compiled_pass.transitions_offset = u32(transitions.size());
+            compiled_pass.num_transitions = u32(transitions_before[compiled_idx].size());
+            transitions.insert(transitions.end(), transitions_before[compiled_idx].begin(), transitions_before[compiled_idx].end());
+            compiled_pass.after_transitions_offset = u32(transitions.size());
+            compiled_pass.num_after_transitions = u32(transitions_after[compiled_idx].size());
+            transitions.insert(transitions.end(), transitions_after[compiled_idx].begin(), transitions_after[compiled_idx].end());
+        }
+
+        // Each pass' inputs and outputs, resolved for every in-flight frame by resolve_handles()
+        pass_resource_slots.clear();
+        for (CompiledPass& compiled_pass : compiled_passes)
+        {
+            const Pass& pass = passes[compiled_pass.pass_idx];
+            compiled_pass.resources_offset = u32(pass_resource_slots.size());
+            pass_resource_slots.insert(pass_resource_slots.end(), pass.resource_slots.begin(), pass.resource_slots.end());
+        }
+
+        // Render targets and depth targets of each graphics pass. Contents only need loading when an earlier pass wrote
+        // them this frame, or when they're kept around for later frames, and only need storing when something reads
+        // them afterwards.
+        compiled_attachments.clear();
+        std::vector<bool> written_this_frame(compiled_resources.size(), false);
+        for (u32 compiled_idx = 0; compiled_idx < compiled_passes.size(); ++compiled_idx)
+        {
+            CompiledPass& compiled_pass = compiled_passes[compiled_idx];
+            const Pass& pass = passes[compiled_pass.pass_idx];
+            compiled_pass.attachments_offset = u32(compiled_attachments.size());
+
+            const auto add_attachment = [&](const PassResourceUsage& resource_usage, const bool is_output, const u32 resolved_idx)
+            {
+                const bool is_depth_target = resource_usage.usage == RESOURCE_USAGE_DEPTH_STENCIL;
+                if (!is_depth_target && resource_usage.usage != RESOURCE_USAGE_RENDER_TARGET)
+                {
+                    return;
+                }
+                // Resources that are both read and written are a single attachment, added with the outputs
+                for (u32 i = compiled_pass.attachments_offset; i < compiled_attachments.size(); i++)
+                {
+                    if (compiled_attachments[i].identifier == resource_usage.identifier)
+                    {
+                        return;
+                    }
+                    ASSERT_MSG(!is_depth_target || !compiled_attachments[i].is_depth_target, "Passes can only have one depth target");
+                }
+
+                const u32 resource_idx = compiled_resource_indices.at(resource_usage.identifier);
+                CompiledAttachment attachment = {
+                    .identifier = resource_usage.identifier,
+                    .resolved_idx = resolved_idx,
+                    .is_backbuffer = resource_idx == backbuffer_idx,
+                    .is_depth_target = is_depth_target,
+                };
+                if (!is_output)
+                {
+                    // Read only depth
+                    attachment.load_op = LoadOp::LOAD;
+                }
+                else if (resource_usage.contents == AttachmentContents::CLEARED)
+                {
+                    attachment.load_op = LoadOp::CLEAR;
+                    std::copy(std::begin(resource_usage.clear_value), std::end(resource_usage.clear_value), attachment.clear_value);
+                }
+                else if (resource_usage.contents == AttachmentContents::OVERWRITTEN)
+                {
+                    attachment.load_op = LoadOp::DISCARD;
+                }
+                else
+                {
+                    const bool keeps_history = !attachment.is_backbuffer && resource_context->get_lifetime(resource_usage.identifier) == ResourceLifetime::HISTORY;
+                    attachment.load_op = written_this_frame[resource_idx] || keeps_history ? LoadOp::LOAD : LoadOp::DISCARD;
+                }
+                compiled_attachments.push_back(attachment);
+            };
+            if (pass.queue_type == CommandQueueType::GRAPHICS)
+            {
+                const u32 outputs_offset = compiled_pass.resources_offset + u32(pass.desc.inputs.size());
+                for (u32 i = 0; i < pass.desc.outputs.size(); i++)
+                {
+                    add_attachment(pass.desc.outputs[i], true, outputs_offset + i);
+                }
+                for (u32 i = 0; i < pass.desc.inputs.size(); i++)
+                {
+                    add_attachment(pass.desc.inputs[i], false, compiled_pass.resources_offset + i);
+                }
+            }
+            compiled_pass.num_attachments = u32(compiled_attachments.size()) - compiled_pass.attachments_offset;
+
+            for (const auto& output : pass.desc.outputs)
+            {
+                written_this_frame[compiled_resource_indices.at(output.identifier)] = true;
+            }
+        }
+
+        for (u32 compiled_idx = 0; compiled_idx < compiled_passes.size(); ++compiled_idx)
+        {
+            const CompiledPass& compiled_pass = compiled_passes[compiled_idx];
+            for (u32 i = 0; i < compiled_pass.num_attachments; i++)
+            {
+                CompiledAttachment& attachment = compiled_attachments[compiled_pass.attachments_offset + i];
+                // Whatever uses the resource next decides whether its contents have to be kept
+                bool is_needed = attachment.is_backbuffer || resource_context->get_lifetime(attachment.identifier) == ResourceLifetime::HISTORY;
+                bool found_next_use = false;
+                for (u32 next_idx = compiled_idx + 1; !found_next_use && next_idx < compiled_passes.size(); ++next_idx)
+                {
+                    const CompiledPass& next_pass = compiled_passes[next_idx];
+                    const PassDesc& next_desc = passes[next_pass.pass_idx].desc;
+                    const auto uses_resource = [&](const PassResourceUsage& resource_usage) { return resource_usage.identifier == attachment.identifier; };
+                    found_next_use = std::any_of(next_desc.inputs.begin(), next_desc.inputs.end(), uses_resource)
+                        || std::any_of(next_desc.outputs.begin(), next_desc.outputs.end(), uses_resource);
+                    if (found_next_use)
+                    {
+                        is_needed = true;
+                        for (u32 j = 0; j < next_pass.num_attachments; j++)
+                        {
+                            const CompiledAttachment& next_attachment = compiled_attachments[next_pass.attachments_offset + j];
+                            if (next_attachment.identifier == attachment.identifier && next_attachment.load_op != LoadOp::LOAD)
+                            {
+                                is_needed = false;
+                            }
+                        }
+                    }
+                }
+                attachment.store_op = is_needed ? StoreOp::STORE : StoreOp::DISCARD;
+            }
+        }
+    }
+
+    void RenderTaskList::resolve_handles()
+    {
+        compile_stats.num_handle_resolves++;
+        const u32 backbuffer_idx = compiled_resource_indices.at(resource_context->get_backbuffer_id());
+
+        // Resolve the handles for each in-flight frame up front
+        backbuffer_transition_indices.clear();
+        for (u32 i = 0; i < frame_transitions.size(); i++)
+        {
+            if (frame_transitions[i].resource_idx == backbuffer_idx)
+            {
+                backbuffer_transition_indices.push_back(i);
+            }
+        }
+        backbuffer_resource_indices.clear();
+        const ResourceSlot backbuffer_slot = compiled_resources[backbuffer_idx].slot;
+        for (u32 i = 0; i < pass_resource_slots.size(); i++)
+        {
+            if (pass_resource_slots[i] == backbuffer_slot)
+            {
+                backbuffer_resource_indices.push_back(i);
+            }
+        }
+        for (u64 frame_idx = 0; frame_idx < RENDER_LATENCY; frame_idx++)
+        {
+            const auto to_transition_desc = [&](const CompiledBarrier& barrier) -> ResourceTransitionDesc
+            {
+                const ResolvedResource resolved = resource_context->get_resolved(compiled_resources[barrier.resource_idx].slot, frame_idx);
+                ResourceTransitionDesc transition_desc = {
+                    .before = barrier.before,
+                    .after = barrier.after,
+                    .mip_level = barrier.mip_level,
+                    .array_slice = barrier.array_slice,
+                    .split = barrier.split,
+                };
+                if (barrier.type == PassResourceType::BUFFER)
+                {
+                    transition_desc.type = ResourceTransitionType::BUFFER;
+                    transition_desc.buffer = resolved.buffer;
+                }
+                else
+                {
+                    transition_desc.type = ResourceTransitionType::TEXTURE;
+                    // The backbuffer's handle gets filled in at execution time
+                    transition_desc.texture = barrier.resource_idx == backbuffer_idx ? TextureHandle{} : resolved.texture;
+                }
+                return transition_desc;
+            };
+
+            compiled_transitions[frame_idx].clear();
+            for (const CompiledBarrier& transition : frame_transitions)
+            {
+                compiled_transitions[frame_idx].push_back(to_transition_desc(transition));
+            }
+            compiled_uav_barriers[frame_idx].clear();
+            for (const CompiledBarrier& uav_barrier : frame_uav_barriers)
+            {
+                compiled_uav_barriers[frame_idx].push_back(to_transition_desc(uav_barrier));
+            }
+            compiled_aliasing_barriers[frame_idx].clear();
+            for (const CompiledBarrier& aliasing_barrier : frame_aliasing_barriers)
+            {
+                compiled_aliasing_barriers[frame_idx].push_back(to_transition_desc(aliasing_barrier));
+            }
+            compiled_pass_resources[frame_idx].clear();
+            for (const ResourceSlot slot : pass_resource_slots)
+            {
+                compiled_pass_resources[frame_idx].push_back(slot == backbuffer_slot ? ResolvedResource{} : resource_context->get_resolved(slot, frame_idx));
+            }
+            needs_state_fixup[frame_idx] = true;
+        }
+        resolved_handles_version = resource_context->get_handles_version();
     }
 
-    BarrierState ResourceContext::get_barrier_state(const ResourceIdentifier resource_identifier) const
+    void RenderTaskList::execute()
     {
-        const u64 idx = gfx::get_current_frame_idx() % RENDER_LATENCY;
-        const ResourceState(&resource_state)[RENDER_LATENCY] = resource_states.at(resource_identifier);
-        return {
-            .resource_usage = resource_state[idx].resource_usage,
-            .queue_type = resource_state[idx].queue_type,
-        };
+        record_and_submit(nullptr);
     }
 
-    ResourceIdentifier ResourceContext::get_backbuffer_id()
+    void RenderTaskList::execute(TaskScheduler& task_scheduler)
     {
-        return backbuffer_id;
+        // Every recording thread needs a command context pool of its own
+        const bool can_record_in_parallel = task_scheduler.get_num_threads() <= MAX_NUM_RECORDING_THREADS;
+        record_and_submit(can_record_in_parallel ? &task_scheduler : nullptr);
     }
 
-    ZecResult PipelineStore::compile(const PipelineId id, const PipelineCompilationDesc& desc, std::string& inout_errors)
+    const RenderTaskList::CompiledAttachment& RenderTaskList::get_compiled_attachment(const size_t compiled_pass_idx, const ResourceIdentifier id) const
     {
-        ASSERT(!pso_handles.contains(id));
-        ASSERT(!recompilation_infos.contains(id));
-
-        ShaderBlobsHandle blobs_handle{};
-        ZecResult res = gfx::shader_compilation::compile_shaders(desc.shader_compilation_desc, blobs_handle, inout_errors);
-
-        if (res == ZecResult::SUCCESS)
+        ASSERT(compiled_pass_idx < compiled_passes.size());
+        const CompiledPass& compiled_pass = compiled_passes[compiled_pass_idx];
+        for (u32 i = 0; i < compiled_pass.num_attachments; i++)
         {
-            ResourceLayoutHandle resource_layout = desc.resource_layout;
-            PipelineStateHandle pso_handle = gfx::pipelines::create_pipeline_state_object(blobs_handle, resource_layout, desc.pso_desc);
-
-            // Success!
-            // Clean up after ourselves
-            gfx::shader_compilation::release_blobs(blobs_handle);
-
-            pso_handles.set(id, pso_handle);
-            recompilation_infos.set(id, desc);;
+            const CompiledAttachment& attachment = compiled_attachments[compiled_pass.attachments_offset + i];
+            if (attachment.identifier == id)
+            {
+                return attachment;
+            }
         }
-        return res;
+        ASSERT_MSG(false, "The resource isn't one of the pass' attachments");
+        return compiled_attachments[compiled_pass.attachments_offset];
     }
 
-    ZecResult PipelineStore::recompile(const PipelineId pipeline_id, std::string& inout_errors)
+    void RenderTaskList::record_and_submit(TaskScheduler* task_scheduler)
     {
-        ASSERT(pso_handles.contains(pipeline_id));
-        ASSERT(recompilation_infos.contains(pipeline_id));
-
-        const PipelineCompilationDesc& recompilation_desc = recompilation_infos.get(pipeline_id);
-        ShaderBlobsHandle blobs_handle{};
-        ZecResult res = gfx::shader_compilation::compile_shaders(recompilation_desc.shader_compilation_desc, blobs_handle, inout_errors);
-
-        if (res == ZecResult::SUCCESS)
+        if (!get_is_compiled())
         {
-            // Recompile pipeline id
-            const ResourceLayoutHandle resource_layout_handle = recompilation_desc.resource_layout;
-            const PipelineStateHandle old_pipeline_id = pso_handles.get(pipeline_id);
-
-            // TODO: do we need to make this whole process async? How would that work?
-            res = gfx::pipelines::recreate_pipeline_state_object(blobs_handle, resource_layout_handle, recompilation_desc.pso_desc, old_pipeline_id);
-
-            gfx::shader_compilation::release_blobs(blobs_handle);
+            compile();
         }
 
-        return res;
-    }
+        PROFILE_EVENT("Pass Recording");
+        const auto record_start = std::chrono::steady_clock::now();
+        RenderGraphFrameStats frame_stats = {};
+        const auto submit = [&frame_stats](CommandContextHandle* cmd_contexts, const size_t num_cmd_contexts) {
+            frame_stats.num_submits++;
+            frame_stats.num_command_lists += u32(num_cmd_contexts);
+            return gfx::cmd::return_and_execute(cmd_contexts, num_cmd_contexts);
+        };
 
-    PassListBuilder::PassListBuilder(RenderTaskList* list_to_build) : out_list(list_to_build)
-    {}
+        resource_context->refresh_backbuffer();
 
-    PassListBuilder::Result PassListBuilder::add_pass(const PassDesc& render_pass_desc)
-    {
-        Result out_result{ StatusCodes::SUCCESS };
-        u32 dependency_index = UINT32_MAX;
+        const u64 frame_idx = gfx::get_current_frame_idx() % RENDER_LATENCY;
+        recording_frame_idx = frame_idx;
+        std::vector<ResourceTransitionDesc>& transitions = compiled_transitions[frame_idx];
 
-        if (out_list->resource_context == nullptr)
+        const TextureHandle backbuffer_handle = gfx::get_current_back_buffer_handle();
+        for (const u32 transition_idx : backbuffer_transition_indices)
         {
-            out_result = Result{ StatusCodes::MISSING_RESOURCE_CONTEXT };
+            transitions[transition_idx].texture = backbuffer_handle;
         }
-        else if (!out_list->resource_context->get_backbuffer_id().is_valid())
+        std::vector<ResolvedResource>& pass_resources = compiled_pass_resources[frame_idx];
+        for (const u32 resource_idx : backbuffer_resource_indices)
         {
-            out_result = Result{ StatusCodes::UNSPECIFIED_BACKBUFFER_RESOURCE };
+            pass_resources[resource_idx].texture = backbuffer_handle;
         }
-        else {
-
-            ASSERT(render_pass_desc.command_queue_type != CommandQueueType::COPY && render_pass_desc.command_queue_type != CommandQueueType::NUM_COMMAND_CONTEXT_POOLS);
 
-            // TODO: Want to validate that the inputs/outputs have been registered
-            for (u32 i = 0; out_result.is_success() && i < render_pass_desc.inputs.size(); ++i)
+        CommandContextHandle fixup_cmd_ctx{};
+        if (needs_state_fixup[frame_idx])
+        {
+            // Move this frame's copies of our resources into the state the compiled barriers expect
+            std::vector<ResourceTransitionDesc> fixup_transitions = {};
+            for (const CompiledResource& resource : compiled_resources)
             {
-                const auto& input = render_pass_desc.inputs[i];
-                if (input.identifier == out_list->resource_context->get_backbuffer_id())
-                {
-                    out_result = Result{ StatusCodes::BACKBUFFER_READ, input.identifier };
-                }
-                else if (!resource_write_ledger.contains(input.identifier))
-                {
-                    out_result = Result{ StatusCodes::MISSING_OUTPUT, input.identifier };
-                }
-                else
+                const BarrierState current_state = resource_context->get_barrier_state(resource.slot, frame_idx);
+                const BarrierState& frame_state = resource.frame_state;
+                if (current_state.queue_type == frame_state.queue_type && current_state.resource_usage != frame_state.resource_usage)
                 {
-                    const u32 last_written_to_by = resource_write_ledger.at(input.identifier);
-                    ASSERT(last_written_to_by < out_list->passes.size());
-                    const PassDesc& writer = out_list->passes[last_written_to_by].desc;
-                    if (writer.command_queue_type != render_pass_desc.command_queue_type)
+                    ResourceTransitionDesc transition_desc = { .before = current_state.resource_usage, .after = frame_state.resource_usage };
+                    const ResolvedResource resolved = resource_context->get_resolved(resource.slot, frame_idx);
+                    if (is_valid(resolved.texture))
                     {
-                        // Record the dependency
-                        dependency_index = dependency_index == UINT32_MAX ? last_written_to_by : max(dependency_index, last_written_to_by);
+                        transition_desc.type = ResourceTransitionType::TEXTURE;
+                        transition_desc.texture = resolved.texture;
                     }
-                    out_result = validate_usage(out_list->resource_context, input);
+                    else
+                    {
+                        transition_desc.type = ResourceTransitionType::BUFFER;
+                        transition_desc.buffer = resolved.buffer;
+                    }
+                    fixup_transitions.push_back(transition_desc);
                 }
+                resource_context->set_barrier_state(resource.slot, frame_idx, frame_state);
+            }
+            if (!fixup_transitions.empty())
+            {
+                fixup_cmd_ctx = gfx::cmd::provision(CommandQueueType::GRAPHICS);
+                gfx::cmd::transition_resources(fixup_cmd_ctx, fixup_transitions.data(), fixup_transitions.size());
             }
+            needs_state_fixup[frame_idx] = false;
+        }
 
-            // TODO: Want to validate that the inputs/outputs have been registered
-            for (u32 i = 0; out_result.is_success() && i < render_pass_desc.outputs.size(); ++i)
+        // Barriers were all resolved by compile(), so jobs can be recorded in any order and on any thread
+        const u32 max_jobs_per_pass = task_scheduler != nullptr ? task_scheduler->get_num_threads() : 1;
+        recording_jobs.clear();
+        for (u32 compiled_idx = 0; compiled_idx < compiled_passes.size(); ++compiled_idx)
+        {
+            const PassDesc& desc = passes[compiled_passes[compiled_idx].pass_idx].desc;
+            const u32 num_jobs = std::max(1u, std::min(desc.max_recording_jobs, max_jobs_per_pass));
+            for (u32 job_idx = 0; job_idx < num_jobs; ++job_idx)
             {
-                const auto& output = render_pass_desc.outputs[i];
-                const bool is_backbuffer_output = output.identifier == out_list->resource_context->get_backbuffer_id();
-                const bool valid_backbuffer_use = output.type == PassResourceType::TEXTURE && output.usage == RESOURCE_USAGE_RENDER_TARGET;
-                if (is_backbuffer_output && !valid_backbuffer_use)
-                {
-                    out_result = Result{ StatusCodes::BACKBUFFER_USED_AS_NON_RT, output.identifier };
-                }
-                else if (!is_backbuffer_output) {
-                    out_result = validate_usage(out_list->resource_context, output);
-                }
+                recording_jobs.push_back({ .list = this, .compiled_pass_idx = compiled_idx, .job_idx = job_idx, .num_jobs = num_jobs });
             }
         }
 
-        if (out_result.is_success())
+        if (task_scheduler == nullptr)
         {
-            // If we've gotten this far, validation has succeeded
-            const u32 pass_index = out_list->passes.size();
-            out_result.pass_handle = { pass_index };
-            out_list->passes.push_back(RenderTaskList::Pass{
-                .requires_flush = false,
-                .dependency_index = dependency_index,
-                .desc = render_pass_desc
-            });
+            for (RecordingJob& job : recording_jobs)
+            {
+                record(job, UINT32_MAX);
+            }
+        }
+        else if (!recording_jobs.empty())
+        {
+            std::vector<Task> tasks(recording_jobs.size());
+            for (size_t i = 0; i < recording_jobs.size(); i++)
+            {
+                const PassDesc& desc = passes[compiled_passes[recording_jobs[i].compiled_pass_idx].pass_idx].desc;
+                tasks[i] = { .function = &RenderTaskList::record_task, .arg = &recording_jobs[i], .name = desc.name.data() };
+            }
+            TaskCounter counter{};
+            task_scheduler->add_tasks(tasks.size(), tasks.data(), counter, TaskPriority::HIGH);
+            task_scheduler->wait_on_counter(counter);
+        }
 
-            for (const auto& output : render_pass_desc.outputs)
+        // Submit in the order the passes were compiled in. Command lists are batched per queue and only submitted once
+        // another queue has to wait on them, so each queue signals at most one fence per cross queue sync point.
+        constexpr size_t NUM_QUEUES = size_t(CommandQueueType::NUM_COMMAND_CONTEXT_POOLS);
+        std::vector<CommandContextHandle> pending_cmd_contexts[NUM_QUEUES] = {};
+        // Per queue: the receipt of its last submission and the compiled index of the last pass that submission included
+        CmdReceipt last_receipts[NUM_QUEUES] = {};
+        u32 submitted_through[NUM_QUEUES] = {};
+        // Per queue: the last receipt from each other queue it was made to wait on, so we don't insert redundant waits
+        CmdReceipt waited_on_receipts[NUM_QUEUES][NUM_QUEUES] = {};
+        for (size_t queue = 0; queue < NUM_QUEUES; ++queue)
+        {
+            submitted_through[queue] = UINT32_MAX;
+        }
+        if (is_valid(fixup_cmd_ctx))
+        {
+            pending_cmd_contexts[size_t(CommandQueueType::GRAPHICS)].push_back(fixup_cmd_ctx);
+        }
+        size_t next_job_idx = 0;
+        for (u32 compiled_idx = 0; compiled_idx < compiled_passes.size(); ++compiled_idx)
+        {
+            const CompiledPass& compiled_pass = compiled_passes[compiled_idx];
+            const size_t queue = size_t(passes[compiled_pass.pass_idx].queue_type);
+
+            if (compiled_pass.wait_on_pass != UINT32_MAX)
             {
-                // Record last that we're the last writer to this resource
-                resource_write_ledger[output.identifier] = pass_index;
+                const u32 wait_on_pass = compiled_pass.wait_on_pass;
+                const size_t other_queue = size_t(passes[compiled_passes[wait_on_pass].pass_idx].queue_type);
+                ASSERT(other_queue != queue);
+                // Passes are visited in compiled order, so anything the other queue has pending includes wait_on_pass
+                if (submitted_through[other_queue] == UINT32_MAX || submitted_through[other_queue] < wait_on_pass)
+                {
+                    std::vector<CommandContextHandle>& other_pending = pending_cmd_contexts[other_queue];
+                    ASSERT(!other_pending.empty());
+                    last_receipts[other_queue] = submit(other_pending.data(), other_pending.size());
+                    submitted_through[other_queue] = compiled_idx - 1;
+                    other_pending.clear();
+                }
+
+                const CmdReceipt receipt = last_receipts[other_queue];
+                CmdReceipt& waited_on_receipt = waited_on_receipts[queue][other_queue];
+                ASSERT(is_valid(receipt));
+                if (!is_valid(waited_on_receipt) || waited_on_receipt.fence_value < receipt.fence_value)
+                {
+                    // Anything still pending on this queue gets submitted after the wait too. That's only ever later than
+                    // it needed to be, and the other queue flushes it first when it depends on it.
+                    gfx::cmd::gpu_wait(CommandQueueType(queue), receipt);
+                    waited_on_receipt = receipt;
+                    frame_stats.num_gpu_waits++;
+                }
             }
 
-            // Mark any cross-queue dependencies as requiring a flush
-            if (dependency_index != UINT32_MAX)
+            for (; next_job_idx < recording_jobs.size() && recording_jobs[next_job_idx].compiled_pass_idx == compiled_idx; ++next_job_idx)
             {
-                out_list->passes[dependency_index].requires_flush = true;
+                pending_cmd_contexts[queue].push_back(recording_jobs[next_job_idx].cmd_ctx);
             }
         }
 
-        return out_result;
+        std::vector<CommandContextHandle>& pending_graphics = pending_cmd_contexts[size_t(CommandQueueType::GRAPHICS)];
+        if (pending_graphics.empty())
+        {
+            pending_graphics.push_back(gfx::cmd::provision(CommandQueueType::GRAPHICS));
+        }
+        submit(pending_graphics.data(), pending_graphics.size());
+
+        std::vector<CommandContextHandle>& pending_async_compute = pending_cmd_contexts[size_t(CommandQueueType::ASYNC_COMPUTE)];
+        if (!pending_async_compute.empty())
+        {
+            submit(pending_async_compute.data(), pending_async_compute.size());
+        }
+
+        frame_stats.cpu_record_ms = get_elapsed_ms(record_start);
+        gather_stats(frame_stats);
     }
 
-    void PassListBuilder::set_pass_list(RenderTaskList* pass_list)
+    void RenderTaskList::gather_stats(const RenderGraphFrameStats& frame_stats)
     {
-        ASSERT(out_list == nullptr);
-        ASSERT(pass_list->passes.size() == 0);
-        out_list = pass_list;
-    }
+        const u64 frame = num_frames_recorded++;
+        pass_stats_history.resize(passes.size() * RENDER_GRAPH_STATS_HISTORY_LENGTH);
+        for (u32 pass_idx = 0; pass_idx < passes.size(); pass_idx++)
+        {
+            get_pass_stats_entry(pass_idx, frame) = {};
+        }
 
+        for (const RecordingJob& job : recording_jobs)
+        {
+            const CompiledPass& compiled_pass = compiled_passes[job.compiled_pass_idx];
+            PassStats& pass_stats = get_pass_stats_entry(compiled_pass.pass_idx, frame);
+            pass_stats.cpu_record_ms += job.cpu_record_ms;
+            pass_stats.num_draws += job.recorded.num_draws;
+            pass_stats.num_dispatches += job.recorded.num_dispatches;
+            pass_stats.num_command_lists++;
+            if (job.job_idx == 0)
+            {
+                pass_stats.num_transitions = compiled_pass.num_transitions + compiled_pass.num_after_transitions;
+                pass_stats.num_uav_barriers = compiled_pass.num_uav_barriers;
+                pass_stats.num_aliasing_barriers = compiled_pass.num_aliasing_barriers;
+            }
+        }
+        frame_stats_history[frame % RENDER_GRAPH_STATS_HISTORY_LENGTH] = frame_stats;
+    }
 
-    void PassListBuilder::set_resource_context(ResourceContext* resource_context)
+    PassStats RenderTaskList::get_pass_stats(const PassHandle pass_handle) const
     {
-        out_list->resource_context = resource_context;
+        ASSERT(pass_handle.idx < passes.size());
+        if (num_frames_recorded == 0 || pass_handle.idx >= pass_stats_history.size() / RENDER_GRAPH_STATS_HISTORY_LENGTH)
+        {
+            return {};
+        }
+        return get_pass_stats_entry(pass_handle.idx, num_frames_recorded - 1);
     }
 
-    void PassListBuilder::set_shader_store(PipelineStore* shader_store)
+    RenderGraphFrameStats RenderTaskList::get_frame_stats() const
     {
-        out_list->shader_store = shader_store;
+        return num_frames_recorded > 0 ? frame_stats_history[(num_frames_recorded - 1) % RENDER_GRAPH_STATS_HISTORY_LENGTH] : RenderGraphFrameStats{};
     }
 
-    RenderTaskList::RenderTaskList(ResourceContext* resource_context, PipelineStore* shader_store)
-        : resource_context{ resource_context }
-        , shader_store{ shader_store }
-        , settings_context{}
-        , per_pass_data_store{}
-    {}
-
-    void RenderTaskList::execute()
+    PassStats RenderTaskList::get_average_pass_stats(const PassHandle pass_handle) const
     {
-        PROFILE_EVENT("Pass Recording");
-
-        resource_context->refresh_backbuffer();
-
-        CommandContextHandle gfx_cmd_list{};
-        CommandContextHandle async_compute_cmd_list{};
+        ASSERT(pass_handle.idx < passes.size());
+        const u64 num_frames = std::min<u64>(num_frames_recorded, RENDER_GRAPH_STATS_HISTORY_LENGTH);
+        if (num_frames == 0 || pass_handle.idx >= pass_stats_history.size() / RENDER_GRAPH_STATS_HISTORY_LENGTH)
+        {
+            return {};
+        }
 
-        u32 num_passes = passes.size();
-        std::vector<CmdReceipt> cmd_receipts(num_passes);
+        float cpu_record_ms = 0.0f;
+        u64 sums[6] = {};
+        for (u64 frame = 0; frame < num_frames; frame++)
+        {
+            const PassStats& pass_stats = get_pass_stats_entry(pass_handle.idx, frame);
+            cpu_record_ms += pass_stats.cpu_record_ms;
+            sums[0] += pass_stats.num_transitions;
+            sums[1] += pass_stats.num_uav_barriers;
+            sums[2] += pass_stats.num_aliasing_barriers;
+            sums[3] += pass_stats.num_draws;
+            sums[4] += pass_stats.num_dispatches;
+            sums[5] += pass_stats.num_command_lists;
+        }
+        return {
+            .cpu_record_ms = cpu_record_ms / float(num_frames),
+            .num_transitions = get_rounded_average(sums[0], num_frames),
+            .num_uav_barriers = get_rounded_average(sums[1], num_frames),
+            .num_aliasing_barriers = get_rounded_average(sums[2], num_frames),
+            .num_draws = get_rounded_average(sums[3], num_frames),
+            .num_dispatches = get_rounded_average(sums[4], num_frames),
+            .num_command_lists = get_rounded_average(sums[5], num_frames),
+        };
+    }
 
-        for (u64 pass_idx = 0; pass_idx < num_passes; ++pass_idx)
+    RenderGraphFrameStats RenderTaskList::get_average_frame_stats() const
+    {
+        const u64 num_frames = std::min<u64>(num_frames_recorded, RENDER_GRAPH_STATS_HISTORY_LENGTH);
+        if (num_frames == 0)
         {
-            const auto& pass = passes[pass_idx];
-            if (!pass.enabled)
-            {
-                continue;
-            }
+            return {};
+        }
 
-            auto& cmd_ctx = pass.desc.command_queue_type == CommandQueueType::ASYNC_COMPUTE ? async_compute_cmd_list : gfx_cmd_list;
+        float cpu_record_ms = 0.0f;
+        u64 sums[3] = {};
+        for (u64 frame = 0; frame < num_frames; frame++)
+        {
+            const RenderGraphFrameStats& frame_stats = frame_stats_history[frame];
+            cpu_record_ms += frame_stats.cpu_record_ms;
+            sums[0] += frame_stats.num_submits;
+            sums[1] += frame_stats.num_command_lists;
+            sums[2] += frame_stats.num_gpu_waits;
+        }
+        return {
+            .cpu_record_ms = cpu_record_ms / float(num_frames),
+            .num_submits = get_rounded_average(sums[0], num_frames),
+            .num_command_lists = get_rounded_average(sums[1], num_frames),
+            .num_gpu_waits = get_rounded_average(sums[2], num_frames),
+        };
+    }
 
-            if (!is_valid(cmd_ctx))
-            {
-                cmd_ctx = gfx::cmd::provision(pass.desc.command_queue_type);
-            }
+    void RenderTaskList::reset_stats()
+    {
+        pass_stats_history.clear();
+        std::fill(std::begin(frame_stats_history), std::end(frame_stats_history), RenderGraphFrameStats{});
+        num_frames_recorded = 0;
+    }
 
-            // Transition resources
-            constexpr size_t MAX_TRANSITION_COUNT = 16;
-            FixedArray<ResourceTransitionDesc, MAX_TRANSITION_COUNT> transition_descs = {};
-            ASSERT_MSG((pass.desc.inputs.size() + pass.desc.outputs.size()) < MAX_TRANSITION_COUNT,
-                "Need to either bump our transitions desc count of %u or use a transient allocation for these", MAX_TRANSITION_COUNT);
+    void RenderTaskList::record_task(TaskScheduler* task_scheduler, void* arg)
+    {
+        RecordingJob& job = *static_cast<RecordingJob*>(arg);
+        job.list->record(job, task_scheduler->get_current_thread_idx());
+    }
 
-            for (const auto& input : pass.desc.inputs)
+    void RenderTaskList::record(RecordingJob& job, const u32 thread_idx)
+    {
+        const CompiledPass& compiled_pass = compiled_passes[job.compiled_pass_idx];
+        const Pass& pass = passes[compiled_pass.pass_idx];
+        std::vector<ResourceTransitionDesc>& transitions = compiled_transitions[recording_frame_idx];
+        const std::vector<ResourceTransitionDesc>& uav_barriers = compiled_uav_barriers[recording_frame_idx];
+        const std::vector<ResourceTransitionDesc>& aliasing_barriers = compiled_aliasing_barriers[recording_frame_idx];
+        const std::vector<ResolvedResource>& pass_resources = compiled_pass_resources[recording_frame_idx];
+
+        const auto record_start = std::chrono::steady_clock::now();
+        const CommandQueueType queue_type = pass.queue_type;
+        job.cmd_ctx = thread_idx == UINT32_MAX ? gfx::cmd::provision(queue_type) : gfx::cmd::provision(queue_type, thread_idx);
+        const CommandContextHandle cmd_ctx = job.cmd_ctx;
+
+        PROFILE_GPU_EVENT(pass.desc.name.data(), cmd_ctx);
+
+        // The first job's command context gets submitted before the others', so it's the only one that needs barriers
+        if (job.job_idx == 0)
+        {
+            // Resources have to be activated by their aliasing barrier before any transition of them
+            for (u32 i = 0; i < compiled_pass.num_aliasing_barriers; i++)
             {
-                // Transition inputs
-                // Handle inter queue fluses
-                BarrierState current_state = resource_context->get_barrier_state(input.identifier);
-
-                if (current_state.queue_type == pass.desc.command_queue_type)
+                const ResourceTransitionDesc& aliasing_barrier = aliasing_barriers[compiled_pass.aliasing_barriers_offset + i];
+                if (aliasing_barrier.type == ResourceTransitionType::BUFFER)
                 {
-                    if (current_state.resource_usage != input.usage)
-                    {
-                        if (input.type == PassResourceType::BUFFER)
-                        {
-                            transition_descs.push_back({
-                                .type = ResourceTransitionType::BUFFER,
-                                .buffer = resource_context->get_buffer(input.identifier),
-                                .before = current_state.resource_usage,
-                                .after = input.usage,
-                            });
-                        }
-                        else
-                        {
-                            transition_descs.push_back({
-                                .type = ResourceTransitionType::TEXTURE,
-                                .texture = resource_context->get_texture(input.identifier),
-                                .before = current_state.resource_usage,
-                                .after = input.usage,
-                            });
-                        }
-
-                        current_state.resource_usage = input.usage;
-                        resource_context->set_barrier_state(input.identifier, current_state);
-                    }
-                    else if (input.usage == RESOURCE_USAGE_COMPUTE_WRITABLE)
-                    {
-                        // Need to insert a UAV transition here
-                        if (input.type == PassResourceType::BUFFER)
-                        {
-                            gfx::cmd::compute_write_barrier(cmd_ctx, resource_context->get_buffer(input.identifier));
-                        }
-                        else
-                        {
-                            gfx::cmd::compute_write_barrier(cmd_ctx, resource_context->get_texture(input.identifier));
-                        }
-                    }
+                    gfx::cmd::aliasing_barrier(cmd_ctx, aliasing_barrier.buffer);
                 }
                 else
                 {
-                    // Don't need to insert resource barriers if we're using the resource between queues, but we do need a GPU wait
-                    // We filled the dependency when adding the pass originally
-                    ASSERT(pass.dependency_index != UINT32_MAX);
-                    ASSERT(is_valid(cmd_receipts[pass.dependency_index]));
-                    gfx::cmd::gpu_wait(pass.desc.command_queue_type, cmd_receipts[pass.dependency_index]);
-                    current_state.queue_type = pass.desc.command_queue_type;
-                    current_state.resource_usage = input.usage;
+                    gfx::cmd::aliasing_barrier(cmd_ctx, aliasing_barrier.texture);
                 }
             }
 
-            for (const auto& output : pass.desc.outputs)
+            if (compiled_pass.num_transitions > 0)
             {
-                // Transition outputs
-                // Handle inter queue fluses
-                BarrierState current_state = resource_context->get_barrier_state(output.identifier);
-
-                if (current_state.queue_type == pass.desc.command_queue_type)
-                {
-                    if (current_state.resource_usage != output.usage)
-                    {
-                        if (output.type == PassResourceType::BUFFER)
-                        {
-                            transition_descs.push_back({
-                                .type = ResourceTransitionType::BUFFER,
-                                .buffer = resource_context->get_buffer(output.identifier),
-                                .before = current_state.resource_usage,
-                                .after = output.usage,
-                                });
-                        }
-                        else
-                        {
-                            transition_descs.push_back({
-                                .type = ResourceTransitionType::TEXTURE,
-                                .texture = resource_context->get_texture(output.identifier),
-                                .before = current_state.resource_usage,
-                                .after = output.usage,
-                                });
-                        }
-
-                        current_state.resource_usage = output.usage;
-                        resource_context->set_barrier_state(output.identifier, current_state);
-                    }
-                    else if (output.usage == RESOURCE_USAGE_COMPUTE_WRITABLE)
-                    {
-                        // Need to insert a UAV transition here
-                        if (output.type == PassResourceType::BUFFER)
-                        {
-                            gfx::cmd::compute_write_barrier(cmd_ctx, resource_context->get_buffer(output.identifier));
-                        }
-                        else
-                        {
-                            gfx::cmd::compute_write_barrier(cmd_ctx, resource_context->get_texture(output.identifier));
-                        }
-                    }
-                }
-                else
-                {
-                    // Don't need to insert resource barriers if we're using the resource between queues, but we do need a GPU wait
-                    // We filled the dependency when adding the pass originally
-                    ASSERT(pass.dependency_index != UINT32_MAX);
-                    ASSERT(is_valid(cmd_receipts[pass.dependency_index]));
-                    gfx::cmd::gpu_wait(pass.desc.command_queue_type, cmd_receipts[pass.dependency_index]);
-                    current_state.queue_type = pass.desc.command_queue_type;
-                    current_state.resource_usage = output.usage;
-                }
+                gfx::cmd::transition_resources(cmd_ctx, &transitions[compiled_pass.transitions_offset], compiled_pass.num_transitions);
             }
 
+            // Aliased render and depth targets are initialized once the transitions have put them in their target state
+            for (u32 i = 0; i < compiled_pass.num_aliasing_barriers; i++)
             {
-                PROFILE_GPU_EVENT(pass.desc.name.data(), cmd_ctx);
-
-                if (transition_descs.size > 0)
+                const ResourceTransitionDesc& aliasing_barrier = aliasing_barriers[compiled_pass.aliasing_barriers_offset + i];
+                if (aliasing_barrier.type == ResourceTransitionType::TEXTURE && (aliasing_barrier.after & (RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_DEPTH_STENCIL)))
                 {
-                    gfx::cmd::transition_resources(cmd_ctx, transition_descs.data, transition_descs.size);
+                    gfx::cmd::discard_texture(cmd_ctx, aliasing_barrier.texture);
                 }
-
-                // Pass Execution
-                PassExecutionContext execution_context = {
-                   .resource_context = resource_context,
-                   .pipeline_context = shader_store,
-                   .settings_context = &settings_context,
-                   .per_pass_data_store = &per_pass_data_store,
-                   .cmd_context = cmd_ctx,
-                };
-                pass.desc.execute_fn(&execution_context);
             }
 
-            if (pass.requires_flush)
+            for (u32 i = 0; i < compiled_pass.num_uav_barriers; i++)
             {
-                cmd_receipts[pass_idx] = gfx::cmd::return_and_execute(&cmd_ctx, 1);
-                //cmd_ctx = CommandContextHandle{};
-                ASSERT(!is_valid(cmd_ctx));
+                const ResourceTransitionDesc& uav_barrier = uav_barriers[compiled_pass.uav_barriers_offset + i];
+                if (uav_barrier.type == ResourceTransitionType::BUFFER)
+                {
+                    gfx::cmd::compute_write_barrier(cmd_ctx, uav_barrier.buffer);
+                }
+                else
+                {
+                    gfx::cmd::compute_write_barrier(cmd_ctx, uav_barrier.texture);
+                }
             }
         }
 
-        ASSERT(is_valid(gfx_cmd_list));
-        if (is_valid(gfx_cmd_list))
+        // Only the first job loads the attachments and only the last one stores them, the jobs in between pick up where
+        // the previous one left off
+        RenderPassDesc render_pass_desc = {};
+        for (u32 i = 0; i < compiled_pass.num_attachments; i++)
         {
-            const auto backbuffer_id = resource_context->get_backbuffer_id();
-            BarrierState backbuffer_state = resource_context->get_barrier_state(backbuffer_id);
-            ASSERT(backbuffer_state.resource_usage == RESOURCE_USAGE_RENDER_TARGET);
-            ASSERT(backbuffer_state.queue_type == CommandQueueType::GRAPHICS);
-            // Add assert that it's in render target state?
-            ResourceTransitionDesc transition_desc{
-                .type = ResourceTransitionType::TEXTURE,
-                .texture = resource_context->get_texture(backbuffer_id),
-                .before = RESOURCE_USAGE_RENDER_TARGET,
-                .after = RESOURCE_USAGE_PRESENT,
+            const CompiledAttachment& attachment = compiled_attachments[compiled_pass.attachments_offset + i];
+            RenderPassAttachment& render_pass_attachment = attachment.is_depth_target
+                ? render_pass_desc.depth_target
+                : render_pass_desc.render_targets[render_pass_desc.num_render_targets++];
+            render_pass_attachment = {
+                .texture = pass_resources[attachment.resolved_idx].texture,
+                .load_op = job.job_idx == 0 ? attachment.load_op : LoadOp::LOAD,
+                .store_op = job.job_idx == job.num_jobs - 1 ? attachment.store_op : StoreOp::STORE,
             };
-            gfx::cmd::transition_resources(gfx_cmd_list, &transition_desc, 1);
-            gfx::cmd::return_and_execute(&gfx_cmd_list, 1);
+            std::copy(std::begin(attachment.clear_value), std::end(attachment.clear_value), render_pass_attachment.clear_value);
+        }
+        if (compiled_pass.num_attachments > 0)
+        {
+            gfx::cmd::begin_render_pass(cmd_ctx, render_pass_desc);
+        }
 
-            backbuffer_state.resource_usage = RESOURCE_USAGE_PRESENT;
-            resource_context->set_barrier_state(backbuffer_id, backbuffer_state);
+        // Pass Execution
+        const ResolvedResource* resolved = pass_resources.data() + compiled_pass.resources_offset;
+        const ResourceSlot* resource_slots = pass_resource_slots.data() + compiled_pass.resources_offset;
+        PassExecutionContext execution_context = {
+           .resource_context = resource_context,
+           .input_resources = { resolved, pass.desc.inputs.size() },
+           .output_resources = { resolved + pass.desc.inputs.size(), pass.desc.outputs.size() },
+           .pipeline_context = shader_store,
+           .settings_context = &settings_context,
+           .per_pass_data_store = &per_pass_data_store,
+           .cmd_context = cmd_ctx,
+           .pass_data = pass.pass_data_idx != UINT32_MAX ? per_pass_data_store.get_entry_ptr(pass.pass_data_idx) : nullptr,
+           .pass_data_type_id = pass.pass_data_idx != UINT32_MAX ? per_pass_data_store.get_entry_type_id(pass.pass_data_idx) : nullptr,
+           .view_idx = pass.view_idx,
+           .job_idx = job.job_idx,
+           .num_jobs = job.num_jobs,
+           .input_slots = { resource_slots, pass.desc.inputs.size() },
+           .output_slots = { resource_slots + pass.desc.inputs.size(), pass.desc.outputs.size() },
+        };
+        pass.desc.execute_fn(&execution_context);
 
+        if (compiled_pass.num_attachments > 0)
+        {
+            gfx::cmd::end_render_pass(cmd_ctx, render_pass_desc);
         }
 
-        if (is_valid(async_compute_cmd_list))
+        if (compiled_pass.num_after_transitions > 0 && job.job_idx == job.num_jobs - 1)
         {
-            gfx::cmd::return_and_execute(&async_compute_cmd_list, 1);
+            gfx::cmd::transition_resources(cmd_ctx, &transitions[compiled_pass.after_transitions_offset], compiled_pass.num_after_transitions);
         }
+
+        job.recorded = gfx::cmd::get_stats(cmd_ctx);
+        job.cpu_record_ms = get_elapsed_ms(record_start);
     }
 
     void RenderTaskList::setup()
     {
         PROFILE_EVENT("Pass Setup");
 
-        for (const auto& pass : passes)
+        for (auto& pass : passes)
         {
             if (pass.desc.setup_fn != nullptr)
             {
+                const u32 num_entries = per_pass_data_store.get_num_entries();
+                settings_context.set_view_idx(pass.view_idx);
+                per_pass_data_store.set_view_idx(pass.view_idx);
                 pass.desc.setup_fn(&settings_context, &per_pass_data_store);
+                settings_context.set_view_idx(0);
+                per_pass_data_store.set_view_idx(0);
+                // Handed to execute_fn directly, so passes don't have to look their data up every frame
+                pass.pass_data_idx = per_pass_data_store.get_num_entries() > num_entries ? num_entries : UINT32_MAX;
             }
         }
-
     }
 
 }
@@ -1,13 +1,21 @@
 #pragma once
+#include <new>
 #include <span>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include "../core/zec_types.h"
 #include "../core/array.h"
 #include "../core/linear_allocator.h"
 #include "public_resources.h"
 
+namespace zec
+{
+    class TaskScheduler;
+}
+
 namespace zec::render_graph
 {
     struct ResourceIdentifier
@@ -22,6 +30,17 @@ namespace zec::render_graph
         }
     };
 
+    // Identifier of a view's own copy of a resource, setting or piece of per pass data. View 0 uses the identifier as is,
+    // so that graphs with a single view don't have to know about views at all.
+    constexpr ResourceIdentifier get_view_identifier(const ResourceIdentifier id, const u32 view_idx)
+    {
+        return view_idx == 0 ? id : ResourceIdentifier{ id.identifier ^ (view_idx * 0x9E3779B9u) };
+    }
+
+    // Dense index that ResourceContext gives each resource it registers, so that per frame lookups are array loads
+    using ResourceSlot = u16;
+    constexpr ResourceSlot k_invalid_resource_slot = UINT16_MAX;
+
     using BufferId = ResourceIdentifier;
     using TextureId = ResourceIdentifier;
     using ResourceLayoutId = ResourceIdentifier;
@@ -46,6 +65,21 @@ namespace zec::render_graph
         ABSOLUTE,
     };
 
+    // How many copies of a resource the in-flight frames need
+    enum struct ResourceLifetime : u8
+    {
+        // Picked by the render graph when it's compiled, based on how the passes use the resource
+        INFERRED = 0,
+        // One copy shared by all in-flight frames. Queues run their frames in order, so this is enough for resources
+        // whose contents don't outlive the frame and that are only used on one queue.
+        SINGLE,
+        // One copy per in-flight frame, so that a frame's work on one queue can overlap the previous frame's on another
+        PER_FRAME,
+        // One copy per in-flight frame, whose contents are still needed once the frame is done. For instance when read
+        // back, or read by the next frame through get_texture(id, frame_idx - 1).
+        HISTORY,
+    };
+
     // TODO: Also support resizing here,but using a divisor -- to enable for instance resizing tile buffers
     struct BufferResourceDesc
     {
@@ -53,6 +87,12 @@ namespace zec::render_graph
         std::wstring_view name = L"";
         ResourceUsage initial_usage = RESOURCE_USAGE_UNUSED;
         BufferDesc desc = {};
+        // Transient resources are written and read within a frame, so their contents never need to survive until the next one.
+        // They only get memory once the render graph is compiled, shared with other transient resources that are never used at the same time.
+        bool is_transient = false;
+        ResourceLifetime lifetime = ResourceLifetime::INFERRED;
+        // Resources that every view of the graph needs its own copy of are registered once per view, see get_view_identifier
+        u32 num_views = 1;
     };
 
     struct TextureResourceDesc
@@ -67,6 +107,14 @@ namespace zec::render_graph
         float relative_width_factor = 1.0f;
         float relative_height_factor = 1.0f;
         TextureDesc desc = {};
+        // See BufferResourceDesc::is_transient
+        bool is_transient = false;
+        ResourceLifetime lifetime = ResourceLifetime::INFERRED;
+        // See BufferResourceDesc::num_views
+        u32 num_views = 1;
+        // Passes only render to the top left part of the texture, scaled by ResourceContext's render scale.
+        // The texture is still allocated at full size, so the scale can change every frame without recreating it.
+        bool dynamic_resolution = false;
     };
 
     // Tracks the state that the resource is in during the execution of the render graph
@@ -76,6 +124,60 @@ namespace zec::render_graph
         CommandQueueType queue_type;
     };
 
+    inline bool operator==(const BarrierState& lhs, const BarrierState& rhs)
+    {
+        return lhs.resource_usage == rhs.resource_usage && lhs.queue_type == rhs.queue_type;
+    }
+
+    // Memory needed by a resource from its first to its last use (inclusive), in the order passes are recorded in
+    struct TransientAllocationRequest
+    {
+        u64 byte_size = 0;
+        u64 alignment = 1;
+        u32 first_use = 0;
+        u32 last_use = 0;
+    };
+
+    // Assigns each request an offset into a shared heap, such that requests whose lifetimes overlap never overlap in memory.
+    // Biggest requests are placed first, each at the lowest offset that fits. Returns the size of the heap needed.
+    u64 pack_transient_allocations(const std::span<const TransientAllocationRequest> requests, const std::span<u64> out_offsets);
+
+    struct TransientResourceLifetime
+    {
+        ResourceIdentifier identifier = {};
+        // Indices of the first and last passes to use the resource, in the order passes are recorded in
+        u32 first_use = 0;
+        u32 last_use = 0;
+        // Where the resource goes in its heap. Left at UINT64_MAX to have place_transient_resources() pack it along with
+        // the others, which it only skips when every resource in the heap comes with an offset.
+        u64 heap_offset = UINT64_MAX;
+    };
+
+    // Summed over all copies of the transient resources
+    struct TransientMemoryStats
+    {
+        u32 num_resources = 0;
+        // What the resources would take up if they each had memory of their own
+        u64 unaliased_byte_size = 0;
+        // What they actually take up
+        u64 heap_byte_size = 0;
+    };
+
+    // Allocations set aside by resizes, for when the window goes back to a size it had before
+    struct ResourcePoolStats
+    {
+        u32 num_textures = 0;
+        u32 num_heaps = 0;
+        u64 byte_size = 0;
+    };
+
+
+    // A resource's handles for one in-flight frame. Only the one matching the resource's type is valid.
+    struct ResolvedResource
+    {
+        BufferHandle buffer = {};
+        TextureHandle texture = {};
+    };
 
     // TODO: Should _all_ resources go through this context? Even the creation of e.g. transient constant buffers?
     // TODO: Should we separate resources managed by the render graph and resources that are updated but the client (like e.g. light buffers)?
@@ -91,31 +193,170 @@ namespace zec::render_graph
         // Sets an id so that when a pass writes to these resources, they're really just writing to the backbuffer
         void set_backbuffer_id(const ResourceIdentifier id);
         void set_barrier_state(const ResourceIdentifier id, const BarrierState barrier_state);
-        // TODO handle resize
-        void set_render_config_state(const RenderConfigState& config_state) { render_config_state = config_state; };
+        void set_barrier_state(const ResourceIdentifier id, const u64 frame_idx, const BarrierState barrier_state);
+        void set_barrier_state(const ResourceSlot slot, const u64 frame_idx, const BarrierState barrier_state);
+        // Textures sized relative to the swap chain are recreated when its size changes, everything else is left alone.
+        // What they used is pooled by size rather than freed, so resizing back and forth reuses the same allocations.
+        // The GPU can't be using any of the resources, which gfx::on_window_resize takes care of.
+        void set_render_config_state(const RenderConfigState& config_state);
+        // Frees whatever resizes set aside, e.g. once the window has settled on a size
+        void clear_resource_pool();
+        ResourcePoolStats get_resource_pool_stats() const;
+        // Scale applied to textures registered with dynamic_resolution, in (0, 1]. Only takes effect for the frames recorded
+        // afterwards, so it should be changed between frames.
+        void set_render_scale(const float scale);
+        float get_render_scale() const { return render_scale; };
+        // The part of the texture passes should render to, i.e. all of it unless it's rendered at the dynamic resolution
+        Viewport get_viewport(const ResourceIdentifier id) const;
+        Viewport get_viewport(const ResourceSlot slot) const;
+        Scissor get_scissor(const ResourceIdentifier id) const;
+        Scissor get_scissor(const ResourceSlot slot) const;
 
         BufferHandle get_buffer(const ResourceIdentifier buffer_identifier) const;
         TextureHandle get_texture(const ResourceIdentifier texture_identifier) const;
         BarrierState get_barrier_state(const ResourceIdentifier resource_identifier) const;
+        // Versions of the above for a specific in-flight frame, rather than the current one
+        BufferHandle get_buffer(const ResourceIdentifier buffer_identifier, const u64 frame_idx) const;
+        TextureHandle get_texture(const ResourceIdentifier texture_identifier, const u64 frame_idx) const;
+        BarrierState get_barrier_state(const ResourceIdentifier resource_identifier, const u64 frame_idx) const;
         ResourceIdentifier get_backbuffer_id();
 
-        bool has_buffer(const ResourceIdentifier id) const { return resource_states.contains(id); };
-        bool has_texture(const ResourceIdentifier id) const { return resource_states.contains(id); };
+        // Slots are handed out in the order resources are registered, the backbuffer included. Returns k_invalid_resource_slot
+        // for identifiers that were never registered.
+        ResourceSlot get_slot(const ResourceIdentifier id) const;
+        // Versions of the above that skip the identifier lookup
+        ResolvedResource get_resolved(const ResourceSlot slot, const u64 frame_idx) const { return resource_states[get_state_idx(slot, frame_idx)].resolved; };
+        BarrierState get_barrier_state(const ResourceSlot slot, const u64 frame_idx) const;
+
+        bool has_buffer(const ResourceIdentifier id) const { return slots.contains(id); };
+        bool has_texture(const ResourceIdentifier id) const { return slots.contains(id); };
+        // How many views the resource was registered with, or 0 if it isn't registered
+        u32 get_num_views(const ResourceIdentifier id) const;
 
         void refresh_backbuffer();
+
+        // Resources registered with ResourceLifetime::INFERRED get the lifetime the render graph infers for them, the rest
+        // keep the one they were registered with. Copies are created or released to match. Returns whether any handles changed.
+        bool set_inferred_lifetime(const ResourceIdentifier id, const ResourceLifetime inferred_lifetime);
+        ResourceLifetime get_lifetime(const ResourceIdentifier id) const { return registered_resources[slots.at(id)].lifetime; };
+
+        bool is_transient(const ResourceIdentifier id) const;
+        // Whether a placed transient resource shares memory with another one, in which case it needs an aliasing barrier before its first use each frame
+        bool is_aliased(const ResourceIdentifier id) const;
+        // Packs the transient resources with a lifetime into heaps and (re)creates those that moved, the rest are released.
+        // Returns whether any handles changed.
+        bool place_transient_resources(const std::span<const TransientResourceLifetime> lifetimes);
+        // What the transient resources were last placed with, offsets included
+        std::span<const TransientResourceLifetime> get_transient_lifetimes() const { return transient_lifetimes; }
+        TransientMemoryStats get_transient_memory_stats() const { return transient_memory_stats; };
+        // Bumped whenever any resource's copies are created or released, so that whoever resolved handles can tell when they're stale
+        u64 get_handles_version() const { return handles_version; };
+        // Hash of everything about the registered resources that compiling a render graph depends on, sizes included
+        u64 get_compile_hash() const;
     private:
         // Tracks the state that the resource is in during the execution of the render graph
         struct ResourceState
         {
-            BufferHandle buffer;
-            TextureHandle texture;
+            ResolvedResource resolved;
             ResourceUsage resource_usage;
             CommandQueueType queue_type;
         };
 
+        // Everything needed to (re)create a registered resource's copies
+        struct RegisteredResource
+        {
+            ResourceIdentifier identifier = {};
+            ResourceTransitionType type = ResourceTransitionType::INVALID;
+            std::wstring name = L"";
+            ResourceUsage initial_usage = RESOURCE_USAGE_UNUSED;
+            BufferDesc buffer_desc = {};
+            TextureDesc texture_desc = {};
+            ResourceLifetime requested_lifetime = ResourceLifetime::INFERRED;
+            // Resources start out with a single copy until the render graph infers otherwise
+            ResourceLifetime lifetime = ResourceLifetime::SINGLE;
+            bool is_transient = false;
+            // Shared by every view's copy
+            u32 num_views = 1;
+            // The rest is only used by transient resources
+            ResourceHeapType heap_type = ResourceHeapType::BUFFERS;
+            ResourceAllocationInfo allocation_info = {};
+            // Offset into the heap for its type, UINT64_MAX while the resource isn't placed
+            u64 heap_offset = UINT64_MAX;
+            bool is_aliased = false;
+            // Textures only. Relative sizes are applied to the swap chain's size again whenever it changes.
+            Sizing sizing = Sizing::ABSOLUTE;
+            float relative_width_factor = 1.0f;
+            float relative_height_factor = 1.0f;
+            bool dynamic_resolution = false;
+        };
+
+        // Released by a resize, along with the state it was left in
+        struct PooledTexture
+        {
+            ResourceSlot slot = k_invalid_resource_slot;
+            u32 width = 0;
+            u32 height = 0;
+            TextureHandle texture = {};
+            ResourceUsage resource_usage = RESOURCE_USAGE_UNUSED;
+            CommandQueueType queue_type = CommandQueueType::GRAPHICS;
+            u32 released_at_resize = 0;
+        };
+
+        struct PooledHeap
+        {
+            ResourceHeapType type = ResourceHeapType::BUFFERS;
+            u64 byte_size = 0;
+            ResourceHeapHandle heap = {};
+            u32 released_at_resize = 0;
+        };
+
+        struct TransientHeap
+        {
+            // Heaps for resources with a single copy only use the first one
+            ResourceHeapHandle heaps[RENDER_LATENCY] = {};
+            u64 byte_size = 0;
+        };
+
+        static size_t get_state_idx(const ResourceSlot slot, const u64 frame_idx)
+        {
+            return size_t(slot) * RENDER_LATENCY + frame_idx % RENDER_LATENCY;
+        }
+
+        ResourceSlot add_slot(RegisteredResource&& registered_resource);
+        void register_resource(RegisteredResource&& registered_resource);
+        // Creates the resource's copies, placed in the transient heaps if it's transient. Frames past the last copy share the first one.
+        void create_copies(const ResourceSlot slot, const u32 first_copy = 0);
+        void release_copies(const ResourceSlot slot);
+        void create_transient_resource(const ResourceSlot slot, const u64 heap_offset);
+        void release_transient_resource(const ResourceSlot slot);
+        TransientHeap& get_transient_heap(const RegisteredResource& transient_resource);
+        TextureDesc get_sized_texture_desc(const RegisteredResource& registered_resource) const;
+        // Take from the pool where possible
+        TextureHandle create_texture(const ResourceSlot slot, const u32 copy_idx);
+        ResourceHeapHandle create_heap(const ResourceHeapType type, const u64 byte_size);
+        // Pools the allocation while resizing, and frees it otherwise
+        void release_heap(const ResourceHeapHandle heap, const ResourceHeapType type, const u64 byte_size);
+        // Size of the part of the texture that's rendered to
+        void get_render_size(const ResourceSlot slot, u32& width, u32& height) const;
+
         ResourceIdentifier backbuffer_id = {};
-        RenderConfigState render_config_state;
-        std::unordered_map< ResourceIdentifier, ResourceState[RENDER_LATENCY]> resource_states;
+        RenderConfigState render_config_state = {};
+        std::unordered_map<ResourceIdentifier, ResourceSlot> slots = {};
+        // RENDER_LATENCY states per slot, see get_state_idx
+        std::vector<ResourceState> resource_states = {};
+        // Indexed by slot. The backbuffer's entry only carries its identifier and lifetime.
+        std::vector<RegisteredResource> registered_resources = {};
+        // Like the resources in them, each copy gets its own heaps. Indexed by whether the resources have a single copy, then heap type.
+        TransientHeap transient_heaps[2][size_t(ResourceHeapType::COUNT)] = {};
+        TransientMemoryStats transient_memory_stats = {};
+        u64 handles_version = 0;
+        // Kept to place the transient resources again when their sizes change
+        std::vector<TransientResourceLifetime> transient_lifetimes = {};
+        std::vector<PooledTexture> texture_pool = {};
+        std::vector<PooledHeap> heap_pool = {};
+        u32 num_resizes = 0;
+        bool is_resizing = false;
+        float render_scale = 1.0f;
     };
 
     template<typename TIdentifier, typename THandle>
@@ -197,52 +438,121 @@ namespace zec::render_graph
         Store<PipelineId, PipelineCompilationDesc> recompilation_infos;
     };
 
+    // Identifies a type without RTTI. Each instantiation of type_id_tag has its own address, which is the same in every
+    // translation unit. The tags aren't const, since the linker could otherwise fold identical read-only data together
+    // (e.g. MSVC's /OPT:ICF) and give every type the same id.
+    using TypeId = const void*;
+
+    template<typename T>
+    inline char type_id_tag = 0;
+
+    template<typename T>
+    constexpr TypeId get_type_id()
+    {
+        return &type_id_tag<std::remove_cvref_t<T>>;
+    }
+
+    // Points straight at an entry of a PassDataStore, so that passes can look their data up once in their setup_fn
+    // and read it every frame without going through the store. Sees whatever the entry is later set to.
+    template<typename T>
+    class PassDataRef
+    {
+    public:
+        PassDataRef() = default;
+        explicit PassDataRef(const T* ptr) : ptr{ ptr } {};
+
+        const T& operator*() const
+        {
+            ASSERT(ptr != nullptr);
+            return *ptr;
+        }
+
+        const T* operator->() const
+        {
+            ASSERT(ptr != nullptr);
+            return ptr;
+        }
+
+        bool is_valid() const { return ptr != nullptr; }
+
+    private:
+        const T* ptr = nullptr;
+    };
+
     class PassDataStore
     {
         struct DataEntry
         {
             void* ptr = nullptr;
-            const size_t byte_size = 0;
+            TypeId type_id = nullptr;
         };
     public:
-
+        // Adds an entry holding a copy of data, unless there already is one under the same identifier, in which case
+        // that one's kept. Either way, returns a reference to the entry.
         template<typename T>
-        void emplace(const ResourceIdentifier id, const T& data)
+        PassDataRef<T> emplace(const ResourceIdentifier id, const T& data)
         {
-            if (entries.count(id) == 0)
+            // Entries are never destroyed, their memory is simply released along with the store
+            static_assert(std::is_trivially_destructible_v<T>);
+            const auto [it, inserted] = indices.insert({ get_view_identifier(id, view_idx), u32(entries.size()) });
+            if (inserted)
             {
-                T* ptr = reinterpret_cast<T*>(allocator.allocate(sizeof(T)));
-                *ptr = data;
-                entries.insert({ id, { ptr, sizeof(T) }});
+                T* ptr = new (allocator.allocate(sizeof(T), alignof(T))) T(data);
+                entries.push_back({ ptr, get_type_id<T>() });
             }
             else
             {
-                ASSERT_MSG(entries[id].byte_size == sizeof(T), "Size mismatch for setting %s, this setting has \
-                    already been registered under the same identifier but with a different byte size");
+                ASSERT_MSG(entries[it->second].type_id == get_type_id<T>(), "This data has already been registered under the same identifier, but with a different type");
             }
+            return PassDataRef<T>{ static_cast<const T*>(entries[it->second].ptr) };
         }
 
         template<typename T>
         void set(const ResourceIdentifier id, const T data)
         {
-            ASSERT_MSG(entries.contains(id), "This per pass data has not been registered");
-            DataEntry& entry = entries.at(id);
-            ASSERT(entry.byte_size == sizeof(T));
-            *static_cast<T*>(entry.ptr) = data;
+            *static_cast<T*>(get_entry<T>(id).ptr) = data;
         }
 
         template<typename T>
         const T& get(const ResourceIdentifier id) const
         {
-            ASSERT_MSG(entries.contains(id), "This per pass data has not been registered");
-            const DataEntry& entry = entries.at(id);
-            ASSERT(entry.byte_size == sizeof(T));
-            return *static_cast<const T*>(entries.at(id).ptr);
+            return *static_cast<const T*>(get_entry<T>(id).ptr);
         }
 
+        template<typename T>
+        PassDataRef<T> get_ref(const ResourceIdentifier id) const
+        {
+            return PassDataRef<T>{ static_cast<const T*>(get_entry<T>(id).ptr) };
+        }
+
+        // While set to another view than 0, entries are emplaced under the view's own identifier, and looked up under it
+        // before falling back to the identifier shared by all views. Lets a single setup_fn serve every view of a pass.
+        void set_view_idx(const u32 idx) { view_idx = idx; }
+
+        // Entries are numbered in the order they were emplaced, which lets the render graph tell which ones a pass' setup_fn added
+        u32 get_num_entries() const { return u32(entries.size()); }
+        const void* get_entry_ptr(const u32 entry_idx) const { return entries[entry_idx].ptr; }
+        TypeId get_entry_type_id(const u32 entry_idx) const { return entries[entry_idx].type_id; }
+
     private:
-        FixedLinearAllocator<1024> allocator = {};
-        std::unordered_map<ResourceIdentifier, DataEntry> entries = {};
+        template<typename T>
+        const DataEntry& get_entry(const ResourceIdentifier id) const
+        {
+            auto it = indices.find(get_view_identifier(id, view_idx));
+            if (it == indices.end())
+            {
+                it = indices.find(id);
+            }
+            ASSERT_MSG(it != indices.end(), "This per pass data has not been registered");
+            const DataEntry& entry = entries[it->second];
+            ASSERT_MSG(entry.type_id == get_type_id<T>(), "This data was registered with a different type");
+            return entry;
+        }
+
+        GrowableLinearAllocator allocator = {};
+        std::vector<DataEntry> entries = {};
+        std::unordered_map<ResourceIdentifier, u32> indices = {};
+        u32 view_idx = 0;
     };
 
     using SettingsStore = PassDataStore;
@@ -255,21 +565,88 @@ namespace zec::render_graph
         TEXTURE,
     };
 
+    // What a pass needs a render target or depth target to hold when it starts. Load and store ops are inferred from
+    // this and from what the other passes do with the resource.
+    enum struct AttachmentContents : u8
+    {
+        // Whatever earlier passes wrote to it, if anything did this frame
+        PRESERVE = 0,
+        // Cleared to PassResourceUsage::clear_value
+        CLEARED,
+        // The pass writes every pixel it cares about, so previous contents aren't needed
+        OVERWRITTEN,
+    };
+
     struct PassResourceUsage
     {
         ResourceIdentifier identifier = {};
         PassResourceType type = PassResourceType::INVALID;
         ResourceUsage usage = RESOURCE_USAGE_UNUSED;
+        // Textures only. Lets a pass use a single mip level and/or array slice, e.g. to read one mip while writing the
+        // next, with the rest of the texture left in whatever state it was in.
+        u32 mip_level = k_all_subresources;
+        u32 array_slice = k_all_subresources;
+        // Buffers only. The bytes a compute writable use touches, when it isn't the whole buffer. Consecutive compute
+        // writable uses of disjoint ranges don't need a UAV barrier between them.
+        u64 byte_offset = 0;
+        u64 byte_size = 0;
+        // Set when the pass' accesses don't depend on, or overlap with, what earlier passes wrote to the resource since
+        // its last barrier, so no UAV barrier is needed before it
+        bool independent_writes = false;
+        // Render target and depth stencil uses only, see AttachmentContents. Depth targets use the first clear value
+        // for depth and the second for stencil.
+        AttachmentContents contents = AttachmentContents::PRESERVE;
+        float clear_value[4] = {};
     };
 
     struct PassExecutionContext
     {
         const ResourceContext* resource_context = nullptr;
+        // The pass' resources for the frame being recorded, resolved when the list was compiled. Indexed like the PassDesc's
+        // inputs and outputs, so passes can skip looking their resources up by identifier.
+        std::span<const ResolvedResource> input_resources = {};
+        std::span<const ResolvedResource> output_resources = {};
         // TODO: Do we even need this? Can we not just get it through our recompilation desc?
         const PipelineStore* pipeline_context = nullptr;
         const SettingsStore* settings_context = nullptr;
         const PerPassDataStore* per_pass_data_store = nullptr;
         CommandContextHandle cmd_context = {};
+        // The first entry the pass' setup_fn added to the per pass data store, if it added any
+        const void* pass_data = nullptr;
+        TypeId pass_data_type_id = nullptr;
+        // Which of the graph's views the pass renders, for passes added once per view
+        u32 view_idx = 0;
+        // Which share of the pass' work to record, for passes that allow more than one recording job.
+        // Each job records into its own command context, so state like render targets has to be set up by every job.
+        u32 job_idx = 0;
+        u32 num_jobs = 1;
+        // Slots of the pass' resources, indexed like input_resources and output_resources
+        std::span<const ResourceSlot> input_slots = {};
+        std::span<const ResourceSlot> output_slots = {};
+
+        TextureHandle get_input_texture(const size_t input_idx) const { return input_resources[input_idx].texture; }
+        BufferHandle get_input_buffer(const size_t input_idx) const { return input_resources[input_idx].buffer; }
+        TextureHandle get_output_texture(const size_t output_idx) const { return output_resources[output_idx].texture; }
+        BufferHandle get_output_buffer(const size_t output_idx) const { return output_resources[output_idx].buffer; }
+        // See ResourceContext::get_viewport
+        Viewport get_input_viewport(const size_t input_idx) const { return resource_context->get_viewport(input_slots[input_idx]); }
+        Viewport get_output_viewport(const size_t output_idx) const { return resource_context->get_viewport(output_slots[output_idx]); }
+        Scissor get_output_scissor(const size_t output_idx) const { return resource_context->get_scissor(output_slots[output_idx]); }
+
+        template<typename T>
+        const T& get_pass_data() const
+        {
+            ASSERT_MSG(pass_data != nullptr, "The pass' setup_fn didn't add any per pass data");
+            ASSERT_MSG(pass_data_type_id == get_type_id<T>(), "The pass' data has a different type");
+            return *static_cast<const T*>(pass_data);
+        }
+
+        // Splits num_items evenly between the pass' jobs, setting [begin, end) to the range this job should record
+        void get_job_range(const size_t num_items, size_t& begin, size_t& end) const
+        {
+            begin = (num_items * job_idx) / num_jobs;
+            end = (num_items * (job_idx + 1)) / num_jobs;
+        }
     };
 
     typedef void(*PassSetupFn)(const SettingsStore* settings_context, PerPassDataStore* per_pass_data_store);
@@ -286,6 +663,48 @@ namespace zec::render_graph
         const PassTeardownFn teardown_fn = nullptr;
         const std::span<PassResourceUsage const> inputs = {};
         const std::span<PassResourceUsage const> outputs = {};
+        // Passes with lots of draws can split their recording into up to this many jobs, recorded on different threads
+        // when the list is executed with a task scheduler. execute_fn is then called once per job, at the same time.
+        const u32 max_recording_jobs = 1;
+        // Compute passes that only use compute compatible resource usages can let the graph compiler move them to the
+        // async compute queue, where they overlap with graphics work they don't depend on.
+        const bool allow_async_compute = false;
+    };
+
+    // How many times each of the render graph's compile stages has run
+    struct RenderGraphCompileStats
+    {
+        u32 num_pass_compiles = 0;
+        u32 num_barrier_compiles = 0;
+        u32 num_handle_resolves = 0;
+    };
+
+    // Number of recorded frames the rolling averages of the stats below are taken over
+    constexpr u32 RENDER_GRAPH_STATS_HISTORY_LENGTH = 64;
+
+    // What recording a pass took and produced in a frame. Passes that didn't run in a frame have all zeros.
+    struct PassStats
+    {
+        // Summed over the pass' recording jobs, which may have run in parallel
+        float cpu_record_ms = 0.0f;
+        // Before and after the pass' work
+        u32 num_transitions = 0;
+        u32 num_uav_barriers = 0;
+        u32 num_aliasing_barriers = 0;
+        u32 num_draws = 0;
+        u32 num_dispatches = 0;
+        // One per recording job
+        u32 num_command_lists = 0;
+    };
+
+    struct RenderGraphFrameStats
+    {
+        // From the start of recording to the last submission, compilation excluded
+        float cpu_record_ms = 0.0f;
+        u32 num_submits = 0;
+        // The passes' along with the one transitioning resources after a compile, if any
+        u32 num_command_lists = 0;
+        u32 num_gpu_waits = 0;
     };
 
     class PassListBuilder;
@@ -299,9 +718,100 @@ namespace zec::render_graph
         struct Pass
         {
             bool enabled = true;
-            bool requires_flush = false;
-            u32 dependency_index = UINT32_MAX;
             PassDesc desc = {};
+            // The queue compile() scheduled the pass on. Differs from desc.command_queue_type for passes moved to async compute.
+            CommandQueueType queue_type = CommandQueueType::GRAPHICS;
+            // Slots of the inputs followed by the outputs, looked up once when the pass is added
+            std::vector<ResourceSlot> resource_slots = {};
+            // Entry of per_pass_data_store handed to execute_fn, set by setup()
+            u32 pass_data_idx = UINT32_MAX;
+            u32 view_idx = 0;
+            // What desc's inputs and outputs point at for passes added for another view than 0, with the resources the
+            // view has its own copies of swapped in
+            std::vector<PassResourceUsage> view_inputs = {};
+            std::vector<PassResourceUsage> view_outputs = {};
+        };
+
+        // Produced by compile(), so that execute() only has to walk flat arrays
+        struct CompiledPass
+        {
+            u32 pass_idx = UINT32_MAX;
+            // Ranges into compiled_transitions and compiled_uav_barriers, recorded before the pass' work
+            u32 transitions_offset = 0;
+            u32 num_transitions = 0;
+            u32 uav_barriers_offset = 0;
+            u32 num_uav_barriers = 0;
+            // Transient resources sharing memory with others, used for the first time this frame by this pass
+            u32 aliasing_barriers_offset = 0;
+            u32 num_aliasing_barriers = 0;
+            // Index into compiled_passes of the pass on another queue that has to finish before this one can start
+            u32 wait_on_pass = UINT32_MAX;
+            // Range into compiled_transitions recorded after the pass' work
+            u32 after_transitions_offset = 0;
+            u32 num_after_transitions = 0;
+            // Range into compiled_attachments. Graphics passes with any are recorded inside a render pass binding them.
+            u32 attachments_offset = 0;
+            u32 num_attachments = 0;
+            // Offset into compiled_pass_resources of the pass' inputs, followed by its outputs
+            u32 resources_offset = 0;
+        };
+
+        // A transition or barrier before its resource's handle is resolved for a particular frame
+        struct CompiledBarrier
+        {
+            u32 resource_idx;
+            PassResourceType type;
+            ResourceUsage before;
+            ResourceUsage after;
+            u32 mip_level = k_all_subresources;
+            u32 array_slice = k_all_subresources;
+            SplitBarrier split = SplitBarrier::NONE;
+        };
+
+        // compile() only re-runs the stages that are dirty, and each stage dirties the ones after it when its results change
+        enum CompileStage : u8
+        {
+            // Culling, ordering and queue assignment of the enabled passes
+            COMPILE_STAGE_PASSES = 1 << 0,
+            // Resource lifetimes and placement, barriers and attachments
+            COMPILE_STAGE_BARRIERS = 1 << 1,
+            // Resolving the compiled resources to the handles of each in-flight frame's copies
+            COMPILE_STAGE_HANDLES = 1 << 2,
+            COMPILE_STAGE_ALL = COMPILE_STAGE_PASSES | COMPILE_STAGE_BARRIERS | COMPILE_STAGE_HANDLES,
+        };
+
+        // Work for a single command context, recorded by execute()
+        struct RecordingJob
+        {
+            RenderTaskList* list = nullptr;
+            u32 compiled_pass_idx = UINT32_MAX;
+            u32 job_idx = 0;
+            u32 num_jobs = 1;
+            // Provisioned by whichever thread records the job
+            CommandContextHandle cmd_ctx = {};
+            // Filled in by record()
+            float cpu_record_ms = 0.0f;
+            CommandContextStats recorded = {};
+        };
+
+        struct CompiledAttachment
+        {
+            ResourceIdentifier identifier = {};
+            // Index into compiled_pass_resources
+            u32 resolved_idx = 0;
+            bool is_backbuffer = false;
+            bool is_depth_target = false;
+            LoadOp load_op = LoadOp::LOAD;
+            StoreOp store_op = StoreOp::STORE;
+            float clear_value[4] = {};
+        };
+
+        struct CompiledResource
+        {
+            ResourceIdentifier identifier = {};
+            ResourceSlot slot = k_invalid_resource_slot;
+            // The state the resource is in at the start and end of every frame
+            BarrierState frame_state = {};
         };
     public:
         RenderTaskList() = default;
@@ -309,7 +819,29 @@ namespace zec::render_graph
         // TODO: Either call or ensure that PassTeardownFn has been called for all passes
         ~RenderTaskList() = default;
 
-        void execute(/*TaskScheduler& task_scheduler*/);
+        // Orders the enabled passes by their resource dependencies, culls those whose outputs never reach the backbuffer
+        // or an exported resource, picks the queue for passes that allow async compute along with the cross queue waits they
+        // need, places transient resources based on when they're used, and precomputes the transitions and UAV and
+        // aliasing barriers each pass needs.
+        // execute() calls this itself if the list has changed since it was last compiled, and only the stages affected by
+        // the change are re-run: toggling a pass that ends up culled anyway leaves everything as is, and resources that get
+        // recreated only need their handles resolving again.
+        void compile();
+        // Hash of the pass descriptions, which passes are enabled, and the resources they use. Lists with the same hash
+        // compile to the same thing.
+        u64 get_compile_hash() const;
+        // What compile() worked out, apart from the resources' handles: the pass order and queues, resource lifetimes, the
+        // barriers and attachments, and where transient resources are placed. Tagged with get_compile_hash(). The list
+        // has to have been compiled.
+        std::vector<u8> serialize_compiled() const;
+        // Restores what serialize_compiled() wrote, so that compiling only has to resolve handles. Returns false and leaves
+        // the list as it was when the data is malformed or was written for a list with another hash.
+        bool load_compiled(const std::span<const u8> data);
+        // Records every pass on the calling thread
+        void execute();
+        // Records the passes as tasks, each into its own command context, then submits them in order from the calling thread.
+        // Falls back to recording on the calling thread if the scheduler has more than MAX_NUM_RECORDING_THREADS threads.
+        void execute(TaskScheduler& task_scheduler);
         void setup(/*TaskScheduler& task_scheduler*/);
 
         template<typename T>
@@ -321,7 +853,7 @@ namespace zec::render_graph
         template<typename T>
         T get_settings(const ResourceIdentifier settings_id) const
         {
-            return settings_context.get(settings_id);
+            return settings_context.get<T>(settings_id);
         };
 
         bool get_pass_enabled(const PassHandle pass_handle)
@@ -339,17 +871,145 @@ namespace zec::render_graph
         void set_pass_enabled(const PassHandle pass_handle, const bool pass_is_enabled)
         {
             ASSERT(pass_handle.idx < passes.size());
-            passes[pass_handle.idx].enabled = pass_is_enabled;
+            if (passes[pass_handle.idx].enabled != pass_is_enabled) {
+                passes[pass_handle.idx].enabled = pass_is_enabled;
+                dirty_stages |= COMPILE_STAGE_PASSES;
+            }
+        }
+
+        bool get_is_compiled() const
+        {
+            return dirty_stages == 0 && resolved_handles_version == resource_context->get_handles_version();
+        }
+
+        RenderGraphCompileStats get_compile_stats() const
+        {
+            return compile_stats;
+        }
+
+        // The passes that will actually run, in the order they'll be recorded in
+        size_t get_num_compiled_passes() const
+        {
+            return compiled_passes.size();
+        }
+
+        PassHandle get_compiled_pass(const size_t compiled_pass_idx) const
+        {
+            ASSERT(compiled_pass_idx < compiled_passes.size());
+            return { compiled_passes[compiled_pass_idx].pass_idx };
+        }
+
+        // UAV barriers that compile() left out, per frame, because the passes' declared accesses didn't overlap
+        u32 get_num_elided_uav_barriers() const
+        {
+            return num_elided_uav_barriers;
+        }
+
+        // The pass on another queue that the compiled pass has to wait on, if any. Waits already implied by earlier ones
+        // are left out.
+        PassHandle get_compiled_pass_wait(const size_t compiled_pass_idx) const
+        {
+            ASSERT(compiled_pass_idx < compiled_passes.size());
+            const u32 wait_on_pass = compiled_passes[compiled_pass_idx].wait_on_pass;
+            return wait_on_pass == UINT32_MAX ? PassHandle{} : PassHandle{ compiled_passes[wait_on_pass].pass_idx };
+        }
+
+        // Load and store ops inferred for one of a compiled pass' render targets or its depth target
+        LoadOp get_load_op(const size_t compiled_pass_idx, const ResourceIdentifier id) const
+        {
+            return get_compiled_attachment(compiled_pass_idx, id).load_op;
+        }
+
+        StoreOp get_store_op(const size_t compiled_pass_idx, const ResourceIdentifier id) const
+        {
+            return get_compiled_attachment(compiled_pass_idx, id).store_op;
+        }
+
+        // The queue the pass was last scheduled on
+        CommandQueueType get_pass_queue(const PassHandle pass_handle) const
+        {
+            ASSERT(pass_handle.idx < passes.size());
+            return passes[pass_handle.idx].queue_type;
+        }
+
+        // Stats of the last frame recorded
+        PassStats get_pass_stats(const PassHandle pass_handle) const;
+        RenderGraphFrameStats get_frame_stats() const;
+        // Rolling averages over the last RENDER_GRAPH_STATS_HISTORY_LENGTH frames, or as many as have been recorded.
+        // Counts are rounded to the nearest whole number.
+        PassStats get_average_pass_stats(const PassHandle pass_handle) const;
+        RenderGraphFrameStats get_average_frame_stats() const;
+        void reset_stats();
+
+        // Lets compile() move passes that allow it to the async compute queue. On by default.
+        void set_async_compute_enabled(const bool enabled)
+        {
+            if (async_compute_enabled != enabled) {
+                async_compute_enabled = enabled;
+                dirty_stages |= COMPILE_STAGE_PASSES;
+            }
         }
 
     private:
         std::vector<Pass> passes = {};
+        // Resources that are used outside of the list, so passes writing to them are never culled
+        std::vector<ResourceIdentifier> exported_resources = {};
+
+        u8 dirty_stages = COMPILE_STAGE_ALL;
+        // The resource context's handles version that compiled_transitions and friends were resolved against
+        u64 resolved_handles_version = 0;
+        RenderGraphCompileStats compile_stats = {};
+        bool async_compute_enabled = true;
+        u32 num_elided_uav_barriers = 0;
+        std::vector<CompiledPass> compiled_passes = {};
+        std::vector<CompiledResource> compiled_resources = {};
+        std::unordered_map<ResourceIdentifier, u32> compiled_resource_indices = {};
+        // Barriers and pass resources as they are for every frame, kept around so that handles can be resolved again on their own
+        std::vector<CompiledBarrier> frame_transitions = {};
+        std::vector<CompiledBarrier> frame_uav_barriers = {};
+        std::vector<CompiledBarrier> frame_aliasing_barriers = {};
+        std::vector<ResourceSlot> pass_resource_slots = {};
+        // One copy per in-flight frame, since each frame uses its own copies of the resources
+        std::vector<ResourceTransitionDesc> compiled_transitions[RENDER_LATENCY] = {};
+        std::vector<ResourceTransitionDesc> compiled_uav_barriers[RENDER_LATENCY] = {};
+        // Only the type and handle are used
+        std::vector<ResourceTransitionDesc> compiled_aliasing_barriers[RENDER_LATENCY] = {};
+        std::vector<CompiledAttachment> compiled_attachments = {};
+        // What each pass' execution context points its input and output resources at
+        std::vector<ResolvedResource> compiled_pass_resources[RENDER_LATENCY] = {};
+        // Transitions and resources of the backbuffer, which we can only fill in once we know which back buffer we're rendering to
+        std::vector<u32> backbuffer_transition_indices = {};
+        std::vector<u32> backbuffer_resource_indices = {};
+        // Set by compile(). Resources might not be in the state the compiled transitions expect them to be in
+        // at the start of a frame, so the first frame after compilation transitions them into it.
+        bool needs_state_fixup[RENDER_LATENCY] = {};
+        std::vector<RecordingJob> recording_jobs = {};
+        // Frame whose copies of the compiled barriers the recording jobs use
+        u64 recording_frame_idx = 0;
+        // Ring buffers of RENDER_GRAPH_STATS_HISTORY_LENGTH frames. The pass stats are indexed by pass first, so that adding
+        // passes only appends to them.
+        std::vector<PassStats> pass_stats_history = {};
+        RenderGraphFrameStats frame_stats_history[RENDER_GRAPH_STATS_HISTORY_LENGTH] = {};
+        u64 num_frames_recorded = 0;
 
         // TODO: Find a better naming for this. Settings vs Resources vs PerPass isn't really all that helpful I don't think.
         ResourceContext* resource_context = nullptr;
         PipelineStore* shader_store = nullptr;
         SettingsStore settings_context = {};
         PerPassDataStore per_pass_data_store = {};
+
+        const CompiledAttachment& get_compiled_attachment(const size_t compiled_pass_idx, const ResourceIdentifier id) const;
+        // The stages of compile(). compile_passes() returns whether the passes that run, their order or their queues changed.
+        bool compile_passes();
+        void compile_barriers();
+        void resolve_handles();
+        void record_and_submit(TaskScheduler* task_scheduler);
+        // thread_idx is UINT32_MAX when recording without a task scheduler
+        void record(RecordingJob& job, const u32 thread_idx);
+        static void record_task(TaskScheduler* task_scheduler, void* arg);
+        void gather_stats(const RenderGraphFrameStats& frame_stats);
+        PassStats& get_pass_stats_entry(const u32 pass_idx, const u64 frame) { return pass_stats_history[size_t(pass_idx) * RENDER_GRAPH_STATS_HISTORY_LENGTH + frame % RENDER_GRAPH_STATS_HISTORY_LENGTH]; }
+        const PassStats& get_pass_stats_entry(const u32 pass_idx, const u64 frame) const { return pass_stats_history[size_t(pass_idx) * RENDER_GRAPH_STATS_HISTORY_LENGTH + frame % RENDER_GRAPH_STATS_HISTORY_LENGTH]; }
     };
 
     class PassListBuilder
@@ -408,7 +1068,12 @@ namespace zec::render_graph
         void set_resource_context(ResourceContext* resource_context);
         void set_shader_store(PipelineStore* shader_store);
         void set_pass_list(RenderTaskList* pass_list);
-        Result add_pass(const PassDesc& render_pass_desc);
+        // Passes that depend on a view, like a camera's depth prepass, are added once per view. Each one uses the view's own
+        // copy of the resources registered per view, and the shared copy of everything else, so view independent passes
+        // like light list uploads only have to be added once. Their setup_fn sees the view's own settings, where it has any.
+        Result add_pass(const PassDesc& render_pass_desc, const u32 view_idx = 0);
+        // Marks a resource as being used outside of the list (e.g. read back, or read next frame), so that passes writing to it don't get culled
+        void export_resource(const ResourceIdentifier id);
 
     private:
         struct BuilderResourceState : BarrierState
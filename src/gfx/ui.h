@@ -12,5 +12,10 @@ namespace zec::ui
 
     void begin_frame();
     void end_frame();
+
+    // Copies the draw data produced by end_frame(), so draw_frame() can record it while the next UI frame is being built.
+    // Once a frame has been captured, draw_frame() always draws the latest capture.
+    void capture_frame();
+
     void draw_frame(CommandContextHandle context_handle);
 }
\ No newline at end of file
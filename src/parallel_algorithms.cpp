@@ -0,0 +1,107 @@
+#include "parallel_algorithms.h"
+#include <cstring>
+#include <utility>
+
+namespace zec
+{
+    namespace
+    {
+        constexpr u32 RADIX_BITS = 8;
+        constexpr u32 RADIX_SIZE = 1 << RADIX_BITS;
+        constexpr u32 RADIX_MASK = RADIX_SIZE - 1;
+        // Each chunk builds its own histogram, so we don't want too many of them
+        constexpr size_t MIN_RADIX_SORT_GRAIN_SIZE = 4096;
+
+        template<typename TKey>
+        inline u32 get_digit(const TKey key, const u32 shift)
+        {
+            return u32(key >> shift) & RADIX_MASK;
+        }
+
+        template<typename TKey>
+        void radix_sort(TaskScheduler& task_scheduler, TKey* keys, u32* values, TKey* scratch_keys, u32* scratch_values, const size_t count)
+        {
+            ASSERT_MSG((values == nullptr) == (scratch_values == nullptr), "Values and scratch values must either both be provided or both be null");
+            if (count < 2) {
+                return;
+            }
+
+            const size_t grain_size = get_grain_size(task_scheduler, count, MIN_RADIX_SORT_GRAIN_SIZE);
+            const size_t num_chunks = (count + grain_size - 1) / grain_size;
+            // histograms[chunk_idx * RADIX_SIZE + digit] holds the count of that digit, and later the chunk's write offset for it
+            std::vector<size_t> histograms(num_chunks * RADIX_SIZE);
+
+            TKey* src_keys = keys;
+            TKey* dst_keys = scratch_keys;
+            u32* src_values = values;
+            u32* dst_values = scratch_values;
+
+            for (u32 shift = 0; shift < sizeof(TKey) * 8; shift += RADIX_BITS) {
+                auto count_digits = [&](const size_t chunk_idx, const size_t begin, const size_t end) {
+                    size_t* histogram = &histograms[chunk_idx * RADIX_SIZE];
+                    memset(histogram, 0, RADIX_SIZE * sizeof(size_t));
+                    for (size_t i = begin; i < end; i++) {
+                        histogram[get_digit(src_keys[i], shift)]++;
+                    }
+                };
+                internal::parallel_for_chunks(task_scheduler, count, grain_size, count_digits, TaskPriority::HIGH);
+
+                // Every key has the same digit, so this pass wouldn't change the order
+                const u32 first_digit = get_digit(src_keys[0], shift);
+                size_t first_digit_count = 0;
+                for (size_t chunk_idx = 0; chunk_idx < num_chunks; chunk_idx++) {
+                    first_digit_count += histograms[chunk_idx * RADIX_SIZE + first_digit];
+                }
+                if (first_digit_count == count) {
+                    continue;
+                }
+
+                // Offsets are ordered by digit first and then by chunk, which keeps the sort stable
+                size_t offset = 0;
+                for (u32 digit = 0; digit < RADIX_SIZE; digit++) {
+                    for (size_t chunk_idx = 0; chunk_idx < num_chunks; chunk_idx++) {
+                        const size_t digit_count = histograms[chunk_idx * RADIX_SIZE + digit];
+                        histograms[chunk_idx * RADIX_SIZE + digit] = offset;
+                        offset += digit_count;
+                    }
+                }
+
+                auto scatter = [&](const size_t chunk_idx, const size_t begin, const size_t end) {
+                    size_t* offsets = &histograms[chunk_idx * RADIX_SIZE];
+                    for (size_t i = begin; i < end; i++) {
+                        const size_t dst_idx = offsets[get_digit(src_keys[i], shift)]++;
+                        dst_keys[dst_idx] = src_keys[i];
+                        if (src_values != nullptr) {
+                            dst_values[dst_idx] = src_values[i];
+                        }
+                    }
+                };
+                internal::parallel_for_chunks(task_scheduler, count, grain_size, scatter, TaskPriority::HIGH);
+
+                std::swap(src_keys, dst_keys);
+                std::swap(src_values, dst_values);
+            }
+
+            // An odd number of passes ran, so the results are sitting in the scratch buffers
+            if (src_keys != keys) {
+                auto copy_back = [&](const size_t begin, const size_t end) {
+                    memcpy(keys + begin, src_keys + begin, (end - begin) * sizeof(TKey));
+                    if (values != nullptr) {
+                        memcpy(values + begin, src_values + begin, (end - begin) * sizeof(u32));
+                    }
+                };
+                parallel_for(task_scheduler, count, copy_back, grain_size);
+            }
+        }
+    }
+
+    void parallel_radix_sort(TaskScheduler& task_scheduler, u32* keys, u32* values, u32* scratch_keys, u32* scratch_values, const size_t count)
+    {
+        radix_sort(task_scheduler, keys, values, scratch_keys, scratch_values, count);
+    }
+
+    void parallel_radix_sort(TaskScheduler& task_scheduler, u64* keys, u32* values, u64* scratch_keys, u32* scratch_values, const size_t count)
+    {
+        radix_sort(task_scheduler, keys, values, scratch_keys, scratch_values, count);
+    }
+}
@@ -0,0 +1,185 @@
+#pragma once
+#include <atomic>
+#include <vector>
+
+#include "cpu_tasks.h"
+#include "utils/assert.h"
+
+namespace zec
+{
+    // Upper bound on the number of tasks a single parallel algorithm call will spawn
+    constexpr size_t MAX_PARALLEL_TASKS = 256;
+
+    // Picks a grain size that gives each thread a few chunks to balance the load with, without letting chunks get so
+    // small that the scheduling overhead dominates.
+    inline size_t get_grain_size(const TaskScheduler& task_scheduler, const size_t count, const size_t min_grain_size = 256)
+    {
+        constexpr size_t CHUNKS_PER_THREAD = 4;
+        const size_t num_threads = task_scheduler.get_num_threads() > 0 ? task_scheduler.get_num_threads() : 1;
+        const size_t grain_size = (count + num_threads * CHUNKS_PER_THREAD - 1) / (num_threads * CHUNKS_PER_THREAD);
+        return grain_size > min_grain_size ? grain_size : min_grain_size;
+    }
+
+    namespace internal
+    {
+        // Chunks are handed out dynamically through an atomic index, so every task shares the same argument
+        // and a slow chunk doesn't hold up a statically assigned range.
+        template<typename Fn>
+        struct ParallelForData
+        {
+            Fn* fn;
+            size_t count;
+            size_t grain_size;
+            size_t num_chunks;
+            std::atomic<size_t> next_chunk = 0;
+        };
+
+        template<typename Fn>
+        void execute_chunks(ParallelForData<Fn>& data)
+        {
+            size_t chunk_idx = data.next_chunk.fetch_add(1, std::memory_order_relaxed);
+            while (chunk_idx < data.num_chunks) {
+                const size_t begin = chunk_idx * data.grain_size;
+                const size_t end = begin + data.grain_size < data.count ? begin + data.grain_size : data.count;
+                (*data.fn)(chunk_idx, begin, end);
+                chunk_idx = data.next_chunk.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        template<typename Fn>
+        void parallel_for_task(TaskScheduler* task_scheduler, void* arg)
+        {
+            execute_chunks(*static_cast<ParallelForData<Fn>*>(arg));
+        }
+
+        // fn(chunk_idx, begin, end) is invoked once per chunk of grain_size elements
+        template<typename Fn>
+        void parallel_for_chunks(TaskScheduler& task_scheduler, const size_t count, const size_t grain_size, Fn& fn, const TaskPriority priority)
+        {
+            ASSERT(grain_size > 0);
+            ParallelForData<Fn> data{
+                .fn = &fn,
+                .count = count,
+                .grain_size = grain_size,
+                .num_chunks = (count + grain_size - 1) / grain_size,
+            };
+            if (data.num_chunks == 0) {
+                return;
+            }
+
+            // The calling thread also processes chunks, so we only need helpers for the rest
+            size_t num_helpers = task_scheduler.get_num_threads() > 0 ? task_scheduler.get_num_threads() - 1 : 0;
+            num_helpers = num_helpers < data.num_chunks - 1 ? num_helpers : data.num_chunks - 1;
+            num_helpers = num_helpers < MAX_PARALLEL_TASKS ? num_helpers : MAX_PARALLEL_TASKS;
+
+            TaskCounter counter{};
+            if (num_helpers > 0) {
+                Task tasks[MAX_PARALLEL_TASKS];
+                for (size_t i = 0; i < num_helpers; i++) {
+                    tasks[i] = { .function = &parallel_for_task<Fn>, .arg = &data, .name = "parallel_for" };
+                }
+                task_scheduler.add_tasks(num_helpers, tasks, counter, priority);
+            }
+
+            execute_chunks(data);
+            task_scheduler.wait_on_counter(counter);
+        }
+    }
+
+    // Invokes fn(begin, end) over sub-ranges of [0, count). A grain_size of zero picks one automatically.
+    template<typename Fn>
+    void parallel_for(TaskScheduler& task_scheduler, const size_t count, Fn&& fn, size_t grain_size = 0, const TaskPriority priority = TaskPriority::HIGH)
+    {
+        if (grain_size == 0) {
+            grain_size = get_grain_size(task_scheduler, count);
+        }
+        auto chunk_fn = [&fn](const size_t, const size_t begin, const size_t end) {
+            fn(begin, end);
+        };
+        internal::parallel_for_chunks(task_scheduler, count, grain_size, chunk_fn, priority);
+    }
+
+    // map_fn(begin, end) reduces a sub-range of [0, count) to a single T, and the per range results are then combined
+    // (in order, so the result is deterministic for a given grain size) using reduce_fn(T, T).
+    template<typename T, typename MapFn, typename ReduceFn>
+    T parallel_reduce(TaskScheduler& task_scheduler, const size_t count, const T& identity, MapFn&& map_fn, ReduceFn&& reduce_fn, size_t grain_size = 0, const TaskPriority priority = TaskPriority::HIGH)
+    {
+        if (grain_size == 0) {
+            grain_size = get_grain_size(task_scheduler, count);
+        }
+        const size_t num_chunks = (count + grain_size - 1) / grain_size;
+        std::vector<T> partial_results(num_chunks, identity);
+
+        auto chunk_fn = [&](const size_t chunk_idx, const size_t begin, const size_t end) {
+            partial_results[chunk_idx] = map_fn(begin, end);
+        };
+        internal::parallel_for_chunks(task_scheduler, count, grain_size, chunk_fn, priority);
+
+        T result = identity;
+        for (const T& partial_result : partial_results) {
+            result = reduce_fn(result, partial_result);
+        }
+        return result;
+    }
+
+    enum struct ScanType : u8
+    {
+        EXCLUSIVE = 0,
+        INCLUSIVE,
+    };
+
+    // Prefix "sum" of input using the associative op(T, T). Input and output may alias.
+    // Exclusive: output[i] = identity op input[0] op ... op input[i - 1]
+    // Inclusive: output[i] = input[0] op ... op input[i]
+    template<typename T, typename Op>
+    void parallel_scan(TaskScheduler& task_scheduler, const T* input, T* output, const size_t count, const T& identity, Op&& op, const ScanType scan_type, size_t grain_size = 0, const TaskPriority priority = TaskPriority::HIGH)
+    {
+        if (grain_size == 0) {
+            grain_size = get_grain_size(task_scheduler, count);
+        }
+        const size_t num_chunks = (count + grain_size - 1) / grain_size;
+        std::vector<T> chunk_offsets(num_chunks, identity);
+
+        // Reduce each chunk
+        auto reduce_chunk = [&](const size_t chunk_idx, const size_t begin, const size_t end) {
+            T sum = identity;
+            for (size_t i = begin; i < end; i++) {
+                sum = op(sum, input[i]);
+            }
+            chunk_offsets[chunk_idx] = sum;
+        };
+        internal::parallel_for_chunks(task_scheduler, count, grain_size, reduce_chunk, priority);
+
+        // Exclusive scan of the chunk sums, which is tiny
+        T running_sum = identity;
+        for (T& chunk_offset : chunk_offsets) {
+            const T chunk_sum = chunk_offset;
+            chunk_offset = running_sum;
+            running_sum = op(running_sum, chunk_sum);
+        }
+
+        // Scan each chunk, starting from its offset
+        auto scan_chunk = [&](const size_t chunk_idx, const size_t begin, const size_t end) {
+            T sum = chunk_offsets[chunk_idx];
+            for (size_t i = begin; i < end; i++) {
+                const T value = input[i];
+                if (scan_type == ScanType::INCLUSIVE) {
+                    sum = op(sum, value);
+                    output[i] = sum;
+                }
+                else {
+                    output[i] = sum;
+                    sum = op(sum, value);
+                }
+            }
+        };
+        internal::parallel_for_chunks(task_scheduler, count, grain_size, scan_chunk, priority);
+    }
+
+    // Stable LSD radix sort (8 bits per pass), keys are sorted in place. Values are optional and will be permuted
+    // along with their keys, pass nullptr for both values and scratch_values to sort the keys alone.
+    // Scratch buffers must hold at least count elements. Passes where every key shares the same digit are skipped,
+    // so sorting small keys stored in u64s is cheap.
+    void parallel_radix_sort(TaskScheduler& task_scheduler, u32* keys, u32* values, u32* scratch_keys, u32* scratch_values, const size_t count);
+    void parallel_radix_sort(TaskScheduler& task_scheduler, u64* keys, u32* values, u64* scratch_keys, u32* scratch_values, const size_t count);
+}
@@ -0,0 +1,128 @@
+#include "task_graph.h"
+#include "utils/assert.h"
+
+namespace zec
+{
+    TaskGraphNodeHandle TaskGraph::add_node(const TaskGraphNodeDesc& desc)
+    {
+        ASSERT(desc.function != nullptr);
+        ASSERT(desc.priority < TaskPriority::COUNT);
+        compiled = false;
+        nodes.push_back({ .desc = desc });
+        return { u32(nodes.size() - 1) };
+    }
+
+    void TaskGraph::add_dependency(const TaskGraphNodeHandle predecessor, const TaskGraphNodeHandle successor)
+    {
+        ASSERT(predecessor.idx < nodes.size() && successor.idx < nodes.size());
+        ASSERT_MSG(predecessor.idx != successor.idx, "A node cannot depend on itself");
+        compiled = false;
+        edges.push_back({ predecessor.idx, successor.idx });
+    }
+
+    void TaskGraph::compile()
+    {
+        const size_t num_nodes = nodes.size();
+        for (Node& node : nodes) {
+            node.num_predecessors = 0;
+            node.num_successors = 0;
+        }
+
+        // Bucket the edges by predecessor so each node's successors are contiguous
+        for (const auto& [predecessor, successor] : edges) {
+            nodes[predecessor].num_successors++;
+            nodes[successor].num_predecessors++;
+        }
+        u32 offset = 0;
+        for (Node& node : nodes) {
+            node.successors_offset = offset;
+            offset += node.num_successors;
+            node.num_successors = 0;
+        }
+        successors.resize(edges.size());
+        for (const auto& [predecessor, successor] : edges) {
+            Node& node = nodes[predecessor];
+            successors[node.successors_offset + node.num_successors++] = successor;
+        }
+
+        node_states = std::make_unique<NodeState[]>(num_nodes);
+        for (auto& tasks : root_tasks) {
+            tasks.clear();
+        }
+        for (u32 node_idx = 0; node_idx < num_nodes; node_idx++) {
+            node_states[node_idx].graph = this;
+            node_states[node_idx].node_idx = node_idx;
+
+            const Node& node = nodes[node_idx];
+            if (node.num_predecessors == 0) {
+                root_tasks[size_t(node.desc.priority)].push_back({ .function = &TaskGraph::execute_node, .arg = &node_states[node_idx], .name = node.desc.name });
+            }
+        }
+
+        // Kahn's algorithm, to make sure there are no cycles (which would leave us waiting forever)
+        std::vector<u32> remaining_predecessors(num_nodes);
+        std::vector<u32> ready_nodes;
+        ready_nodes.reserve(num_nodes);
+        for (u32 node_idx = 0; node_idx < num_nodes; node_idx++) {
+            remaining_predecessors[node_idx] = nodes[node_idx].num_predecessors;
+            if (remaining_predecessors[node_idx] == 0) {
+                ready_nodes.push_back(node_idx);
+            }
+        }
+        for (size_t i = 0; i < ready_nodes.size(); i++) {
+            const Node& node = nodes[ready_nodes[i]];
+            for (u32 j = 0; j < node.num_successors; j++) {
+                const u32 successor = successors[node.successors_offset + j];
+                if (--remaining_predecessors[successor] == 0) {
+                    ready_nodes.push_back(successor);
+                }
+            }
+        }
+        ASSERT_MSG(ready_nodes.size() == num_nodes, "Task graph contains a cycle");
+
+        compiled = true;
+    }
+
+    void TaskGraph::submit(TaskScheduler& task_scheduler, TaskCounter& counter)
+    {
+        ASSERT_MSG(compiled, "Task graph must be compiled before it is submitted");
+
+        active_counter = &counter;
+        for (size_t node_idx = 0; node_idx < nodes.size(); node_idx++) {
+            node_states[node_idx].num_pending_predecessors.store(nodes[node_idx].num_predecessors, std::memory_order_relaxed);
+        }
+
+        for (size_t priority = 0; priority < size_t(TaskPriority::COUNT); priority++) {
+            const std::vector<Task>& tasks = root_tasks[priority];
+            if (!tasks.empty()) {
+                task_scheduler.add_tasks(tasks.size(), tasks.data(), counter, TaskPriority(priority));
+            }
+        }
+    }
+
+    void TaskGraph::execute(TaskScheduler& task_scheduler)
+    {
+        TaskCounter counter{};
+        submit(task_scheduler, counter);
+        task_scheduler.wait_on_counter(counter);
+    }
+
+    void TaskGraph::execute_node(TaskScheduler* task_scheduler, void* arg)
+    {
+        NodeState* state = static_cast<NodeState*>(arg);
+        TaskGraph* graph = state->graph;
+        const Node& node = graph->nodes[state->node_idx];
+
+        node.desc.function(task_scheduler, node.desc.arg);
+
+        // Successors are added to the counter before this node finishes, so the counter can't hit zero early
+        for (u32 i = 0; i < node.num_successors; i++) {
+            const u32 successor_idx = graph->successors[node.successors_offset + i];
+            NodeState& successor_state = graph->node_states[successor_idx];
+            if (successor_state.num_pending_predecessors.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                const Task task = { .function = &TaskGraph::execute_node, .arg = &successor_state, .name = graph->nodes[successor_idx].desc.name };
+                task_scheduler->add_tasks(1, &task, *graph->active_counter, graph->nodes[successor_idx].desc.priority);
+            }
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "cpu_tasks.h"
+
+namespace zec
+{
+    struct TaskGraphNodeHandle
+    {
+        u32 idx = UINT32_MAX;
+    };
+
+    inline bool is_valid(const TaskGraphNodeHandle handle) { return handle.idx != UINT32_MAX; };
+    inline bool operator==(const TaskGraphNodeHandle lhs, const TaskGraphNodeHandle rhs) { return lhs.idx == rhs.idx; };
+
+    struct TaskGraphNodeDesc
+    {
+        const char* name = nullptr;
+        TaskFunction function = nullptr;
+        void* arg = nullptr;
+        TaskPriority priority = TaskPriority::NORMAL;
+    };
+
+    // A DAG of tasks that is built once and then submitted as many times as we like (typically once per frame).
+    // A node is handed to the scheduler as soon as its last predecessor finishes, so independent branches of
+    // the graph overlap across worker threads. Submitting a compiled graph doesn't allocate.
+    class TaskGraph
+    {
+    public:
+        TaskGraph() = default;
+        ~TaskGraph() = default;
+
+        UNCOPIABLE(TaskGraph);
+        UNMOVABLE(TaskGraph);
+
+        TaskGraphNodeHandle add_node(const TaskGraphNodeDesc& desc);
+
+        // successor will not start until predecessor has finished
+        void add_dependency(const TaskGraphNodeHandle predecessor, const TaskGraphNodeHandle successor);
+
+        // Must be called after the last node or dependency has been added, and before the graph is submitted.
+        void compile();
+
+        // Kicks off the root nodes and returns immediately. The counter reaches zero once every node in the graph
+        // has finished, and the graph must not be submitted again before then.
+        void submit(TaskScheduler& task_scheduler, TaskCounter& counter);
+
+        // Submits the graph and waits on it, executing tasks on the calling thread in the meantime
+        void execute(TaskScheduler& task_scheduler);
+
+        inline bool is_compiled() const
+        {
+            return compiled;
+        };
+
+        inline size_t get_num_nodes() const
+        {
+            return nodes.size();
+        };
+
+        inline const char* get_node_name(const TaskGraphNodeHandle node) const
+        {
+            return nodes[node.idx].desc.name;
+        };
+
+    private:
+        struct Node
+        {
+            TaskGraphNodeDesc desc = {};
+            u32 num_predecessors = 0;
+            // Range into the successors array
+            u32 successors_offset = 0;
+            u32 num_successors = 0;
+        };
+
+        // The argument passed to the scheduler for each node
+        struct NodeState
+        {
+            TaskGraph* graph = nullptr;
+            u32 node_idx = 0;
+            std::atomic<u32> num_pending_predecessors = 0;
+        };
+
+        static void execute_node(TaskScheduler* task_scheduler, void* arg);
+
+        std::vector<Node> nodes = {};
+        // (predecessor, successor) pairs, only used until compile()
+        std::vector<std::pair<u32, u32>> edges = {};
+        std::vector<u32> successors = {};
+        std::unique_ptr<NodeState[]> node_states = {};
+        std::vector<Task> root_tasks[size_t(TaskPriority::COUNT)] = {};
+        // Counter passed to the last submit(), which successors are added to as they are released
+        TaskCounter* active_counter = nullptr;
+        bool compiled = false;
+    };
+}
@@ -0,0 +1,26 @@
+#include "catch2/catch.hpp"
+#include "core/linear_allocator.h"
+
+TEST_CASE("Growable linear allocator respects alignment")
+{
+    zec::GrowableLinearAllocator allocator{ 256 };
+    allocator.allocate(1, 1);
+    void* ptr = allocator.allocate(16, 64);
+    REQUIRE(reinterpret_cast<uintptr_t>(ptr) % 64 == 0);
+    ptr = allocator.allocate(3, 4);
+    REQUIRE(reinterpret_cast<uintptr_t>(ptr) % 4 == 0);
+}
+
+TEST_CASE("Growable linear allocator grows past its block size without moving earlier allocations")
+{
+    zec::GrowableLinearAllocator allocator{ 64 };
+    u32* first = reinterpret_cast<u32*>(allocator.allocate(sizeof(u32), alignof(u32)));
+    *first = 42;
+    for (u32 i = 0; i < 100; i++) {
+        allocator.allocate(48, 16);
+    }
+    // Bigger than a block
+    u8* big = reinterpret_cast<u8*>(allocator.allocate(1024, 16));
+    big[1023] = 1;
+    REQUIRE(*first == 42);
+}
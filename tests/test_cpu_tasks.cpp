@@ -0,0 +1,213 @@
+#include "catch2/catch.hpp"
+#include "cpu_tasks.h"
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace zec;
+
+namespace
+{
+    void increment_task(TaskScheduler* task_scheduler, void* arg)
+    {
+        static_cast<std::atomic<u32>*>(arg)->fetch_add(1);
+    }
+
+    struct NestedTaskData
+    {
+        std::atomic<u32>* total;
+        u32 num_children;
+    };
+
+    void nested_task(TaskScheduler* task_scheduler, void* arg)
+    {
+        NestedTaskData* data = static_cast<NestedTaskData*>(arg);
+        std::vector<Task> children(data->num_children, Task{ .function = increment_task, .arg = data->total });
+
+        TaskCounter counter{};
+        task_scheduler->add_tasks(children.size(), children.data(), counter, TaskPriority::LOW);
+        task_scheduler->wait_on_counter(counter);
+    }
+
+    struct BlockerData
+    {
+        std::atomic<bool> started = false;
+        std::atomic<bool> released = false;
+    };
+
+    void blocker_task(TaskScheduler* task_scheduler, void* arg)
+    {
+        BlockerData* data = static_cast<BlockerData*>(arg);
+        data->started = true;
+        while (!data->released) {
+            std::this_thread::yield();
+        }
+    }
+
+    struct OrderData
+    {
+        std::atomic<u32>* next_slot;
+        TaskPriority* order;
+        TaskPriority priority;
+    };
+
+    void record_order_task(TaskScheduler* task_scheduler, void* arg)
+    {
+        OrderData* data = static_cast<OrderData*>(arg);
+        data->order[data->next_slot->fetch_add(1)] = data->priority;
+    }
+}
+
+TEST_CASE("Task scheduler cannot be initialized twice")
+{
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 1 });
+    REQUIRE(task_scheduler.get_num_threads() == 2);
+    REQUIRE(task_scheduler.get_current_thread_idx() == 0);
+    REQUIRE_THROWS(task_scheduler.init());
+}
+
+TEST_CASE("All tasks are executed before wait_on_counter returns")
+{
+    TaskScheduler task_scheduler{};
+    // Small queues so that some tasks spill into the shared queue
+    task_scheduler.init({ .num_worker_threads = 3, .queue_capacity = 64 });
+
+    std::atomic<u32> total = 0;
+    std::vector<Task> tasks(10000, Task{ .function = increment_task, .arg = &total });
+
+    TaskCounter counter{};
+    task_scheduler.add_tasks(tasks.size(), tasks.data(), counter);
+    task_scheduler.wait_on_counter(counter);
+
+    REQUIRE(counter.is_done());
+    REQUIRE(total == 10000);
+}
+
+TEST_CASE("Tasks can spawn and wait on other tasks")
+{
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 2 });
+
+    std::atomic<u32> total = 0;
+    NestedTaskData nested_data = { .total = &total, .num_children = 100 };
+    std::vector<Task> tasks(32, Task{ .function = nested_task, .arg = &nested_data });
+
+    TaskCounter counter{};
+    task_scheduler.add_tasks(tasks.size(), tasks.data(), counter, TaskPriority::HIGH);
+    task_scheduler.wait_on_counter(counter);
+
+    REQUIRE(total == 32 * 100);
+}
+
+TEST_CASE("Higher priority tasks are executed first")
+{
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 1 });
+
+    // Keep the only worker thread busy so that the main thread executes everything below, in order
+    BlockerData blocker_data{};
+    Task blocker = { .function = blocker_task, .arg = &blocker_data };
+    TaskCounter blocker_counter{};
+    task_scheduler.add_tasks(1, &blocker, blocker_counter);
+    while (!blocker_data.started) {
+        std::this_thread::yield();
+    }
+
+    constexpr u32 num_tasks_per_priority = 8;
+    std::atomic<u32> next_slot = 0;
+    TaskPriority order[3 * num_tasks_per_priority] = {};
+    OrderData order_data[] = {
+        { .next_slot = &next_slot, .order = order, .priority = TaskPriority::LOW },
+        { .next_slot = &next_slot, .order = order, .priority = TaskPriority::NORMAL },
+        { .next_slot = &next_slot, .order = order, .priority = TaskPriority::HIGH },
+    };
+
+    TaskCounter counter{};
+    for (OrderData& data : order_data) {
+        std::vector<Task> tasks(num_tasks_per_priority, Task{ .function = record_order_task, .arg = &data });
+        task_scheduler.add_tasks(tasks.size(), tasks.data(), counter, data.priority);
+    }
+    task_scheduler.wait_on_counter(counter);
+
+    blocker_data.released = true;
+    task_scheduler.wait_on_counter(blocker_counter);
+
+    REQUIRE(next_slot == 3 * num_tasks_per_priority);
+    for (u32 i = 0; i < num_tasks_per_priority; i++) {
+        REQUIRE(order[i] == TaskPriority::HIGH);
+        REQUIRE(order[num_tasks_per_priority + i] == TaskPriority::NORMAL);
+        REQUIRE(order[2 * num_tasks_per_priority + i] == TaskPriority::LOW);
+    }
+}
+
+TEST_CASE("Threads outside the scheduler can add and wait on tasks")
+{
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 2 });
+
+    std::atomic<u32> total = 0;
+    u32 external_thread_idx = 0;
+    std::thread external_thread{ [&]() {
+        external_thread_idx = task_scheduler.get_current_thread_idx();
+        std::vector<Task> tasks(500, Task{ .function = increment_task, .arg = &total });
+        TaskCounter counter{};
+        task_scheduler.add_tasks(tasks.size(), tasks.data(), counter);
+        task_scheduler.wait_on_counter(counter);
+    } };
+    external_thread.join();
+
+    REQUIRE(external_thread_idx == UINT32_MAX);
+    REQUIRE(total == 500);
+}
+
+TEST_CASE("Instrumentation records every task and exports a Chrome trace")
+{
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 3, .enable_instrumentation = true, .max_events_per_thread = 256 });
+    REQUIRE(task_scheduler.is_instrumentation_enabled());
+
+    std::atomic<u32> total = 0;
+    std::vector<Task> tasks(1000, Task{ .function = increment_task, .arg = &total, .name = "Increment \"quoted\"" });
+    TaskCounter counter{};
+    task_scheduler.add_tasks(tasks.size(), tasks.data(), counter);
+    task_scheduler.wait_on_counter(counter);
+    REQUIRE(total == 1000);
+
+    u64 num_executed = 0;
+    u64 num_events = 0;
+    u64 num_stolen = 0;
+    for (u32 i = 0; i < task_scheduler.get_num_threads(); i++) {
+        const TaskSchedulerThreadStats stats = task_scheduler.get_thread_stats(i);
+        REQUIRE(stats.num_events + stats.num_dropped_events == stats.num_tasks_executed);
+        REQUIRE(stats.num_tasks_stolen <= stats.num_steal_attempts);
+        num_executed += stats.num_tasks_executed;
+        num_events += stats.num_events;
+        num_stolen += stats.num_tasks_stolen;
+
+        size_t num_thread_events = 0;
+        const TaskEvent* events = task_scheduler.get_thread_events(i, num_thread_events);
+        for (size_t j = 0; j < num_thread_events; j++) {
+            REQUIRE(events[j].begin_ns <= events[j].end_ns);
+        }
+    }
+    REQUIRE(num_executed == 1000);
+    // Everything was pushed onto the main thread's queue, so whatever the workers did they stole
+    REQUIRE(num_stolen == num_executed - task_scheduler.get_thread_stats(0).num_tasks_executed);
+    REQUIRE(task_scheduler.get_thread_stats(0).max_queue_depth > 0);
+    REQUIRE(task_scheduler.get_thread_stats(0).max_queue_depth <= 1000);
+
+    std::ostringstream trace{};
+    task_scheduler.write_chrome_trace(trace);
+    const std::string json = trace.str();
+    REQUIRE(json.starts_with("{\"traceEvents\":["));
+    REQUIRE(json.find("\"name\":\"Increment \\\"quoted\\\"\"") != std::string::npos);
+    REQUIRE(json.find("\"ph\":\"X\"") != std::string::npos);
+
+    task_scheduler.reset_instrumentation();
+    REQUIRE(task_scheduler.get_thread_stats(0).num_tasks_executed == 0);
+    size_t num_thread_events = 0;
+    task_scheduler.get_thread_events(0, num_thread_events);
+    REQUIRE(num_thread_events == 0);
+}
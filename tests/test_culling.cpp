@@ -0,0 +1,71 @@
+#include "catch2/catch.hpp"
+#include "culling.h"
+
+using namespace zec;
+
+namespace
+{
+    // Camera sits at the origin looking down -z
+    Frustum get_test_frustum()
+    {
+        mat4 projection = perspective_projection(1.0f, deg_to_rad(90.0f), 0.1f, 100.0f);
+        return extract_frustum_planes(projection * identity_mat4());
+    }
+
+    mat4 translation(const vec3& t)
+    {
+        mat4 transform = identity_mat4();
+        set_translation(transform, t);
+        return transform;
+    }
+
+    constexpr AABB unit_aabb = { .min = { -0.5f, -0.5f, -0.5f }, .max = { 0.5f, 0.5f, 0.5f } };
+}
+
+TEST_CASE("World bounds are computed for newly pushed objects")
+{
+    WorldBoundsCache cache{};
+    cache.push_back(unit_aabb, translation({ 1.0f, 2.0f, 3.0f }));
+
+    REQUIRE(cache.is_dirty(0));
+    REQUIRE(cache.update() == 1);
+    REQUIRE_FALSE(cache.is_dirty(0));
+
+    REQUIRE(cache.min_x[0] == Approx(0.5f));
+    REQUIRE(cache.max_y[0] == Approx(2.5f));
+    REQUIRE(cache.center_z[0] == Approx(3.0f));
+    REQUIRE(cache.radius[0] == Approx(sqrtf(0.75f)));
+}
+
+TEST_CASE("Only dirty objects are recomputed")
+{
+    WorldBoundsCache cache{};
+    for (size_t i = 0; i < 200; i++) {
+        cache.push_back(unit_aabb, translation({ float(i), 0.0f, 0.0f }));
+    }
+    REQUIRE(cache.update() == 200);
+    REQUIRE(cache.update() == 0);
+
+    cache.set_transform(130, translation({ 0.0f, 10.0f, 0.0f }));
+    REQUIRE(cache.update() == 1);
+    REQUIRE(cache.min_y[130] == Approx(9.5f));
+    REQUIRE(cache.center_x[129] == Approx(129.0f));
+}
+
+TEST_CASE("Objects outside the frustum are culled")
+{
+    WorldBoundsCache cache{};
+    cache.push_back(unit_aabb, translation({ 0.0f, 0.0f, -5.0f }));   // In front
+    cache.push_back(unit_aabb, translation({ 0.0f, 0.0f, 5.0f }));    // Behind
+    cache.push_back(unit_aabb, translation({ 20.0f, 0.0f, -5.0f }));  // Far to the right
+    cache.push_back(unit_aabb, translation({ 0.0f, 0.0f, -200.0f })); // Beyond the far plane
+    cache.push_back(unit_aabb, translation({ 5.2f, 0.0f, -5.0f }));   // Straddling the right plane
+    cache.update();
+
+    Array<u32> visible_list{};
+    cull_world_bounds(get_test_frustum(), cache, visible_list);
+
+    REQUIRE(visible_list.size == 2);
+    REQUIRE(visible_list[0] == 0);
+    REQUIRE(visible_list[1] == 4);
+}
@@ -0,0 +1,141 @@
+#include "catch2/catch.hpp"
+#include "dynamic_resolution.h"
+#include <algorithm>
+
+using namespace zec;
+
+namespace
+{
+    // Frame time of a fake frame with a fixed cost plus a cost that scales with the number of pixels shaded
+    struct SyntheticFrame
+    {
+        float fixed_ms;
+        float full_res_ms;
+
+        float get_frame_time(const float scale) const
+        {
+            return fixed_ms + full_res_ms * scale * scale;
+        }
+    };
+
+    float run_frames(DynamicResolutionController& controller, const SyntheticFrame& frame, const u32 num_frames)
+    {
+        float scale = controller.get_render_scale();
+        for (u32 i = 0; i < num_frames; i++) {
+            scale = controller.update(frame.get_frame_time(scale));
+        }
+        return scale;
+    }
+}
+
+TEST_CASE("Dynamic resolution starts at the max scale")
+{
+    DynamicResolutionController controller{ { .target_frame_time_ms = 16.0f, .min_scale = 0.5f, .max_scale = 0.9f } };
+    REQUIRE(controller.get_render_scale() == 0.9f);
+}
+
+TEST_CASE("Dynamic resolution converges on the target frame time")
+{
+    DynamicResolutionController controller{ { .target_frame_time_ms = 16.0f } };
+    // Full resolution costs 24ms, the target is hit at a scale of ~0.76
+    const SyntheticFrame frame = { .fixed_ms = 4.0f, .full_res_ms = 20.0f };
+
+    float min_seen = 1.0f;
+    float scale = controller.get_render_scale();
+    for (u32 i = 0; i < 200; i++) {
+        scale = controller.update(frame.get_frame_time(scale));
+        min_seen = std::min(min_seen, scale);
+    }
+
+    // Shouldn't overshoot much below the ~0.76 that hits the target
+    REQUIRE(min_seen > 0.7f);
+    REQUIRE(frame.get_frame_time(scale) == Approx(16.0f).margin(0.5f));
+
+    SECTION("Noisy frame times around the target don't change the scale")
+    {
+        const float settled_scale = scale;
+        for (u32 i = 0; i < 50; i++) {
+            const float noise = (i % 2 == 0) ? 0.2f : -0.2f;
+            scale = controller.update(16.0f + noise);
+            REQUIRE(scale == settled_scale);
+        }
+    }
+}
+
+TEST_CASE("Dynamic resolution stays at the max scale when under budget")
+{
+    DynamicResolutionController controller{ { .target_frame_time_ms = 16.0f } };
+    const SyntheticFrame frame = { .fixed_ms = 2.0f, .full_res_ms = 8.0f };
+
+    REQUIRE(run_frames(controller, frame, 100) == 1.0f);
+}
+
+TEST_CASE("Dynamic resolution clamps to the min scale when far over budget")
+{
+    DynamicResolutionController controller{ { .target_frame_time_ms = 16.0f, .min_scale = 0.5f } };
+    const SyntheticFrame frame = { .fixed_ms = 10.0f, .full_res_ms = 60.0f };
+
+    REQUIRE(run_frames(controller, frame, 200) == 0.5f);
+
+    SECTION("And recovers once the load goes away")
+    {
+        const SyntheticFrame light_frame = { .fixed_ms = 2.0f, .full_res_ms = 8.0f };
+        REQUIRE(run_frames(controller, light_frame, 200) == 1.0f);
+    }
+}
+
+TEST_CASE("Dynamic resolution recovers from a spike")
+{
+    DynamicResolutionController controller{ { .target_frame_time_ms = 16.0f } };
+    const SyntheticFrame frame = { .fixed_ms = 4.0f, .full_res_ms = 20.0f };
+    const float settled_scale = run_frames(controller, frame, 200);
+
+    // A few frames of hitching drive the scale down...
+    float scale = settled_scale;
+    for (u32 i = 0; i < 3; i++) {
+        scale = controller.update(frame.get_frame_time(scale) + 30.0f);
+    }
+    REQUIRE(scale < settled_scale);
+
+    // ...and it climbs back once they're over
+    scale = run_frames(controller, frame, 200);
+    REQUIRE(scale == Approx(settled_scale).margin(0.03f));
+}
+
+TEST_CASE("Dynamic resolution recovers when frame times are clamped to the target by vsync")
+{
+    const SyntheticFrame heavy_frame = { .fixed_ms = 10.0f, .full_res_ms = 60.0f };
+    const SyntheticFrame light_frame = { .fixed_ms = 2.0f, .full_res_ms = 8.0f };
+    const auto run_synced_frames = [&](DynamicResolutionController& controller, const u32 num_frames) {
+        float scale = controller.get_render_scale();
+        for (u32 i = 0; i < num_frames; i++) {
+            scale = controller.update(std::max(16.0f, light_frame.get_frame_time(scale)));
+        }
+        return scale;
+    };
+
+    SECTION("With a recovery rate, the scale climbs back to the max")
+    {
+        DynamicResolutionController controller{ { .target_frame_time_ms = 16.0f, .min_scale = 0.5f, .recovery_rate = 0.005f } };
+        REQUIRE(run_frames(controller, heavy_frame, 200) == 0.5f);
+        REQUIRE(run_synced_frames(controller, 200) == 1.0f);
+    }
+
+    SECTION("Without one, it stays close to where the slow frames left it")
+    {
+        DynamicResolutionController controller{ { .target_frame_time_ms = 16.0f, .min_scale = 0.5f } };
+        REQUIRE(run_frames(controller, heavy_frame, 200) == 0.5f);
+        REQUIRE(run_synced_frames(controller, 200) < 0.6f);
+    }
+}
+
+TEST_CASE("Resetting dynamic resolution goes back to the max scale")
+{
+    DynamicResolutionController controller{ { .target_frame_time_ms = 16.0f } };
+    const SyntheticFrame frame = { .fixed_ms = 10.0f, .full_res_ms = 60.0f };
+    run_frames(controller, frame, 50);
+    REQUIRE(controller.get_render_scale() < 1.0f);
+
+    controller.reset();
+    REQUIRE(controller.get_render_scale() == 1.0f);
+}
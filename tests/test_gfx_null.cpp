@@ -0,0 +1,73 @@
+#ifdef USE_NULL_RENDERER
+#include "catch2/catch.hpp"
+#include "gfx/null/gfx_null.h"
+#include <cstring>
+
+using namespace zec;
+
+namespace
+{
+    // Keeps the renderer initialized for the scope it's declared in, so a failed REQUIRE doesn't leave it initialized
+    // for the next test
+    struct NullRendererScope
+    {
+        NullRendererScope(const RendererDesc& renderer_desc) { gfx::init_renderer(renderer_desc); }
+        ~NullRendererScope() { gfx::destroy_renderer(); }
+    };
+}
+
+TEST_CASE("Null gfx backend tracks resources and recorded commands")
+{
+    const NullRendererScope renderer{ { .width = 640, .height = 480 } };
+    gfx::null::reset_stats();
+
+    const u32 data[4] = { 1, 2, 3, 4 };
+    BufferHandle buffer = gfx::buffers::create({
+        .usage = RESOURCE_USAGE_SHADER_READABLE,
+        .type = BufferType::DEFAULT,
+        .byte_size = sizeof(data),
+        .stride = sizeof(u32),
+        });
+    REQUIRE(gfx::null::get_buffer_data(buffer) == nullptr);
+    gfx::buffers::set_data(buffer, data, sizeof(data));
+    REQUIRE(memcmp(gfx::null::get_buffer_data(buffer), data, sizeof(data)) == 0);
+
+    TextureHandle texture = gfx::textures::create({
+        .width = 128,
+        .height = 64,
+        .depth = 1,
+        .num_mips = 1,
+        .array_size = 1,
+        .format = BufferFormat::R16G16B16A16_FLOAT,
+        .usage = RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_SHADER_READABLE,
+        });
+    REQUIRE(gfx::textures::get_texture_info(texture).width == 128);
+    REQUIRE(gfx::textures::get_texture_info(texture).height == 64);
+
+    CommandContextHandle cmd_ctx = gfx::begin_frame();
+    const float clear_color[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    gfx::cmd::clear_render_target(cmd_ctx, texture, clear_color);
+    gfx::cmd::dispatch(cmd_ctx, 8, 8, 1);
+    gfx::cmd::compute_write_barrier(cmd_ctx, buffer);
+    REQUIRE(gfx::cmd::get_stats(cmd_ctx).num_dispatches == 1);
+    REQUIRE(gfx::cmd::get_stats(cmd_ctx).num_draws == 0);
+    gfx::end_frame(cmd_ctx);
+    REQUIRE(is_valid(gfx::present_frame()));
+
+    gfx::null::Stats stats = gfx::null::get_stats();
+    REQUIRE(stats.num_buffers_created == 1);
+    REQUIRE(stats.num_textures_created == 1);
+    REQUIRE(stats.num_bytes_uploaded == sizeof(data));
+    REQUIRE(stats.num_clears == 1);
+    REQUIRE(stats.num_dispatches == 1);
+    // Two for the back buffer transitions, plus the UAV barrier
+    REQUIRE(stats.num_barriers == 3);
+    REQUIRE(stats.num_submits == 1);
+    REQUIRE(stats.num_frames_presented == 1);
+
+    // Work is never in flight
+    CommandContextHandle copy_ctx = gfx::cmd::provision(CommandQueueType::COPY);
+    CmdReceipt copy_receipt = gfx::cmd::return_and_execute(&copy_ctx, 1);
+    REQUIRE(gfx::cmd::check_status(copy_receipt));
+}
+#endif // USE_NULL_RENDERER
@@ -0,0 +1,119 @@
+#include "catch2/catch.hpp"
+#include "parallel_algorithms.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace zec;
+
+TEST_CASE("parallel_for visits every index exactly once")
+{
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 3 });
+
+    std::vector<u32> visits(100000, 0);
+    parallel_for(task_scheduler, visits.size(), [&](const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            visits[i]++;
+        }
+    });
+
+    REQUIRE(std::all_of(visits.begin(), visits.end(), [](const u32 v) { return v == 1; }));
+
+    // Empty ranges are a no-op
+    parallel_for(task_scheduler, 0, [](const size_t, const size_t) { FAIL(); });
+}
+
+TEST_CASE("parallel_reduce matches a serial reduction")
+{
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 3 });
+
+    std::vector<u64> values(54321);
+    std::iota(values.begin(), values.end(), 1);
+
+    const u64 sum = parallel_reduce(task_scheduler, values.size(), u64(0), [&](const size_t begin, const size_t end) {
+        u64 partial_sum = 0;
+        for (size_t i = begin; i < end; i++) {
+            partial_sum += values[i];
+        }
+        return partial_sum;
+    }, [](const u64 a, const u64 b) { return a + b; }, 100);
+
+    REQUIRE(sum == u64(54321) * 54322 / 2);
+}
+
+TEST_CASE("parallel_scan computes exclusive and inclusive prefix sums")
+{
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 3 });
+
+    std::mt19937 rng{ 1337 };
+    std::vector<u32> input(20000);
+    for (u32& value : input) {
+        value = rng() % 8;
+    }
+    auto add = [](const u32 a, const u32 b) { return a + b; };
+
+    std::vector<u32> expected(input.size());
+    std::vector<u32> output(input.size());
+
+    std::exclusive_scan(input.begin(), input.end(), expected.begin(), 0u);
+    parallel_scan(task_scheduler, input.data(), output.data(), input.size(), 0u, add, ScanType::EXCLUSIVE, 512);
+    REQUIRE(output == expected);
+
+    std::inclusive_scan(input.begin(), input.end(), expected.begin());
+    parallel_scan(task_scheduler, input.data(), output.data(), input.size(), 0u, add, ScanType::INCLUSIVE, 512);
+    REQUIRE(output == expected);
+
+    // In place
+    parallel_scan(task_scheduler, input.data(), input.data(), input.size(), 0u, add, ScanType::INCLUSIVE, 512);
+    REQUIRE(input == expected);
+}
+
+TEST_CASE("parallel_radix_sort sorts keys and carries values along stably")
+{
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 3 });
+
+    std::mt19937_64 rng{ 42 };
+    constexpr size_t count = 50000;
+
+    SECTION("u32 keys")
+    {
+        std::vector<u32> keys(count);
+        std::vector<u32> values(count);
+        for (size_t i = 0; i < count; i++) {
+            // Plenty of duplicates so that stability matters, and an odd number of non-trivial passes
+            keys[i] = u32(rng() % 100000);
+            values[i] = u32(i);
+        }
+        std::vector<u32> scratch_keys(count);
+        std::vector<u32> scratch_values(count);
+
+        parallel_radix_sort(task_scheduler, keys.data(), values.data(), scratch_keys.data(), scratch_values.data(), count);
+
+        for (size_t i = 1; i < count; i++) {
+            REQUIRE(keys[i - 1] <= keys[i]);
+            if (keys[i - 1] == keys[i]) {
+                REQUIRE(values[i - 1] < values[i]);
+            }
+        }
+    }
+
+    SECTION("u64 keys without values")
+    {
+        std::vector<u64> keys(count);
+        for (u64& key : keys) {
+            key = rng();
+        }
+        std::vector<u64> expected = keys;
+        std::sort(expected.begin(), expected.end());
+        std::vector<u64> scratch_keys(count);
+
+        parallel_radix_sort(task_scheduler, keys.data(), nullptr, scratch_keys.data(), nullptr, count);
+
+        REQUIRE(keys == expected);
+    }
+}
@@ -0,0 +1,1699 @@
+#ifdef USE_NULL_RENDERER
+#include <atomic>
+#include "catch2/catch.hpp"
+#include "cpu_tasks.h"
+#include "gfx/render_task_system.h"
+#include "gfx/null/gfx_null.h"
+
+using namespace zec;
+using namespace zec::render_graph;
+
+namespace
+{
+    enum struct TestResourceIds : u32
+    {
+        BACKBUFFER = 0,
+        DEPTH,
+        HDR,
+        SCRATCH,
+        LIGHT_INDICES,
+        CLUSTER_COUNTS,
+        MIP_CHAIN,
+    };
+
+    constexpr ResourceIdentifier to_rid(const TestResourceIds id)
+    {
+        return { static_cast<u32>(id) };
+    }
+
+    u32 g_num_executions[5] = {};
+
+    template<u32 Idx>
+    void count_execution(const PassExecutionContext* context)
+    {
+        g_num_executions[Idx]++;
+    }
+
+    constexpr PassResourceUsage depth_outputs[] = {
+        {.identifier = to_rid(TestResourceIds::DEPTH), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_DEPTH_STENCIL },
+    };
+    constexpr PassResourceUsage light_binning_outputs[] = {
+        {.identifier = to_rid(TestResourceIds::LIGHT_INDICES), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_COMPUTE_WRITABLE },
+    };
+    constexpr PassResourceUsage scratch_outputs[] = {
+        {.identifier = to_rid(TestResourceIds::SCRATCH), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_RENDER_TARGET },
+    };
+    constexpr PassResourceUsage forward_inputs[] = {
+        {.identifier = to_rid(TestResourceIds::DEPTH), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_DEPTH_STENCIL },
+        {.identifier = to_rid(TestResourceIds::LIGHT_INDICES), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_SHADER_READABLE },
+    };
+    constexpr PassResourceUsage forward_outputs[] = {
+        {.identifier = to_rid(TestResourceIds::HDR), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_RENDER_TARGET },
+    };
+    constexpr PassResourceUsage tone_mapping_inputs[] = {
+        {.identifier = to_rid(TestResourceIds::HDR), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_SHADER_READABLE },
+    };
+    constexpr PassResourceUsage tone_mapping_outputs[] = {
+        {.identifier = to_rid(TestResourceIds::BACKBUFFER), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_RENDER_TARGET },
+    };
+
+    // Keeps the renderer initialized for the scope it's declared in, so a failed REQUIRE doesn't leave it initialized
+    // for the next test. Declared before the graphs, so they release their resources before it goes away.
+    struct NullRendererScope
+    {
+        NullRendererScope(const RendererDesc& renderer_desc) { gfx::init_renderer(renderer_desc); }
+        ~NullRendererScope() { gfx::destroy_renderer(); }
+    };
+
+    void execute_frames(RenderTaskList& render_task_list, const u32 num_frames)
+    {
+        for (u32 i = 0; i < num_frames; i++) {
+            render_task_list.execute();
+            gfx::present_frame();
+            gfx::reset_for_frame();
+        }
+    }
+
+    // Depth -> Forward -> Tone Mapping, with Light Binning feeding Forward and a Scratch pass nobody reads from
+    struct TestGraph
+    {
+        ResourceContext resource_context;
+        PipelineStore pipeline_store = {};
+        RenderTaskList render_task_list;
+        PassHandle pass_handles[5] = {};
+
+        TestGraph(const CommandQueueType light_binning_queue, const bool export_scratch)
+            : resource_context{ gfx::get_config_state() }
+            , render_task_list{ &resource_context, &pipeline_store }
+        {
+            resource_context.set_backbuffer_id(to_rid(TestResourceIds::BACKBUFFER));
+            const TextureDesc target_desc = {
+                .num_mips = 1,
+                .array_size = 1,
+                .format = BufferFormat::R16G16B16A16_FLOAT,
+                .usage = RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_SHADER_READABLE,
+                .initial_state = RESOURCE_USAGE_RENDER_TARGET,
+            };
+            resource_context.register_texture({
+                .identifier = to_rid(TestResourceIds::DEPTH),
+                .sizing = Sizing::RELATIVE_TO_SWAP_CHAIN,
+                .desc = {
+                    .num_mips = 1,
+                    .array_size = 1,
+                    .format = BufferFormat::D32,
+                    .usage = RESOURCE_USAGE_DEPTH_STENCIL,
+                    .initial_state = RESOURCE_USAGE_DEPTH_STENCIL,
+                },
+                });
+            resource_context.register_texture({ .identifier = to_rid(TestResourceIds::HDR), .sizing = Sizing::RELATIVE_TO_SWAP_CHAIN, .desc = target_desc });
+            resource_context.register_texture({ .identifier = to_rid(TestResourceIds::SCRATCH), .sizing = Sizing::RELATIVE_TO_SWAP_CHAIN, .desc = target_desc });
+            resource_context.register_buffer({
+                .identifier = to_rid(TestResourceIds::LIGHT_INDICES),
+                .initial_usage = RESOURCE_USAGE_COMPUTE_WRITABLE,
+                .desc = {
+                    .usage = RESOURCE_USAGE_COMPUTE_WRITABLE | RESOURCE_USAGE_SHADER_READABLE,
+                    .type = BufferType::RAW,
+                    .byte_size = 1024,
+                    .stride = 4,
+                },
+                });
+
+            const PassDesc pass_descs[] = {
+                { .name = "Depth", .execute_fn = &count_execution<0>, .outputs = depth_outputs },
+                { .name = "Light Binning", .command_queue_type = light_binning_queue, .execute_fn = &count_execution<1>, .outputs = light_binning_outputs },
+                { .name = "Scratch", .execute_fn = &count_execution<2>, .outputs = scratch_outputs },
+                { .name = "Forward", .execute_fn = &count_execution<3>, .inputs = forward_inputs, .outputs = forward_outputs },
+                { .name = "Tone Mapping", .execute_fn = &count_execution<4>, .inputs = tone_mapping_inputs, .outputs = tone_mapping_outputs },
+            };
+
+            PassListBuilder builder{ &render_task_list };
+            for (size_t i = 0; i < std::size(pass_descs); i++) {
+                PassListBuilder::Result result = builder.add_pass(pass_descs[i]);
+                REQUIRE(result.is_success());
+                pass_handles[i] = result.get_pass_handle();
+            }
+            if (export_scratch) {
+                builder.export_resource(to_rid(TestResourceIds::SCRATCH));
+            }
+        }
+
+        void execute_frame()
+        {
+            execute_frames(render_task_list, 1);
+        }
+    };
+
+    enum struct ChainResourceIds : u32
+    {
+        BACKBUFFER = 0,
+        TARGET_A,
+        TARGET_B,
+        TARGET_C,
+    };
+
+    constexpr ResourceIdentifier to_rid(const ChainResourceIds id)
+    {
+        return { static_cast<u32>(id) };
+    }
+
+    constexpr PassResourceUsage chain_a_outputs[] = { {.identifier = to_rid(ChainResourceIds::TARGET_A), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_RENDER_TARGET } };
+    constexpr PassResourceUsage chain_b_inputs[] = { {.identifier = to_rid(ChainResourceIds::TARGET_A), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_SHADER_READABLE } };
+    constexpr PassResourceUsage chain_b_outputs[] = { {.identifier = to_rid(ChainResourceIds::TARGET_B), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_RENDER_TARGET } };
+    constexpr PassResourceUsage chain_c_inputs[] = { {.identifier = to_rid(ChainResourceIds::TARGET_B), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_SHADER_READABLE } };
+    constexpr PassResourceUsage chain_c_outputs[] = { {.identifier = to_rid(ChainResourceIds::TARGET_C), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_RENDER_TARGET } };
+    constexpr PassResourceUsage chain_d_inputs[] = { {.identifier = to_rid(ChainResourceIds::TARGET_C), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_SHADER_READABLE } };
+    constexpr PassResourceUsage chain_d_outputs[] = { {.identifier = to_rid(ChainResourceIds::BACKBUFFER), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_RENDER_TARGET } };
+
+    // A -> B -> C -> D -> backbuffer through transient targets. A's target is free again by the time C's is written to,
+    // so the two can share memory.
+    struct TransientChainGraph
+    {
+        ResourceContext resource_context;
+        PipelineStore pipeline_store = {};
+        RenderTaskList render_task_list;
+        PassHandle pass_handles[4] = {};
+
+        TransientChainGraph()
+            : resource_context{ gfx::get_config_state() }
+            , render_task_list{ &resource_context, &pipeline_store }
+        {
+            resource_context.set_backbuffer_id(to_rid(ChainResourceIds::BACKBUFFER));
+            const TextureDesc target_desc = {
+                .num_mips = 1,
+                .array_size = 1,
+                .format = BufferFormat::R16G16B16A16_FLOAT,
+                .usage = RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_SHADER_READABLE,
+                .initial_state = RESOURCE_USAGE_RENDER_TARGET,
+            };
+            for (const ChainResourceIds id : { ChainResourceIds::TARGET_A, ChainResourceIds::TARGET_B, ChainResourceIds::TARGET_C }) {
+                resource_context.register_texture({ .identifier = to_rid(id), .sizing = Sizing::RELATIVE_TO_SWAP_CHAIN, .desc = target_desc, .is_transient = true });
+            }
+
+            const PassDesc pass_descs[] = {
+                {.name = "A", .execute_fn = &count_execution<0>, .outputs = chain_a_outputs },
+                {.name = "B", .execute_fn = &count_execution<1>, .inputs = chain_b_inputs, .outputs = chain_b_outputs },
+                {.name = "C", .execute_fn = &count_execution<2>, .inputs = chain_c_inputs, .outputs = chain_c_outputs },
+                {.name = "D", .execute_fn = &count_execution<3>, .inputs = chain_d_inputs, .outputs = chain_d_outputs },
+            };
+            PassListBuilder builder{ &render_task_list };
+            for (size_t i = 0; i < std::size(pass_descs); i++) {
+                PassListBuilder::Result result = builder.add_pass(pass_descs[i]);
+                REQUIRE(result.is_success());
+                pass_handles[i] = result.get_pass_handle();
+            }
+        }
+    };
+}
+
+TEST_CASE("Render graph compilation culls passes that don't contribute to the backbuffer")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+    {
+        TestGraph graph{ CommandQueueType::GRAPHICS, false };
+        RenderTaskList& render_task_list = graph.render_task_list;
+        render_task_list.compile();
+        REQUIRE(render_task_list.get_is_compiled());
+
+        REQUIRE(render_task_list.get_num_compiled_passes() == 4);
+        REQUIRE(render_task_list.get_compiled_pass(0) == graph.pass_handles[0]);
+        REQUIRE(render_task_list.get_compiled_pass(1) == graph.pass_handles[1]);
+        REQUIRE(render_task_list.get_compiled_pass(2) == graph.pass_handles[3]);
+        REQUIRE(render_task_list.get_compiled_pass(3) == graph.pass_handles[4]);
+
+        // Without tone mapping, nothing reaches the backbuffer anymore
+        render_task_list.set_pass_enabled(graph.pass_handles[4], false);
+        REQUIRE_FALSE(render_task_list.get_is_compiled());
+        render_task_list.compile();
+        REQUIRE(render_task_list.get_num_compiled_passes() == 0);
+    }
+    {
+        TestGraph graph{ CommandQueueType::GRAPHICS, true };
+        graph.render_task_list.compile();
+        REQUIRE(graph.render_task_list.get_num_compiled_passes() == 5);
+        REQUIRE(graph.render_task_list.get_compiled_pass(2) == graph.pass_handles[2]);
+    }
+}
+
+TEST_CASE("Render graphs only re-run the compile stages affected by a change")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+    TestGraph graph{ CommandQueueType::GRAPHICS, false };
+    RenderTaskList& render_task_list = graph.render_task_list;
+    graph.execute_frame();
+    RenderGraphCompileStats compile_stats = render_task_list.get_compile_stats();
+    REQUIRE(compile_stats.num_pass_compiles == 1);
+    REQUIRE(compile_stats.num_barrier_compiles == 1);
+    REQUIRE(compile_stats.num_handle_resolves == 1);
+
+    // Frames without changes don't compile anything
+    gfx::null::reset_stats();
+    graph.execute_frame();
+    REQUIRE(render_task_list.get_compile_stats().num_pass_compiles == 1);
+
+    // Scratch is culled either way, so toggling it leaves the barriers and handles alone
+    render_task_list.set_pass_enabled(graph.pass_handles[2], false);
+    REQUIRE_FALSE(render_task_list.get_is_compiled());
+    graph.execute_frame();
+    render_task_list.set_pass_enabled(graph.pass_handles[2], true);
+    graph.execute_frame();
+    compile_stats = render_task_list.get_compile_stats();
+    REQUIRE(compile_stats.num_pass_compiles == 3);
+    REQUIRE(compile_stats.num_barrier_compiles == 1);
+    REQUIRE(compile_stats.num_handle_resolves == 1);
+
+    // Tone mapping isn't, but the resources the graph already created are kept around for when it comes back
+    render_task_list.set_pass_enabled(graph.pass_handles[4], false);
+    graph.execute_frame();
+    REQUIRE(render_task_list.get_num_compiled_passes() == 0);
+    render_task_list.set_pass_enabled(graph.pass_handles[4], true);
+    graph.execute_frame();
+    REQUIRE(render_task_list.get_num_compiled_passes() == 4);
+    compile_stats = render_task_list.get_compile_stats();
+    REQUIRE(compile_stats.num_pass_compiles == 5);
+    REQUIRE(compile_stats.num_barrier_compiles == 3);
+    REQUIRE(compile_stats.num_handle_resolves == 3);
+
+    const gfx::null::Stats stats = gfx::null::get_stats();
+    REQUIRE(stats.num_textures_created == 0);
+    REQUIRE(stats.num_textures_destroyed == 0);
+    REQUIRE(stats.num_buffers_created == 0);
+    REQUIRE(stats.num_buffers_destroyed == 0);
+}
+
+TEST_CASE("Compiled render graphs only issue the transitions each frame needs")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+    for (u32& num_executions : g_num_executions) {
+        num_executions = 0;
+    }
+
+    TestGraph graph{ CommandQueueType::GRAPHICS, false };
+    graph.render_task_list.compile();
+
+    // The first frame moves the resources from their initial states into the ones the compiled barriers expect: light
+    // indices from UAV -> SRV and HDR from RT -> SRV. Everything is only used on the graphics queue, so all in-flight
+    // frames share a single copy and later frames don't need to do this again.
+    gfx::null::reset_stats();
+    for (u32 i = 0; i < RENDER_LATENCY; i++) {
+        graph.execute_frame();
+    }
+    REQUIRE(gfx::null::get_stats().num_barriers == 2 + RENDER_LATENCY * 6);
+
+    // Then each frame: light indices -> UAV -> SRV, HDR -> RT -> SRV, backbuffer -> RT -> PRESENT
+    gfx::null::reset_stats();
+    for (u32 i = 0; i < 10; i++) {
+        graph.execute_frame();
+    }
+    gfx::null::Stats stats = gfx::null::get_stats();
+    REQUIRE(stats.num_barriers == 10 * 6);
+    REQUIRE(stats.num_submits == 10);
+
+    REQUIRE(g_num_executions[0] == 10 + RENDER_LATENCY);
+    REQUIRE(g_num_executions[2] == 0);
+    REQUIRE(g_num_executions[4] == 10 + RENDER_LATENCY);
+}
+
+TEST_CASE("Compiled render graphs wait on passes from other queues")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+
+    TestGraph graph{ CommandQueueType::ASYNC_COMPUTE, false };
+    for (u32 i = 0; i < RENDER_LATENCY; i++) {
+        graph.execute_frame();
+    }
+
+    gfx::null::reset_stats();
+    graph.execute_frame();
+    gfx::null::Stats stats = gfx::null::get_stats();
+    // Light binning is flushed so that the graphics queue can wait on it, then the graphics work is submitted
+    REQUIRE(stats.num_submits == 2);
+    // No barriers for the light indices, since they only change usage when changing queues
+    REQUIRE(stats.num_barriers == 4);
+}
+
+namespace
+{
+    constexpr PassResourceUsage async_light_binning_inputs[] = {
+        {.identifier = to_rid(TestResourceIds::DEPTH), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_SHADER_READABLE },
+    };
+    constexpr PassResourceUsage cluster_count_outputs[] = {
+        {.identifier = to_rid(TestResourceIds::CLUSTER_COUNTS), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_COMPUTE_WRITABLE },
+    };
+    constexpr PassResourceUsage cluster_tone_mapping_inputs[] = {
+        {.identifier = to_rid(TestResourceIds::HDR), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_SHADER_READABLE },
+        {.identifier = to_rid(TestResourceIds::LIGHT_INDICES), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_SHADER_READABLE },
+        {.identifier = to_rid(TestResourceIds::CLUSTER_COUNTS), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_SHADER_READABLE },
+    };
+}
+
+TEST_CASE("Command lists are batched into one submission per queue between cross queue sync points")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+
+    SECTION("A graph shaped like the clustered pipeline, all on the graphics queue, is submitted once per frame")
+    {
+        TestGraph graph{ CommandQueueType::GRAPHICS, false };
+        for (u32 i = 0; i < RENDER_LATENCY; i++) {
+            graph.execute_frame();
+        }
+
+        gfx::null::reset_stats();
+        graph.execute_frame();
+        gfx::null::Stats stats = gfx::null::get_stats();
+        REQUIRE(stats.num_submits == 1);
+        REQUIRE(stats.num_command_contexts_submitted == 4);
+        REQUIRE(stats.num_gpu_waits == 0);
+    }
+
+    SECTION("Async compute passes waited on by several graphics passes share one submission and one wait")
+    {
+        // Depth -> (async) Light Binning -> Forward -> Tone Mapping, with Tone Mapping also reading the counts
+        // written by an independent async pass
+        TestGraph graph{ CommandQueueType::GRAPHICS, false };
+        ResourceContext& resource_context = graph.resource_context;
+        RenderTaskList render_task_list{ &resource_context, &graph.pipeline_store };
+        resource_context.register_buffer({
+            .identifier = to_rid(TestResourceIds::CLUSTER_COUNTS),
+            .initial_usage = RESOURCE_USAGE_COMPUTE_WRITABLE,
+            .desc = {
+                .usage = RESOURCE_USAGE_COMPUTE_WRITABLE | RESOURCE_USAGE_SHADER_READABLE,
+                .type = BufferType::RAW,
+                .byte_size = 256,
+                .stride = 4,
+            },
+            });
+
+        PassListBuilder builder{ &render_task_list };
+        REQUIRE(builder.add_pass({ .name = "Depth", .execute_fn = &count_execution<0>, .outputs = depth_outputs }).is_success());
+        REQUIRE(builder.add_pass({
+            .name = "Light Binning",
+            .command_queue_type = CommandQueueType::ASYNC_COMPUTE,
+            .execute_fn = &count_execution<1>,
+            .inputs = async_light_binning_inputs,
+            .outputs = light_binning_outputs,
+            }).is_success());
+        REQUIRE(builder.add_pass({
+            .name = "Cluster Counts",
+            .command_queue_type = CommandQueueType::ASYNC_COMPUTE,
+            .execute_fn = &count_execution<2>,
+            .outputs = cluster_count_outputs,
+            }).is_success());
+        REQUIRE(builder.add_pass({ .name = "Forward", .execute_fn = &count_execution<3>, .inputs = forward_inputs, .outputs = forward_outputs }).is_success());
+        REQUIRE(builder.add_pass({ .name = "Tone Mapping", .execute_fn = &count_execution<4>, .inputs = cluster_tone_mapping_inputs, .outputs = tone_mapping_outputs }).is_success());
+
+        for (u32 i = 0; i < RENDER_LATENCY; i++) {
+            render_task_list.execute();
+            gfx::present_frame();
+            gfx::reset_for_frame();
+        }
+
+        gfx::null::reset_stats();
+        render_task_list.execute();
+        gfx::null::Stats stats = gfx::null::get_stats();
+        // Depth is flushed for light binning to wait on, then both async passes go in together before Forward waits on
+        // them. Tone Mapping's wait on the cluster counts is already covered by Forward's.
+        REQUIRE(stats.num_submits == 3);
+        REQUIRE(stats.num_command_contexts_submitted == 5);
+        REQUIRE(stats.num_gpu_waits == 2);
+        gfx::present_frame();
+        gfx::reset_for_frame();
+    }
+}
+
+namespace
+{
+    constexpr PassResourceUsage light_indices_tone_mapping_inputs[] = {
+        {.identifier = to_rid(TestResourceIds::HDR), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_SHADER_READABLE },
+        {.identifier = to_rid(TestResourceIds::LIGHT_INDICES), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_SHADER_READABLE },
+    };
+
+    // Depth -> Forward -> Tone Mapping, with a Light Binning pass that may run on async compute feeding both Forward
+    // and Tone Mapping
+    void add_async_light_binning_passes(RenderTaskList& render_task_list, const bool light_binning_reads_depth, PassHandle out_pass_handles[4])
+    {
+        PassListBuilder builder{ &render_task_list };
+        const PassDesc pass_descs[] = {
+            { .name = "Depth", .execute_fn = &count_execution<0>, .outputs = depth_outputs },
+            {
+                .name = "Light Binning",
+                .execute_fn = &count_execution<1>,
+                .inputs = light_binning_reads_depth ? std::span<const PassResourceUsage>{ async_light_binning_inputs } : std::span<const PassResourceUsage>{},
+                .outputs = light_binning_outputs,
+                .allow_async_compute = true,
+            },
+            { .name = "Forward", .execute_fn = &count_execution<3>, .inputs = forward_inputs, .outputs = forward_outputs },
+            { .name = "Tone Mapping", .execute_fn = &count_execution<4>, .inputs = light_indices_tone_mapping_inputs, .outputs = tone_mapping_outputs },
+        };
+        for (size_t i = 0; i < std::size(pass_descs); i++) {
+            PassListBuilder::Result result = builder.add_pass(pass_descs[i]);
+            REQUIRE(result.is_success());
+            out_pass_handles[i] = result.get_pass_handle();
+        }
+    }
+}
+
+TEST_CASE("Compute passes are moved to the async compute queue when they can overlap with graphics work")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+
+    SECTION("Light binning doesn't depend on depth, so it runs alongside it")
+    {
+        TestGraph graph{ CommandQueueType::GRAPHICS, false };
+        RenderTaskList render_task_list{ &graph.resource_context, &graph.pipeline_store };
+        PassHandle pass_handles[4] = {};
+        add_async_light_binning_passes(render_task_list, false, pass_handles);
+        render_task_list.compile();
+
+        REQUIRE(render_task_list.get_pass_queue(pass_handles[0]) == CommandQueueType::GRAPHICS);
+        REQUIRE(render_task_list.get_pass_queue(pass_handles[1]) == CommandQueueType::ASYNC_COMPUTE);
+        REQUIRE(render_task_list.get_pass_queue(pass_handles[2]) == CommandQueueType::GRAPHICS);
+        REQUIRE(render_task_list.get_pass_queue(pass_handles[3]) == CommandQueueType::GRAPHICS);
+
+        // Forward waits on light binning, which also covers tone mapping's use of the light indices
+        REQUIRE(render_task_list.get_num_compiled_passes() == 4);
+        for (size_t i = 0; i < render_task_list.get_num_compiled_passes(); i++) {
+            const PassHandle wait = render_task_list.get_compiled_pass_wait(i);
+            if (render_task_list.get_compiled_pass(i) == pass_handles[2]) {
+                REQUIRE(wait == pass_handles[1]);
+            }
+            else {
+                REQUIRE(!is_valid(wait));
+            }
+        }
+
+        for (u32 i = 0; i < RENDER_LATENCY; i++) {
+            render_task_list.execute();
+            gfx::present_frame();
+            gfx::reset_for_frame();
+        }
+        gfx::null::reset_stats();
+        render_task_list.execute();
+        gfx::null::Stats stats = gfx::null::get_stats();
+        REQUIRE(stats.num_submits == 2);
+        REQUIRE(stats.num_gpu_waits == 1);
+        gfx::present_frame();
+        gfx::reset_for_frame();
+
+        // And stays on the graphics queue when async compute is turned off
+        render_task_list.set_async_compute_enabled(false);
+        render_task_list.compile();
+        REQUIRE(render_task_list.get_pass_queue(pass_handles[1]) == CommandQueueType::GRAPHICS);
+        for (size_t i = 0; i < render_task_list.get_num_compiled_passes(); i++) {
+            REQUIRE(!is_valid(render_task_list.get_compiled_pass_wait(i)));
+        }
+    }
+
+    SECTION("Light binning that needs depth has no graphics work to overlap with, so it stays on the graphics queue")
+    {
+        TestGraph graph{ CommandQueueType::GRAPHICS, false };
+        RenderTaskList render_task_list{ &graph.resource_context, &graph.pipeline_store };
+        PassHandle pass_handles[4] = {};
+        add_async_light_binning_passes(render_task_list, true, pass_handles);
+        render_task_list.compile();
+
+        REQUIRE(render_task_list.get_pass_queue(pass_handles[1]) == CommandQueueType::GRAPHICS);
+        for (size_t i = 0; i < render_task_list.get_num_compiled_passes(); i++) {
+            REQUIRE(!is_valid(render_task_list.get_compiled_pass_wait(i)));
+        }
+    }
+}
+
+namespace
+{
+    constexpr u32 NUM_MIP_CHAIN_MIPS = 4;
+
+    constexpr PassResourceUsage mip_chain_outputs[] = {
+        {.identifier = to_rid(TestResourceIds::MIP_CHAIN), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_COMPUTE_WRITABLE },
+    };
+    // Each downsampling pass reads the previous mip and writes the next
+    constexpr PassResourceUsage downsample_inputs[NUM_MIP_CHAIN_MIPS - 1][1] = {
+        { {.identifier = to_rid(TestResourceIds::MIP_CHAIN), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_SHADER_READABLE, .mip_level = 0 } },
+        { {.identifier = to_rid(TestResourceIds::MIP_CHAIN), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_SHADER_READABLE, .mip_level = 1 } },
+        { {.identifier = to_rid(TestResourceIds::MIP_CHAIN), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_SHADER_READABLE, .mip_level = 2 } },
+    };
+    constexpr PassResourceUsage downsample_outputs[NUM_MIP_CHAIN_MIPS - 1][1] = {
+        { {.identifier = to_rid(TestResourceIds::MIP_CHAIN), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_COMPUTE_WRITABLE, .mip_level = 1 } },
+        { {.identifier = to_rid(TestResourceIds::MIP_CHAIN), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_COMPUTE_WRITABLE, .mip_level = 2 } },
+        { {.identifier = to_rid(TestResourceIds::MIP_CHAIN), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_COMPUTE_WRITABLE, .mip_level = 3 } },
+    };
+    constexpr PassResourceUsage mip_chain_tone_mapping_inputs[] = {
+        {.identifier = to_rid(TestResourceIds::MIP_CHAIN), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_SHADER_READABLE },
+        {.identifier = to_rid(TestResourceIds::DEPTH), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_SHADER_READABLE },
+    };
+}
+
+TEST_CASE("Passes using part of a texture only transition the subresources they use")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+
+    TestGraph graph{ CommandQueueType::GRAPHICS, false };
+    graph.resource_context.register_texture({
+        .identifier = to_rid(TestResourceIds::MIP_CHAIN),
+        .desc = {
+            .width = 64,
+            .height = 64,
+            .depth = 1,
+            .num_mips = NUM_MIP_CHAIN_MIPS,
+            .array_size = 1,
+            .format = BufferFormat::R16G16B16A16_FLOAT,
+            .usage = RESOURCE_USAGE_COMPUTE_WRITABLE | RESOURCE_USAGE_SHADER_READABLE,
+            .initial_state = RESOURCE_USAGE_SHADER_READABLE,
+        },
+        });
+
+    RenderTaskList render_task_list{ &graph.resource_context, &graph.pipeline_store };
+    PassListBuilder builder{ &render_task_list };
+    REQUIRE(builder.add_pass({ .name = "Mip 0", .execute_fn = &count_execution<0>, .outputs = mip_chain_outputs }).is_success());
+    for (u32 i = 0; i < NUM_MIP_CHAIN_MIPS - 1; i++) {
+        REQUIRE(builder.add_pass({ .name = "Downsample", .execute_fn = &count_execution<1>, .inputs = downsample_inputs[i], .outputs = downsample_outputs[i] }).is_success());
+    }
+    // Depth is unrelated to the mip chain, so it sits between the last downsample and its consumer
+    REQUIRE(builder.add_pass({ .name = "Depth", .execute_fn = &count_execution<2>, .outputs = depth_outputs }).is_success());
+    REQUIRE(builder.add_pass({ .name = "Tone Mapping", .execute_fn = &count_execution<4>, .inputs = mip_chain_tone_mapping_inputs, .outputs = tone_mapping_outputs }).is_success());
+
+    constexpr PassResourceUsage buffer_mip_usage[] = {
+        {.identifier = to_rid(TestResourceIds::LIGHT_INDICES), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_COMPUTE_WRITABLE, .mip_level = 0 },
+    };
+    REQUIRE(builder.add_pass({ .name = "Invalid", .outputs = buffer_mip_usage }).get_code() == PassListBuilder::StatusCodes::RESOURCE_USAGE_INVALID);
+
+    for (u32 i = 0; i < RENDER_LATENCY; i++) {
+        render_task_list.execute();
+        gfx::present_frame();
+        gfx::reset_for_frame();
+    }
+
+    gfx::null::reset_stats();
+    render_task_list.execute();
+    gfx::null::Stats stats = gfx::null::get_stats();
+    // Mip chain: SRV -> UAV as a whole, then one mip at a time UAV -> SRV, with a UAV barrier before each downsample
+    // writes its mip, and the last mip's transition split across the depth pass. Depth: SRV -> DS -> SRV.
+    // Backbuffer: -> RT -> PRESENT.
+    REQUIRE(stats.num_barriers == (1 + NUM_MIP_CHAIN_MIPS + 1) + (NUM_MIP_CHAIN_MIPS - 1) + 2 + 2);
+    REQUIRE(stats.num_split_barriers_begun == 1);
+    gfx::present_frame();
+    gfx::reset_for_frame();
+}
+
+namespace
+{
+    // Light indices are 1024 bytes, written a range at a time
+    constexpr PassResourceUsage spot_light_binning_outputs[] = {
+        {.identifier = to_rid(TestResourceIds::LIGHT_INDICES), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_COMPUTE_WRITABLE, .byte_offset = 0, .byte_size = 512 },
+    };
+    constexpr PassResourceUsage point_light_binning_outputs[] = {
+        {.identifier = to_rid(TestResourceIds::LIGHT_INDICES), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_COMPUTE_WRITABLE, .byte_offset = 512, .byte_size = 512 },
+    };
+    constexpr PassResourceUsage overlapping_light_binning_outputs[] = {
+        {.identifier = to_rid(TestResourceIds::LIGHT_INDICES), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_COMPUTE_WRITABLE, .byte_offset = 256, .byte_size = 512 },
+    };
+    constexpr PassResourceUsage independent_light_binning_outputs[] = {
+        {.identifier = to_rid(TestResourceIds::LIGHT_INDICES), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_COMPUTE_WRITABLE, .independent_writes = true },
+    };
+    constexpr PassResourceUsage light_indices_inputs[] = {
+        {.identifier = to_rid(TestResourceIds::LIGHT_INDICES), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_SHADER_READABLE },
+    };
+}
+
+TEST_CASE("UAV barriers are left out between compute writes that don't overlap")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+
+    TestGraph graph{ CommandQueueType::GRAPHICS, false };
+    RenderTaskList render_task_list{ &graph.resource_context, &graph.pipeline_store };
+    PassListBuilder builder{ &render_task_list };
+    REQUIRE(builder.add_pass({ .name = "Spot Light Binning", .execute_fn = &count_execution<0>, .outputs = spot_light_binning_outputs }).is_success());
+    REQUIRE(builder.add_pass({ .name = "Point Light Binning", .execute_fn = &count_execution<1>, .outputs = point_light_binning_outputs }).is_success());
+    REQUIRE(builder.add_pass({ .name = "Overlapping", .execute_fn = &count_execution<2>, .outputs = overlapping_light_binning_outputs }).is_success());
+    REQUIRE(builder.add_pass({ .name = "Independent", .execute_fn = &count_execution<3>, .outputs = independent_light_binning_outputs }).is_success());
+    REQUIRE(builder.add_pass({ .name = "Present", .execute_fn = &count_execution<4>, .inputs = light_indices_inputs, .outputs = tone_mapping_outputs }).is_success());
+
+    constexpr PassResourceUsage texture_byte_range[] = {
+        {.identifier = to_rid(TestResourceIds::HDR), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_COMPUTE_WRITABLE, .byte_size = 16 },
+    };
+    REQUIRE(builder.add_pass({ .name = "Invalid", .outputs = texture_byte_range }).get_code() == PassListBuilder::StatusCodes::RESOURCE_USAGE_INVALID);
+
+    for (u32 i = 0; i < RENDER_LATENCY; i++) {
+        render_task_list.execute();
+        gfx::present_frame();
+        gfx::reset_for_frame();
+    }
+
+    gfx::null::reset_stats();
+    render_task_list.execute();
+    // Only the overlapping write has to wait on the ones before it
+    REQUIRE(gfx::null::get_stats().num_uav_barriers == 1);
+    REQUIRE(render_task_list.get_num_elided_uav_barriers() == 2);
+    gfx::present_frame();
+    gfx::reset_for_frame();
+}
+
+namespace
+{
+    constexpr PassResourceUsage cleared_depth_outputs[] = {
+        {
+            .identifier = to_rid(TestResourceIds::DEPTH),
+            .type = PassResourceType::TEXTURE,
+            .usage = RESOURCE_USAGE_DEPTH_STENCIL,
+            .contents = AttachmentContents::CLEARED,
+            .clear_value = { 0.0f, 0.0f },
+        },
+    };
+
+    size_t find_compiled_pass(const RenderTaskList& render_task_list, const PassHandle pass_handle)
+    {
+        for (size_t i = 0; i < render_task_list.get_num_compiled_passes(); i++) {
+            if (render_task_list.get_compiled_pass(i) == pass_handle) {
+                return i;
+            }
+        }
+        FAIL("Pass wasn't compiled");
+        return 0;
+    }
+}
+
+TEST_CASE("Attachment load and store ops are inferred from the passes using them")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+
+    SECTION("Contents are only loaded when written earlier in the frame, and only stored when read afterwards")
+    {
+        TestGraph graph{ CommandQueueType::GRAPHICS, true };
+        RenderTaskList& render_task_list = graph.render_task_list;
+        render_task_list.compile();
+
+        const size_t depth_idx = find_compiled_pass(render_task_list, graph.pass_handles[0]);
+        const size_t scratch_idx = find_compiled_pass(render_task_list, graph.pass_handles[2]);
+        const size_t forward_idx = find_compiled_pass(render_task_list, graph.pass_handles[3]);
+        const size_t tone_mapping_idx = find_compiled_pass(render_task_list, graph.pass_handles[4]);
+
+        REQUIRE(render_task_list.get_load_op(depth_idx, to_rid(TestResourceIds::DEPTH)) == LoadOp::DISCARD);
+        REQUIRE(render_task_list.get_store_op(depth_idx, to_rid(TestResourceIds::DEPTH)) == StoreOp::STORE);
+        // Forward only tests against depth, and nothing uses it after
+        REQUIRE(render_task_list.get_load_op(forward_idx, to_rid(TestResourceIds::DEPTH)) == LoadOp::LOAD);
+        REQUIRE(render_task_list.get_store_op(forward_idx, to_rid(TestResourceIds::DEPTH)) == StoreOp::DISCARD);
+        REQUIRE(render_task_list.get_load_op(forward_idx, to_rid(TestResourceIds::HDR)) == LoadOp::DISCARD);
+        REQUIRE(render_task_list.get_store_op(forward_idx, to_rid(TestResourceIds::HDR)) == StoreOp::STORE);
+        REQUIRE(render_task_list.get_load_op(tone_mapping_idx, to_rid(TestResourceIds::BACKBUFFER)) == LoadOp::DISCARD);
+        REQUIRE(render_task_list.get_store_op(tone_mapping_idx, to_rid(TestResourceIds::BACKBUFFER)) == StoreOp::STORE);
+        // Exported, so its contents carry over between frames
+        REQUIRE(render_task_list.get_load_op(scratch_idx, to_rid(TestResourceIds::SCRATCH)) == LoadOp::LOAD);
+        REQUIRE(render_task_list.get_store_op(scratch_idx, to_rid(TestResourceIds::SCRATCH)) == StoreOp::STORE);
+
+        gfx::null::reset_stats();
+        graph.execute_frame();
+        gfx::null::Stats stats = gfx::null::get_stats();
+        REQUIRE(stats.num_render_passes == 4);
+        REQUIRE(stats.num_attachment_loads == 2);
+        REQUIRE(stats.num_attachment_stores == 4);
+        REQUIRE(stats.num_clears == 0);
+    }
+
+    SECTION("Clears are done by the render pass, and make storing the previous contents unnecessary")
+    {
+        TestGraph graph{ CommandQueueType::GRAPHICS, false };
+        RenderTaskList render_task_list{ &graph.resource_context, &graph.pipeline_store };
+        PassListBuilder builder{ &render_task_list };
+        const PassHandle first_depth = builder.add_pass({ .name = "Depth", .execute_fn = &count_execution<0>, .outputs = depth_outputs }).get_pass_handle();
+        const PassHandle cleared_depth = builder.add_pass({ .name = "Cleared Depth", .execute_fn = &count_execution<1>, .outputs = cleared_depth_outputs }).get_pass_handle();
+        REQUIRE(builder.add_pass({ .name = "Forward", .execute_fn = &count_execution<3>, .inputs = std::span<const PassResourceUsage>{ forward_inputs, 1 }, .outputs = forward_outputs }).is_success());
+        REQUIRE(builder.add_pass({ .name = "Tone Mapping", .execute_fn = &count_execution<4>, .inputs = tone_mapping_inputs, .outputs = tone_mapping_outputs }).is_success());
+        render_task_list.compile();
+
+        REQUIRE(render_task_list.get_store_op(find_compiled_pass(render_task_list, first_depth), to_rid(TestResourceIds::DEPTH)) == StoreOp::DISCARD);
+        REQUIRE(render_task_list.get_load_op(find_compiled_pass(render_task_list, cleared_depth), to_rid(TestResourceIds::DEPTH)) == LoadOp::CLEAR);
+
+        gfx::null::reset_stats();
+        render_task_list.execute();
+        REQUIRE(gfx::null::get_stats().num_clears == 1);
+        gfx::present_frame();
+        gfx::reset_for_frame();
+    }
+}
+
+namespace
+{
+    TextureHandle g_forward_depth = {};
+    BufferHandle g_forward_light_indices = {};
+    TextureHandle g_forward_hdr = {};
+    TextureHandle g_tone_mapping_backbuffer = {};
+
+    void capture_forward_resources(const PassExecutionContext* context)
+    {
+        g_forward_depth = context->get_input_texture(0);
+        g_forward_light_indices = context->get_input_buffer(1);
+        g_forward_hdr = context->get_output_texture(0);
+    }
+
+    void capture_tone_mapping_resources(const PassExecutionContext* context)
+    {
+        g_tone_mapping_backbuffer = context->get_output_texture(0);
+    }
+}
+
+TEST_CASE("Passes get their resources resolved for the frame being recorded")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+    TestGraph graph{ CommandQueueType::ASYNC_COMPUTE, false };
+    const ResourceContext& resource_context = graph.resource_context;
+    // Handed out in the order the resources were registered
+    REQUIRE(resource_context.get_slot(to_rid(TestResourceIds::BACKBUFFER)) == 0);
+    REQUIRE(resource_context.get_slot(to_rid(TestResourceIds::DEPTH)) == 1);
+    REQUIRE(resource_context.get_slot(to_rid(TestResourceIds::LIGHT_INDICES)) == 4);
+    REQUIRE(resource_context.get_slot(to_rid(TestResourceIds::MIP_CHAIN)) == k_invalid_resource_slot);
+
+    RenderTaskList render_task_list{ &graph.resource_context, &graph.pipeline_store };
+    PassListBuilder builder{ &render_task_list };
+    REQUIRE(builder.add_pass({ .name = "Depth", .execute_fn = &count_execution<0>, .outputs = depth_outputs }).is_success());
+    REQUIRE(builder.add_pass({ .name = "Light Binning", .command_queue_type = CommandQueueType::ASYNC_COMPUTE, .execute_fn = &count_execution<1>, .outputs = light_binning_outputs }).is_success());
+    REQUIRE(builder.add_pass({ .name = "Forward", .execute_fn = &capture_forward_resources, .inputs = forward_inputs, .outputs = forward_outputs }).is_success());
+    REQUIRE(builder.add_pass({ .name = "Tone Mapping", .execute_fn = &capture_tone_mapping_resources, .inputs = tone_mapping_inputs, .outputs = tone_mapping_outputs }).is_success());
+
+    // Light indices are used on both queues, so they get a copy per in-flight frame
+    for (u32 i = 0; i < RENDER_LATENCY; i++) {
+        render_task_list.execute();
+        REQUIRE(g_forward_depth == resource_context.get_texture(to_rid(TestResourceIds::DEPTH)));
+        REQUIRE(g_forward_light_indices == resource_context.get_buffer(to_rid(TestResourceIds::LIGHT_INDICES)));
+        REQUIRE(g_forward_hdr == resource_context.get_texture(to_rid(TestResourceIds::HDR)));
+        REQUIRE(g_tone_mapping_backbuffer == gfx::get_current_back_buffer_handle());
+        gfx::present_frame();
+        gfx::reset_for_frame();
+    }
+    REQUIRE(resource_context.get_buffer(to_rid(TestResourceIds::LIGHT_INDICES), 0) != resource_context.get_buffer(to_rid(TestResourceIds::LIGHT_INDICES), 1));
+}
+
+namespace
+{
+    // Catch's assertions aren't thread safe, so jobs only record what they saw
+    std::atomic<u32> g_recorded_jobs_mask = 0;
+    std::atomic<u32> g_num_jobs = 0;
+
+    void record_draw_job(const PassExecutionContext* context)
+    {
+        if (is_valid(context->cmd_context)) {
+            g_recorded_jobs_mask |= 1 << context->job_idx;
+        }
+        g_num_jobs = context->num_jobs;
+    }
+
+    constexpr PassResourceUsage draw_outputs[] = {
+        {.identifier = to_rid(TestResourceIds::HDR), .type = PassResourceType::TEXTURE, .usage = RESOURCE_USAGE_RENDER_TARGET },
+    };
+}
+
+TEST_CASE("Passes can be recorded in parallel and are still submitted in order")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 3 });
+    {
+        TestGraph graph{ CommandQueueType::ASYNC_COMPUTE, false };
+        for (u32 i = 0; i < RENDER_LATENCY; i++) {
+            graph.render_task_list.execute(task_scheduler);
+            gfx::present_frame();
+            gfx::reset_for_frame();
+        }
+
+        gfx::null::reset_stats();
+        graph.render_task_list.execute(task_scheduler);
+        gfx::null::Stats stats = gfx::null::get_stats();
+        // Same submissions and barriers as when recording serially, but with a command context per pass
+        REQUIRE(stats.num_submits == 2);
+        REQUIRE(stats.num_barriers == 4);
+        REQUIRE(stats.num_command_contexts_submitted == 4);
+        gfx::present_frame();
+        gfx::reset_for_frame();
+    }
+    {
+        ResourceContext resource_context{ gfx::get_config_state() };
+        PipelineStore pipeline_store = {};
+        RenderTaskList render_task_list{ &resource_context, &pipeline_store };
+        resource_context.set_backbuffer_id(to_rid(TestResourceIds::BACKBUFFER));
+        resource_context.register_texture({
+            .identifier = to_rid(TestResourceIds::HDR),
+            .sizing = Sizing::RELATIVE_TO_SWAP_CHAIN,
+            .desc = {
+                .num_mips = 1,
+                .array_size = 1,
+                .format = BufferFormat::R16G16B16A16_FLOAT,
+                .usage = RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_SHADER_READABLE,
+                .initial_state = RESOURCE_USAGE_RENDER_TARGET,
+            },
+            });
+
+        PassListBuilder builder{ &render_task_list };
+        REQUIRE(builder.add_pass({ .name = "Draws", .execute_fn = &record_draw_job, .outputs = draw_outputs, .max_recording_jobs = 8 }).is_success());
+        REQUIRE(builder.add_pass({ .name = "Tone Mapping", .execute_fn = &count_execution<4>, .inputs = tone_mapping_inputs, .outputs = tone_mapping_outputs }).is_success());
+
+        // Split across as many jobs as there are threads
+        gfx::null::reset_stats();
+        render_task_list.execute(task_scheduler);
+        REQUIRE(g_num_jobs == task_scheduler.get_num_threads());
+        REQUIRE(g_recorded_jobs_mask == (1u << task_scheduler.get_num_threads()) - 1);
+        gfx::null::Stats stats = gfx::null::get_stats();
+        REQUIRE(stats.num_submits == 1);
+        // Plus one for tone mapping, and one for moving the HDR target into the state the compiled barriers expect
+        REQUIRE(stats.num_command_contexts_submitted == task_scheduler.get_num_threads() + 2);
+        gfx::present_frame();
+        gfx::reset_for_frame();
+
+        // And recorded as a single job without a scheduler
+        g_recorded_jobs_mask = 0;
+        render_task_list.execute();
+        REQUIRE(g_num_jobs == 1);
+        REQUIRE(g_recorded_jobs_mask == 1);
+        gfx::present_frame();
+        gfx::reset_for_frame();
+    }
+    task_scheduler.shutdown();
+}
+
+TEST_CASE("Resources only get a copy per in-flight frame when their use can overlap between frames")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+    {
+        gfx::null::reset_stats();
+        TestGraph graph{ CommandQueueType::GRAPHICS, true };
+        graph.render_task_list.compile();
+        const ResourceContext& resource_context = graph.resource_context;
+
+        // Everything is only used on the graphics queue
+        REQUIRE(resource_context.get_lifetime(to_rid(TestResourceIds::DEPTH)) == ResourceLifetime::SINGLE);
+        REQUIRE(resource_context.get_lifetime(to_rid(TestResourceIds::LIGHT_INDICES)) == ResourceLifetime::SINGLE);
+        REQUIRE(resource_context.get_buffer(to_rid(TestResourceIds::LIGHT_INDICES), 0) == resource_context.get_buffer(to_rid(TestResourceIds::LIGHT_INDICES), 1));
+        // Apart from the exported resource, whose contents have to outlive the frame
+        REQUIRE(resource_context.get_lifetime(to_rid(TestResourceIds::SCRATCH)) == ResourceLifetime::HISTORY);
+        REQUIRE_FALSE(resource_context.get_texture(to_rid(TestResourceIds::SCRATCH), 0) == resource_context.get_texture(to_rid(TestResourceIds::SCRATCH), 1));
+
+        const gfx::null::Stats stats = gfx::null::get_stats();
+        REQUIRE(stats.num_buffers_created == 1);
+        REQUIRE(stats.num_textures_created == 3 + (RENDER_LATENCY - 1));
+    }
+    {
+        TestGraph graph{ CommandQueueType::ASYNC_COMPUTE, false };
+        graph.render_task_list.compile();
+        const ResourceContext& resource_context = graph.resource_context;
+
+        // Light binning for the next frame can start while the forward pass is still reading this frame's light indices
+        REQUIRE(resource_context.get_lifetime(to_rid(TestResourceIds::LIGHT_INDICES)) == ResourceLifetime::PER_FRAME);
+        REQUIRE_FALSE(resource_context.get_buffer(to_rid(TestResourceIds::LIGHT_INDICES), 0) == resource_context.get_buffer(to_rid(TestResourceIds::LIGHT_INDICES), 1));
+        REQUIRE(resource_context.get_lifetime(to_rid(TestResourceIds::DEPTH)) == ResourceLifetime::SINGLE);
+
+        // Without light binning, only the graphics queue uses them and the extra copies go away again
+        gfx::null::reset_stats();
+        graph.render_task_list.set_pass_enabled(graph.pass_handles[1], false);
+        graph.render_task_list.compile();
+        REQUIRE(resource_context.get_lifetime(to_rid(TestResourceIds::LIGHT_INDICES)) == ResourceLifetime::SINGLE);
+        REQUIRE(resource_context.get_buffer(to_rid(TestResourceIds::LIGHT_INDICES), 0) == resource_context.get_buffer(to_rid(TestResourceIds::LIGHT_INDICES), 1));
+        REQUIRE(gfx::null::get_stats().num_buffers_destroyed == RENDER_LATENCY - 1);
+    }
+    {
+        // Lifetimes that are asked for explicitly are kept
+        ResourceContext resource_context{ gfx::get_config_state() };
+        resource_context.register_buffer({
+            .identifier = to_rid(TestResourceIds::LIGHT_INDICES),
+            .desc = {.usage = RESOURCE_USAGE_SHADER_READABLE, .type = BufferType::RAW, .byte_size = 64, .stride = 4 },
+            .lifetime = ResourceLifetime::PER_FRAME,
+            });
+        REQUIRE_FALSE(resource_context.set_inferred_lifetime(to_rid(TestResourceIds::LIGHT_INDICES), ResourceLifetime::SINGLE));
+        REQUIRE(resource_context.get_lifetime(to_rid(TestResourceIds::LIGHT_INDICES)) == ResourceLifetime::PER_FRAME);
+    }
+}
+
+TEST_CASE("Transient allocations that are never alive at the same time share memory")
+{
+    SECTION("Lifetimes")
+    {
+        const TransientAllocationRequest requests[] = {
+            {.byte_size = 100, .first_use = 0, .last_use = 1 },
+            {.byte_size = 100, .first_use = 2, .last_use = 3 },
+            {.byte_size = 50, .first_use = 1, .last_use = 2 },
+        };
+        u64 offsets[std::size(requests)] = {};
+        REQUIRE(pack_transient_allocations(requests, offsets) == 150);
+        REQUIRE(offsets[0] == 0);
+        REQUIRE(offsets[1] == 0);
+        REQUIRE(offsets[2] == 100);
+    }
+
+    SECTION("Alignment")
+    {
+        const TransientAllocationRequest requests[] = {
+            {.byte_size = 10, .alignment = 64, .first_use = 0, .last_use = 0 },
+            {.byte_size = 100, .alignment = 1, .first_use = 0, .last_use = 0 },
+        };
+        u64 offsets[std::size(requests)] = {};
+        REQUIRE(pack_transient_allocations(requests, offsets) == 138);
+        REQUIRE(offsets[0] == 128);
+        REQUIRE(offsets[1] == 0);
+    }
+
+    SECTION("Gaps")
+    {
+        // The second allocation is dead by the time the small one is needed, which leaves a gap between the two that
+        // are alive alongside it. The small one goes in there instead of growing the heap.
+        const TransientAllocationRequest requests[] = {
+            {.byte_size = 100, .first_use = 0, .last_use = 3 },
+            {.byte_size = 100, .first_use = 0, .last_use = 1 },
+            {.byte_size = 100, .first_use = 0, .last_use = 3 },
+            {.byte_size = 40, .first_use = 2, .last_use = 3 },
+        };
+        u64 offsets[std::size(requests)] = {};
+        REQUIRE(pack_transient_allocations(requests, offsets) == 300);
+        REQUIRE(offsets[0] == 0);
+        REQUIRE(offsets[1] == 100);
+        REQUIRE(offsets[2] == 200);
+        REQUIRE(offsets[3] == 100);
+    }
+}
+
+TEST_CASE("Transient render targets are aliased when their lifetimes don't overlap")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+    TransientChainGraph graph{};
+    ResourceContext& resource_context = graph.resource_context;
+    RenderTaskList& render_task_list = graph.render_task_list;
+    REQUIRE_FALSE(is_valid(resource_context.get_texture(to_rid(ChainResourceIds::TARGET_A))));
+
+    gfx::null::reset_stats();
+    render_task_list.compile();
+    const u64 target_byte_size = gfx::textures::get_allocation_info({
+        .width = 320,
+        .height = 240,
+        .depth = 1,
+        .num_mips = 1,
+        .array_size = 1,
+        .format = BufferFormat::R16G16B16A16_FLOAT,
+        .usage = RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_SHADER_READABLE,
+    }).byte_size;
+
+    TransientMemoryStats memory_stats = resource_context.get_transient_memory_stats();
+    REQUIRE(memory_stats.num_resources == 3);
+    // Only used on the graphics queue, so a single copy of each is enough
+    REQUIRE(memory_stats.unaliased_byte_size == 3 * target_byte_size);
+    REQUIRE(memory_stats.heap_byte_size == 2 * target_byte_size);
+    REQUIRE(resource_context.is_aliased(to_rid(ChainResourceIds::TARGET_A)));
+    REQUIRE_FALSE(resource_context.is_aliased(to_rid(ChainResourceIds::TARGET_B)));
+    REQUIRE(resource_context.is_aliased(to_rid(ChainResourceIds::TARGET_C)));
+
+    gfx::null::Stats stats = gfx::null::get_stats();
+    REQUIRE(stats.num_heaps_created == 1);
+    REQUIRE(stats.num_textures_created == 3);
+
+    // A and C have to be activated each frame, before they're used
+    execute_frames(render_task_list, RENDER_LATENCY);
+    gfx::null::reset_stats();
+    render_task_list.execute();
+    REQUIRE(gfx::null::get_stats().num_aliasing_barriers == 2);
+    // Both are written to as render targets, so they're discarded once the aliasing barriers have activated them
+    REQUIRE(gfx::null::get_stats().num_discards == 2);
+    gfx::present_frame();
+    gfx::reset_for_frame();
+
+    // A is done with its target before C is first used, so C takes over A's memory and is activated right as it
+    // starts using it. B's target has memory of its own.
+    const auto get_heap_offset = [&](const ChainResourceIds id) -> u64 {
+        for (const TransientResourceLifetime& lifetime : resource_context.get_transient_lifetimes()) {
+            if (lifetime.identifier == to_rid(id)) {
+                return lifetime.heap_offset;
+            }
+        }
+        return UINT64_MAX;
+    };
+    REQUIRE(get_heap_offset(ChainResourceIds::TARGET_A) != UINT64_MAX);
+    REQUIRE(get_heap_offset(ChainResourceIds::TARGET_C) == get_heap_offset(ChainResourceIds::TARGET_A));
+    REQUIRE(get_heap_offset(ChainResourceIds::TARGET_B) != get_heap_offset(ChainResourceIds::TARGET_A));
+    REQUIRE(render_task_list.get_pass_stats(graph.pass_handles[0]).num_aliasing_barriers == 1);
+    REQUIRE(render_task_list.get_pass_stats(graph.pass_handles[1]).num_aliasing_barriers == 0);
+    REQUIRE(render_task_list.get_pass_stats(graph.pass_handles[2]).num_aliasing_barriers == 1);
+    REQUIRE(render_task_list.get_pass_stats(graph.pass_handles[3]).num_aliasing_barriers == 0);
+
+    // Nothing reaches the backbuffer without D, so the targets are no longer needed
+    gfx::null::reset_stats();
+    render_task_list.set_pass_enabled(graph.pass_handles[3], false);
+    render_task_list.compile();
+    stats = gfx::null::get_stats();
+    REQUIRE(stats.num_textures_destroyed == 3);
+    REQUIRE(resource_context.get_transient_memory_stats().heap_byte_size == 0);
+    REQUIRE_FALSE(is_valid(resource_context.get_texture(to_rid(ChainResourceIds::TARGET_C))));
+
+    // And get placed again once it's back
+    render_task_list.set_pass_enabled(graph.pass_handles[3], true);
+    render_task_list.compile();
+    REQUIRE(resource_context.get_transient_memory_stats().heap_byte_size == 2 * target_byte_size);
+    REQUIRE(is_valid(resource_context.get_texture(to_rid(ChainResourceIds::TARGET_C))));
+}
+namespace
+{
+    struct alignas(64) AlignedSettings
+    {
+        float values[16];
+    };
+
+    struct RefPassData
+    {
+        PassDataRef<float> exposure;
+    };
+
+    float g_seen_exposure = 0.0f;
+
+    void ref_pass_setup(const SettingsStore* settings_context, PerPassDataStore* per_pass_data_store)
+    {
+        per_pass_data_store->emplace(to_rid(TestResourceIds::SCRATCH), RefPassData{ .exposure = settings_context->get_ref<float>({ 1234 }) });
+    }
+
+    void ref_pass_execution(const PassExecutionContext* context)
+    {
+        g_seen_exposure = *context->get_pass_data<RefPassData>().exposure;
+    }
+}
+
+TEST_CASE("Types with identical layouts get different type ids")
+{
+    struct Exposure { float value; };
+    struct Gamma { float value; };
+    REQUIRE(get_type_id<Exposure>() != get_type_id<Gamma>());
+    REQUIRE(get_type_id<u32>() != get_type_id<float>());
+    REQUIRE(get_type_id<const Exposure&>() == get_type_id<Exposure>());
+}
+
+TEST_CASE("Pass data stores grow, keep entries aligned, and hand out references that stay valid")
+{
+    PassDataStore store{};
+    const PassDataRef<AlignedSettings> aligned = store.emplace(ResourceIdentifier{ 0 }, AlignedSettings{ .values = { 1.0f } });
+    REQUIRE(reinterpret_cast<uintptr_t>(&*aligned) % 64 == 0);
+    // Well past what used to be a fixed 1 KB
+    for (u32 i = 1; i < 256; i++) {
+        store.emplace(ResourceIdentifier{ i }, AlignedSettings{});
+    }
+    REQUIRE(store.get_num_entries() == 256);
+    REQUIRE(aligned->values[0] == 1.0f);
+
+    // Emplacing an existing entry keeps it
+    REQUIRE(&*store.emplace(ResourceIdentifier{ 0 }, AlignedSettings{}) == &*aligned);
+    REQUIRE(aligned->values[0] == 1.0f);
+
+    store.set(ResourceIdentifier{ 0 }, AlignedSettings{ .values = { 2.0f } });
+    REQUIRE(aligned->values[0] == 2.0f);
+    REQUIRE(store.get<AlignedSettings>(ResourceIdentifier{ 0 }).values[0] == 2.0f);
+
+    SECTION("Passes get the data their setup_fn added, with settings resolved once")
+    {
+        const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+        TestGraph graph{ CommandQueueType::GRAPHICS, false };
+        RenderTaskList render_task_list{ &graph.resource_context, &graph.pipeline_store };
+        render_task_list.create_settings(ResourceIdentifier{ 1234 }, 1.0f);
+        PassListBuilder builder{ &render_task_list };
+        REQUIRE(builder.add_pass({ .name = "Tone Mapping", .setup_fn = &ref_pass_setup, .execute_fn = &ref_pass_execution, .outputs = tone_mapping_outputs }).is_success());
+        render_task_list.setup();
+
+        render_task_list.execute();
+        REQUIRE(g_seen_exposure == 1.0f);
+        gfx::present_frame();
+        gfx::reset_for_frame();
+
+        render_task_list.set_settings(ResourceIdentifier{ 1234 }, 0.5f);
+        render_task_list.execute();
+        REQUIRE(g_seen_exposure == 0.5f);
+        gfx::present_frame();
+        gfx::reset_for_frame();
+    }
+}
+
+namespace
+{
+    constexpr ResourceIdentifier k_view_cb_setting = { 4321 };
+    constexpr ResourceIdentifier k_view_pass_data = { 4322 };
+
+    struct ViewPassData
+    {
+        PassDataRef<u32> view_cb;
+    };
+
+    u32 g_seen_view_cbs[2] = {};
+    TextureHandle g_seen_view_depths[2] = {};
+    TextureHandle g_seen_view_hdrs[2] = {};
+    BufferHandle g_seen_view_light_indices[2] = {};
+
+    void view_pass_setup(const SettingsStore* settings_context, PerPassDataStore* per_pass_data_store)
+    {
+        per_pass_data_store->emplace(k_view_pass_data, ViewPassData{ .view_cb = settings_context->get_ref<u32>(k_view_cb_setting) });
+    }
+
+    void view_forward_execution(const PassExecutionContext* context)
+    {
+        g_seen_view_cbs[context->view_idx] = *context->get_pass_data<ViewPassData>().view_cb;
+        g_seen_view_depths[context->view_idx] = context->get_input_texture(0);
+        g_seen_view_hdrs[context->view_idx] = context->get_output_texture(0);
+        g_seen_view_light_indices[context->view_idx] = context->get_input_buffer(1);
+    }
+}
+
+TEST_CASE("Passes added once per view get their own resources and settings, and share the rest")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+    ResourceContext resource_context{ gfx::get_config_state() };
+    PipelineStore pipeline_store = {};
+    RenderTaskList render_task_list{ &resource_context, &pipeline_store };
+
+    resource_context.set_backbuffer_id(to_rid(TestResourceIds::BACKBUFFER));
+    resource_context.register_texture({
+        .identifier = to_rid(TestResourceIds::DEPTH),
+        .sizing = Sizing::RELATIVE_TO_SWAP_CHAIN,
+        .desc = {
+            .num_mips = 1,
+            .array_size = 1,
+            .format = BufferFormat::D32,
+            .usage = RESOURCE_USAGE_DEPTH_STENCIL,
+            .initial_state = RESOURCE_USAGE_DEPTH_STENCIL,
+        },
+        .num_views = 2,
+        });
+    resource_context.register_texture({
+        .identifier = to_rid(TestResourceIds::HDR),
+        .sizing = Sizing::RELATIVE_TO_SWAP_CHAIN,
+        .desc = {
+            .num_mips = 1,
+            .array_size = 1,
+            .format = BufferFormat::R16G16B16A16_FLOAT,
+            .usage = RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_SHADER_READABLE,
+            .initial_state = RESOURCE_USAGE_RENDER_TARGET,
+        },
+        .is_transient = true,
+        .num_views = 2,
+        });
+    resource_context.register_buffer({
+        .identifier = to_rid(TestResourceIds::LIGHT_INDICES),
+        .initial_usage = RESOURCE_USAGE_COMPUTE_WRITABLE,
+        .desc = {
+            .usage = RESOURCE_USAGE_COMPUTE_WRITABLE | RESOURCE_USAGE_SHADER_READABLE,
+            .type = BufferType::RAW,
+            .byte_size = 1024,
+            .stride = 4,
+        },
+        });
+    REQUIRE(resource_context.has_texture(get_view_identifier(to_rid(TestResourceIds::DEPTH), 1)));
+    REQUIRE_FALSE(resource_context.has_buffer(get_view_identifier(to_rid(TestResourceIds::LIGHT_INDICES), 1)));
+    // An unrelated resource that happens to have the identifier view 1's copy of the light indices would have
+    resource_context.register_buffer({
+        .identifier = get_view_identifier(to_rid(TestResourceIds::LIGHT_INDICES), 1),
+        .initial_usage = RESOURCE_USAGE_SHADER_READABLE,
+        .desc = {
+            .usage = RESOURCE_USAGE_SHADER_READABLE,
+            .type = BufferType::RAW,
+            .byte_size = 16,
+            .stride = 4,
+        },
+        });
+
+    render_task_list.create_settings(k_view_cb_setting, 10u);
+    render_task_list.create_settings(get_view_identifier(k_view_cb_setting, 1), 11u);
+
+    PassListBuilder builder{ &render_task_list };
+    REQUIRE(builder.add_pass({ .name = "Light Binning", .execute_fn = &count_execution<1>, .outputs = light_binning_outputs }).is_success());
+    for (u32 view_idx = 0; view_idx < 2; view_idx++) {
+        REQUIRE(builder.add_pass({ .name = "Depth", .execute_fn = &count_execution<0>, .outputs = depth_outputs }, view_idx).is_success());
+        REQUIRE(builder.add_pass({ .name = "Forward", .setup_fn = &view_pass_setup, .execute_fn = &view_forward_execution, .inputs = forward_inputs, .outputs = forward_outputs }, view_idx).is_success());
+        REQUIRE(builder.add_pass({ .name = "Tone Mapping", .execute_fn = &count_execution<4>, .inputs = tone_mapping_inputs, .outputs = tone_mapping_outputs }, view_idx).is_success());
+    }
+    render_task_list.setup();
+
+    for (u32& num_executions : g_num_executions) {
+        num_executions = 0;
+    }
+    render_task_list.execute();
+    gfx::present_frame();
+    gfx::reset_for_frame();
+
+    REQUIRE(render_task_list.get_num_compiled_passes() == 7);
+    REQUIRE(g_num_executions[1] == 1);
+    REQUIRE(g_num_executions[0] == 2);
+    REQUIRE(g_seen_view_cbs[0] == 10);
+    REQUIRE(g_seen_view_cbs[1] == 11);
+    REQUIRE(g_seen_view_depths[0] == resource_context.get_texture(to_rid(TestResourceIds::DEPTH)));
+    REQUIRE(g_seen_view_depths[1] == resource_context.get_texture(get_view_identifier(to_rid(TestResourceIds::DEPTH), 1)));
+    REQUIRE(g_seen_view_depths[0] != g_seen_view_depths[1]);
+    REQUIRE(g_seen_view_hdrs[0] != g_seen_view_hdrs[1]);
+    // The light indices aren't registered per view, so both views read the same ones
+    REQUIRE(g_seen_view_light_indices[0] == resource_context.get_buffer(to_rid(TestResourceIds::LIGHT_INDICES)));
+    REQUIRE(g_seen_view_light_indices[1] == g_seen_view_light_indices[0]);
+
+    // Each view is done with its HDR target before the next one starts, so they share memory
+    const TransientMemoryStats memory_stats = resource_context.get_transient_memory_stats();
+    REQUIRE(memory_stats.num_resources == 2);
+    REQUIRE(memory_stats.heap_byte_size * 2 == memory_stats.unaliased_byte_size);
+}
+
+TEST_CASE("Resources sized relative to the swap chain follow it when it's resized, reusing pooled allocations")
+{
+    {
+        const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+        TestGraph graph{ CommandQueueType::GRAPHICS, false };
+        ResourceContext& resource_context = graph.resource_context;
+        resource_context.register_texture({
+            .identifier = to_rid(TestResourceIds::MIP_CHAIN),
+            .sizing = Sizing::RELATIVE_TO_SWAP_CHAIN,
+            .relative_width_factor = 0.5f,
+            .relative_height_factor = 0.5f,
+            .desc = {
+                .num_mips = 1,
+                .array_size = 1,
+                .format = BufferFormat::R16G16B16A16_FLOAT,
+                .usage = RESOURCE_USAGE_SHADER_READABLE,
+                .initial_state = RESOURCE_USAGE_SHADER_READABLE,
+            },
+            });
+        const auto get_size = [&](const TestResourceIds id) {
+            const TextureInfo& info = gfx::textures::get_texture_info(resource_context.get_texture(to_rid(id)));
+            return std::pair{ info.width, info.height };
+        };
+        REQUIRE(get_size(TestResourceIds::MIP_CHAIN) == std::pair{ 160u, 120u });
+        graph.execute_frame();
+
+        const auto resize = [&](const u32 width, const u32 height) {
+            gfx::on_window_resize(width, height);
+            resource_context.set_render_config_state(gfx::get_config_state());
+            graph.execute_frame();
+        };
+
+        // Depth, HDR, Scratch and the half sized one, while the light indices buffer is left alone
+        const BufferHandle light_indices = resource_context.get_buffer(to_rid(TestResourceIds::LIGHT_INDICES));
+        gfx::null::reset_stats();
+        resize(640, 480);
+        REQUIRE(get_size(TestResourceIds::DEPTH) == std::pair{ 640u, 480u });
+        REQUIRE(get_size(TestResourceIds::MIP_CHAIN) == std::pair{ 320u, 240u });
+        REQUIRE(resource_context.get_buffer(to_rid(TestResourceIds::LIGHT_INDICES)) == light_indices);
+        REQUIRE(gfx::null::get_stats().num_textures_created == 4);
+        REQUIRE(gfx::null::get_stats().num_textures_destroyed == 0);
+        REQUIRE(resource_context.get_resource_pool_stats().num_textures == 4);
+
+        // Going back to a size we've had before doesn't allocate anything
+        gfx::null::reset_stats();
+        resize(320, 240);
+        REQUIRE(get_size(TestResourceIds::DEPTH) == std::pair{ 320u, 240u });
+        REQUIRE(gfx::null::get_stats().num_textures_created == 0);
+        REQUIRE(gfx::null::get_stats().num_textures_destroyed == 0);
+
+        // Allocations that keep not being reused are freed eventually
+        resize(800, 600);
+        resize(1024, 768);
+        const ResourcePoolStats pool_stats = resource_context.get_resource_pool_stats();
+        REQUIRE(pool_stats.num_textures == 8);
+        REQUIRE(gfx::null::get_stats().num_textures_destroyed == 4);
+        REQUIRE(pool_stats.byte_size > 0);
+
+        resource_context.clear_resource_pool();
+        REQUIRE(resource_context.get_resource_pool_stats().num_textures == 0);
+        REQUIRE(gfx::null::get_stats().num_textures_destroyed == 12);
+    }
+
+    SECTION("Transient resources are placed again, in pooled heaps")
+    {
+        const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+        ResourceContext resource_context{ gfx::get_config_state() };
+        PipelineStore pipeline_store = {};
+        RenderTaskList render_task_list{ &resource_context, &pipeline_store };
+        resource_context.set_backbuffer_id(to_rid(TestResourceIds::BACKBUFFER));
+        const TextureDesc target_desc = {
+            .num_mips = 1,
+            .array_size = 1,
+            .format = BufferFormat::R16G16B16A16_FLOAT,
+            .usage = RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_SHADER_READABLE,
+            .initial_state = RESOURCE_USAGE_RENDER_TARGET,
+        };
+        resource_context.register_texture({ .identifier = to_rid(TestResourceIds::HDR), .sizing = Sizing::RELATIVE_TO_SWAP_CHAIN, .desc = target_desc, .is_transient = true });
+        PassListBuilder builder{ &render_task_list };
+        REQUIRE(builder.add_pass({ .name = "Forward", .execute_fn = &count_execution<3>, .outputs = forward_outputs }).is_success());
+        REQUIRE(builder.add_pass({ .name = "Tone Mapping", .execute_fn = &count_execution<4>, .inputs = tone_mapping_inputs, .outputs = tone_mapping_outputs }).is_success());
+
+        const auto get_target_byte_size = [&](const u32 width, const u32 height) {
+            TextureDesc desc = target_desc;
+            desc.width = width;
+            desc.height = height;
+            desc.depth = 1;
+            return gfx::textures::get_allocation_info(desc).byte_size;
+        };
+        const auto resize = [&](const u32 width, const u32 height) {
+            gfx::on_window_resize(width, height);
+            resource_context.set_render_config_state(gfx::get_config_state());
+            render_task_list.execute();
+            gfx::present_frame();
+            gfx::reset_for_frame();
+        };
+        render_task_list.execute();
+        REQUIRE(resource_context.get_transient_memory_stats().heap_byte_size == get_target_byte_size(320, 240));
+
+        gfx::null::reset_stats();
+        resize(640, 480);
+        REQUIRE(resource_context.get_transient_memory_stats().heap_byte_size == get_target_byte_size(640, 480));
+        REQUIRE(gfx::textures::get_texture_info(resource_context.get_texture(to_rid(TestResourceIds::HDR))).width == 640);
+        REQUIRE(gfx::null::get_stats().num_heaps_created == 1);
+        REQUIRE(resource_context.get_resource_pool_stats().num_heaps == 1);
+
+        gfx::null::reset_stats();
+        resize(320, 240);
+        REQUIRE(resource_context.get_transient_memory_stats().heap_byte_size == get_target_byte_size(320, 240));
+        REQUIRE(gfx::null::get_stats().num_heaps_created == 0);
+        // The placed texture itself is recreated, which doesn't allocate any memory
+        REQUIRE(gfx::null::get_stats().num_textures_created == 1);
+    }
+}
+
+namespace
+{
+    Viewport g_forward_viewport = {};
+    Viewport g_tone_mapping_input_viewport = {};
+    Scissor g_tone_mapping_scissor = {};
+
+    void capture_forward_viewport(const PassExecutionContext* context)
+    {
+        g_forward_viewport = context->get_output_viewport(0);
+    }
+
+    void capture_tone_mapping_viewports(const PassExecutionContext* context)
+    {
+        g_tone_mapping_input_viewport = context->get_input_viewport(0);
+        g_tone_mapping_scissor = context->get_output_scissor(0);
+    }
+}
+
+TEST_CASE("Dynamic resolution textures are rendered to through a scaled viewport, without being recreated")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+    ResourceContext resource_context{ gfx::get_config_state() };
+    PipelineStore pipeline_store = {};
+    RenderTaskList render_task_list{ &resource_context, &pipeline_store };
+    resource_context.set_backbuffer_id(to_rid(TestResourceIds::BACKBUFFER));
+    resource_context.register_texture({
+        .identifier = to_rid(TestResourceIds::HDR),
+        .sizing = Sizing::RELATIVE_TO_SWAP_CHAIN,
+        .desc = {
+            .num_mips = 1,
+            .array_size = 1,
+            .format = BufferFormat::R16G16B16A16_FLOAT,
+            .usage = RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_SHADER_READABLE,
+            .initial_state = RESOURCE_USAGE_RENDER_TARGET,
+        },
+        .dynamic_resolution = true,
+        });
+    PassListBuilder builder{ &render_task_list };
+    REQUIRE(builder.add_pass({ .name = "Forward", .execute_fn = &capture_forward_viewport, .outputs = forward_outputs }).is_success());
+    REQUIRE(builder.add_pass({ .name = "Tone Mapping", .execute_fn = &capture_tone_mapping_viewports, .inputs = tone_mapping_inputs, .outputs = tone_mapping_outputs }).is_success());
+
+    execute_frames(render_task_list, 1);
+    REQUIRE(g_forward_viewport.width == 320.0f);
+    REQUIRE(g_forward_viewport.height == 240.0f);
+
+    gfx::null::reset_stats();
+    resource_context.set_render_scale(0.5f);
+    execute_frames(render_task_list, 1);
+    REQUIRE(g_forward_viewport.width == 160.0f);
+    REQUIRE(g_forward_viewport.height == 120.0f);
+    REQUIRE(g_tone_mapping_input_viewport.width == 160.0f);
+    // The backbuffer isn't scaled, tone mapping upscales into all of it
+    REQUIRE(g_tone_mapping_scissor.right == 320);
+    REQUIRE(g_tone_mapping_scissor.bottom == 240);
+    // The texture is still allocated at full size
+    REQUIRE(gfx::textures::get_texture_info(resource_context.get_texture(to_rid(TestResourceIds::HDR))).width == 320);
+
+    resource_context.set_render_scale(0.7f);
+    execute_frames(render_task_list, 1);
+    REQUIRE(g_forward_viewport.width == 224.0f);
+    REQUIRE(g_forward_viewport.height == 168.0f);
+    REQUIRE(gfx::null::get_stats().num_textures_created == 0);
+    REQUIRE(gfx::null::get_stats().num_textures_destroyed == 0);
+    REQUIRE(render_task_list.get_compile_stats().num_pass_compiles == 1);
+
+    // Scales carry over to the new size when the swap chain is resized
+    gfx::on_window_resize(640, 480);
+    resource_context.set_render_config_state(gfx::get_config_state());
+    execute_frames(render_task_list, 1);
+    REQUIRE(g_forward_viewport.width == 448.0f);
+    REQUIRE(g_tone_mapping_scissor.right == 640);
+}
+namespace
+{
+    BufferHandle g_index_buffer = {};
+
+    void dispatch_twice(const PassExecutionContext* context)
+    {
+        gfx::cmd::dispatch(context->cmd_context, 8, 8, 1);
+        gfx::cmd::dispatch(context->cmd_context, 8, 8, 1);
+    }
+
+    // Three draws per job
+    void draw_per_job(const PassExecutionContext* context)
+    {
+        for (u32 i = 0; i < 3; i++) {
+            gfx::cmd::draw_mesh(context->cmd_context, g_index_buffer);
+        }
+    }
+}
+
+TEST_CASE("Render graph stats are gathered per pass and per frame, with rolling averages")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 3 });
+    {
+        g_index_buffer = gfx::buffers::create({ .usage = RESOURCE_USAGE_INDEX, .type = BufferType::DEFAULT, .byte_size = 12, .stride = 2 });
+        ResourceContext resource_context{ gfx::get_config_state() };
+        PipelineStore pipeline_store = {};
+        RenderTaskList render_task_list{ &resource_context, &pipeline_store };
+        resource_context.set_backbuffer_id(to_rid(TestResourceIds::BACKBUFFER));
+        const TextureDesc target_desc = {
+            .num_mips = 1,
+            .array_size = 1,
+            .format = BufferFormat::R16G16B16A16_FLOAT,
+            .usage = RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_SHADER_READABLE,
+            .initial_state = RESOURCE_USAGE_RENDER_TARGET,
+        };
+        resource_context.register_texture({ .identifier = to_rid(TestResourceIds::HDR), .sizing = Sizing::RELATIVE_TO_SWAP_CHAIN, .desc = target_desc });
+        resource_context.register_texture({ .identifier = to_rid(TestResourceIds::SCRATCH), .sizing = Sizing::RELATIVE_TO_SWAP_CHAIN, .desc = target_desc });
+        resource_context.register_buffer({
+            .identifier = to_rid(TestResourceIds::LIGHT_INDICES),
+            .initial_usage = RESOURCE_USAGE_COMPUTE_WRITABLE,
+            .desc = {
+                .usage = RESOURCE_USAGE_COMPUTE_WRITABLE | RESOURCE_USAGE_SHADER_READABLE,
+                .type = BufferType::RAW,
+                .byte_size = 1024,
+                .stride = 4,
+            },
+            });
+        constexpr PassResourceUsage draw_inputs[] = {
+            {.identifier = to_rid(TestResourceIds::LIGHT_INDICES), .type = PassResourceType::BUFFER, .usage = RESOURCE_USAGE_SHADER_READABLE },
+        };
+
+        PassListBuilder builder{ &render_task_list };
+        const PassHandle dispatch_pass = builder.add_pass({ .name = "Dispatches", .command_queue_type = CommandQueueType::ASYNC_COMPUTE, .execute_fn = &dispatch_twice, .outputs = light_binning_outputs }).get_pass_handle();
+        const PassHandle scratch_pass = builder.add_pass({ .name = "Scratch", .execute_fn = &count_execution<2>, .outputs = scratch_outputs }).get_pass_handle();
+        const PassHandle draw_pass = builder.add_pass({ .name = "Draws", .execute_fn = &draw_per_job, .inputs = draw_inputs, .outputs = draw_outputs, .max_recording_jobs = 8 }).get_pass_handle();
+        REQUIRE(builder.add_pass({ .name = "Tone Mapping", .execute_fn = &count_execution<4>, .inputs = tone_mapping_inputs, .outputs = tone_mapping_outputs }).is_success());
+        REQUIRE(render_task_list.get_frame_stats().num_submits == 0);
+        REQUIRE(render_task_list.get_average_pass_stats(draw_pass).num_draws == 0);
+
+        for (u32 i = 0; i < RENDER_LATENCY; i++) {
+            render_task_list.execute(task_scheduler);
+            gfx::present_frame();
+            gfx::reset_for_frame();
+        }
+
+        gfx::null::reset_stats();
+        render_task_list.execute(task_scheduler);
+        const gfx::null::Stats backend_stats = gfx::null::get_stats();
+        const u32 num_threads = task_scheduler.get_num_threads();
+
+        const PassStats dispatch_stats = render_task_list.get_pass_stats(dispatch_pass);
+        REQUIRE(dispatch_stats.num_dispatches == 2);
+        REQUIRE(dispatch_stats.num_draws == 0);
+        REQUIRE(dispatch_stats.num_command_lists == 1);
+        REQUIRE(dispatch_stats.cpu_record_ms >= 0.0f);
+
+        const PassStats draw_stats = render_task_list.get_pass_stats(draw_pass);
+        REQUIRE(draw_stats.num_command_lists == num_threads);
+        REQUIRE(draw_stats.num_draws == 3 * num_threads);
+
+        // Scratch gets culled, so never records anything
+        REQUIRE(render_task_list.get_pass_stats(scratch_pass).num_command_lists == 0);
+
+        // The totals match what the backend saw
+        u64 num_draws = 0;
+        u64 num_dispatches = 0;
+        u64 num_barriers = 0;
+        for (size_t i = 0; i < render_task_list.get_num_compiled_passes(); i++) {
+            const PassStats pass_stats = render_task_list.get_pass_stats(render_task_list.get_compiled_pass(i));
+            num_draws += pass_stats.num_draws;
+            num_dispatches += pass_stats.num_dispatches;
+            num_barriers += pass_stats.num_transitions;
+        }
+        REQUIRE(num_draws == backend_stats.num_draws);
+        REQUIRE(num_dispatches == backend_stats.num_dispatches);
+        REQUIRE(num_barriers == backend_stats.num_barriers);
+        const RenderGraphFrameStats frame_stats = render_task_list.get_frame_stats();
+        REQUIRE(frame_stats.num_submits == backend_stats.num_submits);
+        REQUIRE(frame_stats.num_command_lists == backend_stats.num_command_contexts_submitted);
+        REQUIRE(frame_stats.num_gpu_waits == backend_stats.num_gpu_waits);
+        REQUIRE(frame_stats.num_gpu_waits == 1);
+        gfx::present_frame();
+        gfx::reset_for_frame();
+
+        SECTION("Averages cover the frames recorded so far")
+        {
+            // Recorded serially for a while, the draws are all in one job
+            for (u32 i = 0; i < RENDER_GRAPH_STATS_HISTORY_LENGTH - RENDER_LATENCY - 1; i++) {
+                execute_frames(render_task_list, 1);
+            }
+            REQUIRE(render_task_list.get_pass_stats(draw_pass).num_draws == 3);
+            const u32 expected_average = (3 * num_threads * (RENDER_LATENCY + 1) + 3 * (RENDER_GRAPH_STATS_HISTORY_LENGTH - RENDER_LATENCY - 1) + RENDER_GRAPH_STATS_HISTORY_LENGTH / 2) / RENDER_GRAPH_STATS_HISTORY_LENGTH;
+            REQUIRE(render_task_list.get_average_pass_stats(draw_pass).num_draws == expected_average);
+
+            // Once the history wraps around, only the serial frames are left
+            for (u32 i = 0; i < RENDER_GRAPH_STATS_HISTORY_LENGTH; i++) {
+                execute_frames(render_task_list, 1);
+            }
+            REQUIRE(render_task_list.get_average_pass_stats(draw_pass).num_draws == 3);
+            REQUIRE(render_task_list.get_average_pass_stats(draw_pass).num_command_lists == 1);
+            REQUIRE(render_task_list.get_average_frame_stats().num_submits == render_task_list.get_frame_stats().num_submits);
+
+            render_task_list.reset_stats();
+            REQUIRE(render_task_list.get_average_pass_stats(draw_pass).num_draws == 0);
+            REQUIRE(render_task_list.get_frame_stats().num_submits == 0);
+        }
+
+        SECTION("Disabled passes are zeroed out")
+        {
+            render_task_list.set_pass_enabled(draw_pass, false);
+            execute_frames(render_task_list, 1);
+            REQUIRE(render_task_list.get_pass_stats(draw_pass).num_draws == 0);
+            // Along with the pass feeding it, which gets culled
+            REQUIRE(render_task_list.get_pass_stats(dispatch_pass).num_dispatches == 0);
+            REQUIRE(render_task_list.get_frame_stats().num_gpu_waits == 0);
+        }
+        gfx::buffers::destroy(g_index_buffer);
+    }
+    task_scheduler.shutdown();
+}
+
+TEST_CASE("Compiled render graphs can be serialized and loaded instead of being compiled again")
+{
+    const NullRendererScope renderer{ { .width = 320, .height = 240 } };
+
+    SECTION("Pass order, queues and barriers")
+    {
+        std::vector<u8> data = {};
+        gfx::null::Stats compiled_stats = {};
+        {
+            TestGraph graph{ CommandQueueType::GRAPHICS, false };
+            RenderTaskList render_task_list{ &graph.resource_context, &graph.pipeline_store };
+            PassHandle pass_handles[4] = {};
+            add_async_light_binning_passes(render_task_list, false, pass_handles);
+            render_task_list.compile();
+            data = render_task_list.serialize_compiled();
+
+            execute_frames(render_task_list, RENDER_LATENCY);
+            gfx::null::reset_stats();
+            execute_frames(render_task_list, 1);
+            compiled_stats = gfx::null::get_stats();
+        }
+
+        TestGraph graph{ CommandQueueType::GRAPHICS, false };
+        RenderTaskList render_task_list{ &graph.resource_context, &graph.pipeline_store };
+        PassHandle pass_handles[4] = {};
+        add_async_light_binning_passes(render_task_list, false, pass_handles);
+        REQUIRE(render_task_list.load_compiled(data));
+
+        // Only the handles are left to resolve
+        REQUIRE_FALSE(render_task_list.get_is_compiled());
+        render_task_list.compile();
+        const RenderGraphCompileStats compile_stats = render_task_list.get_compile_stats();
+        REQUIRE(compile_stats.num_pass_compiles == 0);
+        REQUIRE(compile_stats.num_barrier_compiles == 0);
+        REQUIRE(compile_stats.num_handle_resolves == 1);
+
+        REQUIRE(render_task_list.get_num_compiled_passes() == 4);
+        REQUIRE(render_task_list.get_pass_queue(pass_handles[1]) == CommandQueueType::ASYNC_COMPUTE);
+        for (size_t i = 0; i < render_task_list.get_num_compiled_passes(); i++) {
+            const bool is_forward = render_task_list.get_compiled_pass(i) == pass_handles[2];
+            REQUIRE(render_task_list.get_compiled_pass_wait(i) == (is_forward ? pass_handles[1] : PassHandle{}));
+        }
+
+        // Frames are recorded just like the compiled list's were
+        execute_frames(render_task_list, RENDER_LATENCY);
+        gfx::null::reset_stats();
+        execute_frames(render_task_list, 1);
+        const gfx::null::Stats stats = gfx::null::get_stats();
+        REQUIRE(stats.num_barriers == compiled_stats.num_barriers);
+        REQUIRE(stats.num_submits == compiled_stats.num_submits);
+        REQUIRE(stats.num_gpu_waits == compiled_stats.num_gpu_waits);
+
+        // And it compiles as usual once something changes
+        render_task_list.set_async_compute_enabled(false);
+        render_task_list.compile();
+        REQUIRE(render_task_list.get_compile_stats().num_pass_compiles == 1);
+        REQUIRE(render_task_list.get_pass_queue(pass_handles[1]) == CommandQueueType::GRAPHICS);
+    }
+
+    SECTION("Transient resource placement")
+    {
+        std::vector<u8> data = {};
+        TransientMemoryStats compiled_memory_stats = {};
+        {
+            TransientChainGraph graph{};
+            graph.render_task_list.compile();
+            data = graph.render_task_list.serialize_compiled();
+            compiled_memory_stats = graph.resource_context.get_transient_memory_stats();
+        }
+
+        TransientChainGraph graph{};
+        gfx::null::reset_stats();
+        REQUIRE(graph.render_task_list.load_compiled(data));
+        const TransientMemoryStats memory_stats = graph.resource_context.get_transient_memory_stats();
+        REQUIRE(memory_stats.num_resources == compiled_memory_stats.num_resources);
+        REQUIRE(memory_stats.heap_byte_size == compiled_memory_stats.heap_byte_size);
+        REQUIRE(memory_stats.heap_byte_size < memory_stats.unaliased_byte_size);
+        REQUIRE(graph.resource_context.is_aliased(to_rid(ChainResourceIds::TARGET_A)));
+        REQUIRE_FALSE(graph.resource_context.is_aliased(to_rid(ChainResourceIds::TARGET_B)));
+        REQUIRE(graph.resource_context.is_aliased(to_rid(ChainResourceIds::TARGET_C)));
+        REQUIRE(gfx::null::get_stats().num_heaps_created == 1);
+
+        execute_frames(graph.render_task_list, RENDER_LATENCY);
+        gfx::null::reset_stats();
+        execute_frames(graph.render_task_list, 1);
+        REQUIRE(gfx::null::get_stats().num_aliasing_barriers == 2);
+        REQUIRE(graph.render_task_list.get_compile_stats().num_barrier_compiles == 0);
+    }
+
+    SECTION("Data written for another list, or that's been cut short, isn't loaded")
+    {
+        std::vector<u8> data = {};
+        {
+            TestGraph graph{ CommandQueueType::GRAPHICS, false };
+            graph.render_task_list.compile();
+            data = graph.render_task_list.serialize_compiled();
+        }
+
+        TestGraph graph{ CommandQueueType::GRAPHICS, false };
+        RenderTaskList& render_task_list = graph.render_task_list;
+        const u64 hash = render_task_list.get_compile_hash();
+        render_task_list.set_pass_enabled(graph.pass_handles[2], false);
+        REQUIRE(render_task_list.get_compile_hash() != hash);
+        REQUIRE_FALSE(render_task_list.load_compiled(data));
+        render_task_list.set_pass_enabled(graph.pass_handles[2], true);
+
+        TestGraph async_graph{ CommandQueueType::ASYNC_COMPUTE, false };
+        REQUIRE_FALSE(async_graph.render_task_list.load_compiled(data));
+
+        REQUIRE_FALSE(render_task_list.load_compiled(std::span<const u8>{ data }.first(data.size() - 1)));
+        std::vector<u8> padded_data = data;
+        padded_data.push_back(0);
+        REQUIRE_FALSE(render_task_list.load_compiled(padded_data));
+        REQUIRE_FALSE(render_task_list.load_compiled({}));
+
+        // None of which touched the list
+        REQUIRE(render_task_list.get_compile_stats().num_pass_compiles == 0);
+        render_task_list.compile();
+        REQUIRE(render_task_list.get_compile_stats().num_pass_compiles == 1);
+        REQUIRE(render_task_list.get_num_compiled_passes() == 4);
+        REQUIRE(render_task_list.load_compiled(data));
+    }
+}
+#endif // USE_NULL_RENDERER
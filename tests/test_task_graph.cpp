@@ -0,0 +1,94 @@
+#include "catch2/catch.hpp"
+#include "task_graph.h"
+#include <atomic>
+
+using namespace zec;
+
+namespace
+{
+    struct RecordOrderData
+    {
+        std::atomic<u32>* next_slot;
+        u32* finish_order;
+    };
+
+    void record_order_task(TaskScheduler* task_scheduler, void* arg)
+    {
+        RecordOrderData* data = static_cast<RecordOrderData*>(arg);
+        *data->finish_order = data->next_slot->fetch_add(1);
+    }
+
+    void increment_task(TaskScheduler* task_scheduler, void* arg)
+    {
+        static_cast<std::atomic<u32>*>(arg)->fetch_add(1);
+    }
+}
+
+TEST_CASE("Task graph nodes run after their predecessors")
+{
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 3 });
+
+    // Diamond: a -> (b, c) -> d
+    std::atomic<u32> next_slot = 0;
+    u32 finish_order[4] = {};
+    RecordOrderData data[4];
+    for (size_t i = 0; i < std::size(data); i++) {
+        data[i] = { .next_slot = &next_slot, .finish_order = &finish_order[i] };
+    }
+
+    TaskGraph graph{};
+    TaskGraphNodeHandle a = graph.add_node({ .name = "a", .function = record_order_task, .arg = &data[0] });
+    TaskGraphNodeHandle b = graph.add_node({ .name = "b", .function = record_order_task, .arg = &data[1] });
+    TaskGraphNodeHandle c = graph.add_node({ .name = "c", .function = record_order_task, .arg = &data[2], .priority = TaskPriority::HIGH });
+    TaskGraphNodeHandle d = graph.add_node({ .name = "d", .function = record_order_task, .arg = &data[3] });
+    graph.add_dependency(a, b);
+    graph.add_dependency(a, c);
+    graph.add_dependency(b, d);
+    graph.add_dependency(c, d);
+    REQUIRE_FALSE(graph.is_compiled());
+    graph.compile();
+    REQUIRE(graph.is_compiled());
+
+    // The same graph is reused every "frame"
+    for (u32 frame = 0; frame < 100; frame++) {
+        next_slot = 0;
+        graph.execute(task_scheduler);
+
+        REQUIRE(next_slot == 4);
+        REQUIRE(finish_order[0] == 0);
+        REQUIRE(finish_order[1] > finish_order[0]);
+        REQUIRE(finish_order[2] > finish_order[0]);
+        REQUIRE(finish_order[3] == 3);
+    }
+}
+
+TEST_CASE("Task graphs can be submitted without blocking")
+{
+    TaskScheduler task_scheduler{};
+    task_scheduler.init({ .num_worker_threads = 2 });
+
+    std::atomic<u32> total = 0;
+    TaskGraph graph{};
+    TaskGraphNodeHandle previous = {};
+    // A long chain plus a few independent nodes
+    for (u32 i = 0; i < 64; i++) {
+        TaskGraphNodeHandle node = graph.add_node({ .function = increment_task, .arg = &total });
+        if (is_valid(previous)) {
+            graph.add_dependency(previous, node);
+        }
+        previous = node;
+    }
+    for (u32 i = 0; i < 16; i++) {
+        graph.add_node({ .function = increment_task, .arg = &total, .priority = TaskPriority::LOW });
+    }
+    graph.compile();
+    REQUIRE(graph.get_num_nodes() == 80);
+
+    for (u32 frame = 0; frame < 10; frame++) {
+        TaskCounter counter{};
+        graph.submit(task_scheduler, counter);
+        task_scheduler.wait_on_counter(counter);
+        REQUIRE(total == 80 * (frame + 1));
+    }
+}